@@ -1,48 +1,353 @@
+/**
+ * @file app_wifi.c
+ * @brief Wi-Fi station bring-up, BLE provisioning and reconnect manager
+ *
+ * Every attempt rewrites the station config: on the cached AP it sets the
+ * BSSID and channel (a single-channel probe instead of a ~2 s all-channel
+ * scan); otherwise it clears both and scans. Failures re-arm a one-shot
+ * esp_timer with the next backoff delay, so nothing blocks in the event
+ * loop. The cache is rewritten only when a join lands on a different AP,
+ * which keeps NVS writes to roaming and re-provisioning.
+ */
+
+#include <string.h>
+#include <stdio.h>
 #include "app_wifi.h"
+#include "sdkconfig.h"
 #include "esp_log.h"
-#include "esp_rmaker_core.h"
-#include "esp_rmaker_standard_types.h"
-#include "esp_rmaker_standard_params.h"
-#include "app_wifi.h"
-#include "nvs_flash.h"
 #include "esp_event.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "wifi_provisioning/manager.h"
+#include "wifi_provisioning/scheme_ble.h"
 
 static const char *TAG = "app_wifi";
 
-void wifi_event_handler(void* arg, esp_event_base_t event_base,
-                        int32_t event_id, void* event_data) {
-    if (event_base == WIFI_PROV_EVENT && event_id == WIFI_PROV_START) {
-        ESP_LOGI(TAG, "Provisioning started");
+#define AP_CACHE_NAMESPACE  "app_wifi"
+#define AP_CACHE_KEY        "ap"
+
+// Last AP joined, kept in NVS
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t ssid_hash;         // The cache belongs to this SSID only
+} ap_cache_t;
+
+// Attempts start on the esp_timer task (retries) and the event loop task
+// (STA start); their outcome arrives on the event loop. Everything from
+// here to stats is under stats_lock, which is never held across a Wi-Fi or
+// NVS call.
+static ap_cache_t ap_cache;
+static bool ap_cache_valid = false;
+
+static esp_timer_handle_t retry_timer = NULL;
+static uint32_t failures = 0;           // Failed attempts since the last IP
+static bool attempt_on_cache = false;
+static int64_t attempt_start_us = 0;
+static int64_t outage_start_us = 0;     // 0 while connected or before the first IP
+
+static app_wifi_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================
+// AP CACHE
+// ============================================
+
+static uint32_t ssid_hash(const uint8_t *ssid)
+{
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 32 && ssid[i]; i++) {
+        h = (h ^ ssid[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void ap_cache_load(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(AP_CACHE_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(ap_cache);
+    ap_cache_valid = nvs_get_blob(nvs, AP_CACHE_KEY, &ap_cache, &len) == ESP_OK &&
+                     len == sizeof(ap_cache);
+    nvs_close(nvs);
+}
+
+static void ap_cache_store(const uint8_t bssid[6], uint8_t channel, uint32_t hash)
+{
+    ap_cache_t entry;
+
+    taskENTER_CRITICAL(&stats_lock);
+    bool same = ap_cache_valid && memcmp(ap_cache.bssid, bssid, 6) == 0 &&
+                ap_cache.channel == channel && ap_cache.ssid_hash == hash;
+    if (!same) {
+        memcpy(ap_cache.bssid, bssid, 6);
+        ap_cache.channel = channel;
+        ap_cache.ssid_hash = hash;
+        ap_cache_valid = true;
+    }
+    entry = ap_cache;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    if (same) {
+        return;
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(AP_CACHE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, AP_CACHE_KEY, &entry, sizeof(entry));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "AP cache not saved: %s", esp_err_to_name(err));
+    }
+}
+
+// ============================================
+// ATTEMPTS AND BACKOFF
+// ============================================
+
+static void start_attempt(void)
+{
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+        return;
+    }
+
+    uint32_t hash = ssid_hash(cfg.sta.ssid);
+    ap_cache_t cache;
+
+    taskENTER_CRITICAL(&stats_lock);
+    bool on_cache = ap_cache_valid && ap_cache.ssid_hash == hash &&
+                    failures < CONFIG_APP_WIFI_FAST_REJOIN_TRIES;
+    cache = ap_cache;
+    attempt_on_cache = on_cache;
+    attempt_start_us = esp_timer_get_time();
+    stats.attempts++;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    if (on_cache) {
+        cfg.sta.bssid_set = true;
+        memcpy(cfg.sta.bssid, cache.bssid, 6);
+        cfg.sta.channel = cache.channel;
+        cfg.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        cfg.sta.bssid_set = false;
+        cfg.sta.channel = 0;
+        cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        cfg.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+    cfg.sta.listen_interval = CONFIG_APP_WIFI_LISTEN_INTERVAL;    // Used in max modem sleep
+    esp_wifi_set_config(WIFI_IF_STA, &cfg);
+
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(err));
+    }
+}
+
+// Equal jitter: the upper half of min * 2^(n-1), capped
+static uint32_t backoff_ms(uint32_t n)
+{
+    uint32_t shift = n > 16 ? 16 : n - 1;
+    uint64_t ceiling = (uint64_t)CONFIG_APP_WIFI_BACKOFF_MIN_MS << shift;
+    if (ceiling > CONFIG_APP_WIFI_BACKOFF_MAX_MS) {
+        ceiling = CONFIG_APP_WIFI_BACKOFF_MAX_MS;
+    }
+    uint32_t half = (uint32_t)ceiling / 2;
+    return half + esp_random() % (half + 1);
+}
+
+static void retry_timer_cb(void *arg)
+{
+    start_attempt();
+}
+
+// ============================================
+// EVENT HANDLERS
+// ============================================
+
+static void on_disconnected(const wifi_event_sta_disconnected_t *event)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&stats_lock);
+    bool dropped = stats.connected;
+    if (dropped) {
+        stats.connected = false;
+        stats.disconnects++;
+        outage_start_us = now_us;
+    }
+    if (attempt_on_cache && (event->reason == WIFI_REASON_NO_AP_FOUND ||
+                             event->reason == WIFI_REASON_BEACON_TIMEOUT)) {
+        stats.cache_misses++;
+    }
+    // A lost connection is not a failed attempt: the first retry after it
+    // still goes to the cached AP
+    if (!dropped) {
+        failures++;
+    }
+    uint32_t failed = failures;
+    bool cache_valid = ap_cache_valid;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    // Probes on the cached AP are cheap, only failed scans grow the backoff
+    uint32_t scans_failed = failed > CONFIG_APP_WIFI_FAST_REJOIN_TRIES ?
+                            failed - CONFIG_APP_WIFI_FAST_REJOIN_TRIES : 0;
+    uint32_t delay_ms = backoff_ms(scans_failed + 1);
+    ESP_LOGW(TAG, "Disconnected (reason %d), retry %lu in %lu ms%s", event->reason,
+             failed + 1, delay_ms,
+             failed < CONFIG_APP_WIFI_FAST_REJOIN_TRIES && cache_valid ? " on cached AP" : "");
+
+    esp_timer_stop(retry_timer);
+    esp_timer_start_once(retry_timer, (uint64_t)delay_ms * 1000);
+}
+
+static void on_got_ip(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t outage_ms = 0;
+
+    taskENTER_CRITICAL(&stats_lock);
+    uint32_t join_ms = (uint32_t)((now_us - attempt_start_us) / 1000);
+    bool on_cache = attempt_on_cache;
+    uint32_t failed = failures;
+    failures = 0;
+    stats.connected = true;
+    stats.connects++;
+    stats.last_join_ms = join_ms;
+    if (on_cache) {
+        stats.fast_joins++;
+    }
+    if (outage_start_us != 0) {
+        outage_ms = (uint32_t)((now_us - outage_start_us) / 1000);
+        stats.last_outage_ms = outage_ms;
+        stats.total_outage_ms += outage_ms;
+        if (outage_ms > stats.max_outage_ms) {
+            stats.max_outage_ms = outage_ms;
+        }
+        outage_start_us = 0;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGI(TAG, "Connected in %lu ms (%s, %lu failed attempts), outage %lu ms", join_ms,
+             on_cache ? "cached AP" : "scan", failed, outage_ms);
+
+    wifi_ap_record_t ap;
+    wifi_config_t cfg;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK &&
+        esp_wifi_get_config(WIFI_IF_STA, &cfg) == ESP_OK) {
+        ap_cache_store(ap.bssid, ap.primary, ssid_hash(cfg.sta.ssid));
+    }
+}
+
+static void event_handler(void *arg, esp_event_base_t event_base,
+                          int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_PROV_EVENT) {
+        if (event_id == WIFI_PROV_START) {
+            ESP_LOGI(TAG, "Provisioning started");
+        } else if (event_id == WIFI_PROV_CRED_FAIL) {
+            ESP_LOGW(TAG, "Provisioning failed, credentials rejected");
+        } else if (event_id == WIFI_PROV_END) {
+            wifi_prov_mgr_deinit();
+        }
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
+        start_attempt();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        on_disconnected((const wifi_event_sta_disconnected_t *)event_data);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ESP_LOGI(TAG, "Connected to Wi-Fi");
+        on_got_ip();
     }
 }
 
-void app_wifi_start_provisioning(const char *pop, const char *service_name) {
+// ============================================
+// PUBLIC API
+// ============================================
+
+void app_wifi_init(void)
+{
+    ESP_ERROR_CHECK(esp_netif_init());
+    esp_err_t err = esp_event_loop_create_default();
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(err);
+    }
+
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_PROV_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL));
+
+    esp_netif_create_default_wifi_sta();
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
-    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_start());
 
+    const esp_timer_create_args_t timer_args = {
+        .callback = retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &retry_timer));
+
+    ap_cache_load();
+}
+
+esp_err_t app_wifi_start(app_wifi_pop_type_t pop_type)
+{
     wifi_prov_mgr_config_t config = {
         .scheme = wifi_prov_scheme_ble,
         .scheme_event_handler = WIFI_PROV_SCHEME_BLE_EVENT_HANDLER_FREE_BTDM,
-        .app_info = NULL
     };
-    wifi_prov_mgr_init(config);
+    esp_err_t err = wifi_prov_mgr_init(config);
+    if (err != ESP_OK) {
+        return err;
+    }
 
     bool provisioned = false;
     wifi_prov_mgr_is_provisioned(&provisioned);
-    if (!provisioned) {
-        ESP_LOGI(TAG, "Starting BLE provisioning");
-        wifi_prov_mgr_start_provisioning(WIFI_PROV_SECURITY_1, pop, service_name);
-    } else {
-        ESP_LOGI(TAG, "Already provisioned, starting Wi-Fi...");
+    if (provisioned) {
+        ESP_LOGI(TAG, "Already provisioned, starting Wi-Fi%s",
+                 ap_cache_valid ? " (cached AP)" : "");
         wifi_prov_mgr_deinit();
+        err = esp_wifi_set_mode(WIFI_MODE_STA);
+        if (err == ESP_OK) {
+            err = esp_wifi_start();
+        }
+        return err;
     }
+
+    uint8_t mac[6];
+    esp_wifi_get_mac(WIFI_IF_STA, mac);
+    char service_name[12];
+    snprintf(service_name, sizeof(service_name), "PROV_%02X%02X%02X", mac[3], mac[4], mac[5]);
+
+    char pop[9];
+    const char *pop_arg = pop;
+    if (pop_type == POP_TYPE_MAC) {
+        snprintf(pop, sizeof(pop), "%02x%02x%02x%02x", mac[2], mac[3], mac[4], mac[5]);
+    } else if (pop_type == POP_TYPE_RANDOM) {
+        snprintf(pop, sizeof(pop), "%08lx", (unsigned long)esp_random());
+    } else {
+        pop_arg = NULL;
+    }
+
+    ESP_LOGI(TAG, "Starting BLE provisioning as %s, PoP %s", service_name,
+             pop_arg ? pop_arg : "none");
+    return wifi_prov_mgr_start_provisioning(WIFI_PROV_SECURITY_1, pop_arg, service_name, NULL);
+}
+
+void app_wifi_get_stats(app_wifi_stats_t *out)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&stats_lock);
 }
@@ -1,10 +1,66 @@
+/**
+ * @file app_wifi.h
+ * @brief Wi-Fi station bring-up, BLE provisioning and reconnect manager
+ *
+ * Connects with the stored credentials, or starts BLE provisioning when
+ * there are none. After a failed attempt or a lost connection it retries
+ * with jittered exponential backoff. The BSSID and channel of the last AP
+ * are cached in NVS, so a rejoin after a reboot or a drop goes straight to
+ * that AP instead of scanning every channel first.
+ *
+ * Connection state reaches the application through the usual esp_event
+ * events (WIFI_EVENT_STA_DISCONNECTED, IP_EVENT_STA_GOT_IP).
+ */
+
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void app_wifi_start_provisioning(const char *pop, const char *service_name);
+typedef enum {
+    POP_TYPE_NONE,
+    POP_TYPE_MAC,       // Last four bytes of the station MAC
+    POP_TYPE_RANDOM,    // Random per boot, printed to the log
+} app_wifi_pop_type_t;
+
+typedef struct {
+    uint32_t attempts;          // esp_wifi_connect() calls
+    uint32_t connects;          // Got an IP
+    uint32_t disconnects;       // Lost the connection after having an IP
+    uint32_t fast_joins;        // Connected on the cached BSSID/channel
+    uint32_t cache_misses;      // Cached AP not found on its channel
+    uint32_t last_join_ms;      // Start of the successful attempt to IP
+    uint32_t last_outage_ms;    // Disconnect to IP again
+    uint32_t max_outage_ms;
+    uint64_t total_outage_ms;   // Finished outages only
+    bool connected;
+} app_wifi_stats_t;
+
+/**
+ * @brief Initialise netif, the default event loop and the Wi-Fi driver
+ *
+ * Needs NVS. Does not start the radio.
+ */
+void app_wifi_init(void);
+
+/**
+ * @brief Start the station, or BLE provisioning if not provisioned yet
+ *
+ * Returns at once; the connection comes up in the background.
+ *
+ * @param pop_type Proof of possession used for provisioning
+ */
+esp_err_t app_wifi_start(app_wifi_pop_type_t pop_type);
+
+/**
+ * @brief Copy the connection counters
+ */
+void app_wifi_get_stats(app_wifi_stats_t *out);
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "rom/ets_sys.h"
+#include "evtrace.h"
 
 static const char *TAG = "DHT11";
 static gpio_num_t dht_gpio;
@@ -59,10 +60,41 @@ static int wait_for_level(int level, int timeout_us)
     return elapsed;
 }
 
-esp_err_t dht11_read(float *temperature, float *humidity)
+esp_err_t dht11_decode(const uint8_t levels[DHT11_FRAME_BITS],
+                       float *temperature, float *humidity)
 {
     uint8_t data[5] = {0};
     
+    // Pack the sampled levels MSB first: still HIGH after 30us means '1'
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        data[i / 8] = (uint8_t)((data[i / 8] << 1) | (levels[i] ? 1 : 0));
+    }
+    
+    // Verify checksum
+    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
+    if (checksum != data[4]) {
+        ESP_LOGW(TAG, "Checksum error: calc=0x%02X, recv=0x%02X", checksum, data[4]);
+        return ESP_FAIL;
+    }
+    
+    // Parse data
+    *humidity = (float)data[0] + (float)data[1] / 10.0f;
+    *temperature = (float)data[2] + (float)data[3] / 10.0f;
+    
+    // Validate ranges
+    if (*temperature < -40.0f || *temperature > 80.0f || 
+        *humidity < 0.0f || *humidity > 100.0f) {
+        ESP_LOGW(TAG, "Invalid readings: T=%.1f, H=%.1f", *temperature, *humidity);
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t dht11_read(float *temperature, float *humidity)
+{
+    uint8_t levels[DHT11_FRAME_BITS];
+    
     // Disable interrupts for precise timing
     portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
     portENTER_CRITICAL(&mux);
@@ -99,10 +131,12 @@ esp_err_t dht11_read(float *temperature, float *humidity)
         return ESP_FAIL;
     }
     
-    // Read 40 bits (5 bytes)
-    for (int i = 0; i < 40; i++) {
+    // Sample 40 bits; packing and checksum happen after the critical section
+    TRACE_BEGIN(DHT_DECODE);
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
         // Wait for bit to start (HIGH)
         if (wait_for_level(1, DHT_BIT_TIMEOUT) < 0) {
+            TRACE_END(DHT_DECODE);
             portEXIT_CRITICAL(&mux);
             ESP_LOGW(TAG, "Timeout reading bit %d", i);
             return ESP_FAIL;
@@ -111,43 +145,24 @@ esp_err_t dht11_read(float *temperature, float *humidity)
         // Measure HIGH pulse duration
         ets_delay_us(30);  // Wait 30us
         
-        int level = gpio_get_level(dht_gpio);
+        levels[i] = (uint8_t)gpio_get_level(dht_gpio);
         
         // Wait for bit to end (LOW)
         if (wait_for_level(0, DHT_BIT_TIMEOUT) < 0) {
+            TRACE_END(DHT_DECODE);
             portEXIT_CRITICAL(&mux);
             ESP_LOGW(TAG, "Timeout ending bit %d", i);
             return ESP_FAIL;
         }
-        
-        // If still HIGH after 30us, it's a '1', otherwise '0'
-        data[i / 8] <<= 1;
-        if (level == 1) {
-            data[i / 8] |= 1;
-        }
     }
+    TRACE_END(DHT_DECODE);
     
     portEXIT_CRITICAL(&mux);
     
-    // Verify checksum
-    uint8_t checksum = data[0] + data[1] + data[2] + data[3];
-    if (checksum != data[4]) {
-        ESP_LOGW(TAG, "Checksum error: calc=0x%02X, recv=0x%02X", checksum, data[4]);
-        return ESP_FAIL;
+    esp_err_t ret = dht11_decode(levels, temperature, humidity);
+    if (ret == ESP_OK) {
+        ESP_LOGD(TAG, "Read success: T=%.1f°C, H=%.1f%%", *temperature, *humidity);
     }
     
-    // Parse data
-    *humidity = (float)data[0] + (float)data[1] / 10.0f;
-    *temperature = (float)data[2] + (float)data[3] / 10.0f;
-    
-    // Validate ranges
-    if (*temperature < -40.0f || *temperature > 80.0f || 
-        *humidity < 0.0f || *humidity > 100.0f) {
-        ESP_LOGW(TAG, "Invalid readings: T=%.1f, H=%.1f", *temperature, *humidity);
-        return ESP_FAIL;
-    }
-    
-    ESP_LOGD(TAG, "Read success: T=%.1f°C, H=%.1f%%", *temperature, *humidity);
-    
-    return ESP_OK;
+    return ret;
 }
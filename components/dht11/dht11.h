@@ -15,6 +15,9 @@
 extern "C" {
 #endif
 
+// Bits per DHT11 frame: humidity (2 bytes), temperature (2 bytes), checksum
+#define DHT11_FRAME_BITS 40
+
 /**
  * @brief Initialize DHT11 sensor
  * 
@@ -54,6 +57,24 @@ esp_err_t dht11_init(gpio_num_t gpio_num);
  */
 esp_err_t dht11_read(float *temperature, float *humidity);
 
+/**
+ * @brief Decode one sampled DHT11 frame
+ * 
+ * Packs the 40 line levels sampled 30us into each bit (non-zero = '1'),
+ * verifies the checksum and converts to engineering units. Used by
+ * dht11_read() once the timing-critical part is over.
+ * 
+ * @param levels Sampled level of each bit, MSB of byte 0 first
+ * @param[out] temperature Temperature in Celsius
+ * @param[out] humidity Relative humidity percentage
+ * 
+ * @return 
+ *     - ESP_OK on a valid frame
+ *     - ESP_FAIL on checksum mismatch or out-of-range values
+ */
+esp_err_t dht11_decode(const uint8_t levels[DHT11_FRAME_BITS],
+                       float *temperature, float *humidity);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,213 @@
+/**
+ * @file dlog.c
+ * @brief Deferred binary logging ring implementation
+ *
+ * Record layout (32-bit words):
+ *   [0] DLOG_MAGIC << 24 | level << 20 | nargs << 16 | sequence
+ *   [1] format string address
+ *   [2] tag string address
+ *   [3] esp_timer timestamp, low 32 bits of microseconds
+ *   [4..] arguments, one word each
+ *
+ * Writers reserve space with a single atomic add on the write position, so
+ * tasks and ISRs never block each other. The ring overwrites its oldest
+ * records; the decoder resynchronises on the magic byte.
+ */
+
+#include "dlog.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_console.h"
+
+static const char *TAG = "DLOG";
+
+#define DLOG_MAGIC          0xD1
+#define DLOG_HEADER_WORDS   4
+
+#if CONFIG_DLOG_ENABLE
+
+#define DLOG_RING_MASK      (CONFIG_DLOG_RING_WORDS - 1)
+
+_Static_assert((CONFIG_DLOG_RING_WORDS & DLOG_RING_MASK) == 0,
+               "CONFIG_DLOG_RING_WORDS must be a power of two");
+
+static uint32_t ring[CONFIG_DLOG_RING_WORDS];
+static atomic_uint_fast32_t write_pos;
+static atomic_bool paused;
+
+static atomic_uint_fast32_t stat_records;
+static atomic_uint_fast32_t stat_words;
+static atomic_uint_fast32_t stat_dropped;
+static atomic_uint_fast32_t stat_cycles;
+
+// ============================================
+// RECORDING
+// ============================================
+
+void dlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                const uint32_t *args, uint32_t nargs)
+{
+    if (atomic_load_explicit(&paused, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&stat_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    uint32_t words = DLOG_HEADER_WORDS + nargs;
+    uint32_t pos = atomic_fetch_add_explicit(&write_pos, words, memory_order_relaxed);
+    uint32_t sequence = atomic_fetch_add_explicit(&stat_records, 1, memory_order_relaxed);
+
+    ring[pos & DLOG_RING_MASK] = ((uint32_t)DLOG_MAGIC << 24) |
+                                 ((uint32_t)level << 20) |
+                                 (nargs << 16) | (sequence & 0xFFFF);
+    ring[(pos + 1) & DLOG_RING_MASK] = (uint32_t)(uintptr_t)fmt;
+    ring[(pos + 2) & DLOG_RING_MASK] = (uint32_t)(uintptr_t)tag;
+    ring[(pos + 3) & DLOG_RING_MASK] = (uint32_t)esp_timer_get_time();
+    for (uint32_t i = 0; i < nargs; i++) {
+        ring[(pos + DLOG_HEADER_WORDS + i) & DLOG_RING_MASK] = args[i];
+    }
+
+    atomic_fetch_add_explicit(&stat_words, words, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat_cycles, esp_cpu_get_cycle_count() - start,
+                              memory_order_relaxed);
+}
+
+void dlog_dump(void)
+{
+    atomic_store(&paused, true);
+
+    uint32_t end = atomic_load(&write_pos);
+    uint32_t count = end < CONFIG_DLOG_RING_WORDS ? end : CONFIG_DLOG_RING_WORDS;
+    uint32_t start = end - count;
+
+    printf("=== DLOG BEGIN pos=%lu words=%lu dropped=%lu ===\n",
+           (unsigned long)start, (unsigned long)count,
+           (unsigned long)atomic_load(&stat_dropped));
+    for (uint32_t i = 0; i < count; i++) {
+        printf("%08lx%c", (unsigned long)ring[(start + i) & DLOG_RING_MASK],
+               (i % 8 == 7 || i == count - 1) ? '\n' : ' ');
+    }
+    printf("=== DLOG END ===\n");
+
+    atomic_store(&paused, false);
+}
+
+void dlog_clear(void)
+{
+    atomic_store(&paused, true);
+    atomic_store(&write_pos, 0);
+    atomic_store(&stat_records, 0);
+    atomic_store(&stat_words, 0);
+    atomic_store(&stat_dropped, 0);
+    atomic_store(&stat_cycles, 0);
+    atomic_store(&paused, false);
+}
+
+void dlog_get_stats(dlog_stats_t *stats)
+{
+    stats->records = atomic_load(&stat_records);
+    stats->bytes = atomic_load(&stat_words) * sizeof(uint32_t);
+    stats->dropped = atomic_load(&stat_dropped);
+    stats->cycles = atomic_load(&stat_cycles);
+}
+
+#else // !CONFIG_DLOG_ENABLE
+
+void dlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                const uint32_t *args, uint32_t nargs)
+{
+}
+
+void dlog_dump(void)
+{
+    printf("Deferred logging disabled (CONFIG_DLOG_ENABLE)\n");
+}
+
+void dlog_clear(void)
+{
+}
+
+void dlog_get_stats(dlog_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // CONFIG_DLOG_ENABLE
+
+// ============================================
+// CONSOLE COMMAND
+// ============================================
+
+#define DLOG_BENCH_ROUNDS   32
+
+/**
+ * Cost of one typical per-sample line: formatted into RAM (the part of
+ * ESP_LOGI that runs before the UART) versus recorded in the ring.
+ */
+static void dlog_bench(void)
+{
+    char line[96];
+    float temperature = 24.5f;
+    float humidity = 55.0f;
+    int light = 2000;
+    int aqi = 57;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < DLOG_BENCH_ROUNDS; i++) {
+        snprintf(line, sizeof(line), "AQI calculation: T=%.1f, H=%.1f, L=%d → AQI=%d",
+                 temperature, humidity, light, aqi);
+    }
+    uint32_t text_cycles = (esp_cpu_get_cycle_count() - start) / DLOG_BENCH_ROUNDS;
+
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < DLOG_BENCH_ROUNDS; i++) {
+        DLOGD(TAG, "AQI calculation: T=%.1f, H=%.1f, L=%d → AQI=%d",
+              temperature, humidity, light, aqi);
+    }
+    uint32_t binary_cycles = (esp_cpu_get_cycle_count() - start) / DLOG_BENCH_ROUNDS;
+
+    printf("snprintf: %lu cycles/line (%d bytes + UART), dlog: %lu cycles/line (%d bytes)\n",
+           (unsigned long)text_cycles, (int)strlen(line),
+           (unsigned long)binary_cycles, (DLOG_HEADER_WORDS + 4) * 4);
+}
+
+static int dlog_cmd(int argc, char **argv)
+{
+    const char *action = argc > 1 ? argv[1] : "dump";
+
+    if (strcmp(action, "dump") == 0) {
+        dlog_dump();
+    } else if (strcmp(action, "stats") == 0) {
+        dlog_stats_t stats;
+        dlog_get_stats(&stats);
+        printf("records=%lu bytes=%lu dropped=%lu cycles/record=%lu\n",
+               (unsigned long)stats.records, (unsigned long)stats.bytes,
+               (unsigned long)stats.dropped,
+               (unsigned long)(stats.records ? stats.cycles / stats.records : 0));
+    } else if (strcmp(action, "clear") == 0) {
+        dlog_clear();
+    } else if (strcmp(action, "bench") == 0) {
+        dlog_bench();
+    } else {
+        printf("usage: dlog [dump|stats|clear|bench]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t dlog_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "dlog",
+        .help = "Deferred log ring: dump (default), stats, clear, bench",
+        .hint = "[dump|stats|clear|bench]",
+        .func = dlog_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
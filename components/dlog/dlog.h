@@ -0,0 +1,137 @@
+/**
+ * @file dlog.h
+ * @brief Deferred binary logging
+ *
+ * DLOGx(tag, fmt, ...) is a drop-in for ESP_LOGx() on hot paths. Instead of
+ * running vfprintf and the UART it stores the address of the format string,
+ * the tag address, a microsecond timestamp and each argument as one raw
+ * 32-bit word in a lock-free RAM ring. Text is produced only on the host by
+ * tools/dlog_decode.py, which looks the strings up in the application ELF.
+ *
+ * Restrictions in deferred mode:
+ * - at most 8 arguments, each stored as 32 bits (no 64-bit integers)
+ * - float/double arguments are stored as float
+ * - %s arguments must point at string literals (flash), not RAM buffers
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ring statistics
+ */
+typedef struct {
+    uint32_t records;           // Records written since boot/clear
+    uint32_t bytes;             // Ring bytes written (headers + arguments)
+    uint32_t dropped;           // Records discarded while the ring was paused
+    uint32_t cycles;            // CPU cycles spent inside dlog_write()
+} dlog_stats_t;
+
+/**
+ * @brief Append one record to the ring (use the DLOGx macros instead)
+ */
+void dlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                const uint32_t *args, uint32_t nargs);
+
+/**
+ * @brief Print the ring as hex words between DLOG BEGIN/END markers
+ *
+ * Recording is paused while the dump runs.
+ */
+void dlog_dump(void);
+
+/**
+ * @brief Discard all records and reset the statistics
+ */
+void dlog_clear(void);
+
+/**
+ * @brief Read the ring statistics
+ */
+void dlog_get_stats(dlog_stats_t *stats);
+
+/**
+ * @brief Register the "dlog" console command (dump / stats / clear / bench)
+ */
+esp_err_t dlog_register_console(void);
+
+#if CONFIG_DLOG_ENABLE
+
+static inline uint32_t dlog_float_word(double value)
+{
+    float f = (float)value;
+    uint32_t word;
+    memcpy(&word, &f, sizeof(word));
+    return word;
+}
+
+static inline uint32_t dlog_ptr_word(const void *ptr)
+{
+    return (uint32_t)(uintptr_t)ptr;
+}
+
+static inline uint32_t dlog_int_word(uint32_t value)
+{
+    return value;
+}
+
+#define DLOG_WORD(x) _Generic((x),                                  \
+        float: dlog_float_word,                                     \
+        double: dlog_float_word,                                    \
+        char *: dlog_ptr_word,                                      \
+        const char *: dlog_ptr_word,                                \
+        void *: dlog_ptr_word,                                      \
+        const void *: dlog_ptr_word,                                \
+        default: dlog_int_word)(x)
+
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define DLOG_NARGS(...) DLOG_NARGS_(_0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_CAT_(a, b) a##b
+#define DLOG_CAT(a, b) DLOG_CAT_(a, b)
+
+#define DLOG_MAP_0()
+#define DLOG_MAP_1(a)      DLOG_WORD(a)
+#define DLOG_MAP_2(a, ...) DLOG_WORD(a), DLOG_MAP_1(__VA_ARGS__)
+#define DLOG_MAP_3(a, ...) DLOG_WORD(a), DLOG_MAP_2(__VA_ARGS__)
+#define DLOG_MAP_4(a, ...) DLOG_WORD(a), DLOG_MAP_3(__VA_ARGS__)
+#define DLOG_MAP_5(a, ...) DLOG_WORD(a), DLOG_MAP_4(__VA_ARGS__)
+#define DLOG_MAP_6(a, ...) DLOG_WORD(a), DLOG_MAP_5(__VA_ARGS__)
+#define DLOG_MAP_7(a, ...) DLOG_WORD(a), DLOG_MAP_6(__VA_ARGS__)
+#define DLOG_MAP_8(a, ...) DLOG_WORD(a), DLOG_MAP_7(__VA_ARGS__)
+#define DLOG_MAP(...) DLOG_CAT(DLOG_MAP_, DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+#define DLOG_RECORD(level, tag, fmt, ...) do {                      \
+        const uint32_t dlog_args_[] = { 0, DLOG_MAP(__VA_ARGS__) }; \
+        dlog_write(level, tag, fmt, &dlog_args_[1],                 \
+                   DLOG_NARGS(__VA_ARGS__));                        \
+    } while (0)
+
+#define DLOGE(tag, fmt, ...) DLOG_RECORD(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define DLOGW(tag, fmt, ...) DLOG_RECORD(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define DLOGI(tag, fmt, ...) DLOG_RECORD(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define DLOGD(tag, fmt, ...) DLOG_RECORD(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+#else // !CONFIG_DLOG_ENABLE
+
+#define DLOGE(tag, fmt, ...) ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#define DLOGW(tag, fmt, ...) ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define DLOGI(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define DLOGD(tag, fmt, ...) ESP_LOGD(tag, fmt, ##__VA_ARGS__)
+
+#endif // CONFIG_DLOG_ENABLE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DLOG_H
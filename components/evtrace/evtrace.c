@@ -0,0 +1,202 @@
+/**
+ * @file evtrace.c
+ * @brief Lightweight binary event trace recorder implementation
+ *
+ * Entry layout (two 32-bit words):
+ *   [0] CPU cycle counter
+ *   [1] type << 30 | task number << 22 | event << 16 | argument
+ *
+ * The cycle counter wraps every few tens of seconds; the host converter
+ * unwraps it, which holds as long as consecutive events are closer than one
+ * wrap period (the 2 s display/alert loops guarantee that).
+ *
+ * The task number is the TCB number, stored with vTaskSetTaskNumber on a
+ * task's first event; the dump lists the tasks that recorded events, so
+ * one deleted since (app_main's) still has a name.
+ */
+
+#include "evtrace.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_log.h"
+#include "esp_console.h"
+
+static const char *TAG = "EVTRACE";
+
+_Static_assert(EVT_COUNT <= 64, "event IDs are stored in 6 bits");
+
+#if CONFIG_EVTRACE_ENABLE
+
+#define EVTRACE_RING_MASK   (CONFIG_EVTRACE_RING_EVENTS - 1)
+#define EVTRACE_MAX_TASKS   24
+
+_Static_assert((CONFIG_EVTRACE_RING_EVENTS & EVTRACE_RING_MASK) == 0,
+               "CONFIG_EVTRACE_RING_EVENTS must be a power of two");
+
+static const char *const event_names[] = {
+#define EVTRACE_NAME(id, name) name,
+    EVTRACE_EVENT_LIST(EVTRACE_NAME)
+#undef EVTRACE_NAME
+};
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t info;
+} evtrace_entry_t;
+
+// A task the recorder has seen, named in the dump even once deleted
+typedef struct {
+    uint32_t number;
+    char name[16];
+} evtrace_task_t;
+
+static evtrace_entry_t ring[CONFIG_EVTRACE_RING_EVENTS];
+static atomic_uint_fast32_t write_idx;
+static atomic_bool paused;
+
+static evtrace_task_t tasks[EVTRACE_MAX_TASKS];
+static atomic_uint_fast32_t task_count;
+
+// ============================================
+// RECORDING
+// ============================================
+
+/**
+ * First event of a task. The trace-facility number stays 0 unless someone
+ * sets it, so give the task its TCB number (what uxTaskGetSystemState
+ * reports) and note its name for the dump.
+ */
+static uint32_t trace_task(TaskHandle_t task)
+{
+    TaskStatus_t status;
+    vTaskGetInfo(task, &status, pdFALSE, eRunning);
+    vTaskSetTaskNumber(task, status.xTaskNumber);
+
+    uint32_t slot = atomic_fetch_add_explicit(&task_count, 1, memory_order_relaxed);
+    if (slot < EVTRACE_MAX_TASKS) {
+        tasks[slot].number = status.xTaskNumber;
+        strlcpy(tasks[slot].name, status.pcTaskName, sizeof(tasks[slot].name));
+    }
+    return status.xTaskNumber;
+}
+
+void evtrace_record(evtrace_type_t type, evtrace_event_t event, uint16_t arg)
+{
+    if (atomic_load_explicit(&paused, memory_order_relaxed)) {
+        return;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t task_number = task ? (uint32_t)uxTaskGetTaskNumber(task) : 0;
+    if (task && task_number == 0) {
+        task_number = trace_task(task);
+    }
+    uint32_t idx = atomic_fetch_add_explicit(&write_idx, 1, memory_order_relaxed);
+    evtrace_entry_t *entry = &ring[idx & EVTRACE_RING_MASK];
+
+    entry->cycles = esp_cpu_get_cycle_count();
+    entry->info = ((uint32_t)type << 30) | ((task_number & 0xFF) << 22) |
+                  (((uint32_t)event & 0x3F) << 16) | arg;
+}
+
+// ============================================
+// DUMP
+// ============================================
+
+static void dump_tasks(void)
+{
+    uint32_t count = atomic_load(&task_count);
+    if (count > EVTRACE_MAX_TASKS) {
+        count = EVTRACE_MAX_TASKS;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        printf("task %lu %s\n", (unsigned long)tasks[i].number, tasks[i].name);
+    }
+}
+
+void evtrace_dump(void)
+{
+    atomic_store(&paused, true);
+
+    uint32_t end = atomic_load(&write_idx);
+    uint32_t count = end < CONFIG_EVTRACE_RING_EVENTS ? end : CONFIG_EVTRACE_RING_EVENTS;
+    uint32_t start = end - count;
+
+    printf("=== TRACE BEGIN cpu_mhz=%lu events=%lu ===\n",
+           (unsigned long)esp_rom_get_cpu_ticks_per_us(), (unsigned long)count);
+    dump_tasks();
+    for (int i = 0; i < EVT_COUNT; i++) {
+        printf("event %d %s\n", i, event_names[i]);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const evtrace_entry_t *entry = &ring[(start + i) & EVTRACE_RING_MASK];
+        printf("%08lx %08lx%c", (unsigned long)entry->cycles, (unsigned long)entry->info,
+               (i % 4 == 3 || i == count - 1) ? '\n' : ' ');
+    }
+    printf("=== TRACE END ===\n");
+
+    atomic_store(&paused, false);
+}
+
+void evtrace_clear(void)
+{
+    atomic_store(&paused, true);
+    atomic_store(&write_idx, 0);
+    atomic_store(&paused, false);
+}
+
+#else // !CONFIG_EVTRACE_ENABLE
+
+void evtrace_record(evtrace_type_t type, evtrace_event_t event, uint16_t arg)
+{
+}
+
+void evtrace_dump(void)
+{
+    printf("Event tracing disabled (CONFIG_EVTRACE_ENABLE)\n");
+}
+
+void evtrace_clear(void)
+{
+}
+
+#endif // CONFIG_EVTRACE_ENABLE
+
+// ============================================
+// CONSOLE COMMAND
+// ============================================
+
+static int trace_cmd(int argc, char **argv)
+{
+    const char *action = argc > 1 ? argv[1] : "dump";
+
+    if (strcmp(action, "dump") == 0) {
+        evtrace_dump();
+    } else if (strcmp(action, "clear") == 0) {
+        evtrace_clear();
+    } else {
+        printf("usage: trace [dump|clear]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t evtrace_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "trace",
+        .help = "Event trace ring: dump (default) or clear",
+        .hint = "[dump|clear]",
+        .func = trace_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file evtrace.h
+ * @brief Lightweight binary event trace recorder
+ *
+ * TRACE_BEGIN(id)/TRACE_END(id) bracket a span and TRACE_INSTANT(id, arg)
+ * marks a point event on the calling task's timeline. Events cost one atomic
+ * add and two word stores, so they can stay enabled in the field and inside
+ * critical sections.
+ */
+
+#ifndef EVTRACE_H
+#define EVTRACE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Every traced event, as (ID, name shown in the trace viewer)
+ *
+ * IDs are stored in 6 bits; append new events at the end so older captures
+ * keep decoding.
+ */
+#define EVTRACE_EVENT_LIST(X)                       \
+    X(SENSOR_CYCLE,     "sensor_cycle")             \
+    X(DHT_READ,         "dht_read")                 \
+    X(DHT_DECODE,       "dht_decode")               \
+    X(LDR_READ,         "ldr_read")                 \
+    X(AQI_CALC,         "aqi_calc")                 \
+    X(QUEUE_SEND,       "queue_send")               \
+    X(DISPLAY_UPDATE,   "display_update")           \
+    X(I2C_FLUSH,        "i2c_flush")                \
+    X(ALERT_CHECK,      "alert_check")              \
+    X(ALERT_NOTIFY,     "alert_notify")             \
+    X(MUTEX_WAIT,       "rmaker_mutex_wait")        \
+    X(PUBLISH,          "publish")                  \
+    X(OTA_CHECK,        "ota_check")
+
+typedef enum {
+#define EVTRACE_ENUM(id, name) EVT_##id,
+    EVTRACE_EVENT_LIST(EVTRACE_ENUM)
+#undef EVTRACE_ENUM
+    EVT_COUNT
+} evtrace_event_t;
+
+typedef enum {
+    EVTRACE_BEGIN = 0,
+    EVTRACE_END = 1,
+    EVTRACE_INSTANT = 2,
+} evtrace_type_t;
+
+/**
+ * @brief Append one event to the ring (use the TRACE_x macros instead)
+ */
+void evtrace_record(evtrace_type_t type, evtrace_event_t event, uint16_t arg);
+
+/**
+ * @brief Print the task/event tables and the ring between TRACE BEGIN/END markers
+ *
+ * Recording is paused while the dump runs.
+ */
+void evtrace_dump(void);
+
+/**
+ * @brief Discard all recorded events
+ */
+void evtrace_clear(void);
+
+/**
+ * @brief Register the "trace" console command (dump / clear)
+ */
+esp_err_t evtrace_register_console(void);
+
+#if CONFIG_EVTRACE_ENABLE
+#define TRACE_BEGIN(id)             evtrace_record(EVTRACE_BEGIN, EVT_##id, 0)
+#define TRACE_END(id)               evtrace_record(EVTRACE_END, EVT_##id, 0)
+#define TRACE_INSTANT(id, arg)      evtrace_record(EVTRACE_INSTANT, EVT_##id, (uint16_t)(arg))
+#else
+#define TRACE_BEGIN(id)             do { } while (0)
+#define TRACE_END(id)               do { } while (0)
+#define TRACE_INSTANT(id, arg)      do { (void)(arg); } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVTRACE_H
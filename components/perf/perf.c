@@ -0,0 +1,221 @@
+/**
+ * @file perf.c
+ * @brief Microbenchmark harness implementation
+ *
+ * JSON output (one line, so it can be grepped out of a console log):
+ *   {"perf":1,"version":"1.0.0","target":"esp32c3","clock":"cycles",
+ *    "cpu_mhz":160,"results":[{"name":"calculate_aqi","iterations":4096,
+ *    "rounds":11,"ns_min":900,"ns_median":912,"ns_max":1510,
+ *    "cycles_median":146}, ...]}
+ */
+
+#include "perf.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_console.h"
+#include "esp_app_desc.h"
+#include "esp_rom_sys.h"
+
+#if defined(SIM_BUILD) || CONFIG_IDF_TARGET_LINUX
+#define PERF_HOST_CLOCK 1
+#include <time.h>
+#else
+#define PERF_HOST_CLOCK 0
+#include "esp_cpu.h"
+#endif
+
+#ifdef CONFIG_IDF_TARGET
+#define PERF_TARGET_NAME CONFIG_IDF_TARGET
+#else
+#define PERF_TARGET_NAME "host"
+#endif
+
+static const char *TAG = "PERF";
+
+// Upper bound on calibration so a benchmark that does nothing terminates
+#define PERF_MAX_ITERATIONS (1u << 22)
+
+static const perf_bench_t *registered;
+static size_t registered_count;
+
+static volatile uint32_t keep_sink;
+
+void perf_keep(uint32_t value)
+{
+    keep_sink ^= value;
+}
+
+// ============================================
+// CLOCK
+// ============================================
+
+#if PERF_HOST_CLOCK
+
+static uint64_t clock_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t clock_to_ns(uint64_t ticks)
+{
+    return ticks;
+}
+
+#else
+
+static uint64_t clock_now(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static uint64_t clock_to_ns(uint64_t cycles)
+{
+    return cycles * 1000u / esp_rom_get_cpu_ticks_per_us();
+}
+
+#endif
+
+// Ticks for one round; the 32-bit cycle counter wraps harmlessly at this scale
+static uint64_t time_round(const perf_bench_t *bench, uint32_t iterations)
+{
+    uint64_t start = clock_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        bench->fn(bench->ctx);
+    }
+#if PERF_HOST_CLOCK
+    return clock_now() - start;
+#else
+    return (uint32_t)(clock_now() - start);
+#endif
+}
+
+// ============================================
+// RUNNER
+// ============================================
+
+esp_err_t perf_register(const perf_bench_t *benches, size_t count)
+{
+    if (benches == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    registered = benches;
+    registered_count = count;
+    return ESP_OK;
+}
+
+esp_err_t perf_run_bench(const perf_bench_t *bench, perf_result_t *result)
+{
+    if (bench == NULL || bench->fn == NULL || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint64_t min_round_ns = (uint64_t)CONFIG_PERF_MIN_ROUND_US * 1000u;
+    uint64_t samples[CONFIG_PERF_ROUNDS];
+    uint32_t iterations = 1;
+
+    // Warm caches, then grow the round until it is long enough to time
+    time_round(bench, 1);
+    while (iterations < PERF_MAX_ITERATIONS &&
+           clock_to_ns(time_round(bench, iterations)) < min_round_ns) {
+        iterations *= 2;
+    }
+
+    for (int r = 0; r < CONFIG_PERF_ROUNDS; r++) {
+        uint64_t ticks = time_round(bench, iterations);
+
+        // Insertion sort as we go; the round count is small
+        int i = r;
+        while (i > 0 && samples[i - 1] > ticks) {
+            samples[i] = samples[i - 1];
+            i--;
+        }
+        samples[i] = ticks;
+    }
+
+    uint64_t median = samples[CONFIG_PERF_ROUNDS / 2];
+    result->name = bench->name;
+    result->iterations = iterations;
+    result->rounds = CONFIG_PERF_ROUNDS;
+    result->ns_min = (uint32_t)(clock_to_ns(samples[0]) / iterations);
+    result->ns_median = (uint32_t)(clock_to_ns(median) / iterations);
+    result->ns_max = (uint32_t)(clock_to_ns(samples[CONFIG_PERF_ROUNDS - 1]) / iterations);
+    result->cycles_median = PERF_HOST_CLOCK ? 0 : (uint32_t)(median / iterations);
+    return ESP_OK;
+}
+
+int perf_run(const char *filter)
+{
+    int count = 0;
+
+    if (registered == NULL) {
+        ESP_LOGW(TAG, "No benchmarks registered");
+        return 0;
+    }
+
+    printf("{\"perf\":1,\"version\":\"%s\",\"target\":\"%s\",\"clock\":\"%s\","
+           "\"cpu_mhz\":%lu,\"results\":[",
+           esp_app_get_description()->version, PERF_TARGET_NAME,
+           PERF_HOST_CLOCK ? "monotonic" : "cycles",
+           (unsigned long)esp_rom_get_cpu_ticks_per_us());
+
+    for (size_t i = 0; i < registered_count; i++) {
+        const perf_bench_t *bench = &registered[i];
+        if (filter && filter[0] && strstr(bench->name, filter) == NULL) {
+            continue;
+        }
+
+        perf_result_t res;
+        if (perf_run_bench(bench, &res) != ESP_OK) {
+            continue;
+        }
+        printf("%s{\"name\":\"%s\",\"iterations\":%lu,\"rounds\":%lu,"
+               "\"ns_min\":%lu,\"ns_median\":%lu,\"ns_max\":%lu,\"cycles_median\":%lu}",
+               count ? "," : "", res.name, (unsigned long)res.iterations,
+               (unsigned long)res.rounds, (unsigned long)res.ns_min,
+               (unsigned long)res.ns_median, (unsigned long)res.ns_max,
+               (unsigned long)res.cycles_median);
+        count++;
+
+        // Let lower-priority tasks and the idle watchdog run between benchmarks
+        vTaskDelay(1);
+    }
+
+    printf("]}\n");
+    return count;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int perf_cmd(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "list") == 0) {
+        for (size_t i = 0; i < registered_count; i++) {
+            printf("%s\n", registered[i].name);
+        }
+        return 0;
+    }
+    return perf_run(argc > 1 ? argv[1] : NULL) > 0 ? 0 : 1;
+}
+
+esp_err_t perf_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "perf",
+        .help = "Run microbenchmarks (all, or names containing FILTER) and "
+                "print JSON; 'perf list' shows the names",
+        .hint = "[list|FILTER]",
+        .func = perf_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
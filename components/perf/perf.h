@@ -0,0 +1,88 @@
+/**
+ * @file perf.h
+ * @brief Microbenchmark harness
+ *
+ * Runs small hot-path functions in timed rounds and reports per-iteration
+ * cost as one JSON line, so results can be collected from the console (or
+ * the host simulation) and compared across firmware versions with
+ * tools/perf_compare.py.
+ *
+ * On target the clock is the CPU cycle counter; on the host (simulation or
+ * linux target) it is CLOCK_MONOTONIC, since the simulated cycle counter only
+ * follows virtual time.
+ *
+ * Each benchmark first doubles its iteration count until one round takes at
+ * least CONFIG_PERF_MIN_ROUND_US, then runs CONFIG_PERF_ROUNDS rounds and
+ * reports the minimum, median and maximum per-iteration time.
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One benchmark: fn(ctx) is a single iteration
+ */
+typedef struct {
+    const char *name;
+    void (*fn)(void *ctx);
+    void *ctx;
+} perf_bench_t;
+
+/**
+ * @brief Per-iteration timing of one benchmark
+ */
+typedef struct {
+    const char *name;
+    uint32_t iterations;        // Iterations per round after calibration
+    uint32_t rounds;
+    uint32_t ns_min;
+    uint32_t ns_median;
+    uint32_t ns_max;
+    uint32_t cycles_median;     // 0 when timed with the host clock
+} perf_result_t;
+
+/**
+ * @brief Register the benchmark table run by perf_run() and the console
+ *
+ * The table must stay valid for the lifetime of the program.
+ */
+esp_err_t perf_register(const perf_bench_t *benches, size_t count);
+
+/**
+ * @brief Calibrate and time a single benchmark
+ */
+esp_err_t perf_run_bench(const perf_bench_t *bench, perf_result_t *result);
+
+/**
+ * @brief Run every registered benchmark whose name contains filter and
+ *        print the results as a single JSON line
+ *
+ * @param filter Substring to match, NULL or "" for all
+ * @return Number of benchmarks run
+ */
+int perf_run(const char *filter);
+
+/**
+ * @brief Register the "perf" console command
+ */
+esp_err_t perf_register_console(void);
+
+/**
+ * @brief Consume a value so the compiler cannot drop the work producing it
+ */
+void perf_keep(uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_H
@@ -0,0 +1,257 @@
+/**
+ * @file push_button.c
+ * @brief Interrupt-driven push button implementation
+ *
+ * The ISR only timestamps the first edge and notifies the button task. The
+ * task sleeps for the debounce time (bounces in between are ignored),
+ * reads the settled level and runs the click state machine. Between edges
+ * it sleeps until the next long-press or double-press deadline, if any.
+ */
+
+#include "push_button.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "PUSH_BUTTON";
+
+static gpio_num_t button_gpio = GPIO_NUM_NC;
+static bool button_active_low = true;
+static TaskHandle_t button_task_handle = NULL;
+
+static QueueHandle_t subscribers[CONFIG_PUSH_BUTTON_MAX_SUBSCRIBERS];
+static int subscriber_count = 0;
+static portMUX_TYPE subscriber_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static push_button_stats_t stats;
+
+// Set by the ISR on the first edge, cleared by the task once settled
+static volatile bool edge_pending = false;
+static volatile int64_t edge_time_us = 0;
+
+// Click state, owned by the button task
+static bool pressed = false;
+static bool long_sent = false;
+static bool click_pending = false;      // One click waiting for a possible second
+static TickType_t press_tick = 0;
+static TickType_t release_tick = 0;
+static uint32_t click_held_ms = 0;
+
+// ============================================
+// EVENT DELIVERY
+// ============================================
+
+static void emit(push_button_event_type_t type, TickType_t now, uint32_t held_ms)
+{
+    push_button_event_t event = {
+        .type = type,
+        .time_ms = (uint32_t)(now * portTICK_PERIOD_MS),
+        .held_ms = held_ms,
+    };
+
+    stats.events[type]++;
+    ESP_LOGD(TAG, "%s (held %lu ms)", push_button_event_name(type), held_ms);
+
+    for (int i = 0; i < subscriber_count; i++) {
+        if (xQueueSend(subscribers[i], &event, 0) != pdTRUE) {
+            stats.dropped++;
+        }
+    }
+}
+
+// ============================================
+// CLICK STATE MACHINE
+// ============================================
+
+static void on_press(TickType_t now)
+{
+    pressed = true;
+    long_sent = false;
+    press_tick = now;
+
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - edge_time_us);
+    if (latency_us > stats.press_latency_max_us) {
+        stats.press_latency_max_us = latency_us;
+    }
+    emit(PUSH_BUTTON_PRESS, now, 0);
+}
+
+static void on_release(TickType_t now)
+{
+    uint32_t held_ms = (uint32_t)((now - press_tick) * portTICK_PERIOD_MS);
+    pressed = false;
+
+    if (long_sent) {
+        // Already reported while held
+        return;
+    }
+    if (click_pending) {
+        click_pending = false;
+        emit(PUSH_BUTTON_DOUBLE, now, held_ms);
+        return;
+    }
+    click_pending = true;
+    release_tick = now;
+    click_held_ms = held_ms;
+}
+
+// Fire whatever deadline has passed; return ticks until the next one
+static TickType_t check_deadlines(TickType_t now)
+{
+    const TickType_t long_ticks = pdMS_TO_TICKS(CONFIG_PUSH_BUTTON_LONG_PRESS_MS);
+    const TickType_t double_ticks = pdMS_TO_TICKS(CONFIG_PUSH_BUTTON_DOUBLE_PRESS_MS);
+    TickType_t wait = portMAX_DELAY;
+
+    if (pressed && !long_sent) {
+        TickType_t elapsed = now - press_tick;
+        if (elapsed >= long_ticks) {
+            long_sent = true;
+            click_pending = false;
+            emit(PUSH_BUTTON_LONG, now, (uint32_t)(elapsed * portTICK_PERIOD_MS));
+        } else {
+            wait = long_ticks - elapsed;
+        }
+    }
+
+    // A second press keeps the first click pending until its release
+    if (click_pending && !pressed) {
+        TickType_t elapsed = now - release_tick;
+        if (elapsed >= double_ticks) {
+            click_pending = false;
+            emit(PUSH_BUTTON_SHORT, now, click_held_ms);
+        } else if (double_ticks - elapsed < wait) {
+            wait = double_ticks - elapsed;
+        }
+    }
+    return wait;
+}
+
+// ============================================
+// ISR & TASK
+// ============================================
+
+static bool level_is_pressed(void)
+{
+    return gpio_get_level(button_gpio) == (button_active_low ? 0 : 1);
+}
+
+static void IRAM_ATTR button_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (!edge_pending) {
+        edge_pending = true;
+        edge_time_us = esp_timer_get_time();
+        vTaskNotifyGiveFromISR(button_task_handle, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void push_button_task(void *pvParameters)
+{
+    TickType_t wait = portMAX_DELAY;
+
+    while (1) {
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            // Let the contacts settle, then take the level as it is now.
+            // Edges from here on notify again.
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_PUSH_BUTTON_DEBOUNCE_MS));
+            edge_pending = false;
+
+            bool level = level_is_pressed();
+            if (level == pressed) {
+                stats.bounces++;
+            } else if (level) {
+                on_press(xTaskGetTickCount());
+            } else {
+                on_release(xTaskGetTickCount());
+            }
+        }
+        wait = check_deadlines(xTaskGetTickCount());
+    }
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+esp_err_t push_button_init(gpio_num_t gpio_num, bool active_low)
+{
+    if (button_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    button_gpio = gpio_num;
+    button_active_low = active_low;
+
+    gpio_config_t cfg = {
+        .pin_bit_mask = (1ULL << gpio_num),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = active_low ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = active_low ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    esp_err_t err = gpio_config(&cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "GPIO config failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (xTaskCreate(push_button_task, "Button", CONFIG_PUSH_BUTTON_TASK_STACK_SIZE, NULL,
+                    CONFIG_PUSH_BUTTON_TASK_PRIORITY, &button_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create button task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Another component may already have installed the ISR service
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "ISR service install failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = gpio_isr_handler_add(gpio_num, button_isr, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "ISR handler add failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Button on GPIO%d (debounce %d ms, long %d ms, double %d ms)",
+             gpio_num, CONFIG_PUSH_BUTTON_DEBOUNCE_MS, CONFIG_PUSH_BUTTON_LONG_PRESS_MS,
+             CONFIG_PUSH_BUTTON_DOUBLE_PRESS_MS);
+    return ESP_OK;
+}
+
+esp_err_t push_button_subscribe(QueueHandle_t queue)
+{
+    esp_err_t err = ESP_OK;
+
+    if (queue == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&subscriber_lock);
+    if (subscriber_count < CONFIG_PUSH_BUTTON_MAX_SUBSCRIBERS) {
+        subscribers[subscriber_count++] = queue;
+    } else {
+        err = ESP_ERR_NO_MEM;
+    }
+    taskEXIT_CRITICAL(&subscriber_lock);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Too many subscribers");
+    }
+    return err;
+}
+
+const char *push_button_event_name(push_button_event_type_t type)
+{
+    static const char *const names[PUSH_BUTTON_EVENT_COUNT] = {
+        "press", "short", "long", "double",
+    };
+    return type < PUSH_BUTTON_EVENT_COUNT ? names[type] : "?";
+}
+
+void push_button_get_stats(push_button_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file push_button.h
+ * @brief Interrupt-driven push button with debounced click events
+ *
+ * A GPIO interrupt wakes a small task that waits out contact bounce and
+ * classifies the presses. Events go to every subscribed FreeRTOS queue, so
+ * consumers never poll the pin and never wait on it.
+ */
+
+#ifndef PUSH_BUTTON_H
+#define PUSH_BUTTON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PUSH_BUTTON_PRESS = 0,      // Debounced press edge, before it is classified
+    PUSH_BUTTON_SHORT,          // Single click, after the double-press window
+    PUSH_BUTTON_LONG,           // Held for CONFIG_PUSH_BUTTON_LONG_PRESS_MS
+    PUSH_BUTTON_DOUBLE,         // Two clicks within the double-press window
+    PUSH_BUTTON_EVENT_COUNT
+} push_button_event_type_t;
+
+typedef struct {
+    push_button_event_type_t type;
+    uint32_t time_ms;           // Tick time the event was detected
+    uint32_t held_ms;           // How long the (last) press lasted, 0 for PRESS
+} push_button_event_t;
+
+typedef struct {
+    uint32_t events[PUSH_BUTTON_EVENT_COUNT];
+    uint32_t bounces;           // Edges that settled back to the old level
+    uint32_t dropped;           // Events lost to a full subscriber queue
+    uint32_t press_latency_max_us;  // First edge to PRESS event
+} push_button_stats_t;
+
+/**
+ * @brief Configure the button pin, install its ISR and start the button task
+ *
+ * @param gpio_num Button GPIO
+ * @param active_low true if the button pulls the pin to ground (internal
+ *                   pull-up is enabled)
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_STATE if already initialized
+ *     - Error from the GPIO driver or ESP_ERR_NO_MEM otherwise
+ */
+esp_err_t push_button_init(gpio_num_t gpio_num, bool active_low);
+
+/**
+ * @brief Deliver button events to a queue of push_button_event_t
+ *
+ * Events are sent without blocking; a full queue loses the event.
+ * May be called before or after push_button_init().
+ *
+ * @return ESP_ERR_NO_MEM when CONFIG_PUSH_BUTTON_MAX_SUBSCRIBERS is reached
+ */
+esp_err_t push_button_subscribe(QueueHandle_t queue);
+
+/**
+ * @brief Event name for logs ("press", "short", "long", "double")
+ */
+const char *push_button_event_name(push_button_event_type_t type);
+
+/**
+ * @brief Copy the event counters
+ */
+void push_button_get_stats(push_button_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PUSH_BUTTON_H
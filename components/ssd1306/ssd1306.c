@@ -8,6 +8,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "esp_log.h"
+#include "evtrace.h"
 
 static const char *TAG = "SSD1306";
 
@@ -106,6 +107,26 @@ void ssd1306_clear_screen(ssd1306_handle_t handle, uint8_t color)
     memset(dev->buffer, color ? 0xFF : 0x00, sizeof(dev->buffer));
 }
 
+i2c_cmd_handle_t ssd1306_prepare_gram(ssd1306_handle_t handle)
+{
+    ssd1306_dev_t *dev = (ssd1306_dev_t *)handle;
+    if (dev == NULL) {
+        return NULL;
+    }
+    
+    i2c_cmd_handle_t i2c_cmd = i2c_cmd_link_create();
+    if (i2c_cmd == NULL) {
+        return NULL;
+    }
+    i2c_master_start(i2c_cmd);
+    i2c_master_write_byte(i2c_cmd, (dev->dev_addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(i2c_cmd, 0x40, true);  // Data mode
+    i2c_master_write(i2c_cmd, dev->buffer, sizeof(dev->buffer), true);
+    i2c_master_stop(i2c_cmd);
+    
+    return i2c_cmd;
+}
+
 esp_err_t ssd1306_refresh_gram(ssd1306_handle_t handle)
 {
     ssd1306_dev_t *dev = (ssd1306_dev_t *)handle;
@@ -113,6 +134,8 @@ esp_err_t ssd1306_refresh_gram(ssd1306_handle_t handle)
         return ESP_ERR_INVALID_ARG;
     }
     
+    TRACE_BEGIN(I2C_FLUSH);
+    
     // Set column address
     ssd1306_write_cmd(dev, SSD1306_CMD_SET_COLUMN_ADDR);
     ssd1306_write_cmd(dev, 0);     // Start column
@@ -124,15 +147,15 @@ esp_err_t ssd1306_refresh_gram(ssd1306_handle_t handle)
     ssd1306_write_cmd(dev, 7);     // End page
     
     // Send display buffer
-    i2c_cmd_handle_t i2c_cmd = i2c_cmd_link_create();
-    i2c_master_start(i2c_cmd);
-    i2c_master_write_byte(i2c_cmd, (dev->dev_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(i2c_cmd, 0x40, true);  // Data mode
-    i2c_master_write(i2c_cmd, dev->buffer, sizeof(dev->buffer), true);
-    i2c_master_stop(i2c_cmd);
+    i2c_cmd_handle_t i2c_cmd = ssd1306_prepare_gram(handle);
+    if (i2c_cmd == NULL) {
+        TRACE_END(I2C_FLUSH);
+        return ESP_ERR_NO_MEM;
+    }
     esp_err_t ret = i2c_master_cmd_begin(dev->i2c_port, i2c_cmd, pdMS_TO_TICKS(1000));
     i2c_cmd_link_delete(i2c_cmd);
     
+    TRACE_END(I2C_FLUSH);
     return ret;
 }
 
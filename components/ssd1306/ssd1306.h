@@ -89,6 +89,20 @@ void ssd1306_clear_screen(ssd1306_handle_t dev, uint8_t color);
  */
 esp_err_t ssd1306_refresh_gram(ssd1306_handle_t dev);
 
+/**
+ * @brief Build the I2C transaction for a full frame buffer upload
+ *
+ * The CPU-side half of ssd1306_refresh_gram(): start, address, data-mode
+ * byte, the 1024-byte buffer and stop, queued on a new command link but
+ * not executed.
+ *
+ * @param dev Device handle
+ *
+ * @return Command link to pass to i2c_master_cmd_begin() and then free
+ *         with i2c_cmd_link_delete(), or NULL on bad handle / no memory
+ */
+i2c_cmd_handle_t ssd1306_prepare_gram(ssd1306_handle_t dev);
+
 /**
  * @brief Draw a string on display
  * 
@@ -0,0 +1,154 @@
+/**
+ * @file adaptive_sampling.c
+ * @brief Sampling-interval controller implementation
+ *
+ * Each sample is scored by its change from the previous one in units of a
+ * "significant" step per quantity (ADAPTIVE_*_STEP); a running mean of the
+ * squared score estimates how much the signal varies per sample. The
+ * interval then:
+ *   - drops to the minimum on a significant step, or near a threshold;
+ *   - grows by half while the variation stays well below one step;
+ *   - halves while it is above half a step.
+ * Because the score is per sample, a slow drift settles at the interval
+ * where it moves about a quarter to half a step between samples.
+ */
+
+#include "adaptive_sampling.h"
+#include "project_config.h"
+#include "alert_task.h"
+#include "sample_interval.h"
+#include <math.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+
+static const char *TAG = "ADAPTIVE";
+
+// Running mean weight of the newest squared change score
+#define ADAPTIVE_SMOOTHING          0.3f
+#define ADAPTIVE_ACTIVITY_LOW       0.25f
+#define ADAPTIVE_ACTIVITY_HIGH      0.5f
+
+extern alert_config_t alert_config;
+
+static portMUX_TYPE limits_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t min_ms = SAMPLE_INTERVAL_MIN_MS;
+static uint32_t max_ms = SAMPLE_INTERVAL_MAX_MS;
+
+static sensor_data_t previous;
+static bool have_previous = false;
+static float variance = 0.0f;
+static uint32_t fixed_elapsed_ms = 0;  // Since the last fixed-rate sample would have been
+
+static adaptive_sampling_stats_t stats = {
+    .interval_ms = SENSOR_READ_INTERVAL_MS,
+    .interval_min_seen_ms = UINT32_MAX,
+};
+
+// ============================================
+// SIGNAL SCORING
+// ============================================
+
+static float change_score(const sensor_data_t *now, const sensor_data_t *prev)
+{
+    float t = fabsf(now->temperature - prev->temperature) / ADAPTIVE_TEMP_STEP;
+    float h = fabsf(now->humidity - prev->humidity) / ADAPTIVE_HUMIDITY_STEP;
+
+    // Light is judged relative to its level, with a floor for dark rooms
+    float lux_step = prev->light_lux * (ADAPTIVE_LUX_STEP_PCT / 100.0f);
+    if (lux_step < ADAPTIVE_LUX_STEP_MIN) {
+        lux_step = ADAPTIVE_LUX_STEP_MIN;
+    }
+    float l = fabsf((float)now->light_lux - (float)prev->light_lux) / lux_step;
+
+    return fmaxf(t, fmaxf(h, l));
+}
+
+static bool near_threshold(const sensor_data_t *s)
+{
+    // Inside the band or already past a limit: watch closely for the edge
+    return s->temperature > alert_config.temp_high - ADAPTIVE_TEMP_BAND ||
+           s->temperature < alert_config.temp_low + ADAPTIVE_TEMP_BAND ||
+           s->humidity > alert_config.humidity_high - ADAPTIVE_HUMIDITY_BAND ||
+           s->humidity < alert_config.humidity_low + ADAPTIVE_HUMIDITY_BAND ||
+           s->aqi > alert_config.aqi_threshold - ADAPTIVE_AQI_BAND;
+}
+
+// ============================================
+// CONTROLLER
+// ============================================
+
+uint32_t adaptive_sampling_update(const sensor_data_t *sample)
+{
+    taskENTER_CRITICAL(&limits_lock);
+    uint32_t lo = min_ms, hi = max_ms;
+    taskEXIT_CRITICAL(&limits_lock);
+
+    uint32_t interval = stats.interval_ms;
+
+    if (!have_previous) {
+        // Start from the configured interval
+        have_previous = true;
+        interval = sample_interval_get_ms();
+        stats.fixed_samples = 1;
+    } else {
+        // Fixed-rate equivalent at the configured interval, which may change
+        uint32_t fixed_ms = sample_interval_get_ms();
+        fixed_elapsed_ms += sample->timestamp - previous.timestamp;
+        stats.fixed_samples += fixed_elapsed_ms / fixed_ms;
+        fixed_elapsed_ms %= fixed_ms;
+
+        float score = change_score(sample, &previous);
+        variance += ADAPTIVE_SMOOTHING * (score * score - variance);
+        float activity = sqrtf(variance);
+
+        if (score >= 1.0f || near_threshold(sample)) {
+            interval = lo;
+        } else if (activity < ADAPTIVE_ACTIVITY_LOW) {
+            interval += interval / 2;
+        } else if (activity > ADAPTIVE_ACTIVITY_HIGH) {
+            interval /= 2;
+        }
+        ESP_LOGD(TAG, "score %.2f activity %.2f -> %lu ms", score, activity, interval);
+    }
+    previous = *sample;
+
+    if (interval < lo) interval = lo;
+    if (interval > hi) interval = hi;
+
+    if (interval != stats.interval_ms) {
+        ESP_LOGI(TAG, "Sample interval %lu -> %lu ms", stats.interval_ms, interval);
+    }
+
+    stats.samples++;
+    stats.interval_ms = interval;
+    if (interval < stats.interval_min_seen_ms) stats.interval_min_seen_ms = interval;
+    if (interval > stats.interval_max_seen_ms) stats.interval_max_seen_ms = interval;
+    return interval;
+}
+
+esp_err_t adaptive_sampling_set_limits(uint32_t new_min_ms, uint32_t new_max_ms)
+{
+    if (new_min_ms < SAMPLE_INTERVAL_MIN_MS || new_max_ms > SAMPLE_INTERVAL_LIMIT_MS ||
+        new_min_ms > new_max_ms) {
+        ESP_LOGW(TAG, "Rejected interval limits %lu..%lu ms", new_min_ms, new_max_ms);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&limits_lock);
+    min_ms = new_min_ms;
+    max_ms = new_max_ms;
+    taskEXIT_CRITICAL(&limits_lock);
+
+    ESP_LOGI(TAG, "Sample interval limits %lu..%lu ms", new_min_ms, new_max_ms);
+    return ESP_OK;
+}
+
+void adaptive_sampling_get_stats(adaptive_sampling_stats_t *out)
+{
+    *out = stats;
+    taskENTER_CRITICAL(&limits_lock);
+    out->min_ms = min_ms;
+    out->max_ms = max_ms;
+    taskEXIT_CRITICAL(&limits_lock);
+}
@@ -0,0 +1,49 @@
+/**
+ * @file adaptive_sampling.h
+ * @brief Sampling-interval controller (ENABLE_ADAPTIVE_SAMPLING)
+ *
+ * Picks the time to the next sensor cycle from how much the readings move
+ * between samples and how close they are to an alert threshold: down to
+ * the 2 s DHT11 minimum while things change or an alert is close, backing
+ * off towards minutes while the room is stable.
+ */
+
+#ifndef ADAPTIVE_SAMPLING_H
+#define ADAPTIVE_SAMPLING_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+
+typedef struct {
+    uint32_t samples;               // Samples taken so far
+    uint32_t fixed_samples;         // Samples the configured Sample Interval would have taken
+    uint32_t interval_ms;           // Current interval
+    uint32_t interval_min_seen_ms;
+    uint32_t interval_max_seen_ms;
+    uint32_t min_ms;                // Configured limits
+    uint32_t max_ms;
+} adaptive_sampling_stats_t;
+
+/**
+ * @brief Feed one finished sample, get the interval to the next cycle
+ *
+ * @param sample Calibrated sample just produced
+ * @return Milliseconds from the start of this cycle to the next
+ */
+uint32_t adaptive_sampling_update(const sensor_data_t *sample);
+
+/**
+ * @brief Set the interval limits (RainMaker "Min/Max Interval")
+ *
+ * @return ESP_ERR_INVALID_ARG unless
+ *         SAMPLE_INTERVAL_MIN_MS <= min_ms <= max_ms <= SAMPLE_INTERVAL_LIMIT_MS
+ */
+esp_err_t adaptive_sampling_set_limits(uint32_t min_ms, uint32_t max_ms);
+
+/**
+ * @brief Copy the controller statistics
+ */
+void adaptive_sampling_get_stats(adaptive_sampling_stats_t *out);
+
+#endif // ADAPTIVE_SAMPLING_H
@@ -6,8 +6,19 @@
 #include <freertos/semphr.h>
 #include <driver/gpio.h>
 #include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_rtc_time.h>
 #include <esp_rmaker_core.h>
 #include <string.h>
+#include "evtrace.h"
+#include "sample_interval.h"
+#include "warm_cache.h"
+#include "app_metrics.h"
+#include "outbox.h"
+#include "cloud_rate.h"
+#if ENABLE_COOP_SCHEDULER
+#include "coop_sched.h"
+#endif
 
 static const char *TAG = "ALERT_TASK";
 
@@ -21,39 +32,16 @@ extern QueueHandle_t sensor_data_queue;
 extern SemaphoreHandle_t rainmaker_mutex;
 extern esp_rmaker_device_t *alert_device;
 
-// Alert configuration (shared with app_main)
-typedef struct {
-    float temp_high;
-    float temp_low;
-    float humidity_high;
-    float humidity_low;
-    int aqi_threshold;
-    bool buzzer_enabled;
-} alert_config_t;
-
+// Alert configuration (defined in app_main)
 extern alert_config_t alert_config;
 
-// Sensor data structure
-typedef struct {
-    float temperature;
-    float humidity;
-    int aqi;
-    uint32_t timestamp;
-} sensor_data_t;
-
 // Alert state tracking
-typedef enum {
-    ALERT_NONE = 0,
-    ALERT_TEMP_HIGH,
-    ALERT_TEMP_LOW,
-    ALERT_HUMIDITY_HIGH,
-    ALERT_HUMIDITY_LOW,
-    ALERT_AQI_HIGH
-} alert_type_t;
-
 static alert_type_t current_alert = ALERT_NONE;
-static uint32_t last_notification_time = 0;
-#define NOTIFICATION_COOLDOWN_MS 60000  // 1 minute between same notifications
+
+// The last notification, kept through deep sleep so an upload wake does not
+// repeat it; timed on the RTC clock, which runs on while the chip sleeps
+RTC_DATA_ATTR static uint8_t last_notified_alert = ALERT_NONE;
+RTC_DATA_ATTR static uint64_t last_notification_us = 0;
 
 // ============================================
 // HARDWARE INITIALIZATION
@@ -73,16 +61,44 @@ static void set_normal_status(void)
     gpio_set_level(BUZZER_GPIO, 0);     // Buzzer OFF
 }
 
-static void set_alert_status(bool buzzer_on)
+#if ENABLE_COOP_SCHEDULER
+
+// The scheduler task must not block, so beeps are toggled by their own job
+static int beep_edges_left = 0;
+static uint32_t beep_half_period_ms = 0;
+
+static uint32_t buzzer_step(void *ctx)
 {
-    gpio_set_level(LED_GREEN_GPIO, 0);  // Green OFF
-    gpio_set_level(LED_RED_GPIO, 1);    // Red ON
-    
-    if (buzzer_on && alert_config.buzzer_enabled) {
-        gpio_set_level(BUZZER_GPIO, 1); // Buzzer ON
-    } else {
+    if (beep_edges_left == 0) {
         gpio_set_level(BUZZER_GPIO, 0);
+        return COOP_SCHED_STOP;
     }
+    gpio_set_level(BUZZER_GPIO, beep_edges_left % 2 == 0);  // Even = ON phase
+    beep_edges_left--;
+    return beep_half_period_ms;
+}
+
+static coop_job_t buzzer_job = { .name = "buzzer", .step = buzzer_step };
+
+static bool buzzer_busy(void)
+{
+    return beep_edges_left > 0;
+}
+
+static void buzzer_beep_pattern(int beeps, int duration_ms)
+{
+    if (!alert_config.buzzer_enabled) return;
+    
+    beep_edges_left = beeps * 2;
+    beep_half_period_ms = duration_ms;
+    coop_sched_add(&buzzer_job, 0);
+}
+
+#else
+
+static bool buzzer_busy(void)
+{
+    return false;
 }
 
 static void buzzer_beep_pattern(int beeps, int duration_ms)
@@ -97,11 +113,25 @@ static void buzzer_beep_pattern(int beeps, int duration_ms)
     }
 }
 
+#endif // ENABLE_COOP_SCHEDULER
+
+static void set_alert_status(bool buzzer_on)
+{
+    gpio_set_level(LED_GREEN_GPIO, 0);  // Green OFF
+    gpio_set_level(LED_RED_GPIO, 1);    // Red ON
+    
+    if (buzzer_on && alert_config.buzzer_enabled) {
+        gpio_set_level(BUZZER_GPIO, 1); // Buzzer ON
+    } else if (!buzzer_busy()) {
+        gpio_set_level(BUZZER_GPIO, 0);
+    }
+}
+
 // ============================================
 // ALERT DETECTION
 // ============================================
 
-static alert_type_t detect_alert(sensor_data_t *data)
+alert_type_t alert_check_thresholds(const sensor_data_t *data)
 {
     // Check temperature thresholds
     if (data->temperature > alert_config.temp_high) {
@@ -143,18 +173,70 @@ static alert_type_t detect_alert(sensor_data_t *data)
 // PUSH NOTIFICATION VIA RAINMAKER
 // ============================================
 
-static void send_push_notification(alert_type_t alert_type, sensor_data_t *data)
+esp_err_t alert_deliver_status(uint8_t key, const void *payload, size_t len)
+{
+    const char *status = payload;
+    if (len == 0 || status[len - 1] != '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Neither wait blocks: a refused status stays in the outbox and the
+    // cloud task tries again after OUTBOX_RETRY_MS
+    if (!cloud_rate_acquire(1, 0)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    TRACE_BEGIN(MUTEX_WAIT);
+    BaseType_t locked = xSemaphoreTake(rainmaker_mutex, 0);
+    TRACE_END(MUTEX_WAIT);
+    if (locked != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    esp_rmaker_param_t *alert_status_param = alert_device ?
+        esp_rmaker_device_get_param_by_name(alert_device, "Alert Status") : NULL;
+    if (alert_status_param) {
+        // Update alert status parameter (will trigger app notification)
+        TRACE_BEGIN(PUBLISH);
+        err = esp_rmaker_param_update_and_report(alert_status_param, esp_rmaker_str(status));
+        TRACE_END(PUBLISH);
+        
+        // Also raise an alert event (if you've configured RainMaker alerts)
+        // esp_rmaker_raise_alert("Environmental Alert!", status);
+    }
+    xSemaphoreGive(rainmaker_mutex);
+    
+    if (err == ESP_OK && key != ALERT_NONE) {
+        ESP_LOGI(TAG, "Push notification sent via RainMaker");
+    }
+    return err;
+}
+
+// Through the outbox, so a notification raised offline goes out on
+// reconnect; the cloud task saves and sends it, this step never blocks
+static void deliver_status(outbox_class_t cls, uint8_t key, const char *status)
+{
+#if ENABLE_OUTBOX
+    if (outbox_put(cls, key, status, strlen(status) + 1) == ESP_OK) {
+        return;
+    }
+#endif
+    alert_deliver_status(key, status, strlen(status) + 1);
+}
+
+static void send_push_notification(alert_type_t alert_type, const sensor_data_t *data)
 {
     // Check cooldown period to avoid notification spam
-    uint32_t current_time = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    uint64_t now_us = esp_rtc_get_time_us();
     
-    if ((current_time - last_notification_time) < NOTIFICATION_COOLDOWN_MS) {
+    if (last_notified_alert == alert_type &&
+        now_us - last_notification_us < (uint64_t)NOTIFICATION_COOLDOWN_MS * 1000) {
         ESP_LOGD(TAG, "Notification cooldown active, skipping");
         return;
     }
     
     char alert_message[128];
-    const char *alert_title = "Environmental Alert!";
     
     // Construct alert message based on type
     switch (alert_type) {
@@ -194,29 +276,100 @@ static void send_push_notification(alert_type_t alert_type, sensor_data_t *data)
     
     ESP_LOGW(TAG, "Sending push notification: %s", alert_message);
     
+    TRACE_INSTANT(ALERT_NOTIFY, alert_type);
+    
     // Update RainMaker alert status (this appears in the app)
-    if (xSemaphoreTake(rainmaker_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+    deliver_status(OUTBOX_ALERT, alert_type, alert_message);
+    
+    last_notified_alert = alert_type;
+    last_notification_us = now_us;
+}
+
+// ============================================
+// SAMPLE PROCESSING
+// ============================================
+
+alert_type_t alert_process_sample(const sensor_data_t *data)
+{
+    // Detect if any alert condition is met
+    TRACE_BEGIN(ALERT_CHECK);
+    alert_type_t detected_alert = alert_check_thresholds(data);
+    TRACE_END(ALERT_CHECK);
+    
+    if (detected_alert != ALERT_NONE) {
+        // Alert condition detected!
         
-        if (alert_device) {
-            esp_rmaker_param_t *alert_status_param = 
-                esp_rmaker_device_get_param_by_name(alert_device, "Alert Status");
+        if (current_alert != detected_alert) {
+            // New alert type
+            ESP_LOGW(TAG, "New alert detected: %d", detected_alert);
+            app_metrics_record_alert(detected_alert);
+#if ENABLE_OUTBOX
+            // A "Normal" still waiting for the cloud is stale now
+            outbox_cancel(OUTBOX_STATE, ALERT_NONE);
+#endif
+            
+            // Send push notification
+            send_push_notification(detected_alert, data);
             
-            if (alert_status_param) {
-                // Update alert status parameter (will trigger app notification)
-                esp_rmaker_param_update_and_report(alert_status_param, 
-                    esp_rmaker_str(alert_message));
-                
-                ESP_LOGI(TAG, "Push notification sent via RainMaker");
-            }
+            // Update hardware status
+            set_alert_status(true);
+            buzzer_beep_pattern(3, 200);  // 3 beeps
+            
+            current_alert = detected_alert;
+        }
+        
+        // Keep alert status active
+        set_alert_status(false);  // Buzzer off after initial beeps
+        
+    } else {
+        // No alert conditions
+        if (current_alert != ALERT_NONE) {
+            ESP_LOGI(TAG, "Alert condition cleared");
+            app_metrics_record_alert(ALERT_NONE);
             
-            // Also raise an alert event (if you've configured RainMaker alerts)
-            // esp_rmaker_raise_alert(alert_title, alert_message);
+            // Update RainMaker
+            deliver_status(OUTBOX_STATE, ALERT_NONE, "Normal");
         }
         
-        xSemaphoreGive(rainmaker_mutex);
+        // Return to normal status
+        set_normal_status();
+        current_alert = ALERT_NONE;
+    }
+    
+#if ENABLE_WARM_START
+    warm_cache_set_alert(current_alert);
+#endif
+    return current_alert;
+}
+
+void alert_task_begin(void)
+{
+#if ENABLE_WARM_START
+    // An alert active before the reset stays raised without a second
+    // notification; the next sample confirms or clears it
+    alert_type_t restored = warm_cache_restored_alert();
+    if (restored != ALERT_NONE) {
+        ESP_LOGI(TAG, "Alert %d restored from before the reset", restored);
+        current_alert = restored;
+        set_alert_status(false);
+        return;
     }
+#endif
     
-    last_notification_time = current_time;
+    // Initial status: normal
+    set_normal_status();
+}
+
+uint32_t alert_task_step(const sensor_data_t *data)
+{
+    if (data != NULL) {
+        alert_process_sample(data);
+    }
+    
+    // Check period follows the sample interval
+    sample_timing_t timing;
+    sample_interval_get_timing(&timing);
+    return timing.alert_ms;
 }
 
 // ============================================
@@ -228,68 +381,13 @@ void alert_task(void *pvParameters)
     ESP_LOGI(TAG, "Alert monitoring task started");
     
     sensor_data_t sensor_data;
-    alert_type_t detected_alert;
+    uint32_t seen_ms = 0;
     
-    // Create a copy of the queue for monitoring
-    QueueHandle_t alert_queue = sensor_data_queue;
-    
-    // Initial status: normal
-    set_normal_status();
+    alert_task_begin();
     
     while (1) {
-        // Peek at sensor data queue (non-blocking)
-        if (xQueuePeek(alert_queue, &sensor_data, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            
-            // Detect if any alert condition is met
-            detected_alert = detect_alert(&sensor_data);
-            
-            if (detected_alert != ALERT_NONE) {
-                // Alert condition detected!
-                
-                if (current_alert != detected_alert) {
-                    // New alert type
-                    ESP_LOGW(TAG, "New alert detected: %d", detected_alert);
-                    
-                    // Send push notification
-                    send_push_notification(detected_alert, &sensor_data);
-                    
-                    // Update hardware status
-                    set_alert_status(true);
-                    buzzer_beep_pattern(3, 200);  // 3 beeps
-                    
-                    current_alert = detected_alert;
-                }
-                
-                // Keep alert status active
-                set_alert_status(false);  // Buzzer off after initial beeps
-                
-            } else {
-                // No alert conditions
-                if (current_alert != ALERT_NONE) {
-                    ESP_LOGI(TAG, "Alert condition cleared");
-                    
-                    // Update RainMaker
-                    if (xSemaphoreTake(rainmaker_mutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-                        if (alert_device) {
-                            esp_rmaker_param_t *alert_status_param = 
-                                esp_rmaker_device_get_param_by_name(alert_device, 
-                                    "Alert Status");
-                            if (alert_status_param) {
-                                esp_rmaker_param_update_and_report(alert_status_param, 
-                                    esp_rmaker_str("Normal"));
-                            }
-                        }
-                        xSemaphoreGive(rainmaker_mutex);
-                    }
-                }
-                
-                // Return to normal status
-                set_normal_status();
-                current_alert = ALERT_NONE;
-            }
-        }
-        
-        // Check at reasonable intervals
-        vTaskDelay(pdMS_TO_TICKS(2000));  // Every 2 seconds
+        // The queue belongs to the cloud task; check each sample once
+        bool have_data = sensor_get_new(&seen_ms, &sensor_data);
+        vTaskDelay(pdMS_TO_TICKS(alert_task_step(have_data ? &sensor_data : NULL)));
     }
 }
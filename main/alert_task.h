@@ -7,6 +7,10 @@
 #define ALERT_TASK_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor_task.h"
 
 // Alert configuration structure (shared with app_main)
 typedef struct {
@@ -18,6 +22,65 @@ typedef struct {
     bool buzzer_enabled;
 } alert_config_t;
 
+/**
+ * @brief Alert conditions, in the order they are checked
+ */
+typedef enum {
+    ALERT_NONE = 0,
+    ALERT_TEMP_HIGH,
+    ALERT_TEMP_LOW,
+    ALERT_HUMIDITY_HIGH,
+    ALERT_HUMIDITY_LOW,
+    ALERT_AQI_HIGH
+} alert_type_t;
+
+/**
+ * @brief Compare one sample against the configured thresholds
+ * 
+ * Pure check with no side effects beyond a warning log on a violation.
+ * 
+ * @param data Sensor sample to evaluate
+ * @return First violated condition in alert_type_t order, or ALERT_NONE
+ */
+alert_type_t alert_check_thresholds(const sensor_data_t *data);
+
+/**
+ * @brief Run one sample through the alert logic
+ * 
+ * Checks thresholds, sends a notification and beeps on a new alert type,
+ * reports "Normal" when an alert clears, and drives the status LEDs.
+ * Called by the alert task for every sample; exposed for the host replay.
+ * 
+ * @param data Sensor sample to evaluate
+ * @return Alert state after this sample
+ */
+alert_type_t alert_process_sample(const sensor_data_t *data);
+
+/**
+ * @brief Report a NUL-terminated status string as the "Alert Status" parameter
+ * 
+ * The outbox handler for OUTBOX_ALERT and OUTBOX_STATE entries; key is the
+ * alert_type_t the status belongs to.
+ * 
+ * @return ESP_ERR_TIMEOUT if the cloud rate limit or the RainMaker mutex
+ *         held it up,
+ *         ESP_ERR_NOT_FOUND without the alert device
+ */
+esp_err_t alert_deliver_status(uint8_t key, const void *payload, size_t len);
+
+/**
+ * @brief Put the LEDs and buzzer in their idle (normal) state
+ */
+void alert_task_begin(void);
+
+/**
+ * @brief One alert check; the body of the alert task loop
+ * 
+ * @param data New sensor sample, or NULL if there is none since the last call
+ * @return Milliseconds until the next check
+ */
+uint32_t alert_task_step(const sensor_data_t *data);
+
 /**
  * @brief Main alert monitoring task
  * 
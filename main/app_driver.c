@@ -5,6 +5,7 @@
 
 #include "app_driver.h"
 #include "project_config.h"
+#include "push_button.h"
 #include <esp_log.h>
 #include <driver/gpio.h>
 #include <driver/i2c.h>
@@ -80,18 +81,10 @@ esp_err_t app_driver_init_gpio(void)
         return err;
     }
     
-    // Configure button GPIO
-    gpio_config_t btn_cfg = {
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    
-    err = gpio_config(&btn_cfg);
+    // Button: interrupt-driven, debounced click events
+    err = push_button_init(BUTTON_GPIO, true);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Button GPIO config failed: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Button init failed: %s", esp_err_to_name(err));
         return err;
     }
     
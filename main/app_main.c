@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -12,6 +13,7 @@
 #include <esp_rmaker_schedule.h>
 #include <esp_rmaker_scenes.h>
 #include <esp_rmaker_ota.h>
+#include <esp_rmaker_console.h>
 #include <app_insights.h>
 #include <app_wifi.h>
 #include <wifi_provisioning/manager.h>
@@ -28,6 +30,7 @@ TaskHandle_t cloud_task_handle = NULL;
 TaskHandle_t display_task_handle = NULL;
 TaskHandle_t alert_task_handle = NULL;
 TaskHandle_t ota_task_handle = NULL;
+TaskHandle_t profiler_task_handle = NULL;
 
 // Queue for sensor data
 QueueHandle_t sensor_data_queue = NULL;
@@ -46,33 +49,7 @@ esp_rmaker_device_t *temp_sensor_device = NULL;
 esp_rmaker_device_t *humidity_sensor_device = NULL;
 esp_rmaker_device_t *aqi_sensor_device = NULL;
 esp_rmaker_device_t *alert_device = NULL;
-
-// Sensor data structure
-typedef struct {
-    float temperature;
-    float humidity;
-    int aqi;
-    uint32_t timestamp;
-} sensor_data_t;
-
-// Alert thresholds (can be modified via RainMaker)
-typedef struct {
-    float temp_high;
-    float temp_low;
-    float humidity_high;
-    float humidity_low;
-    int aqi_threshold;
-    bool buzzer_enabled;
-} alert_config_t;
-
-alert_config_t alert_config = {
-    .temp_high = 35.0,
-    .temp_low = 15.0,
-    .humidity_high = 80.0,
-    .humidity_low = 30.0,
-    .aqi_threshold = 150,
-    .buzzer_enabled = true
-};
+esp_rmaker_device_t *sampling_device = NULL;
 
 // ============================================
 // EXTERNAL FUNCTION DECLARATIONS
@@ -93,12 +70,76 @@ alert_config_t alert_config = {
 // From ota_task.h
 #include "ota_task.h"
 
+// From profiler_task.h
+#include "profiler_task.h"
+
+// From app_metrics.h
+#include "app_metrics.h"
+
+// Deferred binary logging and event tracing
+#include "dlog.h"
+#include "evtrace.h"
+
+// Hot-path microbenchmarks
+#include "perf.h"
+#include "perf_benches.h"
+
+// Sensor calibration console
+#include "calibration.h"
+
+// Deep-sleep duty cycle (ENABLE_DEEP_SLEEP_MODE)
+#include "sleep_logger.h"
+
+// Warm-start cache (ENABLE_WARM_START)
+#include "warm_cache.h"
+
+// Sample interval and adaptive sampling limits (ENABLE_ADAPTIVE_SAMPLING)
+#include "sample_interval.h"
+#include "adaptive_sampling.h"
+
+// Cooperative scheduler (ENABLE_COOP_SCHEDULER)
+#include "coop_sched.h"
+
+// Boot stages and timeline (ENABLE_PARALLEL_BOOT)
+#include "boot_graph.h"
+
+// Batched uplink windows
+#include "uplink_batch.h"
+
+// Cloud publish token bucket
+#include "cloud_rate.h"
+
+// Offline sample backlog and replay (ENABLE_BACKLOG)
+#include "backlog.h"
+
+// Time-series min/avg/max points (ENABLE_TS_AGGREGATE)
+#include "ts_aggregate.h"
+
+// Local LAN query API (ENABLE_LOCAL_API)
+#include "local_api.h"
+
+// Local HTTP dashboard (ENABLE_HTTP_DASH)
+#include "http_dash.h"
+
+// Persistent outbox for alerts, state changes and telemetry (ENABLE_OUTBOX)
+#include "outbox.h"
+
 // From app_driver.h
 #include "app_driver.h"
 
 // From project_config.h
 #include "project_config.h"
 
+// Alert thresholds (can be modified via RainMaker)
+alert_config_t alert_config = {
+    .temp_high = 35.0,
+    .temp_low = 15.0,
+    .humidity_high = 80.0,
+    .humidity_low = 30.0,
+    .aqi_threshold = 150,
+    .buzzer_enabled = true
+};
+
 // ============================================
 // RAINMAKER CALLBACK FUNCTIONS
 // ============================================
@@ -168,16 +209,106 @@ static esp_err_t alert_device_write_cb(const esp_rmaker_device_t *device,
     return ESP_OK;
 }
 
+// Write callback for sampling device. Sample Interval is kept in NVS by
+// sample_interval.c; Min/Max Interval are persisted by RainMaker and come
+// back through here at boot (src "Init").
+static esp_err_t sampling_device_write_cb(const esp_rmaker_device_t *device, 
+                                          const esp_rmaker_param_t *param,
+                                          const esp_rmaker_param_val_t val, 
+                                          void *priv_data,
+                                          esp_rmaker_write_ctx_t *ctx)
+{
+    const char *param_name = esp_rmaker_param_get_name(param);
+    
+    if (val.val.i <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (strcmp(param_name, "Sample Interval") == 0) {
+        if (sample_interval_set((uint32_t)val.val.i * 1000, true) != ESP_OK) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+#if ENABLE_ADAPTIVE_SAMPLING
+    else {
+        adaptive_sampling_stats_t stats;
+        adaptive_sampling_get_stats(&stats);
+        
+        // At boot the two come back one at a time, each checked against the
+        // other's current value: widen that one until its own replay, so a
+        // stored 400..600 s is not refused against the default 300 s max
+        bool init = ctx && ctx->src == ESP_RMAKER_REQ_SRC_INIT;
+        uint32_t min_ms = stats.min_ms;
+        uint32_t max_ms = stats.max_ms;
+        if (strcmp(param_name, "Min Interval") == 0) {
+            min_ms = (uint32_t)val.val.i * 1000;
+            if (init && max_ms < min_ms) {
+                max_ms = min_ms;
+            }
+        } else if (strcmp(param_name, "Max Interval") == 0) {
+            max_ms = (uint32_t)val.val.i * 1000;
+            if (init && min_ms > max_ms) {
+                min_ms = max_ms;
+            }
+        }
+        
+        if (adaptive_sampling_set_limits(min_ms, max_ms) != ESP_OK) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+#endif
+    
+    esp_rmaker_param_update_and_report(param, val);
+    return ESP_OK;
+}
+
 // ============================================
 // RAINMAKER DEVICE CREATION
 // ============================================
 
+// With ENABLE_TS_AGGREGATE the readings keep a cloud history, fed with
+// min/avg/max points by cloud_publish_points()
+#if ENABLE_TS_AGGREGATE
+#define READING_PARAM_FLAGS (PROP_FLAG_READ | PROP_FLAG_TIME_SERIES)
+#else
+#define READING_PARAM_FLAGS PROP_FLAG_READ
+#endif
+
+#if ENABLE_TS_AGGREGATE
+// "<name> Min" and "<name> Max" history params beside a reading
+static void add_extreme_params(esp_rmaker_device_t *device, const char *name,
+                               esp_rmaker_param_val_t val)
+{
+    char param_name[32];
+    snprintf(param_name, sizeof(param_name), "%s Min", name);
+    esp_rmaker_device_add_param(device,
+        esp_rmaker_param_create(param_name, NULL, val, READING_PARAM_FLAGS));
+    snprintf(param_name, sizeof(param_name), "%s Max", name);
+    esp_rmaker_device_add_param(device,
+        esp_rmaker_param_create(param_name, NULL, val, READING_PARAM_FLAGS));
+}
+#endif
+
 static void create_rainmaker_devices(esp_rmaker_node_t *node)
 {
-    // 1. Temperature Sensor Device
-    temp_sensor_device = esp_rmaker_temp_sensor_device_create("Temperature", NULL, 25.0);
+    // 1. Temperature Sensor Device (the standard one, with our param flags)
+    temp_sensor_device = esp_rmaker_device_create("Temperature",
+        ESP_RMAKER_DEVICE_TEMP_SENSOR, NULL);
     esp_rmaker_device_add_cb(temp_sensor_device, temp_sensor_write_cb, NULL);
     
+    esp_rmaker_device_add_param(temp_sensor_device, esp_rmaker_param_create(
+        ESP_RMAKER_DEF_NAME_PARAM, ESP_RMAKER_PARAM_NAME, esp_rmaker_str("Temperature"),
+        PROP_FLAG_READ | PROP_FLAG_WRITE));
+    esp_rmaker_param_t *temp_param = esp_rmaker_param_create(
+        ESP_RMAKER_DEF_TEMPERATURE_NAME, ESP_RMAKER_PARAM_TEMPERATURE,
+        esp_rmaker_float(25.0), READING_PARAM_FLAGS);
+    esp_rmaker_device_add_param(temp_sensor_device, temp_param);
+    esp_rmaker_device_assign_primary_param(temp_sensor_device, temp_param);
+#if ENABLE_TS_AGGREGATE
+    add_extreme_params(temp_sensor_device, ESP_RMAKER_DEF_TEMPERATURE_NAME,
+                       esp_rmaker_float(25.0));
+#endif
+    
     // Add threshold parameters
     esp_rmaker_param_t *temp_high_param = esp_rmaker_param_create(
         "Temp High Threshold", NULL, esp_rmaker_float(35.0),
@@ -204,9 +335,13 @@ static void create_rainmaker_devices(esp_rmaker_node_t *node)
     
     esp_rmaker_param_t *humidity_param = esp_rmaker_param_create(
         ESP_RMAKER_DEF_HUMIDITY_NAME, ESP_RMAKER_PARAM_HUMIDITY,
-        esp_rmaker_float(50.0), PROP_FLAG_READ);
+        esp_rmaker_float(50.0), READING_PARAM_FLAGS);
     esp_rmaker_device_add_param(humidity_sensor_device, humidity_param);
     esp_rmaker_device_assign_primary_param(humidity_sensor_device, humidity_param);
+#if ENABLE_TS_AGGREGATE
+    add_extreme_params(humidity_sensor_device, ESP_RMAKER_DEF_HUMIDITY_NAME,
+                       esp_rmaker_float(50.0));
+#endif
     
     // Humidity thresholds
     esp_rmaker_param_t *hum_high_param = esp_rmaker_param_create(
@@ -232,10 +367,13 @@ static void create_rainmaker_devices(esp_rmaker_node_t *node)
         ESP_RMAKER_DEVICE_TEMP_SENSOR, NULL);
     
     esp_rmaker_param_t *aqi_param = esp_rmaker_param_create(
-        "AQI", NULL, esp_rmaker_int(50), PROP_FLAG_READ);
+        "AQI", NULL, esp_rmaker_int(50), READING_PARAM_FLAGS);
     esp_rmaker_param_add_ui_type(aqi_param, ESP_RMAKER_UI_TEXT);
     esp_rmaker_device_add_param(aqi_sensor_device, aqi_param);
     esp_rmaker_device_assign_primary_param(aqi_sensor_device, aqi_param);
+#if ENABLE_TS_AGGREGATE
+    add_extreme_params(aqi_sensor_device, "AQI", esp_rmaker_int(50));
+#endif
     
     esp_rmaker_param_t *aqi_status_param = esp_rmaker_param_create(
         "Air Quality Status", NULL, esp_rmaker_str("Good"), PROP_FLAG_READ);
@@ -258,44 +396,197 @@ static void create_rainmaker_devices(esp_rmaker_node_t *node)
     esp_rmaker_device_add_param(alert_device, alert_status_param);
     
     esp_rmaker_node_add_device(node, alert_device);
+
+    // 5. Sampling Control Device (seconds)
+    sampling_device = esp_rmaker_device_create("Sampling", ESP_RMAKER_DEVICE_OTHER, NULL);
+    esp_rmaker_device_add_cb(sampling_device, sampling_device_write_cb, NULL);
+    
+    esp_rmaker_param_t *interval_param = esp_rmaker_param_create(
+        "Sample Interval", NULL, esp_rmaker_int(sample_interval_get_ms() / 1000),
+        PROP_FLAG_READ | PROP_FLAG_WRITE);
+    esp_rmaker_param_add_ui_type(interval_param, ESP_RMAKER_UI_SLIDER);
+    esp_rmaker_param_add_bounds(interval_param, esp_rmaker_int(SAMPLE_INTERVAL_MIN_MS / 1000), 
+                                 esp_rmaker_int(SAMPLE_INTERVAL_LIMIT_MS / 1000), 
+                                 esp_rmaker_int(1));
+    esp_rmaker_device_add_param(sampling_device, interval_param);
+    
+#if ENABLE_ADAPTIVE_SAMPLING
+    // The adaptive interval moves between these
+    esp_rmaker_param_t *min_interval_param = esp_rmaker_param_create(
+        "Min Interval", NULL, esp_rmaker_int(SAMPLE_INTERVAL_MIN_MS / 1000),
+        PROP_FLAG_READ | PROP_FLAG_WRITE | PROP_FLAG_PERSIST);
+    esp_rmaker_param_add_ui_type(min_interval_param, ESP_RMAKER_UI_SLIDER);
+    esp_rmaker_param_add_bounds(min_interval_param, esp_rmaker_int(SAMPLE_INTERVAL_MIN_MS / 1000), 
+                                 esp_rmaker_int(600), esp_rmaker_int(1));
+    esp_rmaker_device_add_param(sampling_device, min_interval_param);
+    
+    esp_rmaker_param_t *max_interval_param = esp_rmaker_param_create(
+        "Max Interval", NULL, esp_rmaker_int(SAMPLE_INTERVAL_MAX_MS / 1000),
+        PROP_FLAG_READ | PROP_FLAG_WRITE | PROP_FLAG_PERSIST);
+    esp_rmaker_param_add_ui_type(max_interval_param, ESP_RMAKER_UI_SLIDER);
+    esp_rmaker_param_add_bounds(max_interval_param, esp_rmaker_int(10), 
+                                 esp_rmaker_int(SAMPLE_INTERVAL_LIMIT_MS / 1000), 
+                                 esp_rmaker_int(10));
+    esp_rmaker_device_add_param(sampling_device, max_interval_param);
+#endif
+    
+    esp_rmaker_node_add_device(node, sampling_device);
 }
 
+#if ENABLE_COOP_SCHEDULER && !ENABLE_DEEP_SLEEP_MODE
 // ============================================
-// MAIN APPLICATION
+// COOPERATIVE MODE JOBS
 // ============================================
 
-void app_main(void)
+// Alert and display read the latest sample directly; the queue is left
+// to the cloud task, which still runs as its own task.
+
+static uint32_t sensor_job_step(void *ctx)
 {
-    ESP_LOGI(TAG, "=== Smart Environmental Data Logger ===");
-    ESP_LOGI(TAG, "Version: %s", PROJECT_VER);
+    return sensor_task_step();
+}
+
+static uint32_t alert_job_step(void *ctx)
+{
+    static uint32_t seen_ms = 0;
+    sensor_data_t data;
+    return alert_task_step(sensor_get_new(&seen_ms, &data) ? &data : NULL);
+}
 
-    // Initialize NVS
+static uint32_t display_job_step(void *ctx)
+{
+    static uint32_t seen_ms = 0;
+    sensor_data_t data;
+    return display_task_step(sensor_get_new(&seen_ms, &data) ? &data : NULL);
+}
+
+static uint32_t ota_job_step(void *ctx)
+{
+    return ota_task_step();
+}
+
+static coop_job_t sensor_job = { .name = "sensor", .step = sensor_job_step };
+static coop_job_t alert_job = { .name = "alert", .step = alert_job_step };
+static coop_job_t display_job = { .name = "display", .step = display_job_step };
+static coop_job_t ota_job = { .name = "ota", .step = ota_job_step };
+
+static void start_cooperative_jobs(void)
+{
+    // One-time setup that the tasks do before their loops
+    alert_task_begin();
+    bool display_ok = display_task_begin();
+    ota_task_begin();
+
+    // Staggered so the jobs rarely fall due on the same tick
+    coop_sched_add(&sensor_job, COOP_SENSOR_PHASE_MS);
+    coop_sched_add(&alert_job, COOP_ALERT_PHASE_MS);
+    if (display_ok) {
+        coop_sched_add(&display_job, COOP_DISPLAY_PHASE_MS);
+    }
+    coop_sched_add(&ota_job, COOP_OTA_PHASE_MS);
+
+    xTaskCreatePinnedToCore(coop_sched_task, "Scheduler", COOP_SCHED_STACK_SIZE, NULL,
+                            COOP_SCHED_PRIORITY, NULL, COOP_SCHED_CORE);
+    xTaskCreatePinnedToCore(cloud_task, "Cloud", CLOUD_TASK_STACK_SIZE, NULL,
+                            CLOUD_TASK_PRIORITY, &cloud_task_handle, CLOUD_TASK_CORE);
+#if ENABLE_BACKLOG
+    backlog_start();
+#endif
+
+    // Its stack use is measured, not assumed: "sched" prints the high-water mark
+    ESP_LOGI(TAG, "Cooperative mode: sensor, alert, display and OTA jobs on one %d-byte stack",
+             COOP_SCHED_STACK_SIZE);
+}
+#endif
+
+// ============================================
+// BOOT STAGES
+// ============================================
+
+// Run by boot_graph_run() as soon as their dependencies are done, so the
+// OLED upload overlaps Wi-Fi and RainMaker init.
+
+typedef enum {
+    BOOT_NVS,
+    BOOT_DRIVERS,
+    BOOT_DISPLAY,
+    BOOT_SENSOR,
+    BOOT_SAMPLING,
+    BOOT_WIFI,
+    BOOT_RAINMAKER,
+    BOOT_INSIGHTS,
+    BOOT_START,
+    BOOT_CONSOLE,
+    BOOT_LOCAL_API,
+    BOOT_HTTP_DASH,
+    BOOT_STAGE_COUNT
+} boot_stage_id_t;
+
+static esp_err_t boot_nvs(void)
+{
     esp_err_t err = nvs_flash_init();
     if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         err = nvs_flash_init();
     }
     ESP_ERROR_CHECK(err);
+#if ENABLE_OUTBOX
+    if (outbox_init() == ESP_OK) {
+        outbox_set_handler(OUTBOX_ALERT, alert_deliver_status);
+        outbox_set_handler(OUTBOX_STATE, alert_deliver_status);
+        outbox_set_handler(OUTBOX_TELEMETRY, cloud_deliver_telemetry);
+    }
+#endif
+#if ENABLE_BACKLOG
+    backlog_init();
+#endif
+    return ESP_OK;
+}
 
-    // Initialize hardware drivers
+static esp_err_t boot_drivers(void)
+{
     app_driver_init();
+    return ESP_OK;
+}
+
+static esp_err_t boot_sensor(void)
+{
     sensor_init();
-    display_init();
+#if ENABLE_DEEP_SLEEP_MODE
+    // Sample-only wakes end in here, back in deep sleep
+    sleep_logger_wake();
+#endif
+    return ESP_OK;
+}
 
-    // Create FreeRTOS synchronization objects
-    sensor_data_queue = xQueueCreate(10, sizeof(sensor_data_t));
-    rainmaker_mutex = xSemaphoreCreateMutex();
-    system_events = xEventGroupCreate();
+static esp_err_t boot_sampling(void)
+{
+#if !ENABLE_DEEP_SLEEP_MODE && !ENABLE_COOP_SCHEDULER
+    // First sample while the rest of the bring-up is still running
+    xTaskCreatePinnedToCore(sensor_task, "Sensor", 4096, NULL, 5, 
+                           &sensor_task_handle, 1);
+#endif
+    return ESP_OK;
+}
 
-    if (!sensor_data_queue || !rainmaker_mutex || !system_events) {
-        ESP_LOGE(TAG, "Failed to create FreeRTOS objects!");
-        abort();
-    }
+static esp_err_t boot_display(void)
+{
+#if !ENABLE_DEEP_SLEEP_MODE
+    display_init();     // The display stays off in battery mode
+#endif
+    return ESP_OK;
+}
 
-    // Initialize Wi-Fi
+static esp_err_t boot_wifi(void)
+{
     app_wifi_init();
+    // Every mode, the deep-sleep upload wake included: sleep_logger_upload()
+    // waits on the connection bits these events set
+    return cloud_task_register_events();
+}
 
-    // Initialize RainMaker
+static esp_err_t boot_rainmaker(void)
+{
     esp_rmaker_config_t rainmaker_cfg = {
         .enable_time_sync = true,
     };
@@ -315,22 +606,154 @@ void app_main(void)
     esp_rmaker_timezone_service_enable();
     esp_rmaker_schedule_enable();
     esp_rmaker_scenes_enable();
-    
-    // Enable ESP Insights for dashboard
-    app_insights_enable();
+    return ESP_OK;
+}
 
+static esp_err_t boot_start(void)
+{
     // Start RainMaker
     ESP_ERROR_CHECK(esp_rmaker_start());
 
-    // Start Wi-Fi (provisioning if needed)
-    err = app_wifi_start(POP_TYPE_RANDOM);
+    // Start Wi-Fi (provisioning if needed); association runs in the background
+    esp_err_t err = app_wifi_start(POP_TYPE_RANDOM);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start Wi-Fi!");
     }
+    return ESP_OK;
+}
 
-    // Create FreeRTOS tasks
-    xTaskCreatePinnedToCore(sensor_task, "Sensor", 4096, NULL, 5, 
-                           &sensor_task_handle, 1);
+static esp_err_t boot_insights(void)
+{
+    // Enable ESP Insights for dashboard
+    app_insights_enable();
+    app_metrics_init();
+    boot_graph_register_metrics();
+    return ESP_OK;
+}
+
+static esp_err_t boot_local_api(void)
+{
+#if ENABLE_LOCAL_API && !ENABLE_DEEP_SLEEP_MODE
+    // Not fatal: the logger works without it
+    local_api_start();
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t boot_http_dash(void)
+{
+#if ENABLE_HTTP_DASH && !ENABLE_DEEP_SLEEP_MODE
+    http_dash_start();
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t boot_console(void)
+{
+    // Serial console for local diagnostics commands
+    esp_rmaker_console_init();
+    dlog_register_console();
+    evtrace_register_console();
+    calibration_register_console();
+    boot_graph_register_console();
+    uplink_batch_register_console();
+    cloud_rate_register_console();
+#if ENABLE_OUTBOX
+    outbox_register_console();
+#endif
+#if ENABLE_BACKLOG
+    backlog_register_console();
+#endif
+#if ENABLE_TS_AGGREGATE
+    ts_aggregate_register_console();
+#endif
+#if ENABLE_LOCAL_API
+    local_api_register_console();
+#endif
+#if ENABLE_WARM_START
+    warm_cache_register_console();
+#endif
+#if ENABLE_PERF_BENCH
+    if (perf_benches_register() == ESP_OK) {
+        perf_register_console();
+    }
+#endif
+#if ENABLE_COOP_SCHEDULER
+    coop_sched_register_console();
+#endif
+    return ESP_OK;
+}
+
+#if ENABLE_DEEP_SLEEP_MODE
+// Nothing radio-related until the wake's sample says an upload is due
+#define BOOT_WIFI_DEPS      (BOOT_DEP(BOOT_NVS) | BOOT_DEP(BOOT_SENSOR))
+#else
+#define BOOT_WIFI_DEPS      BOOT_DEP(BOOT_NVS)
+#endif
+
+// Ready stages start in list order. The display goes first: its I2C
+// commands block on the bus and leave the CPU to the Wi-Fi and RainMaker
+// stages on the other worker. With one worker this is the serial order.
+static boot_stage_t boot_stages[BOOT_STAGE_COUNT] = {
+    [BOOT_NVS] = { .name = "nvs", .fn = boot_nvs },
+    [BOOT_DRIVERS] = { .name = "drivers", .fn = boot_drivers },
+    [BOOT_DISPLAY] = { .name = "display", .fn = boot_display, .deps = BOOT_DEP(BOOT_DRIVERS) },
+    // Calibration and the sample interval come from NVS
+    [BOOT_SENSOR] = { .name = "sensor", .fn = boot_sensor,
+                      .deps = BOOT_DEP(BOOT_NVS) | BOOT_DEP(BOOT_DRIVERS) },
+    [BOOT_SAMPLING] = { .name = "sampling", .fn = boot_sampling, .deps = BOOT_DEP(BOOT_SENSOR) },
+    [BOOT_WIFI] = { .name = "wifi", .fn = boot_wifi, .deps = BOOT_WIFI_DEPS },
+    // The Sampling device starts from the stored interval
+    [BOOT_RAINMAKER] = { .name = "rainmaker", .fn = boot_rainmaker,
+                         .deps = BOOT_DEP(BOOT_WIFI) | BOOT_DEP(BOOT_SENSOR) },
+    // Insights hooks into RainMaker before it starts
+    [BOOT_INSIGHTS] = { .name = "insights", .fn = boot_insights,
+                        .deps = BOOT_DEP(BOOT_RAINMAKER) },
+    [BOOT_START] = { .name = "start", .fn = boot_start, .deps = BOOT_DEP(BOOT_INSIGHTS) },
+    [BOOT_CONSOLE] = { .name = "console", .fn = boot_console },
+    // Its server binds once the netif exists; the PoP lives in NVS
+    [BOOT_LOCAL_API] = { .name = "local_api", .fn = boot_local_api,
+                         .deps = BOOT_DEP(BOOT_WIFI) },
+    [BOOT_HTTP_DASH] = { .name = "http_dash", .fn = boot_http_dash,
+                         .deps = BOOT_DEP(BOOT_WIFI) },
+};
+
+// ============================================
+// MAIN APPLICATION
+// ============================================
+
+void app_main(void)
+{
+    ESP_LOGI(TAG, "=== Smart Environmental Data Logger ===");
+    ESP_LOGI(TAG, "Version: %s", PROJECT_VER);
+
+#if ENABLE_WARM_START
+    // Before anything writes to it: what the previous run left behind
+    warm_cache_init();
+#endif
+
+    // Created up front: cheap, and any stage may touch them
+    sensor_data_queue = xQueueCreate(10, sizeof(sensor_data_t));
+    rainmaker_mutex = xSemaphoreCreateMutex();
+    system_events = xEventGroupCreate();
+
+    if (!sensor_data_queue || !rainmaker_mutex || !system_events) {
+        ESP_LOGE(TAG, "Failed to create FreeRTOS objects!");
+        abort();
+    }
+
+    // NVS, drivers, sensors, display, Wi-Fi and RainMaker bring-up
+    ESP_ERROR_CHECK(boot_graph_run(boot_stages, BOOT_STAGE_COUNT,
+                                   ENABLE_PARALLEL_BOOT ? BOOT_GRAPH_WORKERS : 1));
+
+#if ENABLE_DEEP_SLEEP_MODE
+    // Deliver the RTC batch, then back to deep sleep (does not return)
+    sleep_logger_upload();
+#elif ENABLE_COOP_SCHEDULER
+    // Sensor, alert, display and OTA share one scheduler task
+    start_cooperative_jobs();
+#else
+    // Create the remaining FreeRTOS tasks (the sensor task is already running)
     xTaskCreatePinnedToCore(cloud_task, "Cloud", 4096, NULL, 4, 
                            &cloud_task_handle, 0);
     xTaskCreatePinnedToCore(display_task, "Display", 4096, NULL, 3, 
@@ -339,6 +762,19 @@ void app_main(void)
                            &alert_task_handle, 1);
     xTaskCreatePinnedToCore(ota_task, "OTA", 4096, NULL, 2, 
                            &ota_task_handle, 0);
+#if ENABLE_BACKLOG
+    backlog_start();
+#endif
+#endif
+
+#if ENABLE_PROFILER
+    // Started last so its first sample sees every application task
+    if (profiler_init() == ESP_OK) {
+        xTaskCreatePinnedToCore(profiler_task, "Profiler", PROFILER_TASK_STACK_SIZE,
+                                NULL, PROFILER_TASK_PRIORITY,
+                                &profiler_task_handle, PROFILER_TASK_CORE);
+    }
+#endif
 
     ESP_LOGI(TAG, "All tasks created successfully!");
 }
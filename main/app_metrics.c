@@ -0,0 +1,289 @@
+/**
+ * @file app_metrics.c
+ * @brief Application metrics for the ESP Insights dashboard
+ *
+ * Hot paths only do a relaxed atomic add. A periodic esp_timer swaps the
+ * counters out once per METRICS_FLUSH_INTERVAL_MS and hands the window to
+ * the diagnostics metrics/variables store, which Insights uploads on its
+ * own schedule.
+ */
+
+#include "app_metrics.h"
+#include "project_config.h"
+#include "sample_interval.h"
+#include "app_wifi.h"
+#include "prom_metrics.h"
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_diagnostics_metrics.h>
+#include <esp_diagnostics_variables.h>
+
+static const char *TAG = "APP_METRICS";
+
+// ============================================
+// COUNTERS
+// ============================================
+
+// Per-window counters, reset on every flush
+static atomic_uint_fast32_t aqi_good_count;
+static atomic_uint_fast32_t aqi_moderate_count;
+static atomic_uint_fast32_t aqi_unhealthy_count;
+static atomic_uint_fast32_t queue_drop_count;
+static atomic_uint_fast32_t dht_failure_count;
+static atomic_uint_fast32_t publish_count;
+static atomic_uint_fast32_t publish_total_us;
+static atomic_uint_fast32_t publish_max_us;
+static atomic_uint_fast32_t i2c_busy_us;
+static atomic_uint_fast32_t sample_count;
+static atomic_uint_fast32_t sample_interval_ms = SENSOR_READ_INTERVAL_MS;
+static atomic_uint_fast32_t uplink_bursts;
+static atomic_uint_fast32_t uplink_samples;
+static atomic_uint_fast32_t uplink_delay_total_ms;
+static atomic_uint_fast32_t uplink_delay_max_ms;
+
+// Lifetime totals, only touched by the flush timer
+static uint32_t total_queue_drops = 0;
+static uint32_t total_dht_failures = 0;
+static uint32_t total_publishes = 0;
+#if ENABLE_ADAPTIVE_SAMPLING
+static int32_t total_samples_saved = 0;    // Against the configured Sample Interval
+#endif
+static app_wifi_stats_t wifi_flushed;       // Wi-Fi counters at the last flush
+
+static esp_timer_handle_t flush_timer = NULL;
+
+void app_metrics_record_aqi(int aqi)
+{
+    if (aqi <= 50) {
+        atomic_fetch_add_explicit(&aqi_good_count, 1, memory_order_relaxed);
+    } else if (aqi <= 100) {
+        atomic_fetch_add_explicit(&aqi_moderate_count, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&aqi_unhealthy_count, 1, memory_order_relaxed);
+    }
+}
+
+void app_metrics_record_queue_drop(void)
+{
+    atomic_fetch_add_explicit(&queue_drop_count, 1, memory_order_relaxed);
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_QUEUE_DROPS);
+#endif
+}
+
+void app_metrics_record_dht_retry(void)
+{
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_DHT_RETRIES);
+#endif
+}
+
+void app_metrics_record_dht_failure(void)
+{
+    atomic_fetch_add_explicit(&dht_failure_count, 1, memory_order_relaxed);
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_DHT_FAILURES);
+#endif
+}
+
+void app_metrics_record_alert(int alert)
+{
+#if ENABLE_PROM_METRICS
+    prom_metrics_alert(alert);
+#else
+    (void)alert;
+#endif
+}
+
+void app_metrics_record_publish(uint32_t latency_us)
+{
+    atomic_fetch_add_explicit(&publish_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&publish_total_us, latency_us, memory_order_relaxed);
+
+    uint_fast32_t max = atomic_load_explicit(&publish_max_us, memory_order_relaxed);
+    while (latency_us > max &&
+           !atomic_compare_exchange_weak_explicit(&publish_max_us, &max, latency_us,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_PUBLISHES);
+    prom_metrics_observe_publish(latency_us);
+#endif
+}
+
+void app_metrics_record_uplink(uint32_t samples, uint32_t delay_sum_ms, uint32_t delay_max_ms)
+{
+    atomic_fetch_add_explicit(&uplink_bursts, 1, memory_order_relaxed);
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_UPLINK_BURSTS);
+#endif
+    atomic_fetch_add_explicit(&uplink_samples, samples, memory_order_relaxed);
+    atomic_fetch_add_explicit(&uplink_delay_total_ms, delay_sum_ms, memory_order_relaxed);
+
+    uint_fast32_t max = atomic_load_explicit(&uplink_delay_max_ms, memory_order_relaxed);
+    while (delay_max_ms > max &&
+           !atomic_compare_exchange_weak_explicit(&uplink_delay_max_ms, &max, delay_max_ms,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void app_metrics_record_i2c(uint32_t busy_us)
+{
+    atomic_fetch_add_explicit(&i2c_busy_us, busy_us, memory_order_relaxed);
+}
+
+void app_metrics_record_sample_interval(uint32_t interval_ms)
+{
+    atomic_fetch_add_explicit(&sample_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&sample_interval_ms, interval_ms, memory_order_relaxed);
+#if ENABLE_PROM_METRICS
+    prom_metrics_inc(PROM_SAMPLES);
+#endif
+}
+
+// ============================================
+// BATCHED FLUSH
+// ============================================
+
+static uint32_t take(atomic_uint_fast32_t *counter)
+{
+    return (uint32_t)atomic_exchange_explicit(counter, 0, memory_order_relaxed);
+}
+
+static void flush_cb(void *arg)
+{
+    uint32_t drops = take(&queue_drop_count);
+    uint32_t dht_failures = take(&dht_failure_count);
+    uint32_t publishes = take(&publish_count);
+    uint32_t publish_us = take(&publish_total_us);
+    uint32_t publish_max = take(&publish_max_us);
+
+    esp_diag_metrics_add_uint("aqi_good", take(&aqi_good_count));
+    esp_diag_metrics_add_uint("aqi_moderate", take(&aqi_moderate_count));
+    esp_diag_metrics_add_uint("aqi_unhealthy", take(&aqi_unhealthy_count));
+    esp_diag_metrics_add_uint("queue_drops", drops);
+    esp_diag_metrics_add_uint("dht_failures", dht_failures);
+    esp_diag_metrics_add_uint("i2c_busy_ms", take(&i2c_busy_us) / 1000);
+
+#if ENABLE_ADAPTIVE_SAMPLING
+    uint32_t samples = take(&sample_count);
+    esp_diag_metrics_add_uint("samples", samples);
+    esp_diag_metrics_add_uint("sample_interval_s",
+        atomic_load_explicit(&sample_interval_ms, memory_order_relaxed) / 1000);
+    total_samples_saved += METRICS_FLUSH_INTERVAL_MS / sample_interval_get_ms() - (int32_t)samples;
+    esp_diag_variable_add_int("samples_saved_total", total_samples_saved);
+#endif
+
+    if (publishes > 0) {
+        esp_diag_metrics_add_uint("publish_avg_ms", publish_us / publishes / 1000);
+        esp_diag_metrics_add_uint("publish_max_ms", publish_max / 1000);
+    }
+
+    uint32_t uplink_n = take(&uplink_samples);
+    uint32_t uplink_delay_ms = take(&uplink_delay_total_ms);
+    uint32_t uplink_max_ms = take(&uplink_delay_max_ms);
+    esp_diag_metrics_add_uint("uplink_bursts", take(&uplink_bursts));
+    if (uplink_n > 0) {
+        esp_diag_metrics_add_uint("uplink_delay_avg_ms", uplink_delay_ms / uplink_n);
+        esp_diag_metrics_add_uint("uplink_delay_max_ms", uplink_max_ms);
+    }
+
+    total_queue_drops += drops;
+    total_dht_failures += dht_failures;
+    total_publishes += publishes;
+    esp_diag_variable_add_uint("queue_drops_total", total_queue_drops);
+    esp_diag_variable_add_uint("dht_failures_total", total_dht_failures);
+    esp_diag_variable_add_uint("publishes_total", total_publishes);
+
+    app_wifi_stats_t wifi;
+    app_wifi_get_stats(&wifi);
+    esp_diag_metrics_add_uint("wifi_outage_ms",
+        (uint32_t)(wifi.total_outage_ms - wifi_flushed.total_outage_ms));
+    if (wifi.connects != wifi_flushed.connects) {
+        esp_diag_metrics_add_uint("wifi_reconnects", wifi.connects - wifi_flushed.connects);
+        esp_diag_metrics_add_uint("wifi_join_ms", wifi.last_join_ms);
+    }
+    if (wifi.disconnects != wifi_flushed.disconnects) {
+        esp_diag_variable_add_uint("wifi_disconnects_total", wifi.disconnects);
+        esp_diag_variable_add_uint("wifi_outage_max_ms", wifi.max_outage_ms);
+    }
+    wifi_flushed = wifi;
+}
+
+// ============================================
+// INITIALIZATION
+// ============================================
+
+esp_err_t app_metrics_init(void)
+{
+    esp_diag_metrics_register(TAG, "aqi_good", "AQI samples Good (0-50)",
+                              "sensor.aqi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "aqi_moderate", "AQI samples Moderate (51-100)",
+                              "sensor.aqi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "aqi_unhealthy", "AQI samples Unhealthy (>100)",
+                              "sensor.aqi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "queue_drops", "Sensor samples dropped (queue full)",
+                              "sensor.errors", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "dht_failures", "DHT11 reads failed after retries",
+                              "sensor.errors", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "publish_avg_ms", "RainMaker publish latency avg (ms)",
+                              "cloud.latency", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "publish_max_ms", "RainMaker publish latency max (ms)",
+                              "cloud.latency", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "uplink_bursts", "Uplink bursts (radio wakes to publish)",
+                              "cloud.uplink", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "uplink_delay_avg_ms", "Sample taken to published, avg (ms)",
+                              "cloud.uplink", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "uplink_delay_max_ms", "Sample taken to published, max (ms)",
+                              "cloud.uplink", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "i2c_busy_ms", "OLED I2C transfer time (ms)",
+                              "display.i2c", ESP_DIAG_DATA_TYPE_UINT);
+
+#if ENABLE_ADAPTIVE_SAMPLING
+    esp_diag_metrics_register(TAG, "samples", "Sensor samples taken",
+                              "sensor.sampling", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "sample_interval_s", "Current sample interval (s)",
+                              "sensor.sampling", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_variable_register(TAG, "samples_saved_total",
+                               "Samples (and publish rounds) saved vs fixed rate",
+                               "sensor.sampling", ESP_DIAG_DATA_TYPE_INT);
+#endif
+
+    esp_diag_variable_register(TAG, "queue_drops_total", "Sensor samples dropped",
+                               "sensor.errors", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_variable_register(TAG, "dht_failures_total", "DHT11 read failures",
+                               "sensor.errors", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_variable_register(TAG, "publishes_total", "RainMaker publishes",
+                               "cloud", ESP_DIAG_DATA_TYPE_UINT);
+
+    esp_diag_metrics_register(TAG, "wifi_outage_ms", "Time without Wi-Fi, finished outages (ms)",
+                              "wifi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "wifi_reconnects", "Wi-Fi connections made",
+                              "wifi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_metrics_register(TAG, "wifi_join_ms", "Last join, attempt start to IP (ms)",
+                              "wifi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_variable_register(TAG, "wifi_disconnects_total", "Wi-Fi connections lost",
+                               "wifi", ESP_DIAG_DATA_TYPE_UINT);
+    esp_diag_variable_register(TAG, "wifi_outage_max_ms", "Longest Wi-Fi outage (ms)",
+                               "wifi", ESP_DIAG_DATA_TYPE_UINT);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = flush_cb,
+        .name = "metrics_flush",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &flush_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(flush_timer,
+                                       (uint64_t)METRICS_FLUSH_INTERVAL_MS * 1000);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start metrics flush timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Metrics registered, flushing every %d ms", METRICS_FLUSH_INTERVAL_MS);
+    return ESP_OK;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file app_metrics.h
+ * @brief Application metrics for the ESP Insights dashboard
+ */
+
+#ifndef APP_METRICS_H
+#define APP_METRICS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Register Insights metrics/variables and start the flush timer
+ *
+ * The record functions below are safe to call before this; samples are
+ * simply held until the first flush.
+ */
+esp_err_t app_metrics_init(void);
+
+/**
+ * @brief Count one AQI sample in its Good/Moderate/Unhealthy bucket
+ */
+void app_metrics_record_aqi(int aqi);
+
+/**
+ * @brief Count one sample dropped because the sensor queue was full
+ */
+void app_metrics_record_queue_drop(void);
+
+/**
+ * @brief Count one failed DHT11 read that will be retried
+ */
+void app_metrics_record_dht_retry(void);
+
+/**
+ * @brief Count one sensor cycle where every DHT11 retry failed
+ */
+void app_metrics_record_dht_failure(void);
+
+/**
+ * @brief Record how long one RainMaker parameter publish took
+ *
+ * @param latency_us Time spent in the publish, in microseconds
+ */
+void app_metrics_record_publish(uint32_t latency_us);
+
+/**
+ * @brief Add time spent on I2C display transfers
+ *
+ * @param busy_us Transfer time in microseconds
+ */
+void app_metrics_record_i2c(uint32_t busy_us);
+
+/**
+ * @brief Count one sensor sample and the interval chosen after it
+ * @param interval_ms Adaptive interval to the next sample
+ */
+void app_metrics_record_sample_interval(uint32_t interval_ms);
+
+/**
+ * @brief Record one uplink burst
+ * @param samples Samples published in the burst
+ * @param delay_sum_ms Sum over the samples of sample time to publish
+ * @param delay_max_ms Longest of those delays
+ */
+void app_metrics_record_uplink(uint32_t samples, uint32_t delay_sum_ms, uint32_t delay_max_ms);
+
+/**
+ * @brief Count one change of alert state
+ * @param alert New alert_type_t, ALERT_NONE when an alert cleared
+ */
+void app_metrics_record_alert(int alert);
+
+#endif // APP_METRICS_H
@@ -0,0 +1,618 @@
+/**
+ * @file backlog.c
+ * @brief Flash backlog of offline samples and the replay that drains it
+ *
+ * Record n of the log (its sequence number) lives in sector
+ * (n / RECORDS_PER_SECTOR) % sector count. Each sector starts with a header
+ * naming the first sequence number it holds; a sector is erased and its
+ * header written when the log reaches it, which drops the records of the
+ * lap before. At boot the sector with the highest header is the head, and
+ * its first blank slot is where the next record goes.
+ *
+ * backlog_mutex guards the log position and every flash access. The reader
+ * task copies records out under it and encodes without it; the replay task
+ * only touches the cursor.
+ */
+
+#include "backlog.h"
+#include "cloud_task.h"
+#include "telemetry_cbor.h"
+#include "project_config.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_console.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <nvs.h>
+
+static const char *TAG = "BACKLOG";
+
+#define BACKLOG_MAGIC           0x314c4b42  // "BKL1"
+#define BACKLOG_SECTOR_SIZE     4096
+#define BACKLOG_NVS_NAMESPACE   "backlog"
+#define BUFFER_COUNT            2           // Batch being published, batch being read
+
+typedef struct {
+    uint32_t magic;
+    uint32_t first_seq;
+    uint32_t reserved[2];
+} sector_header_t;
+
+typedef struct {
+    uint32_t time_ms;           // Sample timestamp, tick time in its boot
+    uint16_t boot;
+    int16_t temp_dc;            // 0.1 °C
+    uint16_t hum_dc;            // 0.1 %
+    uint16_t aqi;
+    uint16_t light_lux;
+    uint16_t check;             // Low half of the CRC-32 of the fields above
+} backlog_record_t;
+
+_Static_assert(TELEMETRY_CBOR_SIZE(BACKLOG_BATCH_SAMPLES) <= BACKLOG_BATCH_BYTES,
+               "BACKLOG_BATCH_SAMPLES do not fit BACKLOG_BATCH_BYTES");
+
+#define RECORDS_PER_SECTOR \
+    ((BACKLOG_SECTOR_SIZE - sizeof(sector_header_t)) / sizeof(backlog_record_t))
+
+// Unix time at tick time 0 of one boot
+typedef struct {
+    uint16_t boot;
+    uint16_t reserved;
+    uint32_t epoch_base;
+} boot_anchor_t;
+
+// Saved after every published batch
+typedef struct {
+    uint32_t seq;               // Next record to send
+    uint16_t boot;              // Boot of the last record sent
+    uint16_t reserved;
+} cursor_t;
+
+// One encoded batch handed from the reader to the replay task; len 0 ends a drain
+typedef struct {
+    uint8_t buf;
+    uint16_t samples;
+    uint16_t boot;
+    uint32_t len;
+    uint32_t next_seq;
+} replay_batch_t;
+
+static const esp_partition_t *partition = NULL;
+static SemaphoreHandle_t backlog_mutex = NULL;
+static uint32_t sector_count = 0;
+static uint32_t head_seq = 0;           // Next record to write
+static cursor_t cursor;
+static boot_anchor_t anchors[BACKLOG_ANCHORS];
+static bool anchor_saved = false;
+static backlog_stats_t stats;
+
+static TaskHandle_t replay_task_handle = NULL;
+static TaskHandle_t reader_task_handle = NULL;
+static QueueHandle_t free_queue = NULL;
+static QueueHandle_t full_queue = NULL;
+static uint8_t batch_bufs[BUFFER_COUNT][BACKLOG_BATCH_BYTES];
+static backlog_record_t batch_records[BACKLOG_BATCH_SAMPLES];   // Reader task only
+static volatile bool abort_drain = false;
+static uint32_t drain_start_seq = 0;
+static uint16_t drain_prev_boot = 0;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+static uint16_t record_check(const backlog_record_t *r)
+{
+    return (uint16_t)esp_rom_crc32_le(0, (const uint8_t *)r, offsetof(backlog_record_t, check));
+}
+
+static bool record_blank(const backlog_record_t *r)
+{
+    const uint8_t *p = (const uint8_t *)r;
+    for (size_t i = 0; i < sizeof(*r); i++) {
+        if (p[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t sector_offset(uint32_t seq)
+{
+    return (size_t)((seq / RECORDS_PER_SECTOR) % sector_count) * BACKLOG_SECTOR_SIZE;
+}
+
+static size_t record_offset(uint32_t seq)
+{
+    return sector_offset(seq) + sizeof(sector_header_t) +
+           (seq % RECORDS_PER_SECTOR) * sizeof(backlog_record_t);
+}
+
+// ============================================
+// LOG POSITION (backlog_mutex held)
+// ============================================
+
+// Oldest record still in flash: the start of the sector after the head's
+static uint32_t tail_seq(void)
+{
+    uint32_t head_start = head_seq - head_seq % RECORDS_PER_SECTOR;
+    uint32_t span = (sector_count - 1) * RECORDS_PER_SECTOR;
+    return head_start > span ? head_start - span : 0;
+}
+
+static uint32_t pending_locked(void)
+{
+    uint32_t from = cursor.seq > tail_seq() ? cursor.seq : tail_seq();
+    return head_seq > from ? head_seq - from : 0;
+}
+
+static void save_blob(const char *key, const void *data, size_t len)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(BACKLOG_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, key, data, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Saving %s failed: %s", key, esp_err_to_name(err));
+    }
+}
+
+static void load_blob(const char *key, void *data, size_t len)
+{
+    nvs_handle_t handle;
+    if (nvs_open(BACKLOG_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    size_t length = len;
+    if (nvs_get_blob(handle, key, data, &length) != ESP_OK || length != len) {
+        memset(data, 0, len);
+    }
+    nvs_close(handle);
+}
+
+// Head from the highest sector header, then the first blank slot in it
+static void find_head(void)
+{
+    bool found = false;
+    uint32_t head_start = 0;
+    for (uint32_t i = 0; i < sector_count; i++) {
+        sector_header_t header;
+        if (esp_partition_read(partition, i * BACKLOG_SECTOR_SIZE, &header,
+                               sizeof(header)) != ESP_OK || header.magic != BACKLOG_MAGIC) {
+            continue;
+        }
+        if (!found || header.first_seq > head_start) {
+            head_start = header.first_seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        head_seq = 0;
+        return;
+    }
+
+    head_seq = head_start;
+    while (head_seq < head_start + RECORDS_PER_SECTOR) {
+        backlog_record_t r;
+        esp_partition_read(partition, record_offset(head_seq), &r, sizeof(r));
+        if (record_blank(&r)) {
+            break;
+        }
+        head_seq++;
+    }
+}
+
+static uint32_t anchor_epoch(uint16_t boot)
+{
+    for (int i = 0; i < BACKLOG_ANCHORS; i++) {
+        if (anchors[i].boot == boot && anchors[i].epoch_base) {
+            return anchors[i].epoch_base;
+        }
+    }
+    return 0;
+}
+
+// ============================================
+// APPEND
+// ============================================
+
+esp_err_t backlog_init(void)
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                         BACKLOG_PARTITION_LABEL);
+    if (!partition) {
+        ESP_LOGE(TAG, "No \"%s\" partition", BACKLOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    backlog_mutex = xSemaphoreCreateMutex();
+    if (!backlog_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+    sector_count = partition->size / BACKLOG_SECTOR_SIZE;
+
+    load_blob("anchors", anchors, sizeof(anchors));
+    load_blob("cursor", &cursor, sizeof(cursor));
+    uint16_t boot = 0;
+    load_blob("boot", &boot, sizeof(boot));
+    stats.boot = (uint16_t)(boot + 1) ? boot + 1 : 1;
+    save_blob("boot", &stats.boot, sizeof(stats.boot));
+
+    find_head();
+    if (cursor.seq > head_seq) {
+        cursor = (cursor_t){ .seq = tail_seq() };   // Partition erased since
+    }
+    stats.capacity = (sector_count - 1) * RECORDS_PER_SECTOR;
+    stats.pending = pending_locked();
+    if (stats.pending) {
+        ESP_LOGI(TAG, "%lu samples from before the reset to replay", stats.pending);
+    }
+    return ESP_OK;
+}
+
+void backlog_append(const sensor_data_t *sample)
+{
+    if (!backlog_mutex) {
+        return;
+    }
+    backlog_record_t r = {
+        .time_ms = sample->timestamp,
+        .boot = stats.boot,
+        .temp_dc = (int16_t)lroundf(sample->temperature * 10.0f),
+        .hum_dc = (uint16_t)lroundf(sample->humidity * 10.0f),
+        .aqi = (uint16_t)sample->aqi,
+        .light_lux = sample->light_lux,
+    };
+    r.check = record_check(&r);
+
+    xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    if (head_seq % RECORDS_PER_SECTOR == 0) {
+        const sector_header_t header = { .magic = BACKLOG_MAGIC, .first_seq = head_seq };
+        err = esp_partition_erase_range(partition, sector_offset(head_seq), BACKLOG_SECTOR_SIZE);
+        if (err == ESP_OK) {
+            err = esp_partition_write(partition, sector_offset(head_seq), &header, sizeof(header));
+        }
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(partition, record_offset(head_seq), &r, sizeof(r));
+    }
+    if (err == ESP_OK) {
+        head_seq++;
+        stats.appended++;
+        if (head_seq % RECORDS_PER_SECTOR == 0 && tail_seq() > cursor.seq) {
+            // The next sector's records from the lap before are out of reach
+            uint32_t tail = tail_seq();
+            uint32_t from = tail - RECORDS_PER_SECTOR;
+            stats.lost += tail - (cursor.seq > from ? cursor.seq : from);
+        }
+    } else {
+        stats.write_errors++;
+    }
+
+    // Unix time of this boot, once, so its records can be dated later
+    uint32_t epoch = telemetry_cbor_epoch();
+    if (!anchor_saved && epoch) {
+        boot_anchor_t *a = &anchors[stats.boot % BACKLOG_ANCHORS];
+        *a = (boot_anchor_t){ .boot = stats.boot, .epoch_base = epoch - now_ms() / 1000 };
+        save_blob("anchors", anchors, sizeof(anchors));
+        anchor_saved = true;
+    }
+    xSemaphoreGive(backlog_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Append failed: %s", esp_err_to_name(err));
+    } else if (replay_task_handle) {
+        xTaskNotifyGive(replay_task_handle);
+    }
+}
+
+uint32_t backlog_pending(void)
+{
+    if (!backlog_mutex) {
+        return 0;
+    }
+    xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+    uint32_t n = pending_locked();
+    xSemaphoreGive(backlog_mutex);
+    return n;
+}
+
+// ============================================
+// READER
+// ============================================
+
+/*
+ * Copy up to max records from *seq on, within one sector. Skips to the
+ * tail if the records at *seq were overwritten, and over sectors whose
+ * header does not match. Returns 0 once caught up with the head.
+ */
+static uint32_t read_records(uint32_t *seq, backlog_record_t *out, uint32_t max)
+{
+    uint32_t n = 0;
+    xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+    if (*seq < tail_seq()) {
+        *seq = tail_seq();
+    }
+    while (*seq < head_seq) {
+        uint32_t in_sector = RECORDS_PER_SECTOR - *seq % RECORDS_PER_SECTOR;
+        n = head_seq - *seq;
+        n = n < in_sector ? n : in_sector;
+        n = n < max ? n : max;
+
+        sector_header_t header;
+        esp_partition_read(partition, sector_offset(*seq), &header, sizeof(header));
+        if (header.magic == BACKLOG_MAGIC && header.first_seq == *seq - *seq % RECORDS_PER_SECTOR &&
+            esp_partition_read(partition, record_offset(*seq), out,
+                               n * sizeof(backlog_record_t)) == ESP_OK) {
+            break;
+        }
+        stats.corrupt += in_sector < head_seq - *seq ? in_sector : head_seq - *seq;
+        *seq += in_sector;
+        n = 0;
+    }
+    xSemaphoreGive(backlog_mutex);
+    return n;
+}
+
+/*
+ * Fill batch_records with the next batch: up to BACKLOG_BATCH_SAMPLES
+ * valid records, all from one boot. *seq moves past what was taken.
+ */
+static uint32_t gather_batch(uint32_t *seq)
+{
+    uint32_t count = 0;
+    while (count < BACKLOG_BATCH_SAMPLES && !abort_drain) {
+        uint32_t start = *seq;
+        uint32_t n = read_records(seq, &batch_records[count], BACKLOG_BATCH_SAMPLES - count);
+        if (n == 0) {
+            break;
+        }
+        if (*seq != start) {
+            ESP_LOGW(TAG, "Records %lu..%lu were overwritten or unreadable", start, *seq - 1);
+        }
+
+        bool boot_change = false;
+        uint32_t kept = count;
+        for (uint32_t i = 0; i < n; i++) {
+            const backlog_record_t *r = &batch_records[count + i];
+            if (r->check != record_check(r)) {
+                stats.corrupt++;
+                (*seq)++;
+                continue;
+            }
+            if (kept > 0 && r->boot != batch_records[0].boot) {
+                boot_change = true;     // Starts the next batch
+                break;
+            }
+            batch_records[kept++] = *r;
+            (*seq)++;
+        }
+        count = kept;
+        if (boot_change) {
+            break;
+        }
+    }
+    return count;
+}
+
+static size_t encode_batch(uint8_t *buf, uint32_t count, bool gap)
+{
+    const backlog_record_t *first = &batch_records[0];
+    const backlog_record_t *last = &batch_records[count - 1];
+    uint32_t epoch_base = anchor_epoch(first->boot);
+
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin_replay(&enc, buf, BACKLOG_BATCH_BYTES, count, last->time_ms,
+                                epoch_base ? epoch_base + last->time_ms / 1000 : 0,
+                                first->time_ms, first->boot, gap);
+    for (uint32_t i = 0; i < count; i++) {
+        const backlog_record_t *r = &batch_records[i];
+        const sensor_data_t sample = {
+            .temperature = r->temp_dc / 10.0f,
+            .humidity = r->hum_dc / 10.0f,
+            .aqi = r->aqi,
+            .light_lux = r->light_lux,
+            .timestamp = r->time_ms,
+        };
+        telemetry_cbor_add(&enc, &sample);
+    }
+    return telemetry_cbor_end(&enc);
+}
+
+static void reader_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t seq = drain_start_seq;
+        uint16_t prev_boot = drain_prev_boot;
+
+        while (!abort_drain) {
+            uint8_t buf;
+            xQueueReceive(free_queue, &buf, portMAX_DELAY);
+            uint32_t count = gather_batch(&seq);
+            size_t len = count ? encode_batch(batch_bufs[buf], count, prev_boot &&
+                                              batch_records[0].boot != prev_boot) : 0;
+            if (len == 0) {
+                xQueueSend(free_queue, &buf, 0);
+                break;
+            }
+            const replay_batch_t batch = {
+                .buf = buf,
+                .samples = (uint16_t)count,
+                .boot = batch_records[0].boot,
+                .len = (uint32_t)len,
+                .next_seq = seq,
+            };
+            xQueueSend(full_queue, &batch, portMAX_DELAY);
+            prev_boot = batch.boot;
+        }
+
+        const replay_batch_t end = { .next_seq = seq };
+        xQueueSend(full_queue, &end, portMAX_DELAY);
+    }
+}
+
+// ============================================
+// REPLAY
+// ============================================
+
+static void drain(void)
+{
+    xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+    drain_start_seq = cursor.seq;
+    drain_prev_boot = cursor.boot;
+    uint32_t pending = pending_locked();
+    xSemaphoreGive(backlog_mutex);
+
+    ESP_LOGI(TAG, "Replaying %lu samples", pending);
+    uint32_t start_ms = now_ms();
+    uint32_t samples = 0;
+    abort_drain = false;
+    xTaskNotifyGive(reader_task_handle);
+
+    while (1) {
+        replay_batch_t batch;
+        xQueueReceive(full_queue, &batch, portMAX_DELAY);
+        if (batch.len == 0) {
+            // Caught up: whatever lay between was sent or unreadable
+            xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+            if (!abort_drain && batch.next_seq > cursor.seq) {
+                cursor.seq = batch.next_seq;
+                save_blob("cursor", &cursor, sizeof(cursor));
+            }
+            xSemaphoreGive(backlog_mutex);
+            break;
+        }
+
+        // After a failure the reader is told to stop; what it already
+        // encoded is handed back unsent
+        if (!abort_drain) {
+            esp_err_t err = cloud_task_wait_connected(0) ?
+                            cloud_publish_batch(batch_bufs[batch.buf], batch.len) : ESP_FAIL;
+            if (err == ESP_OK) {
+                xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+                cursor = (cursor_t){ .seq = batch.next_seq, .boot = batch.boot };
+                stats.replayed += batch.samples;
+                stats.batches++;
+                stats.bytes += batch.len;
+                save_blob("cursor", &cursor, sizeof(cursor));
+                xSemaphoreGive(backlog_mutex);
+                samples += batch.samples;
+            } else {
+                ESP_LOGW(TAG, "Replay paused: %s", esp_err_to_name(err));
+                abort_drain = true;
+            }
+        }
+        xQueueSend(free_queue, &batch.buf, 0);
+    }
+
+    if (samples) {
+        uint32_t elapsed = now_ms() - start_ms;
+        xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+        stats.drains++;
+        stats.last_drain_samples = samples;
+        stats.last_drain_ms = elapsed;
+        stats.drain_ms += elapsed;
+        xSemaphoreGive(backlog_mutex);
+        ESP_LOGI(TAG, "Replayed %lu samples in %lu ms (%lu samples/s)", samples, elapsed,
+                 elapsed ? (uint32_t)((uint64_t)samples * 1000 / elapsed) : samples);
+    }
+}
+
+static void replay_task(void *pvParameters)
+{
+    while (1) {
+        if (backlog_pending() == 0) {
+            // Woken by the next append
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        cloud_task_wait_connected(portMAX_DELAY);
+        drain();
+        if (abort_drain) {
+            vTaskDelay(pdMS_TO_TICKS(BACKLOG_RETRY_MS));
+        }
+    }
+}
+
+void backlog_start(void)
+{
+    if (!backlog_mutex) {
+        return;
+    }
+    free_queue = xQueueCreate(BUFFER_COUNT, sizeof(uint8_t));
+    full_queue = xQueueCreate(BUFFER_COUNT + 1, sizeof(replay_batch_t));
+    if (!free_queue || !full_queue) {
+        ESP_LOGE(TAG, "Replay queues not created");
+        return;
+    }
+    for (uint8_t i = 0; i < BUFFER_COUNT; i++) {
+        xQueueSend(free_queue, &i, 0);
+    }
+    xTaskCreatePinnedToCore(reader_task, "BacklogRd", BACKLOG_READER_STACK_SIZE, NULL,
+                            BACKLOG_TASK_PRIORITY, &reader_task_handle, BACKLOG_TASK_CORE);
+    xTaskCreatePinnedToCore(replay_task, "Backlog", BACKLOG_TASK_STACK_SIZE, NULL,
+                            BACKLOG_TASK_PRIORITY, &replay_task_handle, BACKLOG_TASK_CORE);
+}
+
+void backlog_get_stats(backlog_stats_t *out)
+{
+    if (!backlog_mutex) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(backlog_mutex, portMAX_DELAY);
+    *out = stats;
+    out->pending = pending_locked();
+    xSemaphoreGive(backlog_mutex);
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int backlog_cmd(int argc, char **argv)
+{
+    backlog_stats_t s;
+    backlog_get_stats(&s);
+    printf("boot %u: %lu of %lu samples pending, %lu stored this boot, %lu lost, "
+           "%lu corrupt, %lu write errors\n", s.boot, s.pending, s.capacity, s.appended,
+           s.lost, s.corrupt, s.write_errors);
+    printf("replayed %lu samples in %lu batches (%lu bytes) over %lu drains, %lu samples/s\n",
+           s.replayed, s.batches, s.bytes, s.drains,
+           s.drain_ms ? (uint32_t)((uint64_t)s.replayed * 1000 / s.drain_ms) : s.replayed);
+    if (s.drains) {
+        printf("last drain: %lu samples in %lu ms, %lu samples/s\n", s.last_drain_samples,
+               s.last_drain_ms, s.last_drain_ms ?
+               (uint32_t)((uint64_t)s.last_drain_samples * 1000 / s.last_drain_ms) :
+               s.last_drain_samples);
+    }
+    return 0;
+}
+
+esp_err_t backlog_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "backlog",
+        .help = "Offline samples in flash and replay throughput",
+        .hint = NULL,
+        .func = backlog_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
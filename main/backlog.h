@@ -0,0 +1,75 @@
+/**
+ * @file backlog.h
+ * @brief Flash backlog of offline samples and the replay that drains it (ENABLE_BACKLOG)
+ *
+ * The uplink batch holds UPLINK_BATCH_SIZE samples in RAM. During a longer
+ * outage the samples it pushes out are appended here instead of being
+ * lost: 16-byte records in a ring of flash sectors (the "backlog"
+ * partition, about 33 hours at a 10 s interval), which survives resets.
+ *
+ * Once the cloud is back, a replay drains the backlog oldest first in
+ * CBOR batches (telemetry_cbor.h) of up to BACKLOG_BATCH_SAMPLES, the most
+ * whose worst-case encoding fits BACKLOG_BATCH_BYTES. A reader task reads
+ * and encodes the next batch while the replay task publishes the current
+ * one. A batch never spans a restart, since tick times start over; the
+ * first batch after one carries "g": 1, and every replay batch carries its
+ * boot number in "b". Batches from a boot that had SNTP time get a real
+ * "e", so the host can place them on the calendar.
+ *
+ * The position of the next record to send is kept in NVS after every
+ * published batch, so a reset during a drain resumes where it stopped.
+ * Publishes go through the cloud rate limit (cloud_rate.h), shared with
+ * live telemetry and alerts.
+ */
+
+#ifndef BACKLOG_H
+#define BACKLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+
+typedef struct {
+    uint32_t capacity;          // Records the partition holds
+    uint32_t pending;           // Stored and not yet sent
+    uint32_t appended;          // This boot
+    uint32_t lost;              // Overwritten before they were sent
+    uint32_t corrupt;           // Records skipped on a bad check or sector header
+    uint32_t write_errors;
+    uint32_t replayed;          // Samples published, this boot
+    uint32_t batches;
+    uint32_t bytes;
+    uint32_t drains;            // Replays that published something
+    uint32_t last_drain_samples;
+    uint32_t last_drain_ms;     // First read to last publish
+    uint32_t drain_ms;          // All drains; replayed / drain_ms is the throughput
+    uint16_t boot;              // Number of this boot, from 1
+} backlog_stats_t;
+
+/**
+ * @brief Find the partition, the end of the log and the saved cursor;
+ *        call after nvs_flash_init()
+ */
+esp_err_t backlog_init(void);
+
+/**
+ * @brief Start the replay and reader tasks
+ */
+void backlog_start(void);
+
+/**
+ * @brief Store one sample the uplink batch could not hold
+ */
+void backlog_append(const sensor_data_t *sample);
+
+uint32_t backlog_pending(void);
+
+void backlog_get_stats(backlog_stats_t *out);
+
+/**
+ * @brief Register the "backlog" console command (size, drain throughput)
+ */
+esp_err_t backlog_register_console(void);
+
+#endif // BACKLOG_H
@@ -0,0 +1,325 @@
+/**
+ * @file boot_graph.c
+ * @brief Dependency-ordered boot stages and the boot timeline
+ *
+ * Each stage owns one bit in an event group, set when it finishes (or is
+ * skipped). A worker picks the first pending stage whose dependency bits are
+ * all set; when none is ready it waits for any bit it has not seen yet, so a
+ * finish between the scan and the wait is never missed. Times are
+ * esp_timer_get_time(), i.e. since the application started.
+ */
+
+#include "boot_graph.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+#include <esp_diagnostics_variables.h>
+
+static const char *TAG = "BOOT_GRAPH";
+
+typedef enum {
+    STAGE_PENDING,
+    STAGE_RUNNING,
+    STAGE_DONE,
+} stage_state_t;
+
+static boot_stage_t *graph = NULL;
+static size_t graph_count = 0;
+static uint32_t graph_all = 0;
+static stage_state_t graph_state[BOOT_GRAPH_MAX_STAGES];
+static EventGroupHandle_t graph_events = NULL;
+static portMUX_TYPE graph_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t graph_end_us = 0;
+
+static int64_t mark_us[BOOT_MARK_COUNT];
+static bool metrics_registered = false;
+static char stage_keys[BOOT_GRAPH_MAX_STAGES][24];
+
+static const char *const mark_keys[BOOT_MARK_COUNT] = {
+    [BOOT_MARK_FIRST_SAMPLE] = "first_sample_ms",
+    [BOOT_MARK_CLOUD_CONNECTED] = "cloud_connect_ms",
+    [BOOT_MARK_FIRST_PUBLISH] = "first_publish_ms",
+};
+
+static const char *const mark_help[BOOT_MARK_COUNT] = {
+    [BOOT_MARK_FIRST_SAMPLE] = "Boot to first sensor sample (ms)",
+    [BOOT_MARK_CLOUD_CONNECTED] = "Boot to RainMaker connection (ms)",
+    [BOOT_MARK_FIRST_PUBLISH] = "Boot to first publish (ms)",
+};
+
+// ============================================
+// WORKERS
+// ============================================
+
+// Called with graph_lock held. Marks stages behind a failed dependency as
+// skipped on the way.
+static boot_stage_t *take_ready_stage(uint32_t done, uint32_t failed, uint32_t *skipped)
+{
+    for (size_t i = 0; i < graph_count; i++) {
+        boot_stage_t *s = &graph[i];
+        if (graph_state[i] != STAGE_PENDING) {
+            continue;
+        }
+        if (s->deps & failed) {
+            graph_state[i] = STAGE_DONE;
+            s->err = ESP_ERR_INVALID_STATE;
+            *skipped |= BOOT_DEP(i);
+            continue;
+        }
+        if ((s->deps & done) == s->deps) {
+            graph_state[i] = STAGE_RUNNING;
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t failed_stages(void)
+{
+    uint32_t failed = 0;
+    for (size_t i = 0; i < graph_count; i++) {
+        if (graph_state[i] == STAGE_DONE && graph[i].err != ESP_OK) {
+            failed |= BOOT_DEP(i);
+        }
+    }
+    return failed;
+}
+
+static void run_worker(uint8_t worker)
+{
+    for (;;) {
+        uint32_t done = xEventGroupGetBits(graph_events) & graph_all;
+        if (done == graph_all) {
+            return;
+        }
+
+        uint32_t skipped = 0;
+        taskENTER_CRITICAL(&graph_lock);
+        boot_stage_t *s = take_ready_stage(done, failed_stages(), &skipped);
+        taskEXIT_CRITICAL(&graph_lock);
+
+        if (skipped) {
+            xEventGroupSetBits(graph_events, skipped);
+        }
+        if (!s) {
+            if (!skipped) {
+                // Nothing ready: sleep until another stage finishes
+                xEventGroupWaitBits(graph_events, graph_all & ~done, pdFALSE, pdFALSE,
+                                    portMAX_DELAY);
+            }
+            continue;
+        }
+
+        s->worker = worker;
+        s->start_us = esp_timer_get_time();
+        esp_err_t err = s->fn();
+        s->end_us = esp_timer_get_time();
+
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Stage %s failed: %s", s->name, esp_err_to_name(err));
+        }
+
+        taskENTER_CRITICAL(&graph_lock);
+        s->err = err;
+        graph_state[s - graph] = STAGE_DONE;
+        taskEXIT_CRITICAL(&graph_lock);
+        xEventGroupSetBits(graph_events, BOOT_DEP(s - graph));
+    }
+}
+
+static void boot_worker_task(void *arg)
+{
+    run_worker((uint8_t)(uintptr_t)arg);
+    vTaskDelete(NULL);
+}
+
+// ============================================
+// INSIGHTS
+// ============================================
+
+static void report_stages(void)
+{
+    for (size_t i = 0; i < graph_count; i++) {
+        if (graph[i].err == ESP_OK) {
+            esp_diag_variable_add_uint(stage_keys[i],
+                (uint32_t)((graph[i].end_us - graph[i].start_us) / 1000));
+        }
+    }
+    esp_diag_variable_add_uint("boot_ms", (uint32_t)(graph_end_us / 1000));
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+esp_err_t boot_graph_run(boot_stage_t *stages, size_t count, int workers)
+{
+    if (count == 0 || count > BOOT_GRAPH_MAX_STAGES || workers < 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Dependencies only on earlier stages, so the graph cannot have a cycle
+    for (size_t i = 0; i < count; i++) {
+        if (stages[i].deps & ~(BOOT_DEP(i) - 1)) {
+            ESP_LOGE(TAG, "Stage %s depends on itself or a later stage", stages[i].name);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    graph_events = xEventGroupCreate();
+    if (!graph_events) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    graph = stages;
+    graph_count = count;
+    graph_all = (uint32_t)((1ULL << count) - 1);
+    for (size_t i = 0; i < count; i++) {
+        graph_state[i] = STAGE_PENDING;
+        stages[i].err = ESP_OK;
+        snprintf(stage_keys[i], sizeof(stage_keys[i]), "boot_%s_ms", stages[i].name);
+    }
+
+    for (int w = 1; w < workers; w++) {
+        if (xTaskCreatePinnedToCore(boot_worker_task, "BootWorker", BOOT_WORKER_STACK_SIZE,
+                                    (void *)(uintptr_t)w, BOOT_WORKER_PRIORITY, NULL,
+                                    BOOT_WORKER_CORE) != pdPASS) {
+            ESP_LOGW(TAG, "Boot worker %d not created, continuing with fewer", w);
+        }
+    }
+
+    run_worker(0);
+    int64_t end_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&graph_lock);
+    graph_end_us = end_us;
+    bool report = metrics_registered;
+    taskEXIT_CRITICAL(&graph_lock);
+
+    esp_err_t first_err = ESP_OK;
+    for (size_t i = 0; i < count; i++) {
+        const boot_stage_t *s = &stages[i];
+        if (s->err == ESP_ERR_INVALID_STATE) {
+            ESP_LOGW(TAG, "  %-10s skipped", s->name);
+        } else {
+            ESP_LOGI(TAG, "  %-10s %6lld - %6lld ms (worker %u)", s->name,
+                     s->start_us / 1000, s->end_us / 1000, s->worker);
+        }
+        if (s->err != ESP_OK && first_err == ESP_OK) {
+            first_err = s->err;
+        }
+    }
+    ESP_LOGI(TAG, "Boot graph done at %lld ms on %d worker(s)", end_us / 1000, workers);
+
+    if (report) {
+        report_stages();
+    }
+    return first_err;
+}
+
+void boot_graph_mark(boot_mark_t mark)
+{
+    if (mark >= BOOT_MARK_COUNT || mark_us[mark] != 0) {
+        return;     // Unlocked fast path once the milestone is recorded
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    bool first = false, report = false;
+
+    taskENTER_CRITICAL(&graph_lock);
+    if (mark_us[mark] == 0) {
+        mark_us[mark] = now_us;
+        first = true;
+        report = metrics_registered;
+    }
+    taskEXIT_CRITICAL(&graph_lock);
+
+    if (first) {
+        ESP_LOGI(TAG, "%s: %lld ms", mark_keys[mark], now_us / 1000);
+    }
+    if (report) {
+        esp_diag_variable_add_uint(mark_keys[mark], (uint32_t)(now_us / 1000));
+    }
+}
+
+esp_err_t boot_graph_register_metrics(void)
+{
+    for (size_t i = 0; i < graph_count; i++) {
+        esp_diag_variable_register(TAG, stage_keys[i], "Boot stage duration (ms)",
+                                   "boot.stages", ESP_DIAG_DATA_TYPE_UINT);
+    }
+    esp_diag_variable_register(TAG, "boot_ms", "Boot to tasks started (ms)",
+                               "boot", ESP_DIAG_DATA_TYPE_UINT);
+    for (int m = 0; m < BOOT_MARK_COUNT; m++) {
+        esp_diag_variable_register(TAG, mark_keys[m], mark_help[m],
+                                   "boot", ESP_DIAG_DATA_TYPE_UINT);
+    }
+
+    int64_t reached[BOOT_MARK_COUNT];
+    taskENTER_CRITICAL(&graph_lock);
+    metrics_registered = true;
+    bool graph_done = graph_end_us != 0;
+    for (int m = 0; m < BOOT_MARK_COUNT; m++) {
+        reached[m] = mark_us[m];
+    }
+    taskEXIT_CRITICAL(&graph_lock);
+
+    if (graph_done) {
+        report_stages();
+    }
+    for (int m = 0; m < BOOT_MARK_COUNT; m++) {
+        if (reached[m] != 0) {
+            esp_diag_variable_add_uint(mark_keys[m], (uint32_t)(reached[m] / 1000));
+        }
+    }
+    return ESP_OK;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int boot_cmd(int argc, char **argv)
+{
+    printf("%-10s %8s %8s %8s %s\n", "stage", "start", "end", "ms", "worker");
+    for (size_t i = 0; i < graph_count; i++) {
+        const boot_stage_t *s = &graph[i];
+        if (s->err == ESP_ERR_INVALID_STATE) {
+            printf("%-10s skipped\n", s->name);
+            continue;
+        }
+        printf("%-10s %8lld %8lld %8lld %u%s\n", s->name, s->start_us / 1000,
+               s->end_us / 1000, (s->end_us - s->start_us) / 1000, s->worker,
+               s->err != ESP_OK ? "  failed" : "");
+    }
+    printf("%-10s %8s %8lld\n", "boot", "", graph_end_us / 1000);
+    for (int m = 0; m < BOOT_MARK_COUNT; m++) {
+        if (mark_us[m] != 0) {
+            printf("%-18s %lld ms\n", mark_keys[m], mark_us[m] / 1000);
+        } else {
+            printf("%-18s not yet\n", mark_keys[m]);
+        }
+    }
+    return 0;
+}
+
+esp_err_t boot_graph_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "boot",
+        .help = "Boot stage timeline and time to first sample/publish",
+        .hint = NULL,
+        .func = boot_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file boot_graph.h
+ * @brief Dependency-ordered boot stages and the boot timeline
+ *
+ * app_main describes its initialisation as stages, each listing the stages
+ * it needs. boot_graph_run() starts every stage as soon as its dependencies
+ * are done, on up to BOOT_GRAPH_WORKERS tasks, so that a stage blocked on a
+ * bus (the OLED upload) or on the radio does not hold up unrelated ones.
+ * Every stage is timestamped, and milestones after boot (first sample,
+ * cloud connection, first publish) are added to the same timeline, which
+ * goes to ESP Insights and the "boot" console command.
+ */
+
+#ifndef BOOT_GRAPH_H
+#define BOOT_GRAPH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define BOOT_GRAPH_MAX_STAGES   16
+#define BOOT_DEP(stage)         (1UL << (stage))
+
+typedef esp_err_t (*boot_stage_fn_t)(void);
+
+typedef struct {
+    const char *name;           // Short, also the Insights key ("boot_<name>_ms")
+    boot_stage_fn_t fn;
+    uint32_t deps;              // BOOT_DEP() of the stages that must finish first
+
+    // Filled in by boot_graph_run()
+    int64_t start_us;
+    int64_t end_us;
+    esp_err_t err;              // ESP_ERR_INVALID_STATE: skipped, a dependency failed
+    uint8_t worker;
+} boot_stage_t;
+
+typedef enum {
+    BOOT_MARK_FIRST_SAMPLE,
+    BOOT_MARK_CLOUD_CONNECTED,
+    BOOT_MARK_FIRST_PUBLISH,
+    BOOT_MARK_COUNT
+} boot_mark_t;
+
+/**
+ * @brief Run the stages in dependency order and record the timeline
+ *
+ * The calling task is one of the workers; the others are created here and
+ * delete themselves when the graph is done. A stage may only depend on
+ * stages listed before it. Among ready stages, earlier entries start first,
+ * so list the critical path first. A stage whose dependency failed
+ * is skipped. Returns once every stage has finished or been skipped.
+ *
+ * @param stages Stage table; must stay valid for the timeline (static)
+ * @param count Number of stages, at most BOOT_GRAPH_MAX_STAGES
+ * @param workers Tasks to run stages on; 1 runs them in list order
+ * @return ESP_OK, or the error of the first stage (in list order) that failed
+ */
+esp_err_t boot_graph_run(boot_stage_t *stages, size_t count, int workers);
+
+/**
+ * @brief Record a milestone; only the first call for each counts
+ *
+ * Cheap enough for the sample and publish paths.
+ */
+void boot_graph_mark(boot_mark_t mark);
+
+/**
+ * @brief Register the boot timeline as Insights variables
+ *
+ * Call once the diagnostics store is up. Stage times already recorded are
+ * reported straight away, later ones when they happen.
+ */
+esp_err_t boot_graph_register_metrics(void);
+
+/**
+ * @brief Register the "boot" console command (stage timeline, milestones)
+ */
+esp_err_t boot_graph_register_console(void);
+
+#endif // BOOT_GRAPH_H
@@ -0,0 +1,480 @@
+/**
+ * @file calibration.c
+ * @brief Per-device sensor calibration implementation
+ *
+ * The LDR curve is compiled into a 257-entry table, one entry every 16 ADC
+ * codes, and looked up with linear interpolation between neighbours. A
+ * rebuild computes the new table on the caller's stack and swaps it in with
+ * the parameters in one critical section; a lookup reads its two entries
+ * under the same lock, so it never mixes two curves. The calibration mode
+ * session (button on the sensor task, commands on the console task) shares
+ * that lock too.
+ */
+
+#include "calibration.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_console.h>
+#include <nvs.h>
+
+static const char *TAG = "CALIBRATION";
+
+#define CALIB_NVS_NAMESPACE     "calib"
+#define CALIB_NVS_KEY           "params"
+#define CALIB_NVS_VERSION       1
+
+#define CALIB_ADC_MAX           4095
+#define CALIB_LUT_ENTRIES       (((CALIB_ADC_MAX + 1) >> CALIB_LUT_SHIFT) + 1)
+#define CALIB_LUT_STEP          (1 << CALIB_LUT_SHIFT)
+
+// Limits accepted from the console / NVS
+#define CALIB_GAIN_MIN          0.5f
+#define CALIB_GAIN_MAX          2.0f
+#define CALIB_OFFSET_MAX        20.0f
+
+typedef struct {
+    uint8_t version;
+    calib_params_t params;
+} calib_blob_t;
+
+// Uncalibrated device: DHT11 as read, LDR linear up to LDR_DEFAULT_FULL_SCALE_LUX
+static const calib_params_t default_params = {
+    .temp_offset = 0.0f,
+    .temp_gain = 1.0f,
+    .hum_offset = 0.0f,
+    .hum_gain = 1.0f,
+    .ldr_point_count = 2,
+    .ldr_points = {
+        { .raw = 0, .lux = 0 },
+        { .raw = CALIB_ADC_MAX, .lux = LDR_DEFAULT_FULL_SCALE_LUX },
+    },
+};
+
+// Everything below is under params_lock
+static calib_params_t params;
+static uint16_t lut[CALIB_LUT_ENTRIES];
+static uint32_t params_gen = 0;                 // Bumped by every change
+static uint32_t saved_gen = 0;                  // params_gen last written to NVS
+static portMUX_TYPE params_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Calibration mode session
+static bool mode_active = false;
+static calib_point_t captured[CALIB_LDR_MAX_POINTS];
+static int captured_count = 0;
+
+// Raw readings of the latest sample
+static float raw_temperature = 0.0f;
+static float raw_humidity = 0.0f;
+static int raw_ldr = -1;
+
+// ============================================
+// LOOKUP TABLE
+// ============================================
+
+static uint16_t curve_lux(const calib_params_t *p, int raw)
+{
+    const calib_point_t *pts = p->ldr_points;
+    int last = p->ldr_point_count - 1;
+
+    // Flat beyond the captured range
+    if (raw <= pts[0].raw) {
+        return pts[0].lux;
+    }
+    if (raw >= pts[last].raw) {
+        return pts[last].lux;
+    }
+
+    int seg = 0;
+    while (raw > pts[seg + 1].raw) {
+        seg++;
+    }
+    const calib_point_t *a = &pts[seg];
+    const calib_point_t *b = &pts[seg + 1];
+    int32_t lux = a->lux + (int32_t)(raw - a->raw) * ((int32_t)b->lux - a->lux) /
+                  (int32_t)(b->raw - a->raw);
+    return (uint16_t)lux;
+}
+
+static void build_lut(const calib_params_t *p, uint16_t *out)
+{
+    for (int i = 0; i < CALIB_LUT_ENTRIES; i++) {
+        int raw = i * CALIB_LUT_STEP;
+        out[i] = curve_lux(p, raw > CALIB_ADC_MAX ? CALIB_ADC_MAX : raw);
+    }
+}
+
+// Parameters and their table in one step; the slow part is done beforehand
+static void install(const calib_params_t *p)
+{
+    uint16_t next[CALIB_LUT_ENTRIES];
+    build_lut(p, next);
+
+    taskENTER_CRITICAL(&params_lock);
+    params = *p;
+    memcpy(lut, next, sizeof(lut));
+    params_gen++;
+    taskEXIT_CRITICAL(&params_lock);
+}
+
+uint16_t calibration_ldr_lux(int raw)
+{
+    if (raw < 0) raw = 0;
+    if (raw > CALIB_ADC_MAX) raw = CALIB_ADC_MAX;
+
+    int i = raw >> CALIB_LUT_SHIFT;
+    int32_t frac = raw & (CALIB_LUT_STEP - 1);
+
+    taskENTER_CRITICAL(&params_lock);
+    int32_t lo = lut[i], hi = lut[i + 1];
+    taskEXIT_CRITICAL(&params_lock);
+
+    return (uint16_t)(lo + (hi - lo) * frac / CALIB_LUT_STEP);
+}
+
+// ============================================
+// PARAMETERS
+// ============================================
+
+static bool params_valid(const calib_params_t *p)
+{
+    if (p->temp_gain < CALIB_GAIN_MIN || p->temp_gain > CALIB_GAIN_MAX ||
+        p->hum_gain < CALIB_GAIN_MIN || p->hum_gain > CALIB_GAIN_MAX ||
+        p->temp_offset < -CALIB_OFFSET_MAX || p->temp_offset > CALIB_OFFSET_MAX ||
+        p->hum_offset < -CALIB_OFFSET_MAX || p->hum_offset > CALIB_OFFSET_MAX) {
+        return false;
+    }
+    if (p->ldr_point_count < 2 || p->ldr_point_count > CALIB_LDR_MAX_POINTS) {
+        return false;
+    }
+    for (int i = 0; i < p->ldr_point_count; i++) {
+        if (p->ldr_points[i].raw > CALIB_ADC_MAX) {
+            return false;
+        }
+        if (i > 0 && p->ldr_points[i].raw <= p->ldr_points[i - 1].raw) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t save_params(void)
+{
+    nvs_handle_t handle;
+    calib_blob_t blob = { .version = CALIB_NVS_VERSION };
+
+    taskENTER_CRITICAL(&params_lock);
+    blob.params = params;
+    uint32_t gen = params_gen;
+    taskEXIT_CRITICAL(&params_lock);
+
+    esp_err_t err = nvs_open(CALIB_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS open failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = nvs_set_blob(handle, CALIB_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Saving calibration failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    // A change made while this one was written stays unsaved
+    taskENTER_CRITICAL(&params_lock);
+    if ((int32_t)(gen - saved_gen) > 0) {
+        saved_gen = gen;
+    }
+    taskEXIT_CRITICAL(&params_lock);
+    ESP_LOGI(TAG, "Calibration saved");
+    return ESP_OK;
+}
+
+static void load_params(calib_params_t *out)
+{
+    nvs_handle_t handle;
+    calib_blob_t blob;
+    size_t length = sizeof(blob);
+
+    *out = default_params;
+
+    if (nvs_open(CALIB_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        ESP_LOGI(TAG, "No calibration stored, using defaults");
+        return;
+    }
+    esp_err_t err = nvs_get_blob(handle, CALIB_NVS_KEY, &blob, &length);
+    nvs_close(handle);
+
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "No calibration stored, using defaults");
+        return;
+    }
+    if (err != ESP_OK || length != sizeof(blob) || blob.version != CALIB_NVS_VERSION ||
+        !params_valid(&blob.params)) {
+        ESP_LOGW(TAG, "Stored calibration unusable, using defaults");
+        return;
+    }
+    *out = blob.params;
+}
+
+esp_err_t calibration_init(void)
+{
+    calib_params_t loaded;
+
+    load_params(&loaded);
+    install(&loaded);
+
+    taskENTER_CRITICAL(&params_lock);
+    saved_gen = params_gen;         // What NVS holds, or the defaults
+    taskEXIT_CRITICAL(&params_lock);
+
+    ESP_LOGI(TAG, "T = %.3f*raw%+.2f, H = %.3f*raw%+.2f, LDR curve %d points",
+             loaded.temp_gain, loaded.temp_offset, loaded.hum_gain, loaded.hum_offset,
+             loaded.ldr_point_count);
+    return ESP_OK;
+}
+
+void calibration_get_params(calib_params_t *out)
+{
+    taskENTER_CRITICAL(&params_lock);
+    *out = params;
+    taskEXIT_CRITICAL(&params_lock);
+}
+
+esp_err_t calibration_set_params(const calib_params_t *new_params, bool persist)
+{
+    if (!params_valid(new_params)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    install(new_params);
+    return persist ? save_params() : ESP_OK;
+}
+
+// ============================================
+// HOT PATH
+// ============================================
+
+void calibration_apply_dht(float *temperature, float *humidity)
+{
+    taskENTER_CRITICAL(&params_lock);
+    float t_gain = params.temp_gain, t_offset = params.temp_offset;
+    float h_gain = params.hum_gain, h_offset = params.hum_offset;
+    taskEXIT_CRITICAL(&params_lock);
+
+    *temperature = *temperature * t_gain + t_offset;
+    *humidity = *humidity * h_gain + h_offset;
+    if (*humidity < 0.0f) *humidity = 0.0f;
+    if (*humidity > 100.0f) *humidity = 100.0f;
+}
+
+void calibration_note_raw(float temperature, float humidity, int ldr_raw)
+{
+    taskENTER_CRITICAL(&params_lock);
+    raw_temperature = temperature;
+    raw_humidity = humidity;
+    raw_ldr = ldr_raw;
+    taskEXIT_CRITICAL(&params_lock);
+}
+
+// ============================================
+// CALIBRATION MODE
+// ============================================
+
+bool calibration_mode_active(void)
+{
+    taskENTER_CRITICAL(&params_lock);
+    bool active = mode_active;
+    taskEXIT_CRITICAL(&params_lock);
+    return active;
+}
+
+static bool params_dirty(void)
+{
+    taskENTER_CRITICAL(&params_lock);
+    bool dirty = params_gen != saved_gen;
+    taskEXIT_CRITICAL(&params_lock);
+    return dirty;
+}
+
+void calibration_toggle_mode(void)
+{
+    taskENTER_CRITICAL(&params_lock);
+    bool active = mode_active = !mode_active;
+    if (active) {
+        captured_count = 0;
+    }
+    taskEXIT_CRITICAL(&params_lock);
+
+    ESP_LOGI(TAG, "Calibration mode: %s", active ? "ENABLED" : "DISABLED");
+    if (!active && params_dirty()) {
+        save_params();
+    }
+}
+
+// Add a point at the latest raw LDR reading; applied once there are two
+static esp_err_t capture_ldr_point(uint16_t lux, int *raw_out, int *count_out)
+{
+    calib_params_t p;
+    esp_err_t err = ESP_OK;
+
+    taskENTER_CRITICAL(&params_lock);
+    int raw = raw_ldr;
+    if (raw < 0) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        // Keep the capture sorted by raw; a repeated raw code replaces its lux
+        int i = 0;
+        while (i < captured_count && captured[i].raw < raw) {
+            i++;
+        }
+        if (i == captured_count || captured[i].raw != raw) {
+            if (captured_count == CALIB_LDR_MAX_POINTS) {
+                err = ESP_ERR_NO_MEM;
+            } else {
+                for (int j = captured_count; j > i; j--) {
+                    captured[j] = captured[j - 1];
+                }
+                captured_count++;
+            }
+        }
+        if (err == ESP_OK) {
+            captured[i].raw = (uint16_t)raw;
+            captured[i].lux = lux;
+            p = params;
+            p.ldr_point_count = (uint8_t)captured_count;
+            memcpy(p.ldr_points, captured, sizeof(p.ldr_points));   // Unused tail included
+        }
+    }
+    int count = captured_count;
+    taskEXIT_CRITICAL(&params_lock);
+
+    if (err != ESP_OK) {
+        return err;
+    }
+    *raw_out = raw;
+    *count_out = count;
+    return count >= 2 ? calibration_set_params(&p, false) : ESP_OK;
+}
+
+static void clear_captured(void)
+{
+    taskENTER_CRITICAL(&params_lock);
+    captured_count = 0;
+    taskEXIT_CRITICAL(&params_lock);
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static void print_params(void)
+{
+    calib_params_t p;
+    calibration_get_params(&p);
+
+    taskENTER_CRITICAL(&params_lock);
+    float raw_t = raw_temperature, raw_h = raw_humidity;
+    int raw = raw_ldr;
+    taskEXIT_CRITICAL(&params_lock);
+
+    printf("mode: %s%s\n", calibration_mode_active() ? "calibrating" : "normal",
+           params_dirty() ? " (unsaved)" : "");
+    printf("temperature: gain %.3f offset %+.2f\n", p.temp_gain, p.temp_offset);
+    printf("humidity:    gain %.3f offset %+.2f\n", p.hum_gain, p.hum_offset);
+    printf("ldr curve:  ");
+    for (int i = 0; i < p.ldr_point_count; i++) {
+        printf(" %u->%u", p.ldr_points[i].raw, p.ldr_points[i].lux);
+    }
+    printf(" (raw->lux)\n");
+    if (raw >= 0) {
+        printf("last raw:    T %.1f H %.1f LDR %d (%u lux)\n", raw_t, raw_h,
+               raw, calibration_ldr_lux(raw));
+    }
+}
+
+static int calib_cmd(int argc, char **argv)
+{
+    calib_params_t p;
+    esp_err_t err = ESP_OK;
+
+    if (argc < 2) {
+        print_params();
+        return 0;
+    }
+
+    calibration_get_params(&p);
+    bool calibrating = calibration_mode_active();
+
+    if ((strcmp(argv[1], "temp") == 0 || strcmp(argv[1], "hum") == 0) && argc >= 3) {
+        bool temp = (argv[1][0] == 't');
+        float offset = strtof(argv[2], NULL);
+        float gain = (argc >= 4) ? strtof(argv[3], NULL) : (temp ? p.temp_gain : p.hum_gain);
+        if (temp) {
+            p.temp_offset = offset;
+            p.temp_gain = gain;
+        } else {
+            p.hum_offset = offset;
+            p.hum_gain = gain;
+        }
+        err = calibration_set_params(&p, !calibrating);
+    } else if (strcmp(argv[1], "ldr") == 0 && argc >= 3) {
+        if (strcmp(argv[2], "clear") == 0) {
+            clear_captured();
+            p.ldr_point_count = default_params.ldr_point_count;
+            memcpy(p.ldr_points, default_params.ldr_points, sizeof(p.ldr_points));
+            err = calibration_set_params(&p, !calibrating);
+        } else if (!calibrating) {
+            printf("Hold the button for 3 s to enter calibration mode first\n");
+            return 1;
+        } else {
+            long lux = strtol(argv[2], NULL, 10);
+            if (lux < 0 || lux > UINT16_MAX) {
+                printf("lux must be 0-65535\n");
+                return 1;
+            }
+            int raw, count;
+            err = capture_ldr_point((uint16_t)lux, &raw, &count);
+            if (err == ESP_OK) {
+                printf("captured %d -> %ld lux (%d points)\n", raw, lux, count);
+            }
+        }
+    } else if (strcmp(argv[1], "save") == 0) {
+        err = save_params();
+    } else if (strcmp(argv[1], "reset") == 0) {
+        clear_captured();
+        err = calibration_set_params(&default_params, true);
+    } else {
+        printf("usage: calib [temp OFFSET [GAIN]|hum OFFSET [GAIN]|ldr LUX|ldr clear|save|reset]\n");
+        return 1;
+    }
+
+    if (err != ESP_OK) {
+        printf("failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    print_params();
+    return 0;
+}
+
+esp_err_t calibration_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "calib",
+        .help = "Show or set sensor calibration. In calibration mode, "
+                "'ldr LUX' pairs the last LDR reading with a reference lux",
+        .hint = "[temp OFFSET [GAIN]|hum OFFSET [GAIN]|ldr LUX|ldr clear|save|reset]",
+        .func = calib_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file calibration.h
+ * @brief Per-device sensor calibration (DHT11 offset/gain, LDR lux curve)
+ *
+ * Parameters live in NVS. At boot, and whenever they change, the LDR curve
+ * is compiled into a small interpolated lookup table, so the per-sample cost
+ * is a few multiply-adds for the DHT11 and one table read for the LDR.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define CALIB_LDR_MAX_POINTS    8
+#define CALIB_LUT_SHIFT         4       // 4096 ADC codes -> 256 LUT segments
+
+/**
+ * @brief One point of the LDR curve: ADC code and the lux it stands for
+ */
+typedef struct {
+    uint16_t raw;
+    uint16_t lux;
+} calib_point_t;
+
+/**
+ * @brief Calibration parameters; calibrated = raw * gain + offset
+ */
+typedef struct {
+    float temp_offset;
+    float temp_gain;
+    float hum_offset;
+    float hum_gain;
+    uint8_t ldr_point_count;        // At least 2, raw strictly increasing
+    calib_point_t ldr_points[CALIB_LDR_MAX_POINTS];
+} calib_params_t;
+
+/**
+ * @brief Load the parameters from NVS (defaults if none) and build the LUT
+ *
+ * Call after nvs_flash_init().
+ */
+esp_err_t calibration_init(void);
+
+/**
+ * @brief Apply the DHT11 offset and gain in place
+ */
+void calibration_apply_dht(float *temperature, float *humidity);
+
+/**
+ * @brief Light level in lux for a raw LDR ADC code (0-4095)
+ */
+uint16_t calibration_ldr_lux(int raw);
+
+/**
+ * @brief Remember the raw (uncalibrated) readings of the latest sample
+ *
+ * The console capture commands pair these with a reference value.
+ */
+void calibration_note_raw(float temperature, float humidity, int ldr_raw);
+
+/**
+ * @brief Enter or leave calibration mode (long press on the button)
+ *
+ * Leaving the mode saves any parameters changed while it was active.
+ */
+void calibration_toggle_mode(void);
+
+bool calibration_mode_active(void);
+
+/**
+ * @brief Copy the current parameters
+ */
+void calibration_get_params(calib_params_t *out);
+
+/**
+ * @brief Validate and apply new parameters, optionally writing them to NVS
+ *
+ * @return ESP_ERR_INVALID_ARG if gains, offsets or the curve are out of range
+ */
+esp_err_t calibration_set_params(const calib_params_t *params, bool persist);
+
+/**
+ * @brief Register the "calib" console command
+ */
+esp_err_t calibration_register_console(void);
+
+#endif // CALIBRATION_H
@@ -0,0 +1,138 @@
+/**
+ * @file cloud_rate.c
+ * @brief Token bucket shared by everything that publishes to the cloud
+ *
+ * Tokens are kept in thousandths so a refill of CLOUD_RATE_PER_SEC comes to
+ * a whole number per millisecond of tick time. The bucket is refilled
+ * lazily by whichever task acquires next; a task that finds too few tokens
+ * sleeps for just the time the missing ones take to refill, then checks
+ * again, since another task may have taken them first.
+ */
+
+#include "cloud_rate.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_console.h>
+
+static const char *TAG = "CLOUD_RATE";
+
+#define MILLI               1000u
+#define CAPACITY_MILLI      (CLOUD_RATE_BURST * MILLI)
+
+static portMUX_TYPE bucket_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t tokens_milli = CAPACITY_MILLI;     // Starts full
+static uint32_t refilled_ms = 0;
+static cloud_rate_stats_t stats;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// bucket_lock held
+static void refill(uint32_t now)
+{
+    uint32_t elapsed = now - refilled_ms;
+    refilled_ms = now;
+    if (elapsed >= CAPACITY_MILLI / CLOUD_RATE_PER_SEC) {
+        tokens_milli = CAPACITY_MILLI;
+        return;
+    }
+    tokens_milli += elapsed * CLOUD_RATE_PER_SEC;
+    if (tokens_milli > CAPACITY_MILLI) {
+        tokens_milli = CAPACITY_MILLI;
+    }
+}
+
+bool cloud_rate_acquire(uint32_t messages, uint32_t timeout_ms)
+{
+    uint32_t need = (messages < CLOUD_RATE_BURST ? messages : CLOUD_RATE_BURST) * MILLI;
+    uint32_t start = now_ms();
+    bool waited = false;
+
+    while (1) {
+        uint32_t now = now_ms();
+        uint32_t waited_ms = now - start;
+
+        taskENTER_CRITICAL(&bucket_lock);
+        refill(now);
+        if (tokens_milli >= need) {
+            tokens_milli -= need;
+            stats.granted += messages;
+            if (waited) {
+                stats.wait_total_ms += waited_ms;
+                if (waited_ms > stats.wait_max_ms) {
+                    stats.wait_max_ms = waited_ms;
+                }
+            }
+            taskEXIT_CRITICAL(&bucket_lock);
+            return true;
+        }
+        // One token per 1000 / CLOUD_RATE_PER_SEC ms
+        uint32_t refill_ms = (need - tokens_milli + CLOUD_RATE_PER_SEC - 1) / CLOUD_RATE_PER_SEC;
+        bool give_up = timeout_ms != CLOUD_RATE_WAIT_FOREVER &&
+                       waited_ms + refill_ms > timeout_ms;
+        if (give_up) {
+            stats.denied++;
+        } else if (!waited) {
+            stats.throttled++;
+        }
+        taskEXIT_CRITICAL(&bucket_lock);
+
+        if (give_up) {
+            ESP_LOGW(TAG, "No tokens for %lu messages within %lu ms", messages, timeout_ms);
+            return false;
+        }
+        if (!waited) {
+            ESP_LOGD(TAG, "Throttled %lu ms for %lu messages", refill_ms, messages);
+        }
+        waited = true;
+        TickType_t ticks = pdMS_TO_TICKS(refill_ms);
+        vTaskDelay(ticks ? ticks : 1);
+    }
+}
+
+void cloud_rate_get_stats(cloud_rate_stats_t *out)
+{
+    taskENTER_CRITICAL(&bucket_lock);
+    refill(now_ms());
+    *out = stats;
+    out->tokens_milli = tokens_milli;
+    taskEXIT_CRITICAL(&bucket_lock);
+    out->burst = CLOUD_RATE_BURST;
+    out->per_sec = CLOUD_RATE_PER_SEC;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int cloudrate_cmd(int argc, char **argv)
+{
+    cloud_rate_stats_t s;
+    cloud_rate_get_stats(&s);
+    printf("%lu.%03lu of %lu tokens, refill %lu/s\n", s.tokens_milli / MILLI,
+           s.tokens_milli % MILLI, s.burst, s.per_sec);
+    printf("%lu messages, %lu throttled (wait avg %llu ms, max %lu ms), %lu denied\n",
+           s.granted, s.throttled, s.throttled ? s.wait_total_ms / s.throttled : 0,
+           s.wait_max_ms, s.denied);
+    return 0;
+}
+
+esp_err_t cloud_rate_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "cloudrate",
+        .help = "Cloud publish token bucket: tokens left, throttled and denied publishes",
+        .hint = NULL,
+        .func = cloudrate_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
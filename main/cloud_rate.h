@@ -0,0 +1,49 @@
+/**
+ * @file cloud_rate.h
+ * @brief Token bucket shared by everything that publishes to the cloud
+ *
+ * Every MQTT message the node sends (a parameter report, a CBOR batch, an
+ * alert status) takes one token. The bucket holds CLOUD_RATE_BURST tokens
+ * and refills at CLOUD_RATE_PER_SEC, so a burst after an outage drains at
+ * the refill rate instead of all at once, while a normal uplink burst goes
+ * out without waiting. Callers block outside the RainMaker mutex until
+ * their tokens are there or their timeout passes.
+ */
+
+#ifndef CLOUD_RATE_H
+#define CLOUD_RATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define CLOUD_RATE_WAIT_FOREVER     UINT32_MAX
+
+typedef struct {
+    uint32_t burst;             // Bucket size, messages
+    uint32_t per_sec;           // Refill rate, messages per second
+    uint32_t tokens_milli;      // Tokens now, in thousandths
+    uint32_t granted;           // Messages let through
+    uint32_t throttled;         // Acquires that had to wait
+    uint32_t denied;            // Acquires that gave up at their timeout
+    uint32_t wait_max_ms;
+    uint64_t wait_total_ms;     // Over the throttled acquires
+} cloud_rate_stats_t;
+
+/**
+ * @brief Take tokens for messages about to be published
+ *
+ * @param messages   MQTT messages the caller will send (at most the burst)
+ * @param timeout_ms Longest wait, CLOUD_RATE_WAIT_FOREVER to always succeed
+ * @return false if the tokens did not come within timeout_ms
+ */
+bool cloud_rate_acquire(uint32_t messages, uint32_t timeout_ms);
+
+void cloud_rate_get_stats(cloud_rate_stats_t *out);
+
+/**
+ * @brief Register the "cloudrate" console command (tokens, throttle counts)
+ */
+esp_err_t cloud_rate_register_console(void);
+
+#endif // CLOUD_RATE_H
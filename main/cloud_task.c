@@ -1,11 +1,33 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
 #include <freertos/event_groups.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_event.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
 #include <esp_rmaker_core.h>
+#include <esp_rmaker_common_events.h>
 #include <esp_rmaker_standard_params.h>
+#include <esp_rmaker_mqtt.h>
+#include "cloud_task.h"
+#include "app_metrics.h"
+#include "dlog.h"
+#include "evtrace.h"
+#include "boot_graph.h"
+#include "uplink_batch.h"
+#include "outbox.h"
+#include "cloud_rate.h"
+#include "backlog.h"
+#include "telemetry_cbor.h"
+#include "ts_aggregate.h"
+#include "project_config.h"
 
 static const char *TAG = "CLOUD_TASK";
 
@@ -20,14 +42,6 @@ extern esp_rmaker_device_t *aqi_sensor_device;
 #define WIFI_CONNECTED_BIT BIT0
 #define CLOUD_CONNECTED_BIT BIT1
 
-// Sensor data structure
-typedef struct {
-    float temperature;
-    float humidity;
-    int aqi;
-    uint32_t timestamp;
-} sensor_data_t;
-
 // ============================================
 // AQI STATUS STRING CONVERTER
 // ============================================
@@ -46,12 +60,18 @@ static const char* get_aqi_status_string(int aqi)
 // RAINMAKER UPDATE FUNCTION
 // ============================================
 
-static void update_rainmaker_params(sensor_data_t *data)
+static void update_rainmaker_params(const sensor_data_t *data)
 {
     esp_err_t err;
     
+    // One message per parameter report below
+    cloud_rate_acquire(CLOUD_RATE_SAMPLE_MESSAGES, CLOUD_RATE_WAIT_FOREVER);
+    
     // Take mutex to protect RainMaker API calls
-    if (xSemaphoreTake(rainmaker_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+    TRACE_BEGIN(MUTEX_WAIT);
+    BaseType_t locked = xSemaphoreTake(rainmaker_mutex, pdMS_TO_TICKS(1000));
+    TRACE_END(MUTEX_WAIT);
+    if (locked == pdTRUE) {
         
         // Update Temperature
         if (temp_sensor_device) {
@@ -62,7 +82,7 @@ static void update_rainmaker_params(sensor_data_t *data)
                 err = esp_rmaker_param_update_and_report(temp_param, 
                     esp_rmaker_float(data->temperature));
                 if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "Updated temperature: %.1f°C", data->temperature);
+                    DLOGI(TAG, "Updated temperature: %.1f°C", data->temperature);
                 } else {
                     ESP_LOGW(TAG, "Failed to update temperature: %s", 
                              esp_err_to_name(err));
@@ -79,7 +99,7 @@ static void update_rainmaker_params(sensor_data_t *data)
                 err = esp_rmaker_param_update_and_report(hum_param, 
                     esp_rmaker_float(data->humidity));
                 if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "Updated humidity: %.1f%%", data->humidity);
+                    DLOGI(TAG, "Updated humidity: %.1f%%", data->humidity);
                 } else {
                     ESP_LOGW(TAG, "Failed to update humidity: %s", 
                              esp_err_to_name(err));
@@ -95,7 +115,7 @@ static void update_rainmaker_params(sensor_data_t *data)
                 err = esp_rmaker_param_update_and_report(aqi_param, 
                     esp_rmaker_int(data->aqi));
                 if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "Updated AQI: %d", data->aqi);
+                    DLOGI(TAG, "Updated AQI: %d", data->aqi);
                 } else {
                     ESP_LOGW(TAG, "Failed to update AQI: %s", 
                              esp_err_to_name(err));
@@ -111,7 +131,7 @@ static void update_rainmaker_params(sensor_data_t *data)
                 err = esp_rmaker_param_update_and_report(aqi_status_param, 
                     esp_rmaker_str(status_str));
                 if (err == ESP_OK) {
-                    ESP_LOGI(TAG, "Updated AQI status: %s", status_str);
+                    DLOGI(TAG, "Updated AQI status: %s", status_str);
                 }
             }
         }
@@ -127,30 +147,227 @@ static void update_rainmaker_params(sensor_data_t *data)
 // CUSTOM METRICS FOR ESP INSIGHTS
 // ============================================
 
-static void send_custom_metrics(sensor_data_t *data)
+static void send_custom_metrics(const sensor_data_t *data, uint32_t publish_us)
 {
-    // Send custom metrics to ESP Insights dashboard
-    // These will appear in the Insights dashboard for analytics
+    // Counted here and flushed to Insights in batches by app_metrics
+    app_metrics_record_aqi(data->aqi);
+    app_metrics_record_publish(publish_us);
+}
+
+void cloud_publish_sample(const sensor_data_t *data)
+{
+    int64_t publish_start = esp_timer_get_time();
+    TRACE_BEGIN(PUBLISH);
+    update_rainmaker_params(data);
+    TRACE_END(PUBLISH);
+    uint32_t publish_us = (uint32_t)(esp_timer_get_time() - publish_start);
+    boot_graph_mark(BOOT_MARK_FIRST_PUBLISH);
     
-    // Example: Track how often AQI exceeds thresholds
-    static uint32_t aqi_good_count = 0;
-    static uint32_t aqi_moderate_count = 0;
-    static uint32_t aqi_unhealthy_count = 0;
+    // Send custom metrics to Insights
+    send_custom_metrics(data, publish_us);
+}
+
+esp_err_t cloud_publish_batch(const uint8_t *cbor, size_t len)
+{
+    char topic[96];
+    snprintf(topic, sizeof(topic), "node/%s/%s", esp_rmaker_get_node_id(), UPLINK_CBOR_TOPIC);
+
+    cloud_rate_acquire(1, CLOUD_RATE_WAIT_FOREVER);
+    TRACE_BEGIN(PUBLISH);
+    esp_err_t err = esp_rmaker_mqtt_publish(topic, (void *)cbor, len, UPLINK_CBOR_QOS, NULL);
+    TRACE_END(PUBLISH);
+    if (err == ESP_OK) {
+        boot_graph_mark(BOOT_MARK_FIRST_PUBLISH);
+        DLOGI(TAG, "Published %u byte CBOR batch", (unsigned)len);
+    }
+    return err;
+}
+
+#if ENABLE_TS_AGGREGATE
+// ============================================
+// TIME-SERIES POINTS
+// ============================================
+
+// The time-series params and where their value sits in a point
+static const struct {
+    esp_rmaker_device_t **device;
+    const char *name;
+    size_t offset;
+    bool integer;
+} point_params[] = {
+    { &temp_sensor_device, ESP_RMAKER_DEF_TEMPERATURE_NAME, offsetof(ts_point_t, temp_avg), false },
+    { &temp_sensor_device, "Temperature Min", offsetof(ts_point_t, temp_min), false },
+    { &temp_sensor_device, "Temperature Max", offsetof(ts_point_t, temp_max), false },
+    { &humidity_sensor_device, ESP_RMAKER_DEF_HUMIDITY_NAME, offsetof(ts_point_t, hum_avg), false },
+    { &humidity_sensor_device, "Humidity Min", offsetof(ts_point_t, hum_min), false },
+    { &humidity_sensor_device, "Humidity Max", offsetof(ts_point_t, hum_max), false },
+    { &aqi_sensor_device, "AQI", offsetof(ts_point_t, aqi_avg), true },
+    { &aqi_sensor_device, "AQI Min", offsetof(ts_point_t, aqi_min), true },
+    { &aqi_sensor_device, "AQI Max", offsetof(ts_point_t, aqi_max), true },
+};
+
+#define POINT_PARAM_COUNT   (sizeof(point_params) / sizeof(point_params[0]))
+
+static char ts_json[TS_AGGREGATE_MSG_SIZE];    // Cloud task, or the deep-sleep upload
+
+static esp_rmaker_param_val_t point_value(size_t param, const ts_point_t *point)
+{
+    const char *field = (const char *)point + point_params[param].offset;
+    return point_params[param].integer ? esp_rmaker_int(*(const int *)field)
+                                       : esp_rmaker_float(*(const float *)field);
+}
+
+// Append, or mark the message full
+static void put(size_t *len, bool *full, const char *fmt, ...)
+{
+    if (*full) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(ts_json + *len, sizeof(ts_json) - *len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= sizeof(ts_json) - *len) {
+        *full = true;
+        return;
+    }
+    *len += (size_t)n;
+}
+
+// RainMaker's time-series format: every param with all its records
+static size_t encode_points(const ts_point_t *points, uint16_t count)
+{
+    size_t len = 0;
+    bool full = false;
     
-    if (data->aqi <= 50) {
-        aqi_good_count++;
-    } else if (data->aqi <= 100) {
-        aqi_moderate_count++;
-    } else {
-        aqi_unhealthy_count++;
+    put(&len, &full, "{\"ts_data_version\":\"2021-09-13\",\"ts_data\":[");
+    for (size_t p = 0; p < POINT_PARAM_COUNT; p++) {
+        const esp_rmaker_device_t *device = *point_params[p].device;
+        put(&len, &full, "%s{\"name\":\"%s.%s\",\"dt\":\"%s\",\"ow\":false,\"records\":[",
+            p ? "," : "", device ? esp_rmaker_device_get_name(device) : "",
+            point_params[p].name, point_params[p].integer ? "int" : "float");
+        for (uint16_t i = 0; i < count; i++) {
+            esp_rmaker_param_val_t v = point_value(p, &points[i]);
+            if (v.type == RMAKER_VAL_TYPE_INTEGER) {
+                put(&len, &full, "%s{\"v\":%d,\"t\":%lu}", i ? "," : "", v.val.i,
+                    points[i].epoch);
+            } else {
+                put(&len, &full, "%s{\"v\":%.2f,\"t\":%lu}", i ? "," : "", v.val.f,
+                    points[i].epoch);
+            }
+        }
+        put(&len, &full, "]}");
     }
+    put(&len, &full, "]}");
+    return full ? 0 : len;
+}
+
+esp_err_t cloud_publish_points(const ts_point_t *points, uint16_t count)
+{
+    if (count == 0) {
+        return ESP_OK;
+    }
+    size_t len = encode_points(points, count);
+    if (len == 0) {
+        ESP_LOGE(TAG, "%u time-series points did not fit", count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    char topic[96];
+    snprintf(topic, sizeof(topic), "node/%s/%s", esp_rmaker_get_node_id(), TS_AGGREGATE_TOPIC);
     
-    // Log metrics (ESP Insights captures these)
-    ESP_LOGI(TAG, "AQI Metrics - Good:%lu Moderate:%lu Unhealthy:%lu",
-             aqi_good_count, aqi_moderate_count, aqi_unhealthy_count);
+    cloud_rate_acquire(CLOUD_RATE_POINT_MESSAGES, CLOUD_RATE_WAIT_FOREVER);
+    int64_t publish_start = esp_timer_get_time();
+    TRACE_BEGIN(PUBLISH);
+    esp_err_t err = esp_rmaker_mqtt_publish(topic, ts_json, len, UPLINK_CBOR_QOS, NULL);
+    TRACE_END(PUBLISH);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Time-series points not published: %s", esp_err_to_name(err));
+        return err;
+    }
     
-    // You can also use esp_diag_metrics_register() and esp_diag_metrics_add()
-    // for structured metrics if you've set up ESP Insights properly
+    // The app's current values from the newest point. esp_rmaker_param_update()
+    // only marks a value for the next params report, which the status report
+    // below sends, so the history is the message above and nothing else.
+    const ts_point_t *newest = &points[count - 1];
+    TRACE_BEGIN(MUTEX_WAIT);
+    BaseType_t locked = xSemaphoreTake(rainmaker_mutex, pdMS_TO_TICKS(1000));
+    TRACE_END(MUTEX_WAIT);
+    if (locked == pdTRUE) {
+        for (size_t p = 0; p < POINT_PARAM_COUNT; p++) {
+            esp_rmaker_device_t *device = *point_params[p].device;
+            esp_rmaker_param_t *param = device ?
+                esp_rmaker_device_get_param_by_name(device, point_params[p].name) : NULL;
+            if (param) {
+                esp_rmaker_param_update(param, point_value(p, newest));
+            }
+        }
+        esp_rmaker_param_t *aqi_status_param = aqi_sensor_device ?
+            esp_rmaker_device_get_param_by_name(aqi_sensor_device, "Air Quality Status") : NULL;
+        if (aqi_status_param) {
+            esp_rmaker_param_update_and_report(aqi_status_param,
+                esp_rmaker_str(get_aqi_status_string(newest->aqi_avg)));
+        }
+        xSemaphoreGive(rainmaker_mutex);
+    } else {
+        ESP_LOGW(TAG, "Failed to acquire RainMaker mutex");
+    }
+    
+    app_metrics_record_publish((uint32_t)(esp_timer_get_time() - publish_start));
+    boot_graph_mark(BOOT_MARK_FIRST_PUBLISH);
+    DLOGI(TAG, "Published %u time-series points (%u bytes) - T:%.1f H:%.1f AQI:%d", count,
+          (unsigned)len, newest->temp_avg, newest->hum_avg, newest->aqi_avg);
+    return ESP_OK;
+}
+
+static void publish_pending_points(void)
+{
+    static ts_point_t points[TS_AGGREGATE_PENDING];    // Cloud task only
+    uint16_t count = ts_aggregate_peek(points, TS_AGGREGATE_PENDING);
+    if (count > 0 && cloud_publish_points(points, count) == ESP_OK) {
+        ts_aggregate_ack(count);
+    }
+}
+#endif
+
+// ============================================
+// OUTBOX TELEMETRY
+// ============================================
+
+// The last reading taken while the cloud was down, kept across resets
+typedef struct {
+    sensor_data_t sample;
+    uint32_t epoch;             // Unix time of the reading, 0 before SNTP
+} outbox_reading_t;
+
+// The outbox holds this boot's reading, which the uplink batch also carries
+static volatile bool reading_queued = false;
+
+esp_err_t cloud_deliver_telemetry(uint8_t key, const void *payload, size_t len)
+{
+    if (len != sizeof(outbox_reading_t)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (reading_queued) {
+        return ESP_ERR_NOT_FOUND;   // Goes out with the next uplink burst
+    }
+    outbox_reading_t reading;
+    memcpy(&reading, payload, sizeof(reading));
+
+#if ENABLE_CBOR_UPLINK
+    // As a one-sample batch stamped with its own time, so an old reading
+    // does not show up as the current value
+    uint8_t cbor[TELEMETRY_CBOR_SIZE(1)];
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin(&enc, cbor, sizeof(cbor), 1, reading.sample.timestamp,
+                         reading.epoch, reading.sample.timestamp);
+    telemetry_cbor_add(&enc, &reading.sample);
+    size_t cbor_len = telemetry_cbor_end(&enc);
+    return cbor_len ? cloud_publish_batch(cbor, cbor_len) : ESP_ERR_INVALID_SIZE;
+#else
+    cloud_publish_sample(&reading.sample);
+    return ESP_OK;
+#endif
 }
 
 // ============================================
@@ -176,6 +393,37 @@ static bool check_cloud_connection(void)
     return true;
 }
 
+static TaskHandle_t cloud_task_handle = NULL;
+
+void cloud_task_notify(void)
+{
+    if (cloud_task_handle) {
+        xTaskNotifyGive(cloud_task_handle);
+    }
+}
+
+// Until the batch window closes, or sooner to retry an outbox entry
+static TickType_t wait_ticks(void)
+{
+    TickType_t wait = uplink_batch_wait_ticks();
+#if ENABLE_OUTBOX
+    if (wait > pdMS_TO_TICKS(OUTBOX_RETRY_MS) && outbox_pending() > 0 &&
+        cloud_task_wait_connected(0)) {
+        wait = pdMS_TO_TICKS(OUTBOX_RETRY_MS);
+    }
+#endif
+    return wait;
+}
+
+bool cloud_task_wait_connected(uint32_t timeout_ms)
+{
+    EventBits_t bits = xEventGroupWaitBits(system_events,
+                                           WIFI_CONNECTED_BIT | CLOUD_CONNECTED_BIT,
+                                           pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & (WIFI_CONNECTED_BIT | CLOUD_CONNECTED_BIT)) ==
+           (WIFI_CONNECTED_BIT | CLOUD_CONNECTED_BIT);
+}
+
 // ============================================
 // MAIN CLOUD TASK
 // ============================================
@@ -187,35 +435,93 @@ void cloud_task(void *pvParameters)
     sensor_data_t sensor_data;
     uint32_t update_count = 0;
     
-    // Wait a bit for system initialization
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    cloud_task_handle = xTaskGetCurrentTaskHandle();
+    xTaskNotifyGive(cloud_task_handle);     // Samples queued before the handle was set
+    
+    // Samples wait in the queue until the first connection, so the first
+    // publish goes out as soon as the cloud is reachable
+    if (!cloud_task_wait_connected(CLOUD_CONNECT_WAIT_MS)) {
+        ESP_LOGW(TAG, "Cloud not connected after %d ms", CLOUD_CONNECT_WAIT_MS);
+    }
+    
+    uplink_batch_init();
+    
+    const uplink_publish_t publish = {
+#if ENABLE_TS_AGGREGATE
+        .sample = NULL,             // Every sample in CBOR, the params get points
+#else
+        .sample = cloud_publish_sample,
+#endif
+#if ENABLE_CBOR_UPLINK
+        .batch = cloud_publish_batch,
+#endif
+    };
     
     while (1) {
-        // Wait for sensor data from queue (blocking wait)
-        if (xQueueReceive(sensor_data_queue, &sensor_data, portMAX_DELAY) == pdTRUE) {
+        // Wait for sensor data or an outbox entry, or until the pending
+        // batch's window closes
+        ulTaskNotifyTake(pdTRUE, wait_ticks());
+        while (xQueueReceive(sensor_data_queue, &sensor_data, 0) == pdTRUE) {
             
-            ESP_LOGI(TAG, "Received sensor data - T:%.1f H:%.1f AQI:%d", 
-                     sensor_data.temperature, sensor_data.humidity, sensor_data.aqi);
+            DLOGI(TAG, "Received sensor data - T:%.1f H:%.1f AQI:%d", 
+                  sensor_data.temperature, sensor_data.humidity, sensor_data.aqi);
+            sensor_data_t evicted;
+            if (uplink_batch_add(&sensor_data, &evicted)) {
+#if ENABLE_BACKLOG
+                // Replayed from flash once the cloud is back
+                backlog_append(&evicted);
+#endif
+            }
+#if ENABLE_TS_AGGREGATE
+            ts_aggregate_add(&sensor_data);
+#endif
+        }
+        
+#if ENABLE_OUTBOX
+        // The alert step only queues: its entries are saved and sent here
+        outbox_flush();
+#endif
+        
+        if (!uplink_batch_due()) {
+            continue;
+        }
+        
+        // Check connection status
+        if (check_cloud_connection()) {
             
-            // Check connection status
-            if (check_cloud_connection()) {
-                
-                // Update RainMaker parameters
-                update_rainmaker_params(&sensor_data);
-                
-                // Send custom metrics to Insights
-                send_custom_metrics(&sensor_data);
-                
-                update_count++;
-                ESP_LOGI(TAG, "Cloud update #%lu successful", update_count);
-                
-            } else {
-                ESP_LOGW(TAG, "Cloud not connected, data not sent");
-                // Could implement local storage/buffering here
+#if ENABLE_OUTBOX
+            // The batch below carries this boot's reading; alerts, state
+            // changes and readings from before a reset went out above
+            if (reading_queued) {
+                outbox_cancel(OUTBOX_TELEMETRY, 0);
+                reading_queued = false;
             }
+#endif
+            
+            // Update RainMaker parameters and Insights metrics, one burst
+            uint32_t sent = uplink_batch_flush(&publish);
+#if ENABLE_TS_AGGREGATE
+            // In the burst's radio tail; the points carry their own times,
+            // so those closed during an outage go up together
+            if (ts_aggregate_pending() > 0) {
+                publish_pending_points();
+            }
+#endif
+            
+            update_count += sent;
+            DLOGI(TAG, "Cloud update #%lu successful (%lu samples)", update_count, sent);
             
-            // Small delay to avoid flooding the cloud
-            vTaskDelay(pdMS_TO_TICKS(500));
+        } else {
+            ESP_LOGW(TAG, "Cloud not connected, samples held for the next try");
+            uplink_batch_postpone();
+#if ENABLE_OUTBOX
+            // Survives a reset before the cloud comes back
+            const outbox_reading_t reading = {
+                .sample = sensor_data,
+                .epoch = telemetry_cbor_epoch(),
+            };
+            reading_queued = outbox_put(OUTBOX_TELEMETRY, 0, &reading, sizeof(reading)) == ESP_OK;
+#endif
         }
     }
 }
@@ -241,6 +547,7 @@ void cloud_task_wifi_disconnected(void)
 void cloud_task_cloud_connected(void)
 {
     xEventGroupSetBits(system_events, CLOUD_CONNECTED_BIT);
+    boot_graph_mark(BOOT_MARK_CLOUD_CONNECTED);
     ESP_LOGI(TAG, "RainMaker cloud connected");
 }
 
@@ -249,3 +556,40 @@ void cloud_task_cloud_disconnected(void)
     xEventGroupClearBits(system_events, CLOUD_CONNECTED_BIT);
     ESP_LOGW(TAG, "RainMaker cloud disconnected");
 }
+
+static void connection_event_handler(void *arg, esp_event_base_t event_base,
+                                     int32_t event_id, void *event_data)
+{
+    if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        cloud_task_wifi_connected();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        // Failed retries also end here; only a lost connection is news
+        if (xEventGroupGetBits(system_events) & WIFI_CONNECTED_BIT) {
+            cloud_task_wifi_disconnected();
+        }
+    } else if (event_base == RMAKER_COMMON_EVENT) {
+        if (event_id == RMAKER_MQTT_EVENT_CONNECTED) {
+            cloud_task_cloud_connected();
+        } else if (event_id == RMAKER_MQTT_EVENT_DISCONNECTED) {
+            cloud_task_cloud_disconnected();
+        }
+    }
+}
+
+esp_err_t cloud_task_register_events(void)
+{
+    esp_err_t err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                               &connection_event_handler, NULL);
+    if (err == ESP_OK) {
+        err = esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                         &connection_event_handler, NULL);
+    }
+    if (err == ESP_OK) {
+        err = esp_event_handler_register(RMAKER_COMMON_EVENT, ESP_EVENT_ANY_ID,
+                                         &connection_event_handler, NULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Connection events not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
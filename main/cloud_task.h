@@ -6,6 +6,12 @@
 #ifndef CLOUD_TASK_H
 #define CLOUD_TASK_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+#include "ts_aggregate.h"
+
 /**
  * @brief Main cloud communication task
  * 
@@ -15,6 +21,62 @@
  */
 void cloud_task(void *pvParameters);
 
+/**
+ * @brief Publish one sample to RainMaker and record its latency
+ * 
+ * Called by the cloud task once connected; exposed for the host replay.
+ * 
+ * @param data Sensor sample to publish
+ */
+void cloud_publish_sample(const sensor_data_t *data);
+
+/**
+ * @brief Publish a CBOR sample batch (telemetry_cbor.h) as one MQTT message
+ * 
+ * Goes to node/<node_id>/UPLINK_CBOR_TOPIC; used by the uplink batch with
+ * ENABLE_CBOR_UPLINK and by the flash backlog replay.
+ * 
+ * @return ESP_OK once queued by the MQTT client
+ */
+esp_err_t cloud_publish_batch(const uint8_t *cbor, size_t len);
+
+/**
+ * @brief Publish min/avg/max points to the time-series params
+ * 
+ * One message on node/<node_id>/TS_AGGREGATE_TOPIC holds every point, each
+ * with its own time, for the averages in Temperature, Humidity and AQI and
+ * the extremes in their "Min" and "Max" params. The newest point then
+ * becomes the params' current value in one params report. With
+ * ENABLE_TS_AGGREGATE only.
+ * 
+ * @param points Oldest first, each with a non-zero epoch
+ * @return ESP_OK once the time-series message is queued by the MQTT client
+ */
+esp_err_t cloud_publish_points(const ts_point_t *points, uint16_t count);
+
+/**
+ * @brief Outbox handler for OUTBOX_TELEMETRY: publish a reading queued offline
+ * 
+ * With ENABLE_CBOR_UPLINK the reading goes up as a one-sample batch with
+ * its own timestamp, otherwise as parameter reports.
+ */
+esp_err_t cloud_deliver_telemetry(uint8_t key, const void *payload, size_t len);
+
+/**
+ * @brief Wait until both Wi-Fi and the RainMaker cloud are connected
+ * 
+ * @param timeout_ms Longest wait
+ * @return false on timeout
+ */
+bool cloud_task_wait_connected(uint32_t timeout_ms);
+
+/**
+ * @brief Wake the cloud task: a sample or an outbox entry is waiting
+ *
+ * Never blocks; does nothing before the cloud task starts.
+ */
+void cloud_task_notify(void);
+
 /**
  * @brief Event handlers for Wi-Fi and cloud connection status
  */
@@ -23,4 +85,11 @@ void cloud_task_wifi_disconnected(void);
 void cloud_task_cloud_connected(void);
 void cloud_task_cloud_disconnected(void);
 
+/**
+ * @brief Drive the handlers above from the Wi-Fi, IP and RainMaker events
+ * 
+ * Call after app_wifi_init() has created the default event loop.
+ */
+esp_err_t cloud_task_register_events(void);
+
 #endif // CLOUD_TASK_H
@@ -0,0 +1,215 @@
+/**
+ * @file coop_sched.c
+ * @brief Cooperative timer-wheel scheduler implementation
+ *
+ * Hashed timer wheel with one slot per RTOS tick. A job due in `delta` ticks
+ * goes into slot (due % COOP_WHEEL_SLOTS) with delta / COOP_WHEEL_SLOTS
+ * full turns to wait, so insertion is O(1) whatever the period. Between
+ * jobs the task blocks until the nearest due tick. Jobs are only added by
+ * steps on this task or before it starts, so no one has to wake it early.
+ */
+
+#include "coop_sched.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+
+static const char *TAG = "COOP_SCHED";
+
+#define COOP_WHEEL_SLOTS    64      // Power of two
+#define COOP_WHEEL_MASK     (COOP_WHEEL_SLOTS - 1)
+
+static coop_job_t *wheel[COOP_WHEEL_SLOTS];
+static TickType_t cursor;           // Next tick whose slot has not been processed
+static bool cursor_valid = false;
+
+// Every job ever added, for statistics
+#define COOP_MAX_JOBS 8
+static coop_job_t *jobs[COOP_MAX_JOBS];
+static int job_count = 0;
+
+static TaskHandle_t sched_task_handle = NULL;
+
+// ============================================
+// WHEEL
+// ============================================
+
+static void wheel_insert(coop_job_t *job)
+{
+    // A job already overdue goes into the next slot to be processed
+    TickType_t tick = job->due;
+    if ((int32_t)(tick - cursor) < 0) {
+        tick = cursor;
+    }
+
+    job->rounds = (tick - cursor) / COOP_WHEEL_SLOTS;
+    job->next = wheel[tick & COOP_WHEEL_MASK];
+    wheel[tick & COOP_WHEEL_MASK] = job;
+}
+
+// Ticks from cursor to the nearest due job, or portMAX_DELAY if none
+static TickType_t ticks_to_next_job(void)
+{
+    TickType_t best = portMAX_DELAY;
+
+    for (TickType_t i = 0; i < COOP_WHEEL_SLOTS; i++) {
+        for (coop_job_t *job = wheel[(cursor + i) & COOP_WHEEL_MASK]; job; job = job->next) {
+            TickType_t ticks = i + job->rounds * COOP_WHEEL_SLOTS;
+            if (ticks < best) {
+                best = ticks;
+            }
+        }
+    }
+    return best;
+}
+
+static void run_job(coop_job_t *job)
+{
+    job->scheduled = false;
+
+    uint32_t late_ms = (uint32_t)((xTaskGetTickCount() - job->due) * portTICK_PERIOD_MS);
+    job->runs++;
+    job->late_sum_ms += late_ms;
+    if (late_ms > job->late_max_ms) {
+        job->late_max_ms = late_ms;
+    }
+
+    int64_t start = esp_timer_get_time();
+    uint32_t delay_ms = job->step(job->ctx);
+    uint32_t step_us = (uint32_t)(esp_timer_get_time() - start);
+    if (step_us > job->step_max_us) {
+        job->step_max_us = step_us;
+    }
+
+    // The step may have rescheduled itself through coop_sched_add()
+    if (delay_ms != COOP_SCHED_STOP && !job->scheduled) {
+        job->due += pdMS_TO_TICKS(delay_ms);
+        job->scheduled = true;
+        wheel_insert(job);
+    }
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+esp_err_t coop_sched_add(coop_job_t *job, uint32_t delay_ms)
+{
+    if (job == NULL || job->step == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (job->scheduled) {
+        return ESP_OK;
+    }
+
+    bool known = false;
+    for (int i = 0; i < job_count; i++) {
+        known |= (jobs[i] == job);
+    }
+    if (!known) {
+        if (job_count == COOP_MAX_JOBS) {
+            ESP_LOGE(TAG, "Too many jobs, '%s' not added", job->name);
+            return ESP_ERR_NO_MEM;
+        }
+        jobs[job_count++] = job;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    if (!cursor_valid) {
+        cursor = now;
+        cursor_valid = true;
+    }
+
+    job->due = now + pdMS_TO_TICKS(delay_ms);
+    job->scheduled = true;
+    wheel_insert(job);
+    return ESP_OK;
+}
+
+void coop_sched_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Cooperative scheduler started with %d jobs", job_count);
+    sched_task_handle = xTaskGetCurrentTaskHandle();
+
+    if (!cursor_valid) {
+        cursor = xTaskGetTickCount();
+        cursor_valid = true;
+    }
+
+    while (1) {
+        // Process every slot up to the current tick
+        TickType_t now = xTaskGetTickCount();
+        while ((int32_t)(now - cursor) >= 0) {
+            uint32_t slot = cursor & COOP_WHEEL_MASK;
+            coop_job_t *list = wheel[slot];
+            wheel[slot] = NULL;
+            cursor++;
+
+            while (list) {
+                coop_job_t *job = list;
+                list = job->next;
+                if (job->rounds > 0) {
+                    job->rounds--;
+                    job->next = wheel[slot];
+                    wheel[slot] = job;
+                } else {
+                    run_job(job);
+                }
+            }
+        }
+
+        // Sleep until the nearest job. Nothing notifies this task: new jobs
+        // come from the steps just run, already counted in next
+        TickType_t next = ticks_to_next_job();
+        if (next != portMAX_DELAY) {
+            int32_t wait = (int32_t)(cursor + next - xTaskGetTickCount());
+            next = wait > 0 ? (TickType_t)wait : 0;
+        }
+        ulTaskNotifyTake(pdTRUE, next);
+    }
+}
+
+// ============================================
+// STATISTICS
+// ============================================
+
+void coop_sched_print_stats(void)
+{
+    printf("%-10s %8s %12s %12s %12s\n", "job", "runs", "late avg ms", "late max ms",
+           "step max us");
+    for (int i = 0; i < job_count; i++) {
+        const coop_job_t *job = jobs[i];
+        printf("%-10s %8lu %12lu %12lu %12lu\n", job->name, (unsigned long)job->runs,
+               (unsigned long)(job->runs ? job->late_sum_ms / job->runs : 0),
+               (unsigned long)job->late_max_ms, (unsigned long)job->step_max_us);
+    }
+    if (sched_task_handle) {
+        printf("stack: %lu of %d bytes never used\n",
+               (unsigned long)uxTaskGetStackHighWaterMark(sched_task_handle),
+               COOP_SCHED_STACK_SIZE);
+    }
+}
+
+static int sched_cmd(int argc, char **argv)
+{
+    coop_sched_print_stats();
+    return 0;
+}
+
+esp_err_t coop_sched_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "sched",
+        .help = "Cooperative scheduler job statistics",
+        .hint = NULL,
+        .func = sched_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file coop_sched.h
+ * @brief Cooperative timer-wheel scheduler (ENABLE_COOP_SCHEDULER)
+ *
+ * Runs the periodic application work as short, non-blocking steps on a
+ * single task instead of one FreeRTOS task (and 4 KB stack) per activity.
+ * A step does one slice of work and returns how long until it wants to run
+ * again, measured from when it was due, so a job returning a fixed period
+ * does not drift. Returning COOP_SCHED_STOP removes the job.
+ */
+
+#ifndef COOP_SCHED_H
+#define COOP_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @brief Step return value that unschedules the job
+ */
+#define COOP_SCHED_STOP UINT32_MAX
+
+typedef uint32_t (*coop_step_fn_t)(void *ctx);
+
+/**
+ * @brief A schedulable job; allocate statically and leave the rest zeroed
+ */
+typedef struct coop_job {
+    const char *name;
+    coop_step_fn_t step;
+    void *ctx;
+
+    // Scheduler bookkeeping
+    struct coop_job *next;
+    TickType_t due;
+    uint32_t rounds;
+    bool scheduled;
+
+    // Statistics
+    uint32_t runs;
+    uint32_t late_max_ms;       // Largest start delay past the due tick
+    uint64_t late_sum_ms;
+    uint32_t step_max_us;       // Longest single step
+} coop_job_t;
+
+/**
+ * @brief Schedule a job to run first after delay_ms
+ *
+ * May be called from any job step or, before the scheduler task starts,
+ * from app_main. Does nothing if the job is already scheduled.
+ */
+esp_err_t coop_sched_add(coop_job_t *job, uint32_t delay_ms);
+
+/**
+ * @brief Scheduler task: runs due jobs, sleeps until the next one
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void coop_sched_task(void *pvParameters);
+
+/**
+ * @brief Print per-job run count, lateness and step time
+ */
+void coop_sched_print_stats(void);
+
+/**
+ * @brief Register the "sched" console command
+ */
+esp_err_t coop_sched_register_console(void);
+
+#endif // COOP_SCHED_H
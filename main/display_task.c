@@ -11,9 +11,14 @@
 #include <freertos/queue.h>
 #include <freertos/event_groups.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <string.h>
 #include <stdio.h>
 #include "ssd1306.h"
+#include "app_metrics.h"
+#include "evtrace.h"
+#include "sample_interval.h"
+#include "warm_cache.h"
 
 static const char *TAG = "DISPLAY_TASK";
 
@@ -28,6 +33,14 @@ extern EventGroupHandle_t system_events;
 static ssd1306_handle_t display_handle = NULL;
 static bool display_initialized = false;
 
+// Push the frame buffer over I2C, accounting the bus time to Insights
+static void display_refresh(void)
+{
+    int64_t start = esp_timer_get_time();
+    ssd1306_refresh_gram(display_handle);
+    app_metrics_record_i2c((uint32_t)(esp_timer_get_time() - start));
+}
+
 void display_init(void)
 {
     ESP_LOGI(TAG, "Initializing OLED display...");
@@ -48,14 +61,25 @@ void display_init(void)
     
     // Clear display
     ssd1306_clear_screen(display_handle, 0x00);
-    ssd1306_refresh_gram(display_handle);
+    display_refresh();
+    
+    display_initialized = true;
+    
+#if ENABLE_WARM_START
+    // Last reading from before the reset, until the first new sample
+    sensor_data_t cached;
+    if (warm_cache_restored_sample(&cached)) {
+        display_sensor_data(&cached);
+        ESP_LOGI(TAG, "OLED display initialized, showing cached sample");
+        return;
+    }
+#endif
     
     // Display startup message
     ssd1306_draw_string(display_handle, 0, 0, (const uint8_t *)"Smart Env Logger", 16, 1);
     ssd1306_draw_string(display_handle, 0, 16, (const uint8_t *)"Initializing...", 16, 1);
-    ssd1306_refresh_gram(display_handle);
+    display_refresh();
     
-    display_initialized = true;
     ESP_LOGI(TAG, "OLED display initialized successfully");
 }
 
@@ -69,13 +93,21 @@ static const char* get_aqi_status_str(int aqi)
     else return "Hazardous";
 }
 
-static void display_sensor_data(sensor_data_t *data)
+void display_format_sample(const sensor_data_t *data, display_lines_t *lines)
+{
+    snprintf(lines->temperature, sizeof(lines->temperature), "Temp: %.1f C", data->temperature);
+    snprintf(lines->humidity, sizeof(lines->humidity), "Humid: %.1f%%", data->humidity);
+    snprintf(lines->aqi, sizeof(lines->aqi), "AQI: %d", data->aqi);
+}
+
+void display_sensor_data(const sensor_data_t *data)
 {
     if (!display_initialized || display_handle == NULL) {
         return;
     }
     
-    char line_buf[32];
+    display_lines_t lines;
+    display_format_sample(data, &lines);
     
     // Clear display
     ssd1306_clear_screen(display_handle, 0x00);
@@ -83,8 +115,8 @@ static void display_sensor_data(sensor_data_t *data)
     // Line 0: Title
     ssd1306_draw_string(display_handle, 0, 0, (const uint8_t *)"Env. Monitor", 12, 1);
     
-    // Check connection status
-    EventBits_t bits = xEventGroupGetBits(system_events);
+    // Check connection status (no event group yet when drawn from display_init)
+    EventBits_t bits = system_events ? xEventGroupGetBits(system_events) : 0;
     bool wifi_connected = (bits & WIFI_CONNECTED_BIT) != 0;
     bool cloud_connected = (bits & CLOUD_CONNECTED_BIT) != 0;
     
@@ -95,23 +127,20 @@ static void display_sensor_data(sensor_data_t *data)
     }
     
     // Line 1: Temperature
-    snprintf(line_buf, sizeof(line_buf), "Temp: %.1f C", data->temperature);
-    ssd1306_draw_string(display_handle, 0, 16, (const uint8_t *)line_buf, 16, 1);
+    ssd1306_draw_string(display_handle, 0, 16, (const uint8_t *)lines.temperature, 16, 1);
     
     // Line 2: Humidity
-    snprintf(line_buf, sizeof(line_buf), "Humid: %.1f%%", data->humidity);
-    ssd1306_draw_string(display_handle, 0, 32, (const uint8_t *)line_buf, 16, 1);
+    ssd1306_draw_string(display_handle, 0, 32, (const uint8_t *)lines.humidity, 16, 1);
     
     // Line 3: AQI with status
-    snprintf(line_buf, sizeof(line_buf), "AQI: %d", data->aqi);
-    ssd1306_draw_string(display_handle, 0, 48, (const uint8_t *)line_buf, 16, 1);
+    ssd1306_draw_string(display_handle, 0, 48, (const uint8_t *)lines.aqi, 16, 1);
     
     // Line 4: AQI Status
     const char *aqi_status = get_aqi_status_str(data->aqi);
     ssd1306_draw_string(display_handle, 60, 48, (const uint8_t *)aqi_status, 16, 1);
     
     // Refresh display
-    ssd1306_refresh_gram(display_handle);
+    display_refresh();
 }
 
 static void display_error_message(const char *message)
@@ -123,59 +152,89 @@ static void display_error_message(const char *message)
     ssd1306_clear_screen(display_handle, 0x00);
     ssd1306_draw_string(display_handle, 0, 0, (const uint8_t *)"ERROR:", 16, 1);
     ssd1306_draw_string(display_handle, 0, 16, (const uint8_t *)message, 16, 1);
-    ssd1306_refresh_gram(display_handle);
+    display_refresh();
 }
 
-void display_task(void *pvParameters)
+bool display_task_begin(void)
 {
-    ESP_LOGI(TAG, "Display task started");
-    
-    sensor_data_t sensor_data;
-    TickType_t last_wake_time = xTaskGetTickCount();
-    const TickType_t update_interval = pdMS_TO_TICKS(DISPLAY_UPDATE_INTERVAL_MS);
-    
     // Wait for display initialization
     if (!display_initialized) {
         ESP_LOGW(TAG, "Display not initialized, attempting init...");
         display_init();
         
         if (!display_initialized) {
-            ESP_LOGE(TAG, "Display initialization failed, task will exit");
-            vTaskDelete(NULL);
-            return;
+            ESP_LOGE(TAG, "Display initialization failed");
+            return false;
         }
     }
     
+#if ENABLE_WARM_START
+    // Keep the cached sample on screen instead
+    sensor_data_t cached;
+    if (warm_cache_restored_sample(&cached)) {
+        return true;
+    }
+#endif
+    
     // Display "Waiting for data..." message
     ssd1306_clear_screen(display_handle, 0x00);
     ssd1306_draw_string(display_handle, 0, 0, (const uint8_t *)"Waiting for", 16, 1);
     ssd1306_draw_string(display_handle, 0, 16, (const uint8_t *)"sensor data...", 16, 1);
-    ssd1306_refresh_gram(display_handle);
+    display_refresh();
     
-    uint32_t no_data_count = 0;
-    
-    while (1) {
-        // Peek at sensor data queue (non-destructive read)
-        if (xQueuePeek(sensor_data_queue, &sensor_data, pdMS_TO_TICKS(100)) == pdTRUE) {
-            // Valid data received
-            display_sensor_data(&sensor_data);
-            no_data_count = 0;
-            
+    return true;
+}
+
+uint32_t display_task_step(const sensor_data_t *data)
+{
+    static TickType_t last_data_tick = 0;
+    static bool error_shown = false;
+    TickType_t now = xTaskGetTickCount();
+    
+    if (data != NULL) {
+        // New sample
+        TRACE_BEGIN(DISPLAY_UPDATE);
+        display_sensor_data(data);
+        TRACE_END(DISPLAY_UPDATE);
+        last_data_tick = now;
+        error_shown = false;
+        
 #if ENABLE_DISPLAY_DEBUG
-            ESP_LOGD(TAG, "Display updated: T=%.1f H=%.1f AQI=%d", 
-                     sensor_data.temperature, sensor_data.humidity, sensor_data.aqi);
+        ESP_LOGD(TAG, "Display updated: T=%.1f H=%.1f AQI=%d", 
+                 data->temperature, data->humidity, data->aqi);
 #endif
-        } else {
-            // No data available
-            no_data_count++;
-            
-            if (no_data_count > 5) {  // After 10 seconds of no data
-                ESP_LOGW(TAG, "No sensor data received for extended period");
-                display_error_message("No sensor data");
-            }
-        }
-        
-        // Update at fixed interval
-        vTaskDelayUntil(&last_wake_time, update_interval);
+    } else if (!error_shown &&
+               (now - last_data_tick) * portTICK_PERIOD_MS > 2 * sensor_get_interval_ms()) {
+        // The last sample stays on screen until one is two intervals overdue
+        ESP_LOGW(TAG, "No sensor data received for extended period");
+        display_error_message("No sensor data");
+        error_shown = true;
+    }
+    
+    // Refresh period follows the sample interval
+    sample_timing_t timing;
+    sample_interval_get_timing(&timing);
+    return timing.display_ms;
+}
+
+void display_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Display task started");
+    
+    sensor_data_t sensor_data;
+    uint32_t seen_ms = 0;
+    TickType_t last_wake_time = xTaskGetTickCount();
+    
+    if (!display_task_begin()) {
+        ESP_LOGE(TAG, "Display task will exit");
+        vTaskDelete(NULL);
+        return;
+    }
+    
+    while (1) {
+        // The queue belongs to the cloud task; redraw only for a new sample
+        bool have_data = sensor_get_new(&seen_ms, &sensor_data);
+        uint32_t next_ms = display_task_step(have_data ? &sensor_data : NULL);
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(next_ms));
     }
 }
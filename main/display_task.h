@@ -6,11 +6,56 @@
 #ifndef DISPLAY_TASK_H
 #define DISPLAY_TASK_H
 
+#include <stdbool.h>
+#include "sensor_task.h"
+
+/**
+ * @brief Text of the per-sample display lines
+ */
+typedef struct {
+    char temperature[32];
+    char humidity[32];
+    char aqi[32];
+} display_lines_t;
+
 /**
  * @brief Initialize OLED display hardware
  */
 void display_init(void);
 
+/**
+ * @brief Render one sample (T, H, AQI, connection state) and push it to the OLED
+ * 
+ * @param data Sensor sample to show
+ */
+void display_sensor_data(const sensor_data_t *data);
+
+/**
+ * @brief Format the temperature, humidity and AQI lines for one sample
+ * 
+ * @param data Sensor sample to format
+ * @param[out] lines Formatted text
+ */
+void display_format_sample(const sensor_data_t *data, display_lines_t *lines);
+
+/**
+ * @brief Make sure the display is up and show the "waiting" screen
+ * 
+ * @return false if the display cannot be used
+ */
+bool display_task_begin(void);
+
+/**
+ * @brief One display refresh; the body of the display task loop
+ * 
+ * Draws a new sample. Without one the screen stays as it is until no
+ * sample has arrived for two sensor intervals, then shows an error screen.
+ * 
+ * @param data New sensor sample, or NULL if there is none since the last call
+ * @return Milliseconds from this update's due time to the next
+ */
+uint32_t display_task_step(const sensor_data_t *data);
+
 /**
  * @brief Main display task function
  * 
@@ -0,0 +1,348 @@
+/**
+ * @file http_dash.c
+ * @brief Local HTTP dashboard: live view, history export, Server-Sent Events
+ *
+ * Everything here runs on the server task, one request at a time, so the
+ * handlers share one static chunk buffer and the event-stream table needs
+ * no lock. sensor_task only reads sse_count and queues work. Sockets kept
+ * for event streams are released in close_fn, which the server calls for
+ * every session it closes (client gone, failed send or LRU purge).
+ */
+
+#include "http_dash.h"
+#include "local_api.h"
+#include "prom_metrics.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <esp_log.h>
+#include <esp_http_server.h>
+
+static const char *TAG = "HTTP_DASH";
+
+#define SNAPSHOT_RECORDS        32          // Records copied out of the ring at a time
+#define ROW_MAX                 96          // Longest CSV row or JSON object
+#define EVENT_MAX               (ROW_MAX + 40)  // With the id/event/data framing
+
+typedef enum {
+    FORMAT_CSV,
+    FORMAT_JSON,
+} export_format_t;
+
+typedef struct {
+    int fd;                     // -1: free
+    uint32_t next_seq;          // Next sample to send
+} sse_client_t;
+
+static httpd_handle_t server = NULL;
+static char chunk[HTTP_DASH_CHUNK_SIZE];
+static sse_client_t sse[HTTP_DASH_SSE_CLIENTS];
+static volatile int sse_count = 0;
+static volatile bool work_queued = false;
+static http_dash_stats_t stats;
+
+static const char index_html[] =
+    "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+    "<meta name=\"viewport\" content=\"width=device-width\">"
+    "<title>" RMAKER_NODE_NAME "</title><style>"
+    "body{font:15px sans-serif;margin:1em}td{padding:2px 12px}"
+    "canvas{width:100%;max-width:640px;height:160px;border:1px solid #ccc}"
+    "</style></head><body><h3>" RMAKER_NODE_NAME "</h3><table>"
+    "<tr><td>Temperature</td><td id=temp>-</td></tr>"
+    "<tr><td>Humidity</td><td id=hum>-</td></tr>"
+    "<tr><td>Air quality</td><td id=aqi>-</td></tr>"
+    "<tr><td>Light</td><td id=lux>-</td></tr></table>"
+    "<canvas id=c width=640 height=160></canvas>"
+    "<p><a href=\"/history.csv\">history.csv</a> <a href=\"/history.json\">history.json</a></p>"
+    "<script>"
+    "var pts=[],last=-1,g=document.getElementById('c').getContext('2d'),"
+    "u={temp:' \\u00b0C',hum:' %',aqi:'',lux:' lx'};"
+    "function draw(){g.clearRect(0,0,640,160);if(pts.length<2)return;"
+    "var lo=Math.min.apply(0,pts)-.5,hi=Math.max.apply(0,pts)+.5;g.beginPath();"
+    "pts.forEach(function(v,i){var x=i*640/(pts.length-1),y=160-(v-lo)*160/(hi-lo);"
+    "i?g.lineTo(x,y):g.moveTo(x,y)});g.stroke()}"
+    "function add(s,live){if(s.seq<=last){if(!live||s.seq==last)return;pts=[]}"
+    "last=s.seq;pts.push(s.temp);"
+    "if(pts.length>360)pts.shift();"
+    "for(var k in u)document.getElementById(k).textContent=s[k]+u[k]}"
+    "fetch('/history.json?last=360').then(function(r){return r.json()})"
+    ".then(function(a){a.forEach(add);draw()});"
+    "new EventSource('/events').addEventListener('sample',"
+    "function(e){add(JSON.parse(e.data),1);draw()});"
+    "</script></body></html>";
+
+// ============================================
+// FORMATTING
+// ============================================
+
+static int put_csv(char *p, size_t room, uint32_t seq, const local_api_record_t *r)
+{
+    int t = r->temp_dc < 0 ? -r->temp_dc : r->temp_dc;
+    return snprintf(p, room, "%lu,%lu,%s%d.%d,%u.%u,%u,%u\n",
+                    (unsigned long)seq, (unsigned long)r->time_ms,
+                    r->temp_dc < 0 ? "-" : "", t / 10, t % 10,
+                    r->hum_dc / 10, r->hum_dc % 10, r->aqi, r->light_lux);
+}
+
+static int put_json(char *p, size_t room, uint32_t seq, const local_api_record_t *r)
+{
+    int t = r->temp_dc < 0 ? -r->temp_dc : r->temp_dc;
+    return snprintf(p, room,
+                    "{\"seq\":%lu,\"t\":%lu,\"temp\":%s%d.%d,\"hum\":%u.%u,\"aqi\":%u,\"lux\":%u}",
+                    (unsigned long)seq, (unsigned long)r->time_ms,
+                    r->temp_dc < 0 ? "-" : "", t / 10, t % 10,
+                    r->hum_dc / 10, r->hum_dc % 10, r->aqi, r->light_lux);
+}
+
+// ============================================
+// HISTORY EXPORT
+// ============================================
+
+static uint32_t query_start(httpd_req_t *req, uint32_t end)
+{
+    char query[48], val[12];
+    uint32_t start = 0;         // local_api_read() skips to the oldest held
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return start;
+    }
+    if (httpd_query_key_value(query, "since", val, sizeof(val)) == ESP_OK) {
+        start = strtoul(val, NULL, 10);
+    } else if (httpd_query_key_value(query, "last", val, sizeof(val)) == ESP_OK) {
+        uint32_t last = strtoul(val, NULL, 10);
+        start = last < end ? end - last : 0;
+    }
+    return start;
+}
+
+static esp_err_t history_handler(httpd_req_t *req)
+{
+    const export_format_t format = (export_format_t)(uintptr_t)req->user_ctx;
+    // Samples taken during the export are left for the next one
+    const uint32_t end = local_api_next_seq();
+    uint32_t seq = query_start(req, end);
+
+    httpd_resp_set_type(req, format == FORMAT_JSON ? "application/json" : "text/csv");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    size_t len = (size_t)snprintf(chunk, sizeof(chunk), "%s",
+                                  format == FORMAT_JSON ? "[" : "seq,time_ms,temp_c,hum_pct,aqi,lux\n");
+    uint32_t rows = 0, bytes = 0, chunks = 0;
+    local_api_record_t recs[SNAPSHOT_RECORDS];
+    uint16_t n;
+
+    while (seq < end && (n = local_api_read(&seq, SNAPSHOT_RECORDS, recs)) > 0) {
+        for (uint16_t i = 0; i < n && seq + i < end; i++) {
+            if (sizeof(chunk) - len < ROW_MAX) {
+                if (httpd_resp_send_chunk(req, chunk, len) != ESP_OK) {
+                    return ESP_FAIL;    // Client gone; the server closes the socket
+                }
+                bytes += len;
+                chunks++;
+                len = 0;
+            }
+            if (format == FORMAT_JSON) {
+                if (rows > 0) {
+                    chunk[len++] = ',';
+                }
+                len += put_json(chunk + len, sizeof(chunk) - len, seq + i, &recs[i]);
+            } else {
+                len += put_csv(chunk + len, sizeof(chunk) - len, seq + i, &recs[i]);
+            }
+            rows++;
+        }
+        seq += n;
+    }
+
+    if (format == FORMAT_JSON) {
+        len += snprintf(chunk + len, sizeof(chunk) - len, "]\n");
+    }
+    if (httpd_resp_send_chunk(req, chunk, len) != ESP_OK ||
+        httpd_resp_send_chunk(req, NULL, 0) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    stats.exports++;
+    stats.rows += rows;
+    stats.bytes += bytes + len;
+    stats.chunks += chunks + 1;
+    ESP_LOGD(TAG, "%s: %lu rows, %lu chunks", req->uri, rows, chunks + 1);
+    return ESP_OK;
+}
+
+// ============================================
+// SERVER-SENT EVENTS
+// ============================================
+
+/**
+ * Send the client every sample it has not seen yet, as "sample" events
+ * batched into chunk-sized writes.
+ */
+static bool sse_flush(sse_client_t *c)
+{
+    local_api_record_t recs[SNAPSHOT_RECORDS];
+    uint16_t n;
+
+    while ((n = local_api_read(&c->next_seq, SNAPSHOT_RECORDS, recs)) > 0) {
+        size_t len = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            if (sizeof(chunk) - len < EVENT_MAX) {
+                if (httpd_socket_send(server, c->fd, chunk, len, 0) < 0) {
+                    return false;
+                }
+                len = 0;
+            }
+            uint32_t seq = c->next_seq + i;
+            len += snprintf(chunk + len, sizeof(chunk) - len, "id: %lu\nevent: sample\ndata: ",
+                            (unsigned long)seq);
+            len += put_json(chunk + len, sizeof(chunk) - len, seq, &recs[i]);
+            chunk[len++] = '\n';
+            chunk[len++] = '\n';
+        }
+        if (httpd_socket_send(server, c->fd, chunk, len, 0) < 0) {
+            return false;
+        }
+        c->next_seq += n;
+        stats.events += n;
+    }
+    return true;
+}
+
+static void sse_work(void *arg)
+{
+    work_queued = false;
+    for (int i = 0; i < HTTP_DASH_SSE_CLIENTS; i++) {
+        if (sse[i].fd >= 0 && !sse_flush(&sse[i])) {
+            httpd_sess_trigger_close(server, sse[i].fd);
+        }
+    }
+}
+
+static esp_err_t events_handler(httpd_req_t *req)
+{
+    int slot = -1;
+    for (int i = 0; i < HTTP_DASH_SSE_CLIENTS; i++) {
+        if (sse[i].fd < 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_sendstr(req, "Too many event streams\n");
+    }
+
+    // Resume after the last event the browser saw, else start at the newest.
+    // An id past the head is from before a reboot restarted the sequence.
+    uint32_t newest = local_api_next_seq();
+    uint32_t next = newest > 0 ? newest - 1 : 0;
+    char id[12];
+    if (httpd_req_get_hdr_value_str(req, "Last-Event-ID", id, sizeof(id)) == ESP_OK) {
+        unsigned long seen = strtoul(id, NULL, 10);
+        if (seen < newest) {
+            next = (uint32_t)seen + 1;
+        }
+    }
+
+    // The response never ends, so write the head ourselves
+    static const char head[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: keep-alive\r\n\r\n"
+        "retry: 5000\n\n";
+    if (httpd_send(req, head, sizeof(head) - 1) < 0) {
+        return ESP_FAIL;
+    }
+
+    sse[slot].fd = httpd_req_to_sockfd(req);
+    sse[slot].next_seq = next;
+    sse_count++;
+    stats.sse_opened++;
+    if (!sse_flush(&sse[slot])) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static void dash_close_fn(httpd_handle_t hd, int sockfd)
+{
+    for (int i = 0; i < HTTP_DASH_SSE_CLIENTS; i++) {
+        if (sse[i].fd == sockfd) {
+            sse[i].fd = -1;
+            sse_count--;
+        }
+    }
+    close(sockfd);
+}
+
+void http_dash_notify(void)
+{
+    if (server == NULL || sse_count == 0 || work_queued) {
+        return;
+    }
+    work_queued = true;
+    if (httpd_queue_work(server, sse_work, NULL) != ESP_OK) {
+        work_queued = false;
+    }
+}
+
+// ============================================
+// STARTUP
+// ============================================
+
+static esp_err_t index_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, index_html, sizeof(index_html) - 1);
+}
+
+esp_err_t http_dash_start(void)
+{
+    for (int i = 0; i < HTTP_DASH_SSE_CLIENTS; i++) {
+        sse[i].fd = -1;
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = HTTP_DASH_PORT;
+    config.max_open_sockets = HTTP_DASH_SSE_CLIENTS + 2;    // Streams + page and export
+    config.lru_purge_enable = true;                         // Stale streams make room
+    config.close_fn = dash_close_fn;
+
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "httpd_start failed: %s", esp_err_to_name(err));
+        server = NULL;
+        return err;
+    }
+
+    const httpd_uri_t uris[] = {
+        { .uri = "/", .method = HTTP_GET, .handler = index_handler },
+        { .uri = "/history.csv", .method = HTTP_GET, .handler = history_handler,
+          .user_ctx = (void *)FORMAT_CSV },
+        { .uri = "/history.json", .method = HTTP_GET, .handler = history_handler,
+          .user_ctx = (void *)FORMAT_JSON },
+        { .uri = "/events", .method = HTTP_GET, .handler = events_handler },
+    };
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        err = httpd_register_uri_handler(server, &uris[i]);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Handler %s not registered: %s", uris[i].uri, esp_err_to_name(err));
+        }
+    }
+#if ENABLE_PROM_METRICS
+    prom_metrics_register_uri(server);
+#endif
+
+    ESP_LOGI(TAG, "Dashboard on port %d", HTTP_DASH_PORT);
+    return ESP_OK;
+}
+
+void http_dash_get_stats(http_dash_stats_t *out)
+{
+    *out = stats;
+    out->sse_clients = sse_count;
+}
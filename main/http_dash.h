@@ -0,0 +1,58 @@
+/**
+ * @file http_dash.h
+ * @brief Local HTTP dashboard: live view, history export, Server-Sent Events
+ *
+ * An esp_http_server instance on HTTP_DASH_PORT serves:
+ *
+ *   /              a small static page that plots the live stream
+ *   /history.csv   the local API history ring as chunked CSV
+ *   /history.json  the same as a chunked JSON array
+ *   /events        Server-Sent Events, one "sample" event per new sample
+ *   /metrics       Prometheus scrape, with ENABLE_PROM_METRICS (prom_metrics.h)
+ *
+ * Both history exports take ?since=SEQ (default: the oldest sample held).
+ * They are formatted straight from snapshots of the ring into one
+ * HTTP_DASH_CHUNK_SIZE buffer per request, so an export of the whole ring
+ * needs no more memory than a single chunk. Every event carries the sample's
+ * sequence number as its id, and a browser that reconnects with
+ * Last-Event-ID resumes after it without gaps, as long as the ring still
+ * holds those samples.
+ *
+ * The history comes from local_api.h, so ENABLE_HTTP_DASH needs
+ * ENABLE_LOCAL_API.
+ */
+
+#ifndef HTTP_DASH_H
+#define HTTP_DASH_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t exports;           // Completed history downloads
+    uint32_t rows;
+    uint32_t bytes;             // Body bytes, chunk framing not included
+    uint32_t chunks;
+    uint32_t sse_opened;        // Event streams accepted
+    uint32_t events;            // Sample events sent, all streams
+    int sse_clients;            // Streams open now
+} http_dash_stats_t;
+
+/**
+ * @brief Start the HTTP server and register the handlers
+ *
+ * Needs the network interface.
+ */
+esp_err_t http_dash_start(void);
+
+/**
+ * @brief Tell the server a new sample is in the history ring
+ *
+ * Called by sensor_task after local_api_record(). Cheap when no event
+ * stream is open; otherwise queues one send on the server task.
+ */
+void http_dash_notify(void);
+
+void http_dash_get_stats(http_dash_stats_t *out);
+
+#endif // HTTP_DASH_H
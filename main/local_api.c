@@ -0,0 +1,468 @@
+/**
+ * @file local_api.c
+ * @brief Local LAN query API over esp_local_ctrl
+ *
+ * The history ring is indexed by sequence number: sample n lives in slot
+ * n % LOCAL_API_HISTORY_SAMPLES for as long as it is among the newest
+ * LOCAL_API_HISTORY_SAMPLES. Readers copy records out in short critical
+ * sections by sequence number, so a sample that arrives in the middle of a
+ * read never tears a record, and anything overwritten meanwhile is skipped.
+ */
+
+#include "local_api.h"
+#include "project_config.h"
+#include "telemetry_cbor.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_random.h>
+#include <esp_console.h>
+#include <esp_local_ctrl.h>
+#include <esp_https_server.h>
+#include <nvs.h>
+
+static const char *TAG = "LOCAL_API";
+
+#define POP_NVS_NAMESPACE       "local_api"
+#define POP_NVS_KEY             "pop"
+#define POP_LEN                 8           // Hex characters
+#define READ_CHUNK              16          // Records copied per critical section
+#define STATS_CHUNK             32          // Records per read in build_stats
+
+typedef enum {
+    PROP_LATEST,
+    PROP_STATS,
+    PROP_COUNT
+} prop_id_t;
+
+static const char *const prop_names[PROP_COUNT] = {
+    [PROP_LATEST] = "latest",
+    [PROP_STATS] = "stats",
+};
+
+#define PROP_TYPE_BINARY        1           // Application defined; all ours are raw bytes
+
+static local_api_record_t history[LOCAL_API_HISTORY_SAMPLES];
+static uint32_t next_seq = 0;
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t pages_served = 0;
+static uint32_t records_served = 0;
+
+static char pop[POP_LEN + 1];
+static bool running = false;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// ============================================
+// HISTORY RING
+// ============================================
+
+void local_api_record(const sensor_data_t *s)
+{
+    local_api_record_t r = {
+        .time_ms = s->timestamp,
+        .temp_dc = (int16_t)lroundf(s->temperature * 10.0f),
+        .hum_dc = (uint16_t)lroundf(s->humidity * 10.0f),
+        .aqi = (uint16_t)s->aqi,
+        .light_lux = s->light_lux,
+    };
+
+    taskENTER_CRITICAL(&history_lock);
+    history[next_seq % LOCAL_API_HISTORY_SAMPLES] = r;
+    next_seq++;
+    taskEXIT_CRITICAL(&history_lock);
+}
+
+uint32_t local_api_next_seq(void)
+{
+    taskENTER_CRITICAL(&history_lock);
+    uint32_t next = next_seq;
+    taskEXIT_CRITICAL(&history_lock);
+    return next;
+}
+
+static uint32_t oldest_seq(uint32_t next)
+{
+    return next > LOCAL_API_HISTORY_SAMPLES ? next - LOCAL_API_HISTORY_SAMPLES : 0;
+}
+
+uint16_t local_api_read(uint32_t *seq, uint16_t max, local_api_record_t *out)
+{
+    uint32_t first = *seq;
+    uint16_t n = 0;
+    bool more = true;
+
+    // A chunk at a time, so a full page never holds off the sampler or,
+    // on one core, the tick for long
+    while (more && n < max) {
+        uint16_t end = max - n > READ_CHUNK ? n + READ_CHUNK : max;
+
+        taskENTER_CRITICAL(&history_lock);
+        uint32_t oldest = oldest_seq(next_seq);
+        if (n == 0 && first < oldest) {
+            first = oldest;
+        }
+        if (first + n < oldest) {
+            // Lapped since the last chunk: stop short, the next read skips ahead
+            more = false;
+        }
+        while (more && n < end && first + n < next_seq) {
+            out[n] = history[(first + n) % LOCAL_API_HISTORY_SAMPLES];
+            n++;
+        }
+        if (n < end) {
+            more = false;           // Caught up with the newest, or lapped
+        }
+        taskEXIT_CRITICAL(&history_lock);
+    }
+
+    *seq = first;
+    return n;
+}
+
+static void fill_header(local_api_header_t *h, local_api_kind_t kind,
+                        uint16_t count, uint32_t first_seq)
+{
+    h->version = LOCAL_API_VERSION;
+    h->kind = kind;
+    h->count = count;
+    h->first_seq = first_seq;
+    h->next_seq = local_api_next_seq();
+    h->now_ms = now_ms();
+    h->epoch_s = telemetry_cbor_epoch();
+}
+
+// ============================================
+// RESPONSES
+// ============================================
+
+static void *build_latest(size_t *size)
+{
+    uint8_t *buf = malloc(sizeof(local_api_header_t) + sizeof(local_api_record_t));
+    if (!buf) {
+        return NULL;
+    }
+
+    uint32_t next = local_api_next_seq();
+    uint32_t seq = next > 0 ? next - 1 : 0;
+    uint16_t n = local_api_read(&seq, 1, (local_api_record_t *)(buf + sizeof(local_api_header_t)));
+    fill_header((local_api_header_t *)buf, LOCAL_API_KIND_LATEST, n, seq);
+    *size = sizeof(local_api_header_t) + n * sizeof(local_api_record_t);
+    return buf;
+}
+
+typedef struct {
+    int32_t min, max;
+    int64_t sum;
+} accum_t;
+
+static void accum_add(accum_t *a, int32_t v)
+{
+    if (v < a->min) {
+        a->min = v;
+    }
+    if (v > a->max) {
+        a->max = v;
+    }
+    a->sum += v;
+}
+
+static void accum_finish(const accum_t *a, uint32_t n, int32_t out[3])
+{
+    out[0] = n ? a->min : 0;
+    out[1] = n ? (int32_t)(a->sum / (int64_t)n) : 0;
+    out[2] = n ? a->max : 0;
+}
+
+static void *build_stats(size_t *size)
+{
+    uint8_t *buf = malloc(sizeof(local_api_header_t) + sizeof(local_api_stats_t));
+    if (!buf) {
+        return NULL;
+    }
+
+    const uint32_t now = now_ms();
+    accum_t acc[4];
+    for (int i = 0; i < 4; i++) {
+        acc[i] = (accum_t){ .min = INT32_MAX, .max = INT32_MIN };
+    }
+
+    local_api_record_t chunk[STATS_CHUNK];
+    uint32_t seq = 0, first_seq = 0, count = 0;
+    uint32_t first_ms = 0, last_ms = 0;
+    uint16_t n;
+    while ((n = local_api_read(&seq, STATS_CHUNK, chunk)) > 0) {
+        for (uint16_t i = 0; i < n; i++) {
+            const local_api_record_t *r = &chunk[i];
+            if (now - r->time_ms > LOCAL_API_STATS_WINDOW_MS) {
+                continue;
+            }
+            if (count == 0) {
+                first_seq = seq + i;
+                first_ms = r->time_ms;
+            }
+            last_ms = r->time_ms;
+            accum_add(&acc[0], r->temp_dc);
+            accum_add(&acc[1], r->hum_dc);
+            accum_add(&acc[2], r->aqi);
+            accum_add(&acc[3], r->light_lux);
+            count++;
+        }
+        seq += n;
+    }
+
+    int32_t v[4][3];
+    for (int i = 0; i < 4; i++) {
+        accum_finish(&acc[i], count, v[i]);
+    }
+    local_api_stats_t *st = (local_api_stats_t *)(buf + sizeof(local_api_header_t));
+    st->window_ms = last_ms - first_ms;
+    st->temp_dc = (local_api_range_t){ v[0][0], v[0][1], v[0][2] };
+    st->hum_dc = (local_api_urange_t){ v[1][0], v[1][1], v[1][2] };
+    st->aqi = (local_api_urange_t){ v[2][0], v[2][1], v[2][2] };
+    st->light_lux = (local_api_urange_t){ v[3][0], v[3][1], v[3][2] };
+
+    fill_header((local_api_header_t *)buf, LOCAL_API_KIND_STATS,
+                count > UINT16_MAX ? UINT16_MAX : count, first_seq);
+    *size = sizeof(local_api_header_t) + sizeof(local_api_stats_t);
+    return buf;
+}
+
+static uint8_t *build_history(uint32_t seq, size_t *size)
+{
+    uint8_t *buf = malloc(sizeof(local_api_header_t) +
+                          LOCAL_API_PAGE_SAMPLES * sizeof(local_api_record_t));
+    if (!buf) {
+        return NULL;
+    }
+
+    uint16_t n = local_api_read(&seq, LOCAL_API_PAGE_SAMPLES,
+                                (local_api_record_t *)(buf + sizeof(local_api_header_t)));
+    fill_header((local_api_header_t *)buf, LOCAL_API_KIND_HISTORY, n, seq);
+
+    pages_served++;
+    records_served += n;
+
+    *size = sizeof(local_api_header_t) + n * sizeof(local_api_record_t);
+    return buf;
+}
+
+// ============================================
+// LOCAL CONTROL HANDLERS
+// ============================================
+
+static esp_err_t get_prop_values(size_t props_count, const esp_local_ctrl_prop_t props[],
+                                 esp_local_ctrl_prop_val_t prop_values[], void *usr_ctx)
+{
+    for (size_t i = 0; i < props_count; i++) {
+        prop_id_t id = (prop_id_t)(uintptr_t)props[i].ctx;
+        void *data = NULL;
+        size_t size = 0;
+
+        switch (id) {
+        case PROP_LATEST:
+            data = build_latest(&size);
+            break;
+        case PROP_STATS:
+            data = build_stats(&size);
+            break;
+        default:
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        if (!data) {
+            ESP_LOGE(TAG, "No memory for \"%s\"", props[i].name);
+            while (i-- > 0) {
+                free(prop_values[i].data);
+                prop_values[i].data = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        prop_values[i].data = data;
+        prop_values[i].size = size;
+        prop_values[i].free_fn = free;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t set_prop_values(size_t props_count, const esp_local_ctrl_prop_t props[],
+                                 const esp_local_ctrl_prop_val_t prop_values[], void *usr_ctx)
+{
+    // All properties are read-only, refused by esp_local_ctrl before this
+    return ESP_ERR_INVALID_ARG;
+}
+
+/**
+ * "history" endpoint. The request carries the sequence number to start at,
+ * so each client pages through with its own cursor and nothing here
+ * depends on who asked before. protocomm frees the response.
+ */
+static esp_err_t history_handler(uint32_t session_id, const uint8_t *inbuf, ssize_t inlen,
+                                 uint8_t **outbuf, ssize_t *outlen, void *priv_data)
+{
+    uint32_t seq;
+    if (!inbuf || inlen != sizeof(seq)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(&seq, inbuf, sizeof(seq));
+
+    size_t size;
+    *outbuf = build_history(seq, &size);
+    if (!*outbuf) {
+        ESP_LOGE(TAG, "No memory for a history page");
+        return ESP_ERR_NO_MEM;
+    }
+    *outlen = (ssize_t)size;
+    return ESP_OK;
+}
+
+// ============================================
+// STARTUP
+// ============================================
+
+static void load_pop(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(POP_NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        size_t len = sizeof(pop);
+        if (nvs_get_str(nvs, POP_NVS_KEY, pop, &len) == ESP_OK && strlen(pop) == POP_LEN) {
+            nvs_close(nvs);
+            return;
+        }
+        snprintf(pop, sizeof(pop), "%08lx", (unsigned long)esp_random());
+        if (nvs_set_str(nvs, POP_NVS_KEY, pop) == ESP_OK) {
+            nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    } else {
+        // Still usable, but changes on every boot
+        snprintf(pop, sizeof(pop), "%08lx", (unsigned long)esp_random());
+        ESP_LOGW(TAG, "PoP not stored, NVS unavailable");
+    }
+}
+
+esp_err_t local_api_start(void)
+{
+    load_pop();
+
+    httpd_ssl_config_t https_conf = HTTPD_SSL_CONFIG_DEFAULT();
+    https_conf.transport_mode = HTTPD_SSL_TRANSPORT_INSECURE;   // Payloads are sec1-encrypted
+    https_conf.port_insecure = LOCAL_API_PORT;
+    https_conf.httpd.ctrl_port = ESP_HTTPD_DEF_CTRL_PORT + 1;   // Leave the default to other servers
+
+    static protocomm_security1_params_t sec_params;
+    sec_params.data = (const uint8_t *)pop;
+    sec_params.len = POP_LEN;
+
+    esp_local_ctrl_config_t config = {
+        .transport = ESP_LOCAL_CTRL_TRANSPORT_HTTPD,
+        .transport_config = {
+            .httpd = &https_conf,
+        },
+        .proto_sec = {
+            .version = PROTOCOM_SEC1,
+            .custom_handle = NULL,
+            .sec_params = &sec_params,
+        },
+        .handlers = {
+            .get_prop_values = get_prop_values,
+            .set_prop_values = set_prop_values,
+            .usr_ctx = NULL,
+            .usr_ctx_free_fn = NULL,
+        },
+        .max_properties = PROP_COUNT,
+    };
+
+    esp_err_t err = esp_local_ctrl_start(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_local_ctrl_start failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    for (int i = 0; i < PROP_COUNT; i++) {
+        esp_local_ctrl_prop_t prop = {
+            .name = (char *)prop_names[i],
+            .type = PROP_TYPE_BINARY,
+            .size = 0,                      // Variable length
+            .flags = PROP_FLAG_READONLY,
+            .ctx = (void *)(uintptr_t)i,
+            .ctx_free_fn = NULL,
+        };
+        err = esp_local_ctrl_add_property(&prop);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Property \"%s\" not added: %s", prop_names[i], esp_err_to_name(err));
+            esp_local_ctrl_stop();
+            return err;
+        }
+    }
+
+    err = esp_local_ctrl_set_handler(LOCAL_API_HISTORY_ENDPOINT, history_handler, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Endpoint \"%s\" not added: %s", LOCAL_API_HISTORY_ENDPOINT,
+                 esp_err_to_name(err));
+        esp_local_ctrl_stop();
+        return err;
+    }
+
+    running = true;
+    // The PoP itself only goes out through "lapi pop", never to the log
+    ESP_LOGI(TAG, "Local API on port %d, sec1 with PoP set", LOCAL_API_PORT);
+    return ESP_OK;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int lapi_cmd(int argc, char **argv)
+{
+    uint32_t next = local_api_next_seq();
+    uint32_t oldest = oldest_seq(next);
+
+    if (argc >= 2) {
+        if (strcmp(argv[1], "pop") != 0) {
+            printf("usage: lapi [pop]\n");
+            return 1;
+        }
+        // Provisioning a LAN client: asked for by name on the serial console
+        if (!running) {
+            printf("not running\n");
+            return 1;
+        }
+        printf("%s\n", pop);
+        return 0;
+    }
+
+    if (running) {
+        printf("port %d, sec1 PoP set (\"lapi pop\" to show)\n", LOCAL_API_PORT);
+    } else {
+        printf("not running\n");
+    }
+    printf("history %lu/%d samples (seq %lu-%lu)\n",
+           next - oldest, LOCAL_API_HISTORY_SAMPLES, oldest, next ? next - 1 : 0);
+    printf("pages served %lu, records %lu\n", pages_served, records_served);
+    return 0;
+}
+
+esp_err_t local_api_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "lapi",
+        .help = "Local LAN API: port and history fill; \"pop\" prints the proof of possession",
+        .hint = "[pop]",
+        .func = lapi_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
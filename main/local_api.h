@@ -0,0 +1,120 @@
+/**
+ * @file local_api.h
+ * @brief Local LAN query API over esp_local_ctrl
+ *
+ * Keeps the last LOCAL_API_HISTORY_SAMPLES samples in a RAM ring and
+ * exposes them over esp_local_ctrl on the local network, so on-site
+ * tooling can pull current and historical data without going through the
+ * cloud:
+ *
+ *   "latest"   (property)    header + the newest record
+ *   "stats"    (property)    header + min/avg/max over LOCAL_API_STATS_WINDOW_MS
+ *   "history"  (endpoint)    request: uint32 sequence number to start at;
+ *                            response: header + up to LOCAL_API_PAGE_SAMPLES
+ *                            records from there
+ *
+ * Every sample gets a sequence number, counting up from 0 at boot. The
+ * client keeps its own cursor: the next page starts at first_seq + count
+ * of the last one, and a lost response is simply asked for again. The
+ * server holds no state per client. Values are little-endian and the
+ * structs below are the wire format; tools/lapi_decode.py turns responses
+ * into CSV.
+ *
+ * The transport is HTTP on LOCAL_API_PORT with protocomm security 1; the
+ * proof of possession is generated once and kept in NVS. It is never
+ * logged: "lapi pop" on the serial console prints it, to provision a
+ * client. RainMaker's own local control service must stay
+ * disabled (CONFIG_ESP_RMAKER_LOCAL_CTRL_AUTO_ENABLE), as esp_local_ctrl runs
+ * a single instance.
+ */
+
+#ifndef LOCAL_API_H
+#define LOCAL_API_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+
+#define LOCAL_API_VERSION           2
+
+#define LOCAL_API_HISTORY_ENDPOINT  "history"   // Custom protocomm endpoint, same session
+
+typedef enum {
+    LOCAL_API_KIND_LATEST = 1,
+    LOCAL_API_KIND_STATS,
+    LOCAL_API_KIND_HISTORY,
+} local_api_kind_t;
+
+// Starts every response (20 bytes)
+typedef struct __attribute__((packed)) {
+    uint8_t version;            // LOCAL_API_VERSION
+    uint8_t kind;               // local_api_kind_t
+    uint16_t count;             // Records that follow (stats: samples in the window)
+    uint32_t first_seq;         // Sequence number of the first of them
+    uint32_t next_seq;          // Sequence number the next sample will get
+    uint32_t now_ms;            // Device clock, same base as time_ms
+    uint32_t epoch_s;           // Wall time at now_ms, 0 before time sync
+} local_api_header_t;
+
+// One sample (12 bytes)
+typedef struct __attribute__((packed)) {
+    uint32_t time_ms;           // Tick clock, ms since boot
+    int16_t temp_dc;            // 0.1 °C
+    uint16_t hum_dc;            // 0.1 %
+    uint16_t aqi;
+    uint16_t light_lux;
+} local_api_record_t;
+
+typedef struct __attribute__((packed)) {
+    int16_t min, avg, max;
+} local_api_range_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t min, avg, max;
+} local_api_urange_t;
+
+// "stats" payload after the header (28 bytes), same units as the record
+typedef struct __attribute__((packed)) {
+    uint32_t window_ms;         // Oldest to newest sample in the window
+    local_api_range_t temp_dc;
+    local_api_urange_t hum_dc;
+    local_api_urange_t aqi;
+    local_api_urange_t light_lux;
+} local_api_stats_t;
+
+/**
+ * @brief Add a sample to the history ring; called for every sample
+ */
+void local_api_record(const sensor_data_t *sample);
+
+/**
+ * @brief Copy samples out of the history ring
+ *
+ * Copies up to max records starting at sequence number *seq and moves *seq
+ * to the first one actually copied, which is later than asked if those have
+ * been overwritten. The ring lock is held for a few records at a time; if
+ * new samples overwrite the rest of the range in between, the copy stops
+ * short and the records returned are still consecutive.
+ *
+ * @return Records copied, 0 once *seq has caught up with the newest sample
+ */
+uint16_t local_api_read(uint32_t *seq, uint16_t max, local_api_record_t *out);
+
+/**
+ * @brief Sequence number the next sample will get
+ */
+uint32_t local_api_next_seq(void);
+
+/**
+ * @brief Start the local control server with the properties and the history endpoint
+ *
+ * Needs NVS and the network interface.
+ */
+esp_err_t local_api_start(void);
+
+/**
+ * @brief Register the "lapi" console command (port, ring fill; "lapi pop" for the PoP)
+ */
+esp_err_t local_api_register_console(void);
+
+#endif // LOCAL_API_H
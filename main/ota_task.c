@@ -11,6 +11,7 @@
 #include <esp_ota_ops.h>
 #include <esp_app_desc.h>
 #include <driver/gpio.h>
+#include "evtrace.h"
 
 static const char *TAG = "OTA_TASK";
 
@@ -34,7 +35,7 @@ static void log_firmware_info(void)
     const esp_partition_t *boot = esp_ota_get_boot_partition();
     ESP_LOGI(TAG, "Boot partition: %s", boot->label);
     
-    // Check if we're running from factory or OTA partition
+    // Check the running slot is the one otadata selects
     if (running == boot) {
         ESP_LOGI(TAG, "Running from boot partition (normal boot)");
     } else {
@@ -53,16 +54,17 @@ static void blink_led_ota_pattern(void)
     }
 }
 
-void ota_task(void *pvParameters)
+// Running partition, looked up once in ota_task_begin()
+static const esp_partition_t *running = NULL;
+
+void ota_task_begin(void)
 {
-    ESP_LOGI(TAG, "OTA monitoring task started");
-    
     // Log firmware information at startup
     log_firmware_info();
     
     // Check if this is first boot after OTA update
     esp_ota_img_states_t ota_state;
-    const esp_partition_t *running = esp_ota_get_running_partition();
+    running = esp_ota_get_running_partition();
     
     if (esp_ota_get_state_partition(running, &ota_state) == ESP_OK) {
         if (ota_state == ESP_OTA_IMG_PENDING_VERIFY) {
@@ -77,48 +79,63 @@ void ota_task(void *pvParameters)
             blink_led_ota_pattern();
         }
     }
+}
+
+uint32_t ota_task_step(void)
+{
+    static uint32_t check_count = 0;
+    esp_ota_img_states_t ota_state;
     
-    uint32_t check_count = 0;
+    // Periodic monitoring
+    check_count++;
     
-    while (1) {
-        // Periodic monitoring
-        check_count++;
+    // Every 10 checks (10 minutes), log status
+    if (check_count % 10 == 0) {
+        TRACE_BEGIN(OTA_CHECK);
+        ESP_LOGI(TAG, "OTA monitoring active (checks: %lu)", check_count);
         
-        // Every 10 checks (10 minutes), log status
-        if (check_count % 10 == 0) {
-            ESP_LOGI(TAG, "OTA monitoring active (checks: %lu)", check_count);
-            
-            // Check partition state
-            if (esp_ota_get_state_partition(running, &ota_state) == ESP_OK) {
-                switch (ota_state) {
-                    case ESP_OTA_IMG_VALID:
-                        ESP_LOGD(TAG, "Current firmware validated");
-                        break;
-                    case ESP_OTA_IMG_UNDEFINED:
-                        ESP_LOGW(TAG, "Firmware state undefined");
-                        break;
-                    case ESP_OTA_IMG_INVALID:
-                        ESP_LOGE(TAG, "Current firmware marked as invalid!");
-                        break;
-                    case ESP_OTA_IMG_ABORTED:
-                        ESP_LOGW(TAG, "Previous OTA update was aborted");
-                        break;
-                    case ESP_OTA_IMG_NEW:
-                        ESP_LOGI(TAG, "Running new firmware (first boot)");
-                        break;
-                    case ESP_OTA_IMG_PENDING_VERIFY:
-                        ESP_LOGW(TAG, "Firmware pending verification");
-                        break;
-                    default:
-                        break;
-                }
+        // Check partition state
+        if (esp_ota_get_state_partition(running, &ota_state) == ESP_OK) {
+            switch (ota_state) {
+                case ESP_OTA_IMG_VALID:
+                    ESP_LOGD(TAG, "Current firmware validated");
+                    break;
+                case ESP_OTA_IMG_UNDEFINED:
+                    ESP_LOGW(TAG, "Firmware state undefined");
+                    break;
+                case ESP_OTA_IMG_INVALID:
+                    ESP_LOGE(TAG, "Current firmware marked as invalid!");
+                    break;
+                case ESP_OTA_IMG_ABORTED:
+                    ESP_LOGW(TAG, "Previous OTA update was aborted");
+                    break;
+                case ESP_OTA_IMG_NEW:
+                    ESP_LOGI(TAG, "Running new firmware (first boot)");
+                    break;
+                case ESP_OTA_IMG_PENDING_VERIFY:
+                    ESP_LOGW(TAG, "Firmware pending verification");
+                    break;
+                default:
+                    break;
             }
         }
-        
-        // Note: OTA update itself is handled by esp_rmaker_ota_enable_default()
-        // This task just monitors the process
-        
-        // Check every minute
-        vTaskDelay(pdMS_TO_TICKS(OTA_CHECK_INTERVAL_MS));
+        TRACE_END(OTA_CHECK);
+    }
+    
+    // Note: OTA update itself is handled by esp_rmaker_ota_enable_default()
+    // This task just monitors the process
+    
+    // Check every minute
+    return OTA_CHECK_INTERVAL_MS;
+}
+
+void ota_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "OTA monitoring task started");
+    
+    ota_task_begin();
+    
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(ota_task_step()));
     }
 }
@@ -6,6 +6,22 @@
 #ifndef OTA_TASK_H
 #define OTA_TASK_H
 
+#include <stdint.h>
+
+/**
+ * @brief Log firmware/partition info and confirm a freshly updated image
+ * 
+ * Blinks the green LED for ~600 ms after the first boot of a new image.
+ */
+void ota_task_begin(void);
+
+/**
+ * @brief One OTA monitoring check; the body of the OTA task loop
+ * 
+ * @return Milliseconds until the next check
+ */
+uint32_t ota_task_step(void);
+
 /**
  * @brief Main OTA monitoring task function
  * 
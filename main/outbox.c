@@ -0,0 +1,453 @@
+/**
+ * @file outbox.c
+ * @brief Persistent, prioritised outbox for cloud messages
+ *
+ * The slot table is guarded by one mutex, held only to copy or edit the
+ * table: handlers run without it, and the NVS write works on a snapshot
+ * taken by the flushing task, so a put never waits on a publish or on the
+ * flash. A slot still holding the same sequence number and coalesce count
+ * after its handler returns is removed; if a put replaced its payload
+ * meanwhile, it stays for the next flush.
+ */
+
+#include "outbox.h"
+#include "cloud_task.h"
+#include "telemetry_cbor.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_console.h>
+#include <nvs.h>
+
+static const char *TAG = "OUTBOX";
+
+#define OUTBOX_NVS_NAMESPACE    "outbox"
+#define OUTBOX_NVS_KEY          "slots"
+#define OUTBOX_NVS_VERSION      1
+#define SLOT_FREE               0xff
+
+typedef struct {
+    uint8_t cls;                // outbox_class_t, SLOT_FREE when unused
+    uint8_t key;
+    uint8_t restored;           // Loaded from NVS: queued_ms is from another boot
+    uint8_t len;
+    uint32_t coalesced;         // Puts folded into this entry
+    uint32_t seq;               // Queue order
+    uint32_t queued_ms;         // Tick time of the first put
+    uint32_t queued_epoch;      // Unix time then, 0 before SNTP
+    uint8_t payload[OUTBOX_PAYLOAD_SIZE];
+} outbox_slot_t;
+
+typedef struct {
+    uint32_t version;
+    uint32_t next_seq;
+    outbox_slot_t slots[OUTBOX_SLOTS];
+} outbox_table_t;
+
+static outbox_table_t table;
+static outbox_table_t snapshot;         // Flushing task only
+static SemaphoreHandle_t table_mutex = NULL;
+static outbox_handler_t handlers[OUTBOX_CLASS_COUNT];
+static outbox_stats_t stats;
+static bool flushing = false;
+static bool unsaved = false;            // Alert or state changes not yet in NVS
+static bool telemetry_dirty = false;
+static uint32_t last_save_ms = 0;
+
+static const char *const class_names[OUTBOX_CLASS_COUNT] = {
+    [OUTBOX_ALERT] = "alert",
+    [OUTBOX_STATE] = "state",
+    [OUTBOX_TELEMETRY] = "telemetry",
+};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// ============================================
+// PERSISTENCE (flushing task, table_mutex not held)
+// ============================================
+
+// Changes waiting for NVS; telemetry-only ones once per OUTBOX_TELEMETRY_SAVE_MS
+static bool save_due(void)
+{
+    return unsaved ||
+           (telemetry_dirty && now_ms() - last_save_ms >= OUTBOX_TELEMETRY_SAVE_MS);
+}
+
+static void save_table(void)
+{
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    snapshot = table;
+    bool was_unsaved = unsaved, was_dirty = telemetry_dirty;
+    unsaved = false;
+    telemetry_dirty = false;
+    xSemaphoreGive(table_mutex);
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(OUTBOX_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, OUTBOX_NVS_KEY, &snapshot, sizeof(snapshot));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    if (err != ESP_OK) {
+        unsaved |= was_unsaved;     // Tried again on the next flush
+        telemetry_dirty |= was_dirty;
+        ESP_LOGE(TAG, "Saving outbox failed: %s", esp_err_to_name(err));
+    } else {
+        stats.saves++;
+    }
+    last_save_ms = now_ms();
+    xSemaphoreGive(table_mutex);
+}
+
+static void clear_table(void)
+{
+    memset(&table, 0, sizeof(table));
+    table.version = OUTBOX_NVS_VERSION;
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        table.slots[i].cls = SLOT_FREE;
+    }
+}
+
+// ============================================
+// SLOTS (table_mutex held)
+// ============================================
+
+static int find_slot(outbox_class_t cls, uint8_t key)
+{
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        if (table.slots[i].cls == cls && table.slots[i].key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// A free slot, else the oldest entry of the lowest class not above cls
+static int claim_slot(outbox_class_t cls)
+{
+    int victim = -1;
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        const outbox_slot_t *s = &table.slots[i];
+        if (s->cls == SLOT_FREE) {
+            return i;
+        }
+        if (s->cls < cls) {
+            continue;
+        }
+        if (victim < 0 || s->cls > table.slots[victim].cls ||
+            (s->cls == table.slots[victim].cls && s->seq < table.slots[victim].seq)) {
+            victim = i;
+        }
+    }
+    if (victim >= 0) {
+        ESP_LOGW(TAG, "Full, dropping %s entry %u", class_names[table.slots[victim].cls],
+                 table.slots[victim].key);
+        stats.cls[table.slots[victim].cls].dropped++;
+    }
+    return victim;
+}
+
+// Highest class, then oldest
+static int next_slot(void)
+{
+    int best = -1;
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        const outbox_slot_t *s = &table.slots[i];
+        if (s->cls == SLOT_FREE) {
+            continue;
+        }
+        if (best < 0 || s->cls < table.slots[best].cls ||
+            (s->cls == table.slots[best].cls && s->seq < table.slots[best].seq)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static uint16_t count_pending(void)
+{
+    uint16_t n = 0;
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        n += table.slots[i].cls != SLOT_FREE;
+    }
+    return n;
+}
+
+static void record_delay(const outbox_slot_t *s)
+{
+    uint32_t delay_ms;
+    uint32_t epoch = telemetry_cbor_epoch();
+    if (!s->restored) {
+        delay_ms = now_ms() - s->queued_ms;
+    } else if (s->queued_epoch && epoch >= s->queued_epoch) {
+        delay_ms = (epoch - s->queued_epoch) * 1000;
+    } else {
+        return;     // Queued before a reset and before SNTP: unknown
+    }
+
+    outbox_class_stats_t *cs = &stats.cls[s->cls];
+    cs->delay_count++;
+    cs->delay_total_ms += delay_ms;
+    if (delay_ms > cs->delay_max_ms) {
+        cs->delay_max_ms = delay_ms;
+    }
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+esp_err_t outbox_init(void)
+{
+    table_mutex = xSemaphoreCreateMutex();
+    if (!table_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    clear_table();
+    nvs_handle_t handle;
+    if (nvs_open(OUTBOX_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        size_t length = sizeof(table);
+        esp_err_t err = nvs_get_blob(handle, OUTBOX_NVS_KEY, &table, &length);
+        nvs_close(handle);
+        if (err != ESP_OK || length != sizeof(table) || table.version != OUTBOX_NVS_VERSION) {
+            if (err != ESP_ERR_NVS_NOT_FOUND) {
+                ESP_LOGW(TAG, "Stored outbox unusable, starting empty");
+            }
+            clear_table();
+        }
+    }
+
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        outbox_slot_t *s = &table.slots[i];
+        if (s->cls >= OUTBOX_CLASS_COUNT || s->len > OUTBOX_PAYLOAD_SIZE) {
+            s->cls = SLOT_FREE;
+        } else {
+            s->restored = 1;
+            stats.restored++;
+        }
+    }
+    if (stats.restored) {
+        ESP_LOGI(TAG, "%u undelivered entries from before the reset", stats.restored);
+    }
+    return ESP_OK;
+}
+
+void outbox_set_handler(outbox_class_t cls, outbox_handler_t handler)
+{
+    handlers[cls] = handler;
+}
+
+esp_err_t outbox_put(outbox_class_t cls, uint8_t key, const void *payload, size_t len)
+{
+    if (cls >= OUTBOX_CLASS_COUNT || len > OUTBOX_PAYLOAD_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!table_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    stats.cls[cls].queued++;
+    int i = find_slot(cls, key);
+    if (i >= 0) {
+        table.slots[i].coalesced++;
+        stats.cls[cls].coalesced++;
+    } else if ((i = claim_slot(cls)) >= 0) {
+        table.slots[i] = (outbox_slot_t){
+            .cls = cls,
+            .key = key,
+            .seq = table.next_seq++,
+            .queued_ms = now_ms(),
+            .queued_epoch = telemetry_cbor_epoch(),
+        };
+    }
+
+    esp_err_t err = ESP_OK;
+    if (i < 0) {
+        // Full of higher classes
+        stats.cls[cls].dropped++;
+        err = ESP_ERR_NO_MEM;
+    } else {
+        memcpy(table.slots[i].payload, payload, len);
+        table.slots[i].len = (uint8_t)len;
+        if (cls != OUTBOX_TELEMETRY) {
+            unsaved = true;
+        } else {
+            telemetry_dirty = true;
+        }
+    }
+    xSemaphoreGive(table_mutex);
+
+    if (err == ESP_OK) {
+        cloud_task_notify();    // Saved and sent from there
+    }
+    return err;
+}
+
+void outbox_cancel(outbox_class_t cls, uint8_t key)
+{
+    if (!table_mutex) {
+        return;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    int i = find_slot(cls, key);
+    if (i >= 0) {
+        table.slots[i].cls = SLOT_FREE;
+        stats.cls[cls].coalesced++;
+        unsaved = true;
+    }
+    xSemaphoreGive(table_mutex);
+}
+
+uint32_t outbox_flush(void)
+{
+    if (!table_mutex) {
+        return 0;
+    }
+
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    bool busy = flushing;
+    flushing = true;
+    xSemaphoreGive(table_mutex);
+    if (busy) {
+        return 0;
+    }
+
+    // Before delivering, so a reset during a slow publish keeps the entry
+    if (save_due()) {
+        save_table();
+    }
+
+    uint32_t delivered = 0;
+    bool removed = false;
+    while (cloud_task_wait_connected(0)) {
+        outbox_slot_t slot;
+        xSemaphoreTake(table_mutex, portMAX_DELAY);
+        int i = next_slot();
+        if (i >= 0) {
+            slot = table.slots[i];
+        }
+        xSemaphoreGive(table_mutex);
+        if (i < 0) {
+            break;
+        }
+
+        outbox_handler_t handler = handlers[slot.cls];
+        esp_err_t err = handler ? handler(slot.key, slot.payload, slot.len) : ESP_ERR_INVALID_STATE;
+
+        xSemaphoreTake(table_mutex, portMAX_DELAY);
+        outbox_slot_t *s = &table.slots[i];
+        bool same = s->cls == slot.cls && s->seq == slot.seq;
+        if (err == ESP_OK) {
+            stats.cls[slot.cls].delivered++;
+            record_delay(&slot);
+            delivered++;
+        } else if (err == ESP_ERR_NOT_FOUND) {
+            ESP_LOGD(TAG, "%s entry %u no longer needed", class_names[slot.cls], slot.key);
+            stats.cls[slot.cls].dropped++;
+        } else if (err == ESP_ERR_INVALID_ARG) {
+            ESP_LOGW(TAG, "Dropping %s entry %u", class_names[slot.cls], slot.key);
+            stats.cls[slot.cls].dropped++;
+        } else {
+            stats.cls[slot.cls].failures++;
+        }
+        if (err != ESP_OK && err != ESP_ERR_NOT_FOUND && err != ESP_ERR_INVALID_ARG) {
+            xSemaphoreGive(table_mutex);
+            break;  // Retried on the next flush
+        }
+        if (same && s->coalesced == slot.coalesced) {
+            s->cls = SLOT_FREE;
+            removed = true;
+        }
+        xSemaphoreGive(table_mutex);
+    }
+
+    if (removed || save_due()) {
+        save_table();
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    flushing = false;
+    xSemaphoreGive(table_mutex);
+    return delivered;
+}
+
+uint16_t outbox_pending(void)
+{
+    if (!table_mutex) {
+        return 0;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    uint16_t n = count_pending();
+    xSemaphoreGive(table_mutex);
+    return n;
+}
+
+void outbox_get_stats(outbox_stats_t *out)
+{
+    if (!table_mutex) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    *out = stats;
+    out->pending = count_pending();
+    xSemaphoreGive(table_mutex);
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int outbox_cmd(int argc, char **argv)
+{
+    outbox_stats_t s;
+    outbox_get_stats(&s);
+    printf("%u pending, %u restored at boot, %lu NVS saves\n", s.pending, s.restored, s.saves);
+    for (int c = 0; c < OUTBOX_CLASS_COUNT; c++) {
+        const outbox_class_stats_t *cs = &s.cls[c];
+        printf("%-9s queued %lu, coalesced %lu, delivered %lu, dropped %lu, retries %lu, "
+               "delay avg %llu ms, max %lu ms\n", class_names[c], cs->queued, cs->coalesced,
+               cs->delivered, cs->dropped, cs->failures,
+               cs->delay_count ? cs->delay_total_ms / cs->delay_count : 0, cs->delay_max_ms);
+    }
+
+    xSemaphoreTake(table_mutex, portMAX_DELAY);
+    for (int i = 0; i < OUTBOX_SLOTS; i++) {
+        const outbox_slot_t *slot = &table.slots[i];
+        if (slot->cls != SLOT_FREE) {
+            printf("  #%lu %s/%u, %u bytes, x%lu%s\n", slot->seq, class_names[slot->cls],
+                   slot->key, slot->len, slot->coalesced + 1,
+                   slot->restored ? ", from before the reset" : "");
+        }
+    }
+    xSemaphoreGive(table_mutex);
+    return 0;
+}
+
+esp_err_t outbox_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "outbox",
+        .help = "Pending cloud messages and delivery delays per class",
+        .hint = NULL,
+        .func = outbox_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
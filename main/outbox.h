@@ -0,0 +1,109 @@
+/**
+ * @file outbox.h
+ * @brief Persistent, prioritised outbox for cloud messages (ENABLE_OUTBOX)
+ *
+ * Messages that must reach the cloud are put in the outbox instead of being
+ * sent once and forgotten. Each entry has a class, delivered in this order:
+ *
+ *   OUTBOX_ALERT       alert notifications
+ *   OUTBOX_STATE       state changes (an alert clearing)
+ *   OUTBOX_TELEMETRY   the last reading taken while the cloud was down
+ *
+ * and a key within its class. A put with the class and key of a pending
+ * entry replaces that entry's payload (coalescing) and keeps its original
+ * queue time, so the delay statistics count from the first occurrence.
+ * A put or cancel only edits the RAM table and wakes the cloud task, so
+ * the alert step never waits on the flash or the network. The cloud task
+ * calls outbox_flush(), which saves the table and delivers pending
+ * entries, highest class first and oldest first within a class, through
+ * one handler per class, and stops at the first failure; whatever is left
+ * goes out on a later flush once the cloud takes it.
+ *
+ * The OUTBOX_SLOTS entries are kept in one NVS blob, so they survive
+ * resets and deep sleep. Alerts and state changes are saved on the next
+ * flush, before any delivery; telemetry puts at most every
+ * OUTBOX_TELEMETRY_SAVE_MS to spare the flash during a long outage. When the outbox is full, the oldest
+ * entry of the lowest class at or below the new one's makes room.
+ */
+
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    OUTBOX_ALERT,
+    OUTBOX_STATE,
+    OUTBOX_TELEMETRY,
+    OUTBOX_CLASS_COUNT
+} outbox_class_t;
+
+/**
+ * @brief Send one entry
+ *
+ * @return ESP_OK when delivered; ESP_ERR_NOT_FOUND or ESP_ERR_INVALID_ARG
+ *         drops the entry; anything else keeps it for the next flush
+ */
+typedef esp_err_t (*outbox_handler_t)(uint8_t key, const void *payload, size_t len);
+
+typedef struct {
+    uint32_t queued;            // Puts, coalesced ones included
+    uint32_t coalesced;         // Puts that replaced a pending entry, and cancels
+    uint32_t delivered;
+    uint32_t dropped;           // Evicted when full, or refused by the handler
+    uint32_t failures;          // Delivery attempts that will be retried
+    uint32_t delay_count;       // Deliveries with a known delay
+    uint32_t delay_max_ms;      // First queued to delivered
+    uint64_t delay_total_ms;
+} outbox_class_stats_t;
+
+typedef struct {
+    outbox_class_stats_t cls[OUTBOX_CLASS_COUNT];
+    uint32_t saves;             // NVS writes
+    uint16_t restored;          // Entries found in NVS at boot
+    uint16_t pending;
+} outbox_stats_t;
+
+/**
+ * @brief Load the entries left from before the reset; call after nvs_flash_init()
+ */
+esp_err_t outbox_init(void);
+
+void outbox_set_handler(outbox_class_t cls, outbox_handler_t handler);
+
+/**
+ * @brief Queue a payload of up to OUTBOX_PAYLOAD_SIZE bytes
+ *
+ * Does not block on NVS or the cloud; the cloud task's next flush saves
+ * and sends it.
+ */
+esp_err_t outbox_put(outbox_class_t cls, uint8_t key, const void *payload, size_t len);
+
+/**
+ * @brief Drop a pending entry that newer news has made stale
+ */
+void outbox_cancel(outbox_class_t cls, uint8_t key);
+
+/**
+ * @brief Save unsaved changes, then deliver pending entries while the cloud is connected
+ *
+ * Blocks on NVS and the publish handlers: call from the cloud task, or
+ * from the deep-sleep upload. Returns at once if another task is already
+ * flushing.
+ *
+ * @return Entries delivered
+ */
+uint32_t outbox_flush(void);
+
+uint16_t outbox_pending(void);
+
+void outbox_get_stats(outbox_stats_t *out);
+
+/**
+ * @brief Register the "outbox" console command (pending entries, delays)
+ */
+esp_err_t outbox_register_console(void);
+
+#endif // OUTBOX_H
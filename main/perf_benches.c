@@ -0,0 +1,180 @@
+/**
+ * @file perf_benches.c
+ * @brief Microbenchmarks of the application hot paths
+ *
+ * Every benchmark calls the same function the tasks use, on fixed inputs,
+ * without touching the bus or the shared display. Inputs rotate through a
+ * small set of realistic samples so nothing is constant-folded.
+ */
+
+#include "perf_benches.h"
+#include "project_config.h"
+#include <esp_log.h>
+#include "perf.h"
+#include "sensor_task.h"
+#include "display_task.h"
+#include "alert_task.h"
+#include "dht11.h"
+#include "ssd1306.h"
+#include "calibration.h"
+#include "prom_metrics.h"
+#include "telemetry_cbor.h"
+#include <stdio.h>
+
+static const char *TAG = "PERF_BENCH";
+
+// Typical readings, all inside the default alert thresholds
+static const sensor_data_t samples[] = {
+    { .temperature = 24.3f, .humidity = 55.0f, .aqi = 42 },
+    { .temperature = 27.8f, .humidity = 48.0f, .aqi = 77 },
+    { .temperature = 21.1f, .humidity = 63.0f, .aqi = 35 },
+    { .temperature = 30.4f, .humidity = 41.0f, .aqi = 118 },
+};
+static const int sample_lights[] = { 2100, 850, 3300, 1500 };
+static const char *const sample_status[] = { "Good", "Moderate", "Good", "Unhealthy for Sensitive" };
+
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+static uint32_t next_sample;
+
+// Scratch OLED device: frame buffer only, never initialised on the bus
+static ssd1306_handle_t bench_display;
+
+// 55.0 %RH, 24.3 C: bytes 0x37 0x00 0x18 0x03, checksum 0x52
+static uint8_t dht_levels[DHT11_FRAME_BITS];
+
+#if ENABLE_PROM_METRICS
+static char prom_buf[PROM_RENDER_SIZE];
+#endif
+
+// One full uplink batch, 10 s apart, and both encodings of it
+static sensor_data_t batch[UPLINK_BATCH_SIZE];
+static uint8_t batch_cbor[TELEMETRY_CBOR_SIZE(UPLINK_BATCH_SIZE)];
+static char batch_json[UPLINK_BATCH_SIZE * 160];
+
+// ============================================
+// BENCHMARKS
+// ============================================
+
+static void bench_calculate_aqi(void *ctx)
+{
+    uint32_t i = next_sample++ % SAMPLE_COUNT;
+    perf_keep((uint32_t)calculate_aqi(samples[i].temperature, samples[i].humidity,
+                                      sample_lights[i]));
+}
+
+static void bench_dht11_decode(void *ctx)
+{
+    float temperature, humidity;
+    dht11_decode(dht_levels, &temperature, &humidity);
+    perf_keep((uint32_t)temperature);
+}
+
+static void bench_draw_string(void *ctx)
+{
+    ssd1306_draw_string(bench_display, 0, 16, (const uint8_t *)"Temp: 24.3 C", 16, 1);
+}
+
+static void bench_prepare_gram(void *ctx)
+{
+    i2c_cmd_handle_t cmd = ssd1306_prepare_gram(bench_display);
+    if (cmd) {
+        i2c_cmd_link_delete(cmd);
+    }
+}
+
+static void bench_alert_thresholds(void *ctx)
+{
+    perf_keep((uint32_t)alert_check_thresholds(&samples[next_sample++ % SAMPLE_COUNT]));
+}
+
+static void bench_display_format(void *ctx)
+{
+    display_lines_t lines;
+    display_format_sample(&samples[next_sample++ % SAMPLE_COUNT], &lines);
+    perf_keep((uint32_t)lines.aqi[5]);
+}
+
+static void bench_calibration_apply(void *ctx)
+{
+    uint32_t i = next_sample++ % SAMPLE_COUNT;
+    float temperature = samples[i].temperature, humidity = samples[i].humidity;
+    calibration_apply_dht(&temperature, &humidity);
+    perf_keep((uint32_t)temperature + calibration_ldr_lux(sample_lights[i]));
+}
+
+static void bench_uplink_cbor(void *ctx)
+{
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin(&enc, batch_cbor, sizeof(batch_cbor), UPLINK_BATCH_SIZE,
+                         batch[UPLINK_BATCH_SIZE - 1].timestamp, 1700000000, batch[0].timestamp);
+    for (int i = 0; i < UPLINK_BATCH_SIZE; i++) {
+        telemetry_cbor_add(&enc, &batch[i]);
+    }
+    perf_keep((uint32_t)telemetry_cbor_end(&enc));
+}
+
+// The same batch as the parameter reports cloud_publish_sample() sends,
+// floats formatted the way RainMaker's JSON generator does (5 decimals)
+static void bench_uplink_json(void *ctx)
+{
+    size_t len = 0;
+    for (int i = 0; i < UPLINK_BATCH_SIZE; i++) {
+        len += snprintf(batch_json + len, sizeof(batch_json) - len,
+                        "{\"Temperature Sensor\":{\"Temperature\":%.5f},"
+                        "\"Humidity Sensor\":{\"Humidity\":%.5f},"
+                        "\"AQI Sensor\":{\"AQI\":%d,\"Air Quality Status\":\"%s\"}}",
+                        batch[i].temperature, batch[i].humidity, batch[i].aqi,
+                        sample_status[i % SAMPLE_COUNT]);
+    }
+    perf_keep((uint32_t)len);
+}
+
+#if ENABLE_PROM_METRICS
+static void bench_prom_render(void *ctx)
+{
+    perf_keep((uint32_t)prom_metrics_render(prom_buf, sizeof(prom_buf)));
+}
+#endif
+
+static const perf_bench_t benches[] = {
+    { "calculate_aqi",          bench_calculate_aqi,    NULL },
+    { "dht11_decode",           bench_dht11_decode,     NULL },
+    { "ssd1306_draw_string",    bench_draw_string,      NULL },
+    { "ssd1306_prepare_gram",   bench_prepare_gram,     NULL },
+    { "alert_check_thresholds", bench_alert_thresholds, NULL },
+    { "display_format_sample",  bench_display_format,   NULL },
+    { "calibration_apply",      bench_calibration_apply, NULL },
+    { "uplink_cbor_batch",      bench_uplink_cbor,      NULL },
+    { "uplink_json_batch",      bench_uplink_json,      NULL },
+#if ENABLE_PROM_METRICS
+    { "prom_metrics_render",    bench_prom_render,      NULL },
+#endif
+};
+
+// ============================================
+// REGISTRATION
+// ============================================
+
+esp_err_t perf_benches_register(void)
+{
+    static const uint8_t frame[5] = { 0x37, 0x00, 0x18, 0x03, 0x52 };
+    for (int i = 0; i < DHT11_FRAME_BITS; i++) {
+        dht_levels[i] = (frame[i / 8] >> (7 - i % 8)) & 1;
+    }
+    for (int i = 0; i < UPLINK_BATCH_SIZE; i++) {
+        batch[i] = samples[i % SAMPLE_COUNT];
+        batch[i].light_lux = (uint16_t)sample_lights[i % SAMPLE_COUNT];
+        batch[i].timestamp = 600000 + i * 10000;
+    }
+
+    if (bench_display == NULL) {
+        bench_display = ssd1306_create(I2C_MASTER_NUM, SSD1306_I2C_ADDRESS);
+        if (bench_display == NULL) {
+            ESP_LOGE(TAG, "No memory for the scratch display");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    return perf_register(benches, sizeof(benches) / sizeof(benches[0]));
+}
@@ -0,0 +1,20 @@
+/**
+ * @file perf_benches.h
+ * @brief Microbenchmarks of the application hot paths
+ */
+
+#ifndef PERF_BENCHES_H
+#define PERF_BENCHES_H
+
+#include "esp_err.h"
+
+/**
+ * @brief Register the hot-path benchmarks with the perf harness
+ *
+ * Covers AQI calculation, DHT11 frame decoding, OLED text rendering and
+ * frame upload preparation, alert threshold checks and display line
+ * formatting. Run them with the "perf" console command.
+ */
+esp_err_t perf_benches_register(void);
+
+#endif // PERF_BENCHES_H
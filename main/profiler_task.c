@@ -0,0 +1,303 @@
+/**
+ * @file profiler_task.c
+ * @brief Per-task CPU, stack and heap profiling task implementation
+ *
+ * Consumes the FreeRTOS run-time stats enabled in sdkconfig.defaults
+ * (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) so task stacks can be sized
+ * from field data instead of guesses.
+ */
+
+#include "profiler_task.h"
+#include "project_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_console.h>
+#include <esp_diagnostics_metrics.h>
+#include <esp_heap_caps.h>
+#include <esp_heap_task_info.h>
+#include <string.h>
+#include <stdio.h>
+
+static const char *TAG = "PROFILER";
+
+// ============================================
+// TRACKED TASKS
+// ============================================
+
+// Insights keys and labels must outlive registration, so they are literals
+typedef struct {
+    const char *task_name;
+    const char *cpu_key;
+    const char *cpu_label;
+    const char *stack_key;
+    const char *stack_label;
+    const char *heap_key;
+    const char *heap_label;
+} profiled_task_t;
+
+#define PROFILED_TASK(name, id) {                                   \
+        name,                                                       \
+        "cpu_" id,   name " CPU share (permille)",                  \
+        "stack_" id, name " stack free (bytes)",                    \
+        "heap_" id,  name " heap in use (bytes)",                   \
+    }
+
+static const profiled_task_t profiled_tasks[] = {
+#if ENABLE_COOP_SCHEDULER
+    PROFILED_TASK("Scheduler", "sched"),
+    PROFILED_TASK("Cloud",    "cloud"),
+#else
+    PROFILED_TASK("Sensor",   "sensor"),
+    PROFILED_TASK("Cloud",    "cloud"),
+    PROFILED_TASK("Display",  "display"),
+    PROFILED_TASK("Alert",    "alert"),
+    PROFILED_TASK("OTA",      "ota"),
+#endif
+    PROFILED_TASK("Profiler", "profiler"),
+    PROFILED_TASK("IDLE",     "idle"),
+};
+
+#define PROFILED_TASK_COUNT (sizeof(profiled_tasks) / sizeof(profiled_tasks[0]))
+
+// ============================================
+// PROFILER STATE
+// ============================================
+
+typedef struct {
+    UBaseType_t task_number;
+    uint32_t last_runtime;
+} runtime_baseline_t;
+
+static TaskStatus_t task_status[PROFILER_MAX_TASKS];
+static runtime_baseline_t baselines[PROFILER_MAX_TASKS];
+static int baseline_count = 0;
+static uint32_t last_total_runtime = 0;
+
+static profiler_entry_t snapshot[PROFILER_MAX_TASKS];
+static int snapshot_count = 0;
+static SemaphoreHandle_t snapshot_mutex = NULL;
+
+#if CONFIG_HEAP_TASK_TRACKING
+static heap_task_totals_t heap_totals[PROFILER_MAX_TASKS];
+#endif
+
+// ============================================
+// SAMPLING
+// ============================================
+
+static uint32_t runtime_delta(UBaseType_t task_number, uint32_t runtime)
+{
+    for (int i = 0; i < baseline_count; i++) {
+        if (baselines[i].task_number == task_number) {
+            // Unsigned subtraction also handles the 32-bit counter wrapping
+            uint32_t delta = runtime - baselines[i].last_runtime;
+            baselines[i].last_runtime = runtime;
+            return delta;
+        }
+    }
+
+    if (baseline_count < PROFILER_MAX_TASKS) {
+        baselines[baseline_count].task_number = task_number;
+        baselines[baseline_count].last_runtime = runtime;
+        baseline_count++;
+    }
+    return 0;  // First sighting, no interval to compare against yet
+}
+
+// Forget tasks that have been deleted, so their slots go to new ones
+static void prune_baselines(UBaseType_t task_count)
+{
+    int kept = 0;
+    for (int i = 0; i < baseline_count; i++) {
+        for (UBaseType_t j = 0; j < task_count; j++) {
+            if (task_status[j].xTaskNumber == baselines[i].task_number) {
+                baselines[kept++] = baselines[i];
+                break;
+            }
+        }
+    }
+    baseline_count = kept;
+}
+
+static uint32_t task_heap_bytes(TaskHandle_t task, size_t heap_total_count)
+{
+#if CONFIG_HEAP_TASK_TRACKING
+    for (size_t i = 0; i < heap_total_count; i++) {
+        if (heap_totals[i].task == task) {
+            return heap_totals[i].size[0];
+        }
+    }
+#endif
+    return 0;
+}
+
+static size_t collect_heap_totals(void)
+{
+    size_t count = 0;
+#if CONFIG_HEAP_TASK_TRACKING
+    heap_task_info_params_t params = {
+        .caps = { MALLOC_CAP_8BIT },
+        .mask = { MALLOC_CAP_8BIT },
+        .tasks = NULL,
+        .num_tasks = 0,
+        .totals = heap_totals,
+        .num_totals = &count,
+        .max_totals = PROFILER_MAX_TASKS,
+        .blocks = NULL,
+        .max_blocks = 0,
+    };
+    heap_caps_get_per_task_info(&params);
+#endif
+    return count;
+}
+
+static void take_sample(void)
+{
+    uint32_t total_runtime = 0;
+    UBaseType_t task_count = uxTaskGetSystemState(task_status, PROFILER_MAX_TASKS,
+                                                  &total_runtime);
+    if (task_count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, raise PROFILER_MAX_TASKS", PROFILER_MAX_TASKS);
+        return;
+    }
+
+    prune_baselines(task_count);
+    uint32_t total_delta = total_runtime - last_total_runtime;
+    last_total_runtime = total_runtime;
+    size_t heap_total_count = collect_heap_totals();
+
+    xSemaphoreTake(snapshot_mutex, portMAX_DELAY);
+    snapshot_count = 0;
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        TaskStatus_t *status = &task_status[i];
+        profiler_entry_t *entry = &snapshot[snapshot_count++];
+        uint32_t delta = runtime_delta(status->xTaskNumber, status->ulRunTimeCounter);
+
+        strlcpy(entry->name, status->pcTaskName, sizeof(entry->name));
+        entry->cpu_permille = total_delta ?
+            (uint16_t)(((uint64_t)delta * 1000) / total_delta) : 0;
+        entry->stack_free = status->usStackHighWaterMark;
+        entry->heap_bytes = task_heap_bytes(status->xHandle, heap_total_count);
+    }
+    xSemaphoreGive(snapshot_mutex);
+}
+
+static void publish_sample(void)
+{
+    xSemaphoreTake(snapshot_mutex, portMAX_DELAY);
+    for (int i = 0; i < snapshot_count; i++) {
+        const profiler_entry_t *entry = &snapshot[i];
+
+        for (size_t j = 0; j < PROFILED_TASK_COUNT; j++) {
+            const profiled_task_t *tracked = &profiled_tasks[j];
+            if (strcmp(entry->name, tracked->task_name) != 0) {
+                continue;
+            }
+            esp_diag_metrics_add_uint(tracked->cpu_key, entry->cpu_permille);
+            esp_diag_metrics_add_uint(tracked->stack_key, entry->stack_free);
+            esp_diag_metrics_add_uint(tracked->heap_key, entry->heap_bytes);
+            break;
+        }
+
+#if ENABLE_PROFILER_DEBUG
+        ESP_LOGI(TAG, "%-10s cpu=%u.%u%% stack_free=%lu heap=%lu",
+                 entry->name, entry->cpu_permille / 10, entry->cpu_permille % 10,
+                 entry->stack_free, entry->heap_bytes);
+#endif
+    }
+    xSemaphoreGive(snapshot_mutex);
+}
+
+int profiler_get_snapshot(profiler_entry_t *out, int max_entries)
+{
+    if (snapshot_mutex == NULL) {
+        return 0;
+    }
+
+    xSemaphoreTake(snapshot_mutex, portMAX_DELAY);
+    int count = snapshot_count < max_entries ? snapshot_count : max_entries;
+    memcpy(out, snapshot, count * sizeof(profiler_entry_t));
+    xSemaphoreGive(snapshot_mutex);
+    return count;
+}
+
+// ============================================
+// CONSOLE COMMAND
+// ============================================
+
+static int prof_cmd(int argc, char **argv)
+{
+    profiler_entry_t entries[PROFILER_MAX_TASKS];
+    int count = profiler_get_snapshot(entries, PROFILER_MAX_TASKS);
+
+    if (count == 0) {
+        printf("No profiler sample yet (interval %d ms)\n", PROFILER_INTERVAL_MS);
+        return 0;
+    }
+
+    printf("%-12s %7s %11s %10s\n", "Task", "CPU %", "Stack free", "Heap");
+    for (int i = 0; i < count; i++) {
+        printf("%-12s %5u.%u %11lu %10lu\n", entries[i].name,
+               entries[i].cpu_permille / 10, entries[i].cpu_permille % 10,
+               entries[i].stack_free, entries[i].heap_bytes);
+    }
+    return 0;
+}
+
+// ============================================
+// INITIALIZATION & MAIN TASK
+// ============================================
+
+esp_err_t profiler_init(void)
+{
+    snapshot_mutex = xSemaphoreCreateMutex();
+    if (snapshot_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create snapshot mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t i = 0; i < PROFILED_TASK_COUNT; i++) {
+        const profiled_task_t *tracked = &profiled_tasks[i];
+        esp_diag_metrics_register(TAG, tracked->cpu_key, tracked->cpu_label,
+                                  "tasks.cpu", ESP_DIAG_DATA_TYPE_UINT);
+        esp_diag_metrics_register(TAG, tracked->stack_key, tracked->stack_label,
+                                  "tasks.stack", ESP_DIAG_DATA_TYPE_UINT);
+        esp_diag_metrics_register(TAG, tracked->heap_key, tracked->heap_label,
+                                  "tasks.heap", ESP_DIAG_DATA_TYPE_UINT);
+    }
+
+    const esp_console_cmd_t cmd = {
+        .command = "prof",
+        .help = "Per-task CPU share, stack high-water mark and heap usage",
+        .hint = NULL,
+        .func = prof_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+
+    ESP_LOGI(TAG, "Profiler initialized (%d tasks tracked, interval %d ms)",
+             (int)PROFILED_TASK_COUNT, PROFILER_INTERVAL_MS);
+    return ESP_OK;
+}
+
+void profiler_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Profiler task started");
+
+    TickType_t last_wake_time = xTaskGetTickCount();
+    const TickType_t interval = pdMS_TO_TICKS(PROFILER_INTERVAL_MS);
+
+    // First pass only establishes the run-time baselines
+    take_sample();
+
+    while (1) {
+        vTaskDelayUntil(&last_wake_time, interval);
+
+        take_sample();
+        publish_sample();
+    }
+}
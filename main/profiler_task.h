@@ -0,0 +1,49 @@
+/**
+ * @file profiler_task.h
+ * @brief Per-task CPU, stack and heap profiling task interface
+ */
+
+#ifndef PROFILER_TASK_H
+#define PROFILER_TASK_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief One task's figures from the latest profiler sample
+ */
+typedef struct {
+    char name[16];              // FreeRTOS task name
+    uint16_t cpu_permille;      // CPU share over the last interval (0-1000)
+    uint32_t stack_free;        // Stack high-water mark (bytes never used)
+    uint32_t heap_bytes;        // Heap currently owned by the task
+} profiler_entry_t;
+
+/**
+ * @brief Register Insights metrics and the "prof" console command
+ *
+ * Must be called before the profiler task is started.
+ */
+esp_err_t profiler_init(void);
+
+/**
+ * @brief Main profiler task
+ *
+ * Samples uxTaskGetSystemState() every PROFILER_INTERVAL_MS, turns run-time
+ * counters into CPU share deltas and publishes CPU, stack and heap figures
+ * as ESP Insights metrics.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void profiler_task(void *pvParameters);
+
+/**
+ * @brief Copy the latest sample
+ *
+ * @param[out] out Array to fill
+ * @param max_entries Capacity of out
+ * @return Number of entries written
+ */
+int profiler_get_snapshot(profiler_entry_t *out, int max_entries);
+
+#endif // PROFILER_TASK_H
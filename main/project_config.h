@@ -6,6 +6,7 @@
 #ifndef PROJECT_CONFIG_H
 #define PROJECT_CONFIG_H
 
+#include "sdkconfig.h"
 #include "driver/gpio.h"
 #include "driver/adc.h"
 
@@ -45,13 +46,22 @@
 #define DISPLAY_TASK_STACK_SIZE     4096
 #define ALERT_TASK_STACK_SIZE       4096
 #define OTA_TASK_STACK_SIZE         4096
+#define PROFILER_TASK_STACK_SIZE    3072
+#define BOOT_WORKER_STACK_SIZE      6144    // Runs any boot stage, RainMaker init included
+#define COOP_SCHED_STACK_SIZE       5120    // Sensor+alert+display+OTA jobs, see below
+#define BACKLOG_TASK_STACK_SIZE     3072
+#define BACKLOG_READER_STACK_SIZE   3072
 
 // Task Priorities (higher number = higher priority)
 #define SENSOR_TASK_PRIORITY        5
 #define CLOUD_TASK_PRIORITY         4
 #define DISPLAY_TASK_PRIORITY       3
 #define ALERT_TASK_PRIORITY         6       // Highest priority
-#define OTA_TASK_PRIORITY           2       // Lowest priority
+#define OTA_TASK_PRIORITY           2
+#define PROFILER_TASK_PRIORITY      1       // Lowest priority, just above idle
+#define BOOT_WORKER_PRIORITY        1       // Same as the main task it helps
+#define COOP_SCHED_PRIORITY         5
+#define BACKLOG_TASK_PRIORITY       2       // Replay and its reader, below live telemetry
 
 // Task Core Assignments (ESP32-C3 is single core, but kept for compatibility)
 #define SENSOR_TASK_CORE            0
@@ -59,18 +69,122 @@
 #define DISPLAY_TASK_CORE           0
 #define ALERT_TASK_CORE             0
 #define OTA_TASK_CORE               0
+#define PROFILER_TASK_CORE          0
+#define BOOT_WORKER_CORE            0
+#define COOP_SCHED_CORE             0
+#define BACKLOG_TASK_CORE           0
 
 // Queue Sizes
 #define SENSOR_DATA_QUEUE_SIZE      10
 
 // Timing Configuration (in milliseconds)
+// Default sample interval; "Sample Interval" in RainMaker overrides it at
+// runtime (see sample_interval.h)
+#ifdef CONFIG_SENSOR_READ_INTERVAL_SEC
+#define SENSOR_READ_INTERVAL_MS     (CONFIG_SENSOR_READ_INTERVAL_SEC * 1000)
+#else
 #define SENSOR_READ_INTERVAL_MS     10000   // 10 seconds
-#define DISPLAY_UPDATE_INTERVAL_MS  2000    // 2 seconds
-#define ALERT_CHECK_INTERVAL_MS     2000    // 2 seconds
+#endif
+#define DISPLAY_UPDATE_INTERVAL_MS  2000    // 2 seconds, fastest display refresh
+#define ALERT_CHECK_INTERVAL_MS     2000    // 2 seconds, fastest alert check
 #define OTA_CHECK_INTERVAL_MS       60000   // 60 seconds
+#define PROFILER_INTERVAL_MS        30000   // 30 seconds
+#define METRICS_FLUSH_INTERVAL_MS   60000   // 60 seconds, batched Insights metrics
+#define SAMPLE_CONSUMER_DIVISOR     5       // Display refreshes/alert checks per sample
+#define CLOUD_CONNECT_WAIT_MS       30000   // Cloud task holds samples this long at boot
+#define BOOT_GRAPH_WORKERS          2       // Boot stage workers, app_main included
+
+// Sample interval limits; Min/Max Interval in RainMaker override the first
+// two at runtime (ENABLE_ADAPTIVE_SAMPLING)
+#define SAMPLE_INTERVAL_MIN_MS      2000    // DHT11 needs 2 s between reads
+#define SAMPLE_INTERVAL_MAX_MS      300000  // 5 minutes while stable
+#define SAMPLE_INTERVAL_LIMIT_MS    3600000 // Largest interval accepted
+
+// Change between samples that counts as significant, and distance to an
+// alert threshold inside which sampling stays at the minimum interval
+#define ADAPTIVE_TEMP_STEP          0.5f    // °C
+#define ADAPTIVE_HUMIDITY_STEP      2.0f    // %
+#define ADAPTIVE_LUX_STEP_PCT       20      // % of the previous light level
+#define ADAPTIVE_LUX_STEP_MIN       20      // lux
+#define ADAPTIVE_TEMP_BAND          1.0f    // °C
+#define ADAPTIVE_HUMIDITY_BAND      3.0f    // %
+#define ADAPTIVE_AQI_BAND           15
+
+// Cooperative scheduler job phases: spread jobs with equal periods apart so a
+// slow step (e.g. the ~25 ms OLED upload) does not delay the next job
+#define COOP_SENSOR_PHASE_MS        0
+#define COOP_ALERT_PHASE_MS         100
+#define COOP_DISPLAY_PHASE_MS       200
+#define COOP_OTA_PHASE_MS           300
+
+// Deep-sleep duty cycle (ENABLE_DEEP_SLEEP_MODE); the wake interval is the
+// configured Sample Interval
+#define DEEP_SLEEP_UPLOAD_EVERY     30      // Sample wakes per upload
+#define DEEP_SLEEP_RING_SIZE        64      // Samples buffered in RTC memory
+#define DEEP_SLEEP_CONNECT_TIMEOUT_MS 20000 // Give up an upload after this
+#define DEEP_SLEEP_FLUSH_MS         1000    // MQTT flush before sleeping
+
+// Batched uplink (see uplink_batch.h); the window is set in menuconfig and
+// with the "uplink" console command, 0 publishes every sample
+#ifdef CONFIG_UPLINK_WINDOW_SEC
+#define UPLINK_WINDOW_MS            (CONFIG_UPLINK_WINDOW_SEC * 1000)
+#else
+#define UPLINK_WINDOW_MS            60000   // 1 minute
+#endif
+#define UPLINK_WINDOW_LIMIT_MS      3600000 // Largest window accepted
+#define UPLINK_BATCH_SIZE           32      // Samples held; a full batch goes out early
+#define UPLINK_BURST_TAIL_MS        300     // Radio stays on after a burst for the PUBACKs
+#define UPLINK_RETRY_MS             10000   // Next try after a flush found the cloud down
+#define UPLINK_CBOR_TOPIC           "tlm/cbor"  // Under node/<node_id>/ (ENABLE_CBOR_UPLINK)
+#define UPLINK_CBOR_QOS             1
+
+// Local LAN query API (ENABLE_LOCAL_API, see local_api.h)
+#define LOCAL_API_PORT              8080
+#define LOCAL_API_HISTORY_SAMPLES   512     // 12 bytes each (6 KB); ~85 min at 10 s
+#define LOCAL_API_PAGE_SAMPLES      256     // Records per "history" read (~3 KB)
+#define LOCAL_API_STATS_WINDOW_MS   3600000 // "stats" covers the last hour
+
+// Local HTTP dashboard (ENABLE_HTTP_DASH, see http_dash.h)
+#define HTTP_DASH_PORT              80
+#define HTTP_DASH_SSE_CLIENTS       4       // Event streams open at once
+#define HTTP_DASH_CHUNK_SIZE        1436    // History/event write; one TCP segment
+
+// Prometheus scrape endpoint (ENABLE_PROM_METRICS, see prom_metrics.h)
+#define PROM_RENDER_SIZE            6144    // Whole /metrics response
+#define PROM_MAX_TASKS              16      // task_stack_free_bytes series
+
+// Cloud publish rate limit (see cloud_rate.h). RainMaker's MQTT broker is
+// AWS IoT Core, which throttles a connection above 100 publishes/s; stay
+// at a tenth of that, with room for an uplink burst plus an alert.
+#define CLOUD_RATE_BURST            20      // Messages
+#define CLOUD_RATE_PER_SEC          10
+#define CLOUD_RATE_SAMPLE_MESSAGES  4       // Parameter reports per published sample
+#define CLOUD_RATE_POINT_MESSAGES   2       // Time-series message plus params report (ENABLE_TS_AGGREGATE)
+
+// Time-series history points (ENABLE_TS_AGGREGATE, see ts_aggregate.h)
+#define TS_AGGREGATE_INTERVAL_MS    300000  // One min/avg/max point per 5 minutes
+#define TS_AGGREGATE_PENDING        12      // Points kept while the cloud is down (1 hour)
+#define TS_AGGREGATE_MSG_SIZE       4096    // Holds every pending point of the 9 params
+#define TS_AGGREGATE_TOPIC          "tsdata"    // Under node/<node_id>/, RainMaker's own
+
+// Offline sample backlog in flash (ENABLE_BACKLOG, see backlog.h)
+#define BACKLOG_PARTITION_LABEL     "backlog"   // partitions.csv
+#define BACKLOG_BATCH_BYTES         4096    // Replay message buffer, two of them
+#define BACKLOG_BATCH_SAMPLES       225     // Most whose worst case fits BACKLOG_BATCH_BYTES
+#define BACKLOG_ANCHORS             8       // Boots whose Unix time offset is kept
+#define BACKLOG_RETRY_MS            10000   // After a replay publish failed
+
+// Persistent outbox (ENABLE_OUTBOX, see outbox.h)
+#define OUTBOX_SLOTS                8       // ~150 bytes each in one NVS blob
+#define OUTBOX_PAYLOAD_SIZE         128     // Fits a full alert message
+#define OUTBOX_TELEMETRY_SAVE_MS    300000  // Telemetry-only changes hit flash at most this often
+#define OUTBOX_RETRY_MS             1000    // Cloud task retries a refused entry this soon
+
+// Warm-start cache (ENABLE_WARM_START)
+#define WARM_CACHE_MAX_AGE_MS       600000  // Older than this is not shown at boot
 
 // Alert Configuration
-#define NOTIFICATION_COOLDOWN_MS    60000   // 1 minute between notifications
+#define NOTIFICATION_COOLDOWN_MS    60000   // 1 minute between notifications of one alert type
 
 // Default Alert Thresholds
 #define DEFAULT_TEMP_HIGH           35.0f   // °C
@@ -82,6 +196,10 @@
 // Sensor Configuration
 #define DHT11_MAX_RETRIES           3
 #define LDR_SAMPLE_COUNT            10
+#define LDR_DEFAULT_FULL_SCALE_LUX  1000    // Lux at ADC 4095 until the LDR is calibrated
+
+// Profiler Configuration
+#define PROFILER_MAX_TASKS          20      // Upper bound on tasks sampled per pass
 
 // ADC Configuration
 #define ADC_ATTEN                   ADC_ATTEN_DB_11
@@ -108,5 +226,99 @@
 #define ENABLE_CLOUD_DEBUG          1
 #define ENABLE_DISPLAY_DEBUG        0
 #define ENABLE_ALERT_DEBUG          1
+#define ENABLE_PROFILER             1       // Per-task CPU/stack/heap metrics
+#define ENABLE_PROFILER_DEBUG       0       // Log every profiler sample
+#define ENABLE_SAMPLE_CAPTURE       0       // Log raw samples for sim/ replay
+#define ENABLE_PERF_BENCH           1       // "perf" console microbenchmarks
+
+// Vary the sensor interval with signal activity (see adaptive_sampling.h);
+// 0 samples every SENSOR_READ_INTERVAL_MS
+#ifndef ENABLE_ADAPTIVE_SAMPLING
+#define ENABLE_ADAPTIVE_SAMPLING    1
+#endif
+
+// Keep the last samples and alert state in RTC memory across resets, so the
+// display and alerts resume at once after a reboot or OTA restart
+#ifndef ENABLE_WARM_START
+#define ENABLE_WARM_START           1
+#endif
+
+// Overlap independent boot stages (display, sensors, Wi-Fi association) on
+// BOOT_GRAPH_WORKERS tasks; 0 runs them one after another (see boot_graph.h)
+#ifndef ENABLE_PARALLEL_BOOT
+#define ENABLE_PARALLEL_BOOT        1
+#endif
+
+// Battery mode: sample on RTC timer wakes from deep sleep, buffer in RTC
+// memory and bring Wi-Fi up only to upload a batch (see sleep_logger.h).
+// Replaces the task set; the display stays off.
+#ifndef ENABLE_DEEP_SLEEP_MODE
+#define ENABLE_DEEP_SLEEP_MODE      0
+#endif
+
+// Run the sensor, alert, display and OTA-monitor work as jobs on one
+// cooperative scheduler task instead of four tasks (saves ~11 KB of stacks).
+// Cloud publishing keeps its own task. The host simulation builds both ways.
+#ifndef ENABLE_COOP_SCHEDULER
+#define ENABLE_COOP_SCHEDULER       0
+#endif
+
+// Serve current and historical samples on the LAN over esp_local_ctrl
+// (see local_api.h); not started in deep-sleep mode
+#ifndef ENABLE_LOCAL_API
+#define ENABLE_LOCAL_API            1
+#endif
+
+// Dashboard page, CSV/JSON history export and live Server-Sent Events over
+// HTTP (see http_dash.h); reads the ENABLE_LOCAL_API history ring
+#ifndef ENABLE_HTTP_DASH
+#define ENABLE_HTTP_DASH            1
+#endif
+
+#if ENABLE_HTTP_DASH && !ENABLE_LOCAL_API
+#error "ENABLE_HTTP_DASH needs ENABLE_LOCAL_API"
+#endif
+
+// Send uplink bursts of 2+ samples as one CBOR message (telemetry_cbor.h)
+// instead of RainMaker parameter reports per sample
+#ifndef ENABLE_CBOR_UPLINK
+#define ENABLE_CBOR_UPLINK          1
+#endif
+
+// Prometheus /metrics on the dashboard server (see prom_metrics.h)
+#ifndef ENABLE_PROM_METRICS
+#define ENABLE_PROM_METRICS         1
+#endif
+
+// Queue alerts, alert clears and the last offline reading in NVS until
+// the cloud takes them (see outbox.h)
+#ifndef ENABLE_OUTBOX
+#define ENABLE_OUTBOX               1
+#endif
+
+// Keep samples an outage pushes out of the uplink batch in flash and
+// replay them afterwards (see backlog.h)
+#ifndef ENABLE_BACKLOG
+#define ENABLE_BACKLOG              1
+#endif
+
+// Report Temperature, Humidity and AQI as time-series params, one min/avg/max
+// point per TS_AGGREGATE_INTERVAL_MS, instead of every sample; the samples
+// go in the CBOR batches only (see ts_aggregate.h)
+#ifndef ENABLE_TS_AGGREGATE
+#define ENABLE_TS_AGGREGATE         1
+#endif
+
+#if ENABLE_TS_AGGREGATE && !ENABLE_CBOR_UPLINK
+#error "ENABLE_TS_AGGREGATE needs ENABLE_CBOR_UPLINK"
+#endif
+
+#if ENABLE_BACKLOG && !ENABLE_CBOR_UPLINK
+#error "ENABLE_BACKLOG needs ENABLE_CBOR_UPLINK"
+#endif
+
+#if ENABLE_PROM_METRICS && !ENABLE_HTTP_DASH
+#error "ENABLE_PROM_METRICS needs ENABLE_HTTP_DASH"
+#endif
 
 #endif // PROJECT_CONFIG_H
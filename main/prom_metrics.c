@@ -0,0 +1,333 @@
+/**
+ * @file prom_metrics.c
+ * @brief Prometheus scrape endpoint (/metrics) for device and pipeline metrics
+ *
+ * Counter updates are relaxed atomic adds; the histogram takes a short
+ * critical section so a scrape never sees a bucket without its sum. The
+ * render runs on the HTTP server task into a static buffer and writes
+ * whole lines only, so a buffer that turns out too small truncates the
+ * output at a series boundary instead of corrupting it.
+ */
+
+#include "prom_metrics.h"
+#include "project_config.h"
+#include "sensor_task.h"
+#include "alert_task.h"
+#include "profiler_task.h"
+#include "sample_interval.h"
+#include "app_wifi.h"
+#include "cloud_rate.h"
+#include "backlog.h"
+#include "ts_aggregate.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_wifi.h>
+
+static const char *TAG = "PROM_METRICS";
+
+#define PREFIX                  "envlogger_"
+#define ALERT_TYPE_COUNT        (ALERT_AQI_HIGH + 1)
+
+// ============================================
+// REGISTRY
+// ============================================
+
+typedef struct {
+    const char *name;
+    const char *help;
+} prom_desc_t;
+
+static const prom_desc_t counter_desc[PROM_COUNTER_COUNT] = {
+    [PROM_SAMPLES] = { PREFIX "samples_total", "Sensor samples taken" },
+    [PROM_QUEUE_DROPS] = { PREFIX "queue_drops_total",
+                           "Samples dropped because the sensor queue was full" },
+    [PROM_DHT_RETRIES] = { PREFIX "dht_retries_total", "DHT11 reads that failed and were retried" },
+    [PROM_DHT_FAILURES] = { PREFIX "dht_failures_total",
+                            "Sensor cycles where every DHT11 retry failed" },
+    [PROM_PUBLISHES] = { PREFIX "publishes_total", "RainMaker parameter publishes" },
+    [PROM_UPLINK_BURSTS] = { PREFIX "uplink_bursts_total", "Batched uplink bursts sent" },
+};
+
+static atomic_uint_fast32_t counters[PROM_COUNTER_COUNT];
+
+static const char *const alert_label[ALERT_TYPE_COUNT] = {
+    [ALERT_NONE] = "none",
+    [ALERT_TEMP_HIGH] = "temp_high",
+    [ALERT_TEMP_LOW] = "temp_low",
+    [ALERT_HUMIDITY_HIGH] = "humidity_high",
+    [ALERT_HUMIDITY_LOW] = "humidity_low",
+    [ALERT_AQI_HIGH] = "aqi_high",
+};
+
+static atomic_uint_fast32_t alert_transitions[ALERT_TYPE_COUNT];
+
+// Upper bounds of the publish latency buckets; one more bucket for +Inf
+static const uint32_t bucket_us[] = {
+    5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+};
+#define BUCKET_COUNT            (sizeof(bucket_us) / sizeof(bucket_us[0]))
+
+typedef struct {
+    uint32_t buckets[BUCKET_COUNT + 1];     // Not cumulative; summed at render
+    uint32_t count;
+    uint64_t sum_us;
+} histogram_t;
+
+static histogram_t publish_latency;
+static portMUX_TYPE histogram_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t last_render_us;
+static uint32_t last_render_bytes;
+
+void prom_metrics_inc(prom_counter_t counter)
+{
+    atomic_fetch_add_explicit(&counters[counter], 1, memory_order_relaxed);
+}
+
+void prom_metrics_alert(int alert)
+{
+    if (alert >= 0 && alert < ALERT_TYPE_COUNT) {
+        atomic_fetch_add_explicit(&alert_transitions[alert], 1, memory_order_relaxed);
+    }
+}
+
+void prom_metrics_observe_publish(uint32_t latency_us)
+{
+    size_t b = 0;
+    while (b < BUCKET_COUNT && latency_us > bucket_us[b]) {
+        b++;
+    }
+
+    taskENTER_CRITICAL(&histogram_lock);
+    publish_latency.buckets[b]++;
+    publish_latency.count++;
+    publish_latency.sum_us += latency_us;
+    taskEXIT_CRITICAL(&histogram_lock);
+}
+
+// ============================================
+// RENDER
+// ============================================
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool full;
+} writer_t;
+
+// Append one or more whole lines, or nothing
+static void put(writer_t *w, const char *fmt, ...)
+{
+    if (w->full) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= w->size - w->len) {
+        w->buf[w->len] = '\0';
+        w->full = true;
+        return;
+    }
+    w->len += (size_t)n;
+}
+
+static void put_head(writer_t *w, const char *name, const char *type, const char *help)
+{
+    put(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void put_gauge(writer_t *w, const char *name, const char *help, double value)
+{
+    put_head(w, name, "gauge", help);
+    put(w, "%s %.10g\n", name, value);
+}
+
+static void render_histogram(writer_t *w)
+{
+    histogram_t h;
+    taskENTER_CRITICAL(&histogram_lock);
+    h = publish_latency;
+    taskEXIT_CRITICAL(&histogram_lock);
+
+    const char *name = PREFIX "publish_latency_seconds";
+    put_head(w, name, "histogram", "Time spent in one RainMaker parameter publish");
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        cumulative += h.buckets[b];
+        put(w, "%s_bucket{le=\"%g\"} %lu\n", name, bucket_us[b] / 1e6, (unsigned long)cumulative);
+    }
+    put(w, "%s_bucket{le=\"+Inf\"} %lu\n", name, (unsigned long)h.count);
+    put(w, "%s_sum %.6f\n%s_count %lu\n", name, h.sum_us / 1e6, name, (unsigned long)h.count);
+}
+
+static void render_tasks(writer_t *w)
+{
+#if ENABLE_PROFILER
+    static profiler_entry_t tasks[PROM_MAX_TASKS];
+    int n = profiler_get_snapshot(tasks, PROM_MAX_TASKS);
+    if (n <= 0) {
+        return;
+    }
+    const char *name = PREFIX "task_stack_free_bytes";
+    put_head(w, name, "gauge", "Stack high-water mark per task (bytes never used)");
+    for (int i = 0; i < n; i++) {
+        put(w, "%s{task=\"%s\"} %lu\n", name, tasks[i].name, (unsigned long)tasks[i].stack_free);
+    }
+#endif
+}
+
+static void render_wifi(writer_t *w)
+{
+    app_wifi_stats_t wifi;
+    app_wifi_get_stats(&wifi);
+
+    put_gauge(w, PREFIX "wifi_connected", "1 while the station has an IP", wifi.connected);
+    put_head(w, PREFIX "wifi_disconnects_total", "counter", "Connections lost after getting an IP");
+    put(w, PREFIX "wifi_disconnects_total %lu\n", (unsigned long)wifi.disconnects);
+
+    wifi_ap_record_t ap;
+    if (wifi.connected && esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        put_gauge(w, PREFIX "wifi_rssi_dbm", "Signal strength of the current AP", ap.rssi);
+    }
+}
+
+static void render_cloud_rate(writer_t *w)
+{
+    cloud_rate_stats_t rate;
+    cloud_rate_get_stats(&rate);
+
+    put_gauge(w, PREFIX "cloud_rate_tokens", "Publish tokens left in the cloud rate bucket",
+              rate.tokens_milli / 1e3);
+    put_head(w, PREFIX "cloud_rate_throttled_total", "counter",
+             "Publishes that waited for the cloud rate limit");
+    put(w, PREFIX "cloud_rate_throttled_total %lu\n", (unsigned long)rate.throttled);
+    put_head(w, PREFIX "cloud_rate_denied_total", "counter",
+             "Publishes given up at the cloud rate limit, to be retried");
+    put(w, PREFIX "cloud_rate_denied_total %lu\n", (unsigned long)rate.denied);
+}
+
+static void render_backlog(writer_t *w)
+{
+#if ENABLE_BACKLOG
+    backlog_stats_t bl;
+    backlog_get_stats(&bl);
+
+    put_gauge(w, PREFIX "backlog_pending_samples", "Offline samples in flash not yet replayed",
+              bl.pending);
+    put_head(w, PREFIX "backlog_replayed_samples_total", "counter",
+             "Offline samples replayed to the cloud");
+    put(w, PREFIX "backlog_replayed_samples_total %lu\n", (unsigned long)bl.replayed);
+    put_head(w, PREFIX "backlog_lost_samples_total", "counter",
+             "Offline samples overwritten before they were replayed");
+    put(w, PREFIX "backlog_lost_samples_total %lu\n", (unsigned long)bl.lost);
+#endif
+}
+
+static void render_ts_aggregate(writer_t *w)
+{
+#if ENABLE_TS_AGGREGATE
+    ts_aggregate_stats_t ts;
+    ts_aggregate_get_stats(&ts);
+
+    put_gauge(w, PREFIX "ts_points_pending", "Time-series points waiting for the cloud",
+              ts.pending);
+    put_head(w, PREFIX "ts_points_published_total", "counter",
+             "Min/avg/max time-series points published");
+    put(w, PREFIX "ts_points_published_total %lu\n", (unsigned long)ts.published);
+    put_head(w, PREFIX "ts_points_skipped_total", "counter",
+             "Time-series points closed before SNTP time or pushed out while offline");
+    put(w, PREFIX "ts_points_skipped_total %lu\n", (unsigned long)ts.skipped);
+#endif
+}
+
+static void render_latest(writer_t *w)
+{
+    sensor_data_t s;
+    if (!sensor_get_latest(&s)) {
+        return;
+    }
+    put_gauge(w, PREFIX "temperature_celsius", "Latest temperature", s.temperature);
+    put_gauge(w, PREFIX "humidity_percent", "Latest relative humidity", s.humidity);
+    put_gauge(w, PREFIX "aqi", "Latest air quality index estimate", s.aqi);
+    put_gauge(w, PREFIX "light_lux", "Latest light level", s.light_lux);
+}
+
+size_t prom_metrics_render(char *buf, size_t size)
+{
+    int64_t start = esp_timer_get_time();
+    writer_t w = { .buf = buf, .size = size };
+
+    for (int i = 0; i < PROM_COUNTER_COUNT; i++) {
+        put_head(&w, counter_desc[i].name, "counter", counter_desc[i].help);
+        put(&w, "%s %lu\n", counter_desc[i].name,
+            (unsigned long)atomic_load_explicit(&counters[i], memory_order_relaxed));
+    }
+
+    const char *name = PREFIX "alert_transitions_total";
+    put_head(&w, name, "counter", "Alert state changes by new state (none: cleared)");
+    for (int i = 0; i < ALERT_TYPE_COUNT; i++) {
+        put(&w, "%s{to=\"%s\"} %lu\n", name, alert_label[i],
+            (unsigned long)atomic_load_explicit(&alert_transitions[i], memory_order_relaxed));
+    }
+
+    render_histogram(&w);
+
+    put_gauge(&w, PREFIX "uptime_seconds", "Time since boot", esp_timer_get_time() / 1e6);
+    put_gauge(&w, PREFIX "sample_interval_seconds", "Configured sample interval",
+              sample_interval_get_ms() / 1e3);
+    put_gauge(&w, PREFIX "heap_free_bytes", "Free heap", esp_get_free_heap_size());
+    put_gauge(&w, PREFIX "heap_min_free_bytes", "Lowest free heap since boot",
+              esp_get_minimum_free_heap_size());
+    render_tasks(&w);
+    render_wifi(&w);
+    render_cloud_rate(&w);
+    render_backlog(&w);
+    render_ts_aggregate(&w);
+    render_latest(&w);
+    put_gauge(&w, PREFIX "metrics_render_seconds", "Time the previous scrape took to render",
+              last_render_us / 1e6);
+    put_gauge(&w, PREFIX "metrics_render_bytes", "Size of the previous scrape",
+              last_render_bytes);
+
+    if (w.full) {
+        ESP_LOGW(TAG, "Render cut at %u bytes; raise PROM_RENDER_SIZE", (unsigned)w.len);
+    }
+    last_render_us = (uint32_t)(esp_timer_get_time() - start);
+    last_render_bytes = (uint32_t)w.len;
+    return w.len;
+}
+
+// ============================================
+// HTTP HANDLER
+// ============================================
+
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    static char buf[PROM_RENDER_SIZE];     // Server task only
+
+    size_t len = prom_metrics_render(buf, sizeof(buf));
+    httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+    return httpd_resp_send(req, buf, (ssize_t)len);
+}
+
+esp_err_t prom_metrics_register_uri(httpd_handle_t server)
+{
+    const httpd_uri_t uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler,
+    };
+    esp_err_t err = httpd_register_uri_handler(server, &uri);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Handler /metrics not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
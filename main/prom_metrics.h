@@ -0,0 +1,63 @@
+/**
+ * @file prom_metrics.h
+ * @brief Prometheus scrape endpoint (/metrics) for device and pipeline metrics
+ *
+ * Counters and the publish latency histogram live in a fixed registry of
+ * atomics, fed by the app_metrics record functions; the tasks pay one
+ * relaxed add per event. Gauges (heap, stack watermarks, RSSI, latest
+ * readings) are read when a scrape renders. The render writes the
+ * Prometheus text format (0.0.4) into one static PROM_RENDER_SIZE buffer:
+ * no heap allocation per scrape, and a fixed set of series (task labels
+ * capped at PROM_MAX_TASKS) bounds the render time.
+ *
+ * The handler is served by the dashboard's HTTP server (http_dash.h).
+ */
+
+#ifndef PROM_METRICS_H
+#define PROM_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+typedef enum {
+    PROM_SAMPLES,
+    PROM_QUEUE_DROPS,
+    PROM_DHT_RETRIES,
+    PROM_DHT_FAILURES,
+    PROM_PUBLISHES,
+    PROM_UPLINK_BURSTS,
+    PROM_COUNTER_COUNT
+} prom_counter_t;
+
+/**
+ * @brief Add one to a counter
+ */
+void prom_metrics_inc(prom_counter_t counter);
+
+/**
+ * @brief Count a change of alert state
+ *
+ * @param alert New alert_type_t, ALERT_NONE when an alert cleared
+ */
+void prom_metrics_alert(int alert);
+
+/**
+ * @brief Put one publish latency into the histogram
+ */
+void prom_metrics_observe_publish(uint32_t latency_us);
+
+/**
+ * @brief Render every series into buf
+ *
+ * @return Bytes written; the output is cut at a whole line if buf is too small
+ */
+size_t prom_metrics_render(char *buf, size_t size);
+
+/**
+ * @brief Register GET /metrics on a running server
+ */
+esp_err_t prom_metrics_register_uri(httpd_handle_t server);
+
+#endif // PROM_METRICS_H
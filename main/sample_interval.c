@@ -0,0 +1,140 @@
+/**
+ * @file sample_interval.c
+ * @brief Runtime sample interval implementation
+ *
+ * Display and alert run SAMPLE_CONSUMER_DIVISOR times per sensor cycle, no
+ * faster than their own floor (DISPLAY_UPDATE_INTERVAL_MS and
+ * ALERT_CHECK_INTERVAL_MS). At the default 10 s interval this reproduces
+ * the fixed 2 s periods; on a quiet site with a long interval they slow
+ * down with the sensor instead of redrawing the same sample.
+ */
+
+#include "sample_interval.h"
+#include "project_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <nvs.h>
+
+static const char *TAG = "SAMPLE_INTERVAL";
+
+#define SAMPLE_NVS_NAMESPACE    "sampling"
+#define SAMPLE_NVS_KEY          "interval_s"
+
+static portMUX_TYPE timing_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t configured_ms = SENSOR_READ_INTERVAL_MS;
+static sample_timing_t timing = {
+    .sensor_ms = SENSOR_READ_INTERVAL_MS,
+    .display_ms = DISPLAY_UPDATE_INTERVAL_MS,
+    .alert_ms = ALERT_CHECK_INTERVAL_MS,
+};
+
+// ============================================
+// HELPERS
+// ============================================
+
+static bool interval_valid(uint32_t interval_ms)
+{
+    // The DHT11 needs 2 s between reads; the retries of one cycle
+    // (DHT11_MAX_RETRIES attempts 500 ms apart) fit inside that
+    return interval_ms % 1000 == 0 &&
+           interval_ms >= SAMPLE_INTERVAL_MIN_MS &&
+           interval_ms <= SAMPLE_INTERVAL_LIMIT_MS;
+}
+
+static uint32_t consumer_period(uint32_t sensor_ms, uint32_t floor_ms)
+{
+    uint32_t period = sensor_ms / SAMPLE_CONSUMER_DIVISOR;
+    return period > floor_ms ? period : floor_ms;
+}
+
+static void apply_interval(uint32_t interval_ms)
+{
+    sample_timing_t next = {
+        .sensor_ms = interval_ms,
+        .display_ms = consumer_period(interval_ms, DISPLAY_UPDATE_INTERVAL_MS),
+        .alert_ms = consumer_period(interval_ms, ALERT_CHECK_INTERVAL_MS),
+    };
+
+    taskENTER_CRITICAL(&timing_lock);
+    configured_ms = interval_ms;
+    timing = next;
+    taskEXIT_CRITICAL(&timing_lock);
+}
+
+static esp_err_t save_interval(uint32_t interval_ms)
+{
+    nvs_handle_t handle;
+
+    esp_err_t err = nvs_open(SAMPLE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS open failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = nvs_set_u32(handle, SAMPLE_NVS_KEY, interval_ms / 1000);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Saving sample interval failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+esp_err_t sample_interval_init(void)
+{
+    nvs_handle_t handle;
+    uint32_t stored_s = 0;
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+
+    if (nvs_open(SAMPLE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        err = nvs_get_u32(handle, SAMPLE_NVS_KEY, &stored_s);
+        nvs_close(handle);
+    }
+
+    uint32_t interval_ms = SENSOR_READ_INTERVAL_MS;
+    if (err == ESP_OK && interval_valid(stored_s * 1000)) {
+        interval_ms = stored_s * 1000;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Stored sample interval unusable, using default");
+    }
+
+    apply_interval(interval_ms);
+
+    ESP_LOGI(TAG, "Sample interval %lu s", interval_ms / 1000);
+    return ESP_OK;
+}
+
+esp_err_t sample_interval_set(uint32_t interval_ms, bool persist)
+{
+    if (!interval_valid(interval_ms)) {
+        ESP_LOGW(TAG, "Rejected sample interval %lu ms", interval_ms);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    apply_interval(interval_ms);
+
+    ESP_LOGI(TAG, "Sample interval %lu s", interval_ms / 1000);
+    return persist ? save_interval(interval_ms) : ESP_OK;
+}
+
+uint32_t sample_interval_get_ms(void)
+{
+    taskENTER_CRITICAL(&timing_lock);
+    uint32_t interval_ms = configured_ms;
+    taskEXIT_CRITICAL(&timing_lock);
+    return interval_ms;
+}
+
+void sample_interval_get_timing(sample_timing_t *out)
+{
+    taskENTER_CRITICAL(&timing_lock);
+    *out = timing;
+    taskEXIT_CRITICAL(&timing_lock);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file sample_interval.h
+ * @brief Runtime sample interval (RainMaker "Sample Interval")
+ *
+ * One configured interval drives the sensor cycle and, derived from it, the
+ * display refresh and alert check periods. The three periods are published
+ * together as one sample_timing_t, so a task never sees a new sensor period
+ * with an old display or alert period. Changes apply from each task's next
+ * wake-up; no restart is needed.
+ *
+ * With ENABLE_ADAPTIVE_SAMPLING the sensor cycle moves on its own, but the
+ * display and alert periods stay tied to the configured interval so a
+ * fast-changing sample is not left waiting for a slowed-down consumer.
+ */
+
+#ifndef SAMPLE_INTERVAL_H
+#define SAMPLE_INTERVAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t sensor_ms;         // Sensor cycle start to next cycle start
+    uint32_t display_ms;        // Display refresh period
+    uint32_t alert_ms;          // Alert check period
+} sample_timing_t;
+
+/**
+ * @brief Load the interval from NVS (SENSOR_READ_INTERVAL_MS if none)
+ *
+ * Call after nvs_flash_init().
+ */
+esp_err_t sample_interval_init(void);
+
+/**
+ * @brief Validate and apply a new configured interval
+ *
+ * @param interval_ms New interval, whole seconds
+ * @param persist Also write it to NVS
+ * @return ESP_ERR_INVALID_ARG unless the interval is a whole number of
+ *         seconds within SAMPLE_INTERVAL_MIN_MS..SAMPLE_INTERVAL_LIMIT_MS
+ */
+esp_err_t sample_interval_set(uint32_t interval_ms, bool persist);
+
+/**
+ * @brief Configured interval in milliseconds
+ */
+uint32_t sample_interval_get_ms(void);
+
+/**
+ * @brief Copy the current periods
+ */
+void sample_interval_get_timing(sample_timing_t *out);
+
+#endif // SAMPLE_INTERVAL_H
@@ -4,32 +4,30 @@
 #include <driver/gpio.h>
 #include <driver/adc.h>
 #include <esp_log.h>
-#include <esp_adc_cal.h>
 #include <esp_random.h>
 #include "sensor_task.h"
 #include "project_config.h"
 #include "dht11.h"
+#include "app_metrics.h"
+#include "dlog.h"
+#include "evtrace.h"
+#include "push_button.h"
+#include "calibration.h"
+#include "adaptive_sampling.h"
+#include "sample_interval.h"
+#include "warm_cache.h"
+#include "boot_graph.h"
+#include "local_api.h"
+#include "http_dash.h"
+#include "cloud_task.h"
 
 static const char *TAG = "SENSOR_TASK";
 
-// GPIO definitions
-#define DHT11_GPIO GPIO_NUM_4
-#define LDR_ADC_CHANNEL ADC1_CHANNEL_3  // GPIO3
-#define BUTTON_GPIO GPIO_NUM_5
-
 // External references
 extern QueueHandle_t sensor_data_queue;
 
-// Sensor data structure
-typedef struct {
-    float temperature;
-    float humidity;
-    int aqi;
-    uint32_t timestamp;
-} sensor_data_t;
-
-// ADC calibration
-static esp_adc_cal_characteristics_t adc_chars;
+// Button events (long press toggles calibration mode)
+static QueueHandle_t button_events = NULL;
 
 // ============================================
 // AIR QUALITY CALCULATION (Creative Solution)
@@ -43,7 +41,7 @@ static esp_adc_cal_characteristics_t adc_chars;
  * - Low light levels indoors may indicate poor ventilation → higher AQI
  * - Optimal conditions: 20-25°C, 40-60% humidity → lowest AQI
  */
-static int calculate_aqi(float temp, float humidity, int light_level)
+int calculate_aqi(float temp, float humidity, int light_level)
 {
     int aqi = 50; // Base "Good" AQI
     
@@ -75,8 +73,8 @@ static int calculate_aqi(float temp, float humidity, int light_level)
     if (aqi < 0) aqi = 0;
     if (aqi > 500) aqi = 500;
     
-    ESP_LOGI(TAG, "AQI calculation: T=%.1f, H=%.1f, L=%d → AQI=%d", 
-             temp, humidity, light_level, aqi);
+    DLOGI(TAG, "AQI calculation: T=%.1f, H=%.1f, L=%d → AQI=%d", 
+          temp, humidity, light_level, aqi);
     
     return aqi;
 }
@@ -96,38 +94,31 @@ void sensor_init(void)
     adc1_config_width(ADC_WIDTH_BIT_12);  // 0-4095
     adc1_config_channel_atten(LDR_ADC_CHANNEL, ADC_ATTEN_DB_11);  // 0-3.3V range
     
-    // Characterize ADC
-    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 
-                             1100, &adc_chars);
+    // Per-device calibration and the LDR lookup table
+    calibration_init();
+    sample_interval_init();
     
-    // Initialize button
-    gpio_config_t btn_cfg = {
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&btn_cfg);
+    // Button events from the push button service (app_driver_init)
+    button_events = xQueueCreate(4, sizeof(push_button_event_t));
+    if (button_events == NULL || push_button_subscribe(button_events) != ESP_OK) {
+        ESP_LOGW(TAG, "Button events unavailable, calibration mode disabled");
+    }
     
     ESP_LOGI(TAG, "Sensors initialized successfully");
 }
 
 // ============================================
-// DHT11 READING WITH RETRY
+// DHT11 READING
 // ============================================
 
-static bool read_dht11_with_retry(float *temp, float *humidity, int max_retries)
+static bool read_dht11(float *temp, float *humidity)
 {
-    for (int i = 0; i < max_retries; i++) {
-        if (dht11_read(temp, humidity) == ESP_OK) {
-            // Validate readings
-            if (*temp >= -40.0 && *temp <= 80.0 && 
-                *humidity >= 0.0 && *humidity <= 100.0) {
-                return true;
-            }
+    if (dht11_read(temp, humidity) == ESP_OK) {
+        // Validate readings
+        if (*temp >= -40.0 && *temp <= 80.0 && 
+            *humidity >= 0.0 && *humidity <= 100.0) {
+            return true;
         }
-        vTaskDelay(pdMS_TO_TICKS(500));  // Wait before retry
     }
     return false;
 }
@@ -146,9 +137,7 @@ static int read_ldr(void)
     }
     adc_reading /= 10;
     
-    // Convert to voltage (optional, for logging)
-    uint32_t voltage = esp_adc_cal_raw_to_voltage(adc_reading, &adc_chars);
-    ESP_LOGD(TAG, "LDR: ADC=%lu, Voltage=%lumV", adc_reading, voltage);
+    ESP_LOGD(TAG, "LDR: ADC=%lu", adc_reading);
     
     return (int)adc_reading;
 }
@@ -157,9 +146,232 @@ static int read_ldr(void)
 // BUTTON MANUAL CALIBRATION
 // ============================================
 
-static bool button_pressed(void)
+// Long press toggles calibration mode. The button service detects it the
+// moment the threshold is reached; the queue is drained once per cycle, so
+// it never delays the sample schedule.
+static void check_calibration_button(void)
+{
+    push_button_event_t event;
+    
+    if (button_events == NULL) {
+        return;
+    }
+    
+    while (xQueueReceive(button_events, &event, 0) == pdTRUE) {
+        if (event.type == PUSH_BUTTON_LONG) {
+            calibration_toggle_mode();
+        }
+    }
+}
+
+// ============================================
+// SAMPLING STATE MACHINE
+// ============================================
+
+typedef enum {
+    SENSOR_STATE_START = 0,     // Button events at the top of a cycle
+    SENSOR_STATE_DHT,           // One DHT11 attempt, retried after a pause
+    SENSOR_STATE_FINISH,        // LDR, AQI and hand-off of the sample
+} sensor_state_t;
+
+static sensor_state_t state = SENSOR_STATE_START;
+static uint32_t cycle_ms = 0;           // Pauses already taken this cycle
+static int dht_attempts = 0;
+static bool dht_ok = false;
+static uint32_t interval_ms = SENSOR_READ_INTERVAL_MS;  // This cycle to the next
+
+// Last readings, reused when the DHT11 fails
+static float last_temperature = 25.0;
+static float last_humidity = 50.0;
+
+// Latest complete sample, for consumers that do not use the queue
+static portMUX_TYPE latest_lock = portMUX_INITIALIZER_UNLOCKED;
+static sensor_data_t latest_sample;
+static bool latest_valid = false;
+
+static uint32_t pause(uint32_t ms)
+{
+    cycle_ms += ms;
+    return ms;
+}
+
+static void finish_sample(void)
+{
+    sensor_data_t sensor_data;
+    
+    if (dht_ok) {
+        DLOGI(TAG, "DHT11: Temperature=%.1f°C, Humidity=%.1f%%", 
+              last_temperature, last_humidity);
+    } else {
+        ESP_LOGW(TAG, "DHT11 read failed, using previous values");
+        app_metrics_record_dht_failure();
+    }
+    
+    // Read LDR (Light Level)
+    TRACE_BEGIN(LDR_READ);
+    int light_level = read_ldr();
+    TRACE_END(LDR_READ);
+    DLOGI(TAG, "Light Level: %d/4095", light_level);
+    
+#if ENABLE_SAMPLE_CAPTURE
+    // "t_ms,temperature,humidity,light" - input format of the host replay
+    DLOGI("CAPTURE", "%lu,%.1f,%.1f,%d",
+          (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
+          last_temperature, last_humidity, light_level);
+#endif
+    
+    // Apply per-device calibration (raw values stay for the next fallback)
+    float temperature = last_temperature;
+    float humidity = last_humidity;
+    calibration_note_raw(temperature, humidity, light_level);
+    calibration_apply_dht(&temperature, &humidity);
+    
+    // Calculate AQI based on environmental factors
+    TRACE_BEGIN(AQI_CALC);
+    int aqi = calculate_aqi(temperature, humidity, light_level);
+    TRACE_END(AQI_CALC);
+    
+    // Prepare sensor data structure
+    sensor_data.temperature = temperature;
+    sensor_data.humidity = humidity;
+    sensor_data.aqi = aqi;
+    sensor_data.light_lux = calibration_ldr_lux(light_level);
+    sensor_data.timestamp = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    
+#if ENABLE_ADAPTIVE_SAMPLING
+    interval_ms = adaptive_sampling_update(&sensor_data);
+    app_metrics_record_sample_interval(interval_ms);
+#else
+    // Picks up a new "Sample Interval" from this cycle on
+    sample_timing_t timing;
+    sample_interval_get_timing(&timing);
+    interval_ms = timing.sensor_ms;
+#endif
+    
+    taskENTER_CRITICAL(&latest_lock);
+    latest_sample = sensor_data;
+    latest_valid = true;
+    taskEXIT_CRITICAL(&latest_lock);
+    
+#if ENABLE_WARM_START
+    warm_cache_push(&sensor_data);
+#endif
+#if ENABLE_LOCAL_API
+    local_api_record(&sensor_data);
+#endif
+#if ENABLE_HTTP_DASH
+    http_dash_notify();
+#endif
+    boot_graph_mark(BOOT_MARK_FIRST_SAMPLE);
+    
+    if (sensor_data_queue == NULL) {
+        return;     // One-shot sample (sensor_sample_once) before the queue exists
+    }
+    
+    // Send data to queue (non-blocking)
+    BaseType_t sent = xQueueSend(sensor_data_queue, &sensor_data, 0);
+    TRACE_INSTANT(QUEUE_SEND, sent == pdTRUE);
+    if (sent != pdTRUE) {
+        ESP_LOGW(TAG, "Sensor data queue full, data dropped");
+        app_metrics_record_queue_drop();
+    } else {
+        DLOGI(TAG, "Sensor data sent to queue");
+        cloud_task_notify();
+    }
+}
+
+uint32_t sensor_task_step(void)
+{
+    switch (state) {
+        case SENSOR_STATE_START:
+            cycle_ms = 0;
+            dht_attempts = 0;
+            state = SENSOR_STATE_DHT;
+            check_calibration_button();
+            // fall through
+            
+        case SENSOR_STATE_DHT:
+            if (dht_attempts == 0) {
+                TRACE_BEGIN(SENSOR_CYCLE);
+            }
+            
+            // Read DHT11 (Temperature & Humidity)
+            TRACE_BEGIN(DHT_READ);
+            dht_ok = read_dht11(&last_temperature, &last_humidity);
+            TRACE_END(DHT_READ);
+            
+            if (!dht_ok) {
+                if (++dht_attempts >= DHT11_MAX_RETRIES) {
+                    state = SENSOR_STATE_FINISH;
+                } else {
+                    app_metrics_record_dht_retry();
+                }
+                return pause(500);  // Wait before retry
+            }
+            // fall through
+            
+        case SENSOR_STATE_FINISH:
+        default:
+            finish_sample();
+            TRACE_END(SENSOR_CYCLE);
+            state = SENSOR_STATE_START;
+            
+            // Next cycle starts one read interval after this one did
+            return cycle_ms < interval_ms ? interval_ms - cycle_ms : 1;
+    }
+}
+
+bool sensor_sample_once(sensor_data_t *out)
 {
-    return (gpio_get_level(BUTTON_GPIO) == 0);  // Active LOW
+    // Run one whole cycle, sleeping through the retry pauses
+    state = SENSOR_STATE_START;
+    do {
+        uint32_t ms = sensor_task_step();
+        if (state != SENSOR_STATE_START) {
+            vTaskDelay(pdMS_TO_TICKS(ms));
+        }
+    } while (state != SENSOR_STATE_START);
+    
+    sensor_get_latest(out);
+    return dht_ok;
+}
+
+bool sensor_get_latest(sensor_data_t *out)
+{
+    taskENTER_CRITICAL(&latest_lock);
+    bool valid = latest_valid;
+    if (valid) {
+        *out = latest_sample;
+    }
+    taskEXIT_CRITICAL(&latest_lock);
+    return valid;
+}
+
+void sensor_seed_latest(const sensor_data_t *sample)
+{
+    taskENTER_CRITICAL(&latest_lock);
+    if (!latest_valid) {
+        latest_sample = *sample;
+        latest_valid = true;
+    }
+    taskEXIT_CRITICAL(&latest_lock);
+}
+
+bool sensor_get_new(uint32_t *seen_ms, sensor_data_t *out)
+{
+    taskENTER_CRITICAL(&latest_lock);
+    bool fresh = latest_valid && latest_sample.timestamp != *seen_ms;
+    if (fresh) {
+        *out = latest_sample;
+        *seen_ms = latest_sample.timestamp;
+    }
+    taskEXIT_CRITICAL(&latest_lock);
+    return fresh;
+}
+
+uint32_t sensor_get_interval_ms(void)
+{
+    return interval_ms;
 }
 
 // ============================================
@@ -170,65 +382,10 @@ void sensor_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Sensor task started");
     
-    sensor_data_t sensor_data;
     TickType_t last_wake_time = xTaskGetTickCount();
-    const TickType_t read_interval = pdMS_TO_TICKS(10000);  // Every 10 seconds
-    
-    // Variables for sensor readings
-    float temperature = 25.0;
-    float humidity = 50.0;
-    int light_level = 2000;
-    int aqi = 50;
-    
-    // Calibration mode flag
-    bool calibration_mode = false;
-    uint32_t button_press_time = 0;
     
     while (1) {
-        // Check for button long press (3 seconds) to enter calibration mode
-        if (button_pressed()) {
-            if (button_press_time == 0) {
-                button_press_time = xTaskGetTickCount();
-            } else if ((xTaskGetTickCount() - button_press_time) > pdMS_TO_TICKS(3000)) {
-                calibration_mode = !calibration_mode;
-                ESP_LOGI(TAG, "Calibration mode: %s", 
-                         calibration_mode ? "ENABLED" : "DISABLED");
-                button_press_time = 0;
-                vTaskDelay(pdMS_TO_TICKS(1000));  // Debounce
-            }
-        } else {
-            button_press_time = 0;
-        }
-        
-        // Read DHT11 (Temperature & Humidity)
-        if (read_dht11_with_retry(&temperature, &humidity, 3)) {
-            ESP_LOGI(TAG, "DHT11: Temperature=%.1f°C, Humidity=%.1f%%", 
-                     temperature, humidity);
-        } else {
-            ESP_LOGW(TAG, "DHT11 read failed, using previous values");
-        }
-        
-        // Read LDR (Light Level)
-        light_level = read_ldr();
-        ESP_LOGI(TAG, "Light Level: %d/4095", light_level);
-        
-        // Calculate AQI based on environmental factors
-        aqi = calculate_aqi(temperature, humidity, light_level);
-        
-        // Prepare sensor data structure
-        sensor_data.temperature = temperature;
-        sensor_data.humidity = humidity;
-        sensor_data.aqi = aqi;
-        sensor_data.timestamp = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
-        
-        // Send data to queue (non-blocking)
-        if (xQueueSend(sensor_data_queue, &sensor_data, 0) != pdTRUE) {
-            ESP_LOGW(TAG, "Sensor data queue full, data dropped");
-        } else {
-            ESP_LOGI(TAG, "Sensor data sent to queue");
-        }
-        
-        // Wait for next read interval (precise timing)
-        vTaskDelayUntil(&last_wake_time, read_interval);
+        // Wait for next step (precise timing, relative to the last wake)
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(sensor_task_step()));
     }
 }
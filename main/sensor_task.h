@@ -7,6 +7,7 @@
 #define SENSOR_TASK_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
  * @brief Sensor data structure shared between tasks
@@ -15,14 +16,82 @@ typedef struct {
     float temperature;      // Temperature in Celsius
     float humidity;         // Humidity in percentage
     int aqi;               // Air Quality Index (0-500)
+    uint16_t light_lux;    // Calibrated light level in lux
     uint32_t timestamp;    // Timestamp in milliseconds
 } sensor_data_t;
 
 /**
- * @brief Initialize sensor hardware (DHT11, LDR, ADC)
+ * @brief Estimate AQI from temperature, humidity and light level
+ * 
+ * @param temp Temperature in Celsius
+ * @param humidity Relative humidity in percent
+ * @param light_level Raw LDR ADC reading (0-4095)
+ * @return AQI (0-500), including a small random variation
+ */
+int calculate_aqi(float temp, float humidity, int light_level);
+
+/**
+ * @brief Initialize sensor hardware (DHT11, LDR, ADC) and load calibration
  */
 void sensor_init(void);
 
+/**
+ * @brief Run one step of the sampling cycle
+ * 
+ * A cycle is: calibration button check, DHT11 read (up to DHT11_MAX_RETRIES
+ * attempts 500 ms apart), LDR read, AQI, then the sample goes to the queue.
+ * Cycles start the configured sample interval apart (sample_interval.h), or
+ * at the adaptive interval with ENABLE_ADAPTIVE_SAMPLING. Never blocks; the pauses are returned instead.
+ * 
+ * @return Milliseconds from this step's due time to the next step
+ */
+uint32_t sensor_task_step(void);
+
+/**
+ * @brief Take one complete sample now, blocking through DHT11 retries
+ * 
+ * For the deep-sleep wake path, where no task loop runs. Before the sensor
+ * queue exists the sample is not queued.
+ * 
+ * @param[out] out The sample
+ * @return false if the DHT11 failed and the previous values were reused
+ */
+bool sensor_sample_once(sensor_data_t *out);
+
+/**
+ * @brief Copy the most recent complete sample
+ * 
+ * @param[out] out Latest sample
+ * @return false until the first cycle has completed, unless a warm-start
+ *         sample was restored
+ */
+bool sensor_get_latest(sensor_data_t *out);
+
+/**
+ * @brief Make a sample from before a reset the latest until the first cycle
+ * 
+ * For the warm-start cache; does nothing once a cycle has completed.
+ */
+void sensor_seed_latest(const sensor_data_t *sample);
+
+/**
+ * @brief Copy the most recent sample if the caller has not had it yet
+ * 
+ * For consumers that run more often than the sensor, so the same sample
+ * is not handled twice.
+ * 
+ * @param[in,out] seen_ms Timestamp of the sample the caller last took,
+ *                        0 for none; updated when a newer one is copied
+ * @param[out] out Latest sample
+ * @return false if no sample has completed since *seen_ms
+ */
+bool sensor_get_new(uint32_t *seen_ms, sensor_data_t *out);
+
+/**
+ * @brief Time from the latest cycle to the next, adaptive interval included
+ */
+uint32_t sensor_get_interval_ms(void);
+
 /**
  * @brief Main sensor task function
  * 
@@ -0,0 +1,247 @@
+/**
+ * @file sleep_logger.c
+ * @brief Deep-sleep duty-cycled logging implementation
+ *
+ * The ring and its counters are RTC_DATA_ATTR: they survive deep sleep and
+ * start out zeroed after any other reset. A sample costs one 12-byte record,
+ * so DEEP_SLEEP_RING_SIZE records use well under 1 KB of RTC memory. Wakes
+ * are scheduled against the RTC clock (next_wake_us), so the time spent
+ * awake does not stretch the interval.
+ */
+
+#include "sleep_logger.h"
+#include "project_config.h"
+#include "sensor_task.h"
+#include "alert_task.h"
+#include "cloud_task.h"
+#include "sample_interval.h"
+#include "telemetry_cbor.h"
+#include "outbox.h"
+#include <math.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_sleep.h>
+#include <esp_rtc_time.h>
+
+static const char *TAG = "SLEEP_LOGGER";
+
+// One buffered sample, packed for RTC memory
+typedef struct {
+    uint32_t time_ms;           // RTC clock, ms since power-on
+    int16_t temp_dc;            // 0.1 °C
+    uint16_t hum_dc;            // 0.1 %
+    uint16_t aqi;
+    uint16_t light_lux;
+} sleep_record_t;
+
+typedef struct {
+    uint64_t next_wake_us;      // RTC time the next wake is due
+    uint16_t head;              // Next record to write
+    uint16_t count;
+    uint16_t wakes_since_upload;
+    bool in_alert;              // Last sample was in alert
+    sleep_logger_stats_t stats;
+    sleep_record_t records[DEEP_SLEEP_RING_SIZE];
+} sleep_ring_t;
+
+RTC_DATA_ATTR static sleep_ring_t ring;
+
+#if ENABLE_CBOR_UPLINK
+static uint8_t cbor_buf[TELEMETRY_CBOR_SIZE(DEEP_SLEEP_RING_SIZE)];
+#endif
+
+// ============================================
+// RING
+// ============================================
+
+static void ring_push(const sensor_data_t *s)
+{
+    sleep_record_t *r = &ring.records[ring.head];
+
+    r->time_ms = (uint32_t)(esp_rtc_get_time_us() / 1000);
+    r->temp_dc = (int16_t)lroundf(s->temperature * 10.0f);
+    r->hum_dc = (uint16_t)lroundf(s->humidity * 10.0f);
+    r->aqi = (uint16_t)s->aqi;
+    r->light_lux = s->light_lux;
+
+    ring.head = (ring.head + 1) % DEEP_SLEEP_RING_SIZE;
+    if (ring.count < DEEP_SLEEP_RING_SIZE) {
+        ring.count++;
+    } else {
+        ring.stats.overwritten++;
+    }
+}
+
+static void ring_get(uint16_t i, sensor_data_t *out)
+{
+    // i = 0 is the oldest record
+    const sleep_record_t *r =
+        &ring.records[(ring.head + DEEP_SLEEP_RING_SIZE - ring.count + i) % DEEP_SLEEP_RING_SIZE];
+
+    out->temperature = r->temp_dc / 10.0f;
+    out->humidity = r->hum_dc / 10.0f;
+    out->aqi = r->aqi;
+    out->light_lux = r->light_lux;
+    out->timestamp = r->time_ms;
+}
+
+#if ENABLE_CBOR_UPLINK
+// The whole ring as one CBOR batch
+static bool upload_cbor(void)
+{
+    sensor_data_t sample;
+    telemetry_cbor_t enc;
+
+    ring_get(0, &sample);
+    telemetry_cbor_begin(&enc, cbor_buf, sizeof(cbor_buf), ring.count,
+                         (uint32_t)(esp_rtc_get_time_us() / 1000), telemetry_cbor_epoch(),
+                         sample.timestamp);
+    for (uint16_t i = 0; i < ring.count; i++) {
+        ring_get(i, &sample);
+        telemetry_cbor_add(&enc, &sample);
+    }
+
+    size_t len = telemetry_cbor_end(&enc);
+    esp_err_t err = len ? cloud_publish_batch(cbor_buf, len) : ESP_ERR_NO_MEM;
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "CBOR batch not published (%s), sending parameters",
+                 esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+#endif
+
+// ============================================
+// SLEEP
+// ============================================
+
+static void __attribute__((noreturn)) sleep_until_next_wake(void)
+{
+    uint64_t now_us = esp_rtc_get_time_us();
+    uint64_t interval_us = (uint64_t)sample_interval_get_ms() * 1000;
+
+    ring.next_wake_us += interval_us;
+    if (ring.next_wake_us <= now_us) {
+        // Power-on, or awake longer than one interval (upload): restart the grid
+        ring.next_wake_us = now_us + interval_us;
+    }
+
+    uint64_t sleep_us = ring.next_wake_us - now_us;
+    ESP_LOGI(TAG, "Deep sleep for %llu ms (%u buffered)", sleep_us / 1000, ring.count);
+
+    esp_sleep_enable_timer_wakeup(sleep_us);
+    esp_deep_sleep_start();
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+bool sleep_logger_upload_due(uint32_t wakes_since_upload, uint32_t buffered,
+                             bool alert_started, uint32_t upload_every)
+{
+    return alert_started ||
+           wakes_since_upload >= upload_every ||
+           buffered >= DEEP_SLEEP_RING_SIZE;
+}
+
+void sleep_logger_wake(void)
+{
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER) {
+        // Power-on or reset: full boot (provisioning, OTA check), then sleep
+        ESP_LOGI(TAG, "Cold start, uploading before the first sleep");
+        return;
+    }
+
+    ring.stats.wakes++;
+
+    sensor_data_t sample;
+    sensor_sample_once(&sample);
+    ring_push(&sample);
+    ring.wakes_since_upload++;
+
+    bool in_alert = alert_check_thresholds(&sample) != ALERT_NONE;
+    bool alert_started = in_alert && !ring.in_alert;
+    ring.in_alert = in_alert;
+
+    if (sleep_logger_upload_due(ring.wakes_since_upload, ring.count, alert_started,
+                                DEEP_SLEEP_UPLOAD_EVERY)) {
+        ESP_LOGI(TAG, "Upload wake: %u buffered%s", ring.count,
+                 alert_started ? ", alert" : "");
+        return;
+    }
+    sleep_until_next_wake();
+}
+
+void sleep_logger_upload(void)
+{
+    if (!cloud_task_wait_connected(DEEP_SLEEP_CONNECT_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "Cloud not reached in %d ms, keeping %u samples",
+                 DEEP_SLEEP_CONNECT_TIMEOUT_MS, ring.count);
+        ring.stats.upload_failures++;
+        sleep_until_next_wake();
+    }
+
+    sensor_data_t sample;
+    // Notification for an alert that started while asleep, ahead of the
+    // samples so it finds the rate bucket full
+    if (ring.count > 0 && ring.in_alert) {
+        ring_get(ring.count - 1, &sample);
+        alert_process_sample(&sample);
+    }
+#if ENABLE_OUTBOX
+    // No cloud task in this mode: send what the alert step queued, and
+    // anything left from earlier uploads
+    outbox_flush();
+#endif
+    
+#if ENABLE_TS_AGGREGATE
+    // Every sample in the CBOR batch; the params get one history point
+    // for the whole upload
+    if (ring.count > 0 && !upload_cbor()) {
+        ring.stats.upload_failures++;
+        sleep_until_next_wake();
+    }
+    ts_window_t window;
+    ts_point_t point;
+    ts_window_reset(&window);
+    for (uint16_t i = 0; i < ring.count; i++) {
+        ring_get(i, &sample);
+        ts_window_add(&window, &sample);
+    }
+    if (ts_window_point(&window, (uint32_t)(esp_rtc_get_time_us() / 1000), &point) &&
+        point.epoch != 0) {
+        cloud_publish_points(&point, 1);
+    }
+#else
+    // Oldest first, so the params end on the newest values
+    uint16_t first = 0;
+#if ENABLE_CBOR_UPLINK
+    if (ring.count >= 2 && upload_cbor()) {
+        first = ring.count - 1;     // Only the newest as parameters
+    }
+#endif
+    for (uint16_t i = first; i < ring.count; i++) {
+        ring_get(i, &sample);
+        cloud_publish_sample(&sample);
+    }
+#endif
+
+    ESP_LOGI(TAG, "Uploaded %u samples", ring.count);
+    ring.stats.uploads++;
+    ring.count = 0;
+    ring.wakes_since_upload = 0;
+
+    // Let the MQTT client flush the reports before the radio goes down
+    vTaskDelay(pdMS_TO_TICKS(DEEP_SLEEP_FLUSH_MS));
+    sleep_until_next_wake();
+}
+
+void sleep_logger_get_stats(sleep_logger_stats_t *out)
+{
+    *out = ring.stats;
+    out->buffered = ring.count;
+}
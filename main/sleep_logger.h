@@ -0,0 +1,62 @@
+/**
+ * @file sleep_logger.h
+ * @brief Deep-sleep duty-cycled logging (ENABLE_DEEP_SLEEP_MODE)
+ *
+ * For battery deployments: the chip wakes on the RTC timer, takes one
+ * sample, appends it to a ring in RTC memory and goes straight back to deep
+ * sleep. Only every DEEP_SLEEP_UPLOAD_EVERY wakes, when the ring is full or
+ * when a reading crosses an alert threshold does a wake run the full boot,
+ * bring up Wi-Fi and RainMaker and upload the batch.
+ */
+
+#ifndef SLEEP_LOGGER_H
+#define SLEEP_LOGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t wakes;                 // Timer wakes since power-on
+    uint32_t uploads;               // Batches delivered
+    uint32_t upload_failures;       // Upload wakes that could not connect
+    uint32_t overwritten;           // Samples lost to a full ring
+    uint16_t buffered;              // Samples waiting in the ring
+} sleep_logger_stats_t;
+
+/**
+ * @brief Take this wake's sample and decide whether to upload
+ *
+ * Call early in app_main, after sensor_init(). Returns only when this boot
+ * should upload (power-on, batch due, or an alert started); otherwise the
+ * chip goes back to deep sleep from inside this call.
+ */
+void sleep_logger_wake(void);
+
+/**
+ * @brief Publish the buffered samples and go back to deep sleep
+ *
+ * Call at the end of app_main once RainMaker and Wi-Fi are started, with
+ * cloud_task_register_events() in place. Waits up to
+ * DEEP_SLEEP_CONNECT_TIMEOUT_MS for the cloud connection; on timeout
+ * the batch stays in the ring for the next upload. Does not return.
+ */
+void sleep_logger_upload(void);
+
+/**
+ * @brief Upload policy, shared with the host energy model
+ *
+ * @param wakes_since_upload Sample wakes since the last delivered batch
+ * @param buffered Samples in the ring, this wake's included
+ * @param alert_started This wake's sample is in alert and the last was not
+ * @param upload_every Wakes per upload (DEEP_SLEEP_UPLOAD_EVERY on target)
+ * @return true if this wake should bring up the radio
+ */
+bool sleep_logger_upload_due(uint32_t wakes_since_upload, uint32_t buffered,
+                             bool alert_started, uint32_t upload_every);
+
+/**
+ * @brief Copy the counters kept in RTC memory
+ */
+void sleep_logger_get_stats(sleep_logger_stats_t *out);
+
+#endif // SLEEP_LOGGER_H
@@ -0,0 +1,153 @@
+/**
+ * @file telemetry_cbor.c
+ * @brief CBOR encoding of sample batches for bulk uploads
+ *
+ * Only the few CBOR items the format needs: unsigned and negative
+ * integers, one-letter text keys, a definite-length map and arrays.
+ */
+
+#include "telemetry_cbor.h"
+#include <math.h>
+#include <time.h>
+
+#define MAJOR_UINT      0x00
+#define MAJOR_NINT      0x20
+#define MAJOR_TEXT      0x60
+#define MAJOR_ARRAY     0x80
+#define MAJOR_MAP       0xa0
+
+#define SAMPLE_FIELDS   5
+
+#define TIME_SYNCED_AFTER       1577836800  // 2020-01-01; earlier means no SNTP yet
+
+// ============================================
+// ITEMS
+// ============================================
+
+// Initial byte plus argument, shortest form
+static void put_head(telemetry_cbor_t *enc, uint8_t major, uint32_t value)
+{
+    uint8_t head[5];
+    size_t n;
+    if (value < 24) {
+        head[0] = major | (uint8_t)value;
+        n = 1;
+    } else if (value <= 0xff) {
+        head[0] = major | 24;
+        head[1] = (uint8_t)value;
+        n = 2;
+    } else if (value <= 0xffff) {
+        head[0] = major | 25;
+        head[1] = (uint8_t)(value >> 8);
+        head[2] = (uint8_t)value;
+        n = 3;
+    } else {
+        head[0] = major | 26;
+        head[1] = (uint8_t)(value >> 24);
+        head[2] = (uint8_t)(value >> 16);
+        head[3] = (uint8_t)(value >> 8);
+        head[4] = (uint8_t)value;
+        n = 5;
+    }
+
+    if (enc->len + n > enc->size) {
+        enc->overflow = true;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        enc->buf[enc->len + i] = head[i];
+    }
+    enc->len += n;
+}
+
+static void put_int(telemetry_cbor_t *enc, int32_t value)
+{
+    if (value >= 0) {
+        put_head(enc, MAJOR_UINT, (uint32_t)value);
+    } else {
+        put_head(enc, MAJOR_NINT, (uint32_t)(-1 - value));
+    }
+}
+
+static void put_key(telemetry_cbor_t *enc, char key)
+{
+    put_head(enc, MAJOR_TEXT, 1);
+    if (enc->len < enc->size) {
+        enc->buf[enc->len++] = (uint8_t)key;
+    } else {
+        enc->overflow = true;
+    }
+}
+
+// ============================================
+// BATCH
+// ============================================
+
+uint32_t telemetry_cbor_epoch(void)
+{
+    time_t now = time(NULL);
+    return now > TIME_SYNCED_AFTER ? (uint32_t)now : 0;
+}
+
+static void begin_map(telemetry_cbor_t *enc, uint8_t *buf, size_t size, uint16_t count,
+                      uint32_t now_ms, uint32_t epoch_s, uint32_t first_ms, uint32_t keys)
+{
+    *enc = (telemetry_cbor_t){
+        .buf = buf,
+        .size = size,
+        .last_ms = first_ms,
+        .count = count,
+    };
+
+    put_head(enc, MAJOR_MAP, keys);
+    put_key(enc, 'v');
+    put_head(enc, MAJOR_UINT, TELEMETRY_CBOR_VERSION);
+    put_key(enc, 'n');
+    put_head(enc, MAJOR_UINT, now_ms);
+    put_key(enc, 'e');
+    put_head(enc, MAJOR_UINT, epoch_s);
+    put_key(enc, 't');
+    put_head(enc, MAJOR_UINT, first_ms);
+}
+
+void telemetry_cbor_begin(telemetry_cbor_t *enc, uint8_t *buf, size_t size, uint16_t count,
+                          uint32_t now_ms, uint32_t epoch_s, uint32_t first_ms)
+{
+    begin_map(enc, buf, size, count, now_ms, epoch_s, first_ms, 5);
+    put_key(enc, 's');
+    put_head(enc, MAJOR_ARRAY, count);
+}
+
+void telemetry_cbor_begin_replay(telemetry_cbor_t *enc, uint8_t *buf, size_t size,
+                                 uint16_t count, uint32_t now_ms, uint32_t epoch_s,
+                                 uint32_t first_ms, uint16_t boot, bool gap)
+{
+    begin_map(enc, buf, size, count, now_ms, epoch_s, first_ms, 7);
+    put_key(enc, 'b');
+    put_head(enc, MAJOR_UINT, boot);
+    put_key(enc, 'g');
+    put_head(enc, MAJOR_UINT, gap);
+    put_key(enc, 's');
+    put_head(enc, MAJOR_ARRAY, count);
+}
+
+void telemetry_cbor_add(telemetry_cbor_t *enc, const sensor_data_t *sample)
+{
+    put_head(enc, MAJOR_ARRAY, SAMPLE_FIELDS);
+    put_head(enc, MAJOR_UINT, sample->timestamp - enc->last_ms);
+    put_int(enc, (int32_t)lroundf(sample->temperature * 10.0f));
+    put_int(enc, (int32_t)lroundf(sample->humidity * 10.0f));
+    put_int(enc, sample->aqi);
+    put_head(enc, MAJOR_UINT, sample->light_lux);
+
+    enc->last_ms = sample->timestamp;
+    enc->added++;
+}
+
+size_t telemetry_cbor_end(telemetry_cbor_t *enc)
+{
+    if (enc->overflow || enc->added != enc->count) {
+        return 0;
+    }
+    return enc->len;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file telemetry_cbor.h
+ * @brief CBOR encoding of sample batches for bulk uploads
+ *
+ * One batch is a CBOR map (RFC 8949) with one-letter text keys:
+ *
+ *   "v": 1            format version
+ *   "n": uint         device tick time of the encode, ms
+ *   "e": uint         Unix time of the encode, 0 before SNTP sync
+ *   "t": uint         tick time of the first sample, ms
+ *   "s": [[dt, temp_dc, hum_dc, aqi, lux], ...]
+ *
+ * Backlog replay batches (backlog.h) add two keys before "s":
+ *
+ *   "b": uint         boot number the samples were taken in
+ *   "g": 0 or 1       1: the device restarted after the sample sent before
+ *
+ * dt is the time since the previous sample in ms (0 for the first); the
+ * readings are integers in 0.1 °C, 0.1 %RH, AQI and lux. Samples are written
+ * straight from sensor_data_t into the caller's buffer as CBOR integers, in
+ * their shortest form, so there is no float formatting and no allocation.
+ * A sample takes at most TELEMETRY_CBOR_SAMPLE_MAX bytes, about 14 at a 10 s
+ * interval.
+ *
+ * tools/tlm_decode.py decodes batches (or a concatenation of them) on the host.
+ */
+
+#ifndef TELEMETRY_CBOR_H
+#define TELEMETRY_CBOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_task.h"
+
+#define TELEMETRY_CBOR_VERSION      1
+#define TELEMETRY_CBOR_HEAD_MAX     40      // Map and keys, largest values, replay keys
+#define TELEMETRY_CBOR_SAMPLE_MAX   18      // Array head, 5 s32/u32 worst case
+
+/**
+ * @brief Buffer size that always holds a batch of n samples
+ */
+#define TELEMETRY_CBOR_SIZE(n)      (TELEMETRY_CBOR_HEAD_MAX + TELEMETRY_CBOR_SAMPLE_MAX * (n))
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    uint32_t last_ms;
+    uint16_t count;             // Samples announced by begin
+    uint16_t added;
+    bool overflow;
+} telemetry_cbor_t;
+
+/**
+ * @brief Unix time now, 0 before SNTP has set the clock
+ *
+ * The "e" key here; the outbox, local API and backlog stamp records with it too.
+ */
+uint32_t telemetry_cbor_epoch(void);
+
+/**
+ * @brief Start a batch of exactly count samples in buf
+ *
+ * @param now_ms   Tick time of the encode (same clock as sample timestamps)
+ * @param epoch_s  Unix time of the encode, 0 if not known
+ * @param first_ms Timestamp of the first sample that will be added
+ */
+void telemetry_cbor_begin(telemetry_cbor_t *enc, uint8_t *buf, size_t size, uint16_t count,
+                          uint32_t now_ms, uint32_t epoch_s, uint32_t first_ms);
+
+/**
+ * @brief Start a backlog replay batch: as telemetry_cbor_begin, plus "b" and "g"
+ *
+ * @param boot Boot number of every sample in the batch
+ * @param gap  The device restarted since the sample sent before this batch
+ */
+void telemetry_cbor_begin_replay(telemetry_cbor_t *enc, uint8_t *buf, size_t size,
+                                 uint16_t count, uint32_t now_ms, uint32_t epoch_s,
+                                 uint32_t first_ms, uint16_t boot, bool gap);
+
+/**
+ * @brief Append one sample, oldest first
+ */
+void telemetry_cbor_add(telemetry_cbor_t *enc, const sensor_data_t *sample);
+
+/**
+ * @brief Finish the batch
+ *
+ * @return Encoded length, 0 if buf was too small or the sample count is off
+ */
+size_t telemetry_cbor_end(telemetry_cbor_t *enc);
+
+#endif // TELEMETRY_CBOR_H
@@ -0,0 +1,195 @@
+/**
+ * @file ts_aggregate.c
+ * @brief Min/avg/max aggregation for the RainMaker time-series params
+ *
+ * The open window belongs to the cloud task. The pending ring and the
+ * stats are shared with the console, under a spinlock.
+ */
+
+#include "ts_aggregate.h"
+#include "telemetry_cbor.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_console.h>
+
+static const char *TAG = "TS_AGG";
+
+static ts_window_t window;              // Cloud task only
+static ts_point_t ring[TS_AGGREGATE_PENDING];
+static uint16_t ring_head = 0;          // Oldest pending point
+static uint16_t ring_count = 0;
+static ts_aggregate_stats_t stats;
+static portMUX_TYPE agg_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// ============================================
+// WINDOW
+// ============================================
+
+void ts_window_reset(ts_window_t *w)
+{
+    *w = (ts_window_t){0};
+}
+
+void ts_window_add(ts_window_t *w, const sensor_data_t *sample)
+{
+    if (w->samples == 0) {
+        w->temp_min = w->temp_max = sample->temperature;
+        w->hum_min = w->hum_max = sample->humidity;
+        w->aqi_min = w->aqi_max = sample->aqi;
+        w->start_ms = sample->timestamp;
+    }
+    if (sample->temperature < w->temp_min) w->temp_min = sample->temperature;
+    if (sample->temperature > w->temp_max) w->temp_max = sample->temperature;
+    if (sample->humidity < w->hum_min) w->hum_min = sample->humidity;
+    if (sample->humidity > w->hum_max) w->hum_max = sample->humidity;
+    if (sample->aqi < w->aqi_min) w->aqi_min = sample->aqi;
+    if (sample->aqi > w->aqi_max) w->aqi_max = sample->aqi;
+    w->temp_sum += sample->temperature;
+    w->hum_sum += sample->humidity;
+    w->aqi_sum += sample->aqi;
+    w->end_ms = sample->timestamp;
+    w->samples++;
+}
+
+bool ts_window_point(const ts_window_t *w, uint32_t now, ts_point_t *out)
+{
+    if (w->samples == 0) {
+        return false;
+    }
+    uint32_t epoch = telemetry_cbor_epoch();
+    uint32_t age_s = (now - w->end_ms) / 1000;
+
+    out->temp_min = w->temp_min;
+    out->temp_avg = (float)(w->temp_sum / w->samples);
+    out->temp_max = w->temp_max;
+    out->hum_min = w->hum_min;
+    out->hum_avg = (float)(w->hum_sum / w->samples);
+    out->hum_max = w->hum_max;
+    out->aqi_min = w->aqi_min;
+    out->aqi_avg = (int)((w->aqi_sum + w->samples / 2) / w->samples);
+    out->aqi_max = w->aqi_max;
+    out->samples = w->samples;
+    out->epoch = epoch > age_s ? epoch - age_s : 0;
+    return true;
+}
+
+// ============================================
+// CLOUD TASK WINDOW
+// ============================================
+
+// The point of the window just closed, into the pending ring
+static void queue_point(void)
+{
+    ts_point_t point;
+    ts_window_point(&window, now_ms(), &point);
+    ESP_LOGD(TAG, "Point of %u samples: T %.1f/%.1f/%.1f", point.samples,
+             point.temp_min, point.temp_avg, point.temp_max);
+
+    taskENTER_CRITICAL(&agg_lock);
+    stats.points++;
+    if (point.epoch == 0) {
+        stats.skipped++;            // RainMaker could not place it
+    } else {
+        if (ring_count == TS_AGGREGATE_PENDING) {
+            ring_head = (ring_head + 1) % TS_AGGREGATE_PENDING;
+            ring_count--;
+            stats.skipped++;
+        }
+        ring[(ring_head + ring_count) % TS_AGGREGATE_PENDING] = point;
+        ring_count++;
+    }
+    taskEXIT_CRITICAL(&agg_lock);
+}
+
+bool ts_aggregate_add(const sensor_data_t *sample)
+{
+    bool closed = window.samples > 0 &&
+                  sample->timestamp - window.start_ms >= TS_AGGREGATE_INTERVAL_MS;
+    if (closed) {
+        queue_point();
+        ts_window_reset(&window);
+    }
+    ts_window_add(&window, sample);
+
+    taskENTER_CRITICAL(&agg_lock);
+    stats.samples++;
+    stats.open_samples = window.samples;
+    taskEXIT_CRITICAL(&agg_lock);
+    return closed;
+}
+
+uint16_t ts_aggregate_peek(ts_point_t *out, uint16_t max)
+{
+    taskENTER_CRITICAL(&agg_lock);
+    uint16_t count = ring_count < max ? ring_count : max;
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = ring[(ring_head + i) % TS_AGGREGATE_PENDING];
+    }
+    taskEXIT_CRITICAL(&agg_lock);
+    return count;
+}
+
+void ts_aggregate_ack(uint16_t count)
+{
+    taskENTER_CRITICAL(&agg_lock);
+    if (count > ring_count) {
+        count = ring_count;
+    }
+    ring_head = (ring_head + count) % TS_AGGREGATE_PENDING;
+    ring_count -= count;
+    stats.published += count;
+    stats.messages++;
+    taskEXIT_CRITICAL(&agg_lock);
+}
+
+uint16_t ts_aggregate_pending(void)
+{
+    return ring_count;
+}
+
+void ts_aggregate_get_stats(ts_aggregate_stats_t *out)
+{
+    taskENTER_CRITICAL(&agg_lock);
+    *out = stats;
+    out->pending = ring_count;
+    taskEXIT_CRITICAL(&agg_lock);
+    out->interval_ms = TS_AGGREGATE_INTERVAL_MS;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int tsagg_cmd(int argc, char **argv)
+{
+    ts_aggregate_stats_t s;
+    ts_aggregate_get_stats(&s);
+    printf("interval %lu s, %u samples in the open window, %u points pending\n",
+           s.interval_ms / 1000, s.open_samples, s.pending);
+    printf("%lu samples, %lu points: %lu published in %lu messages, %lu skipped\n",
+           s.samples, s.points, s.published, s.messages, s.skipped);
+    return 0;
+}
+
+esp_err_t ts_aggregate_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "tsagg",
+        .help = "Time-series aggregation: points published, pending and skipped",
+        .hint = NULL,
+        .func = tsagg_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
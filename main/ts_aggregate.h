@@ -0,0 +1,102 @@
+/**
+ * @file ts_aggregate.h
+ * @brief Min/avg/max aggregation for the RainMaker time-series params (ENABLE_TS_AGGREGATE)
+ *
+ * Temperature, Humidity and AQI, with a "Min" and "Max" param beside each,
+ * are time-series params. Instead of reporting every sample, the cloud
+ * task folds samples into windows of TS_AGGREGATE_INTERVAL_MS and sends
+ * one point per window: the average in the primary param, the extremes in
+ * the other two. A window closes with the first sample at or past its end,
+ * and that sample opens the next one; windows follow the tick clock that
+ * stamps sensor_data_t.timestamp.
+ *
+ * Closed points wait in a ring of TS_AGGREGATE_PENDING until the cloud
+ * takes them, so an outage shorter than the ring leaves no hole in the
+ * history: each point carries the Unix time of its last sample and goes
+ * up with that time, however late. A point from before SNTP time cannot
+ * be placed and is skipped, as is the oldest when the ring is full.
+ *
+ * The per-sample record still goes up in the CBOR uplink batches
+ * (uplink_batch.h); the points are the compact history the RainMaker
+ * app charts.
+ */
+
+#ifndef TS_AGGREGATE_H
+#define TS_AGGREGATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+
+typedef struct {
+    float temp_min, temp_avg, temp_max;
+    float hum_min, hum_avg, hum_max;
+    int aqi_min, aqi_avg, aqi_max;
+    uint16_t samples;
+    uint32_t epoch;             // Unix time of the last sample, 0 before SNTP
+} ts_point_t;
+
+/**
+ * @brief Running sums of one window; also used for a deep-sleep upload
+ */
+typedef struct {
+    float temp_min, temp_max, hum_min, hum_max;
+    double temp_sum, hum_sum;
+    int32_t aqi_sum;
+    int aqi_min, aqi_max;
+    uint16_t samples;
+    uint32_t start_ms;          // Sample timestamps, tick or RTC clock
+    uint32_t end_ms;
+} ts_window_t;
+
+typedef struct {
+    uint32_t interval_ms;
+    uint32_t samples;           // Folded into a window
+    uint32_t points;            // Windows closed
+    uint32_t published;
+    uint32_t skipped;           // Closed before SNTP time, or pushed out of the ring
+    uint32_t messages;          // Time-series messages, several points each after an outage
+    uint16_t pending;
+    uint16_t open_samples;      // In the window still open
+} ts_aggregate_stats_t;
+
+void ts_window_reset(ts_window_t *w);
+
+void ts_window_add(ts_window_t *w, const sensor_data_t *sample);
+
+/**
+ * @param now_ms The clock of the sample timestamps now, to date the point
+ * @return false if the window holds no samples
+ */
+bool ts_window_point(const ts_window_t *w, uint32_t now_ms, ts_point_t *out);
+
+/**
+ * @brief Fold one sample into the open window; call from the cloud task
+ *
+ * @return true if the sample closed a window and queued its point
+ */
+bool ts_aggregate_add(const sensor_data_t *sample);
+
+/**
+ * @brief Copy up to max pending points, oldest first, without removing them
+ *
+ * @return Points copied
+ */
+uint16_t ts_aggregate_peek(ts_point_t *out, uint16_t max);
+
+/**
+ * @brief Remove the oldest count points once published
+ */
+void ts_aggregate_ack(uint16_t count);
+
+uint16_t ts_aggregate_pending(void);
+
+void ts_aggregate_get_stats(ts_aggregate_stats_t *out);
+
+/**
+ * @brief Register the "tsagg" console command (points sent, pending, open window)
+ */
+esp_err_t ts_aggregate_register_console(void);
+
+#endif // TS_AGGREGATE_H
@@ -0,0 +1,320 @@
+/**
+ * @file uplink_batch.c
+ * @brief Batched uplink windows with Wi-Fi modem sleep in between
+ *
+ * Pending samples sit in a small ring owned by the cloud task. A burst
+ * switches power save off, publishes the ring oldest first and arms a
+ * one-shot timer that puts the station back into max modem sleep after the
+ * tail. Delays are measured on the tick clock, the same one that stamps
+ * sensor_data_t.timestamp.
+ */
+
+#include "uplink_batch.h"
+#include "alert_task.h"
+#include "app_metrics.h"
+#include "telemetry_cbor.h"
+#include "project_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <esp_console.h>
+
+static const char *TAG = "UPLINK";
+
+static sensor_data_t ring[UPLINK_BATCH_SIZE];
+static uint16_t ring_head = 0;          // Oldest pending sample
+static uint16_t ring_count = 0;
+static uint32_t deadline_ms = 0;        // Window close for the pending samples
+static bool flush_now = false;
+static bool alert_pending = false;      // flush_now was set by an alert
+static bool in_alert = false;
+
+static uint32_t window_ms = UPLINK_WINDOW_MS;
+static bool initialised = false;
+static esp_timer_handle_t tail_timer = NULL;
+
+static uplink_batch_stats_t stats;
+static portMUX_TYPE batch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if ENABLE_CBOR_UPLINK
+#define CBOR_MIN_SAMPLES        2           // A single sample goes as parameters, if it can
+
+static uint8_t cbor_buf[TELEMETRY_CBOR_SIZE(UPLINK_BATCH_SIZE)];   // Cloud task only
+#endif
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// ============================================
+// RADIO POWER SAVE
+// ============================================
+
+static void set_power_save(wifi_ps_type_t mode)
+{
+    esp_err_t err = esp_wifi_set_ps(mode);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_set_ps(%d) failed: %s", mode, esp_err_to_name(err));
+    }
+}
+
+static void tail_timer_cb(void *arg)
+{
+    if (window_ms > 0) {
+        set_power_save(WIFI_PS_MAX_MODEM);
+    }
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+void uplink_batch_init(void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = tail_timer_cb,
+        .name = "uplink_tail",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &tail_timer));
+
+    initialised = true;
+    if (window_ms > 0) {
+        set_power_save(WIFI_PS_MAX_MODEM);
+    }
+    ESP_LOGI(TAG, "Uplink window %lu ms, listen interval %d", window_ms,
+             CONFIG_APP_WIFI_LISTEN_INTERVAL);
+}
+
+void uplink_batch_set_window_ms(uint32_t ms)
+{
+    taskENTER_CRITICAL(&batch_lock);
+    window_ms = ms;
+    if (ring_count > 0) {
+        deadline_ms = ring[ring_head].timestamp + ms;
+    }
+    taskEXIT_CRITICAL(&batch_lock);
+
+    if (initialised) {
+        set_power_save(ms > 0 ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+    }
+}
+
+bool uplink_batch_add(const sensor_data_t *sample, sensor_data_t *evicted)
+{
+    bool full;
+    bool alert = alert_check_thresholds(sample) != ALERT_NONE;
+    bool alert_started = alert && !in_alert;
+    in_alert = alert;
+
+    taskENTER_CRITICAL(&batch_lock);
+    full = ring_count == UPLINK_BATCH_SIZE;
+    if (full) {
+        // Offline for longer than the batch holds: keep the newest
+        *evicted = ring[ring_head];
+        ring_head = (ring_head + 1) % UPLINK_BATCH_SIZE;
+        ring_count--;
+        stats.dropped++;
+    }
+    if (ring_count == 0) {
+        deadline_ms = sample->timestamp + window_ms;
+    }
+    ring[(ring_head + ring_count) % UPLINK_BATCH_SIZE] = *sample;
+    ring_count++;
+    if (alert_started) {
+        flush_now = true;
+        alert_pending = true;
+    }
+    if (ring_count == UPLINK_BATCH_SIZE || stats.bursts == 0) {
+        flush_now = true;   // Also the first batch after boot, for a fresh dashboard
+    }
+    taskEXIT_CRITICAL(&batch_lock);
+    return full;
+}
+
+bool uplink_batch_due(void)
+{
+    return ring_count > 0 &&
+           (flush_now || (int32_t)(now_ms() - deadline_ms) >= 0);
+}
+
+TickType_t uplink_batch_wait_ticks(void)
+{
+    if (ring_count == 0) {
+        return portMAX_DELAY;
+    }
+    if (uplink_batch_due()) {
+        return 0;
+    }
+    return pdMS_TO_TICKS(deadline_ms - now_ms());
+}
+
+#if ENABLE_CBOR_UPLINK
+/**
+ * Encode every pending sample (the ring only changes on the cloud task, so
+ * no lock is needed to read it here) and hand the batch to the publisher.
+ */
+static bool publish_cbor(esp_err_t (*batch)(const uint8_t *cbor, size_t len))
+{
+    uint16_t count = ring_count;
+    telemetry_cbor_t enc;
+    telemetry_cbor_begin(&enc, cbor_buf, sizeof(cbor_buf), count, now_ms(),
+                         telemetry_cbor_epoch(), ring[ring_head].timestamp);
+    for (uint16_t i = 0; i < count; i++) {
+        telemetry_cbor_add(&enc, &ring[(ring_head + i) % UPLINK_BATCH_SIZE]);
+    }
+
+    size_t len = telemetry_cbor_end(&enc);
+    if (len == 0) {
+        ESP_LOGE(TAG, "CBOR batch of %u samples did not fit", count);
+        return false;
+    }
+    esp_err_t err = batch(cbor_buf, len);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "CBOR batch not published (%s)", esp_err_to_name(err));
+        return false;
+    }
+
+    taskENTER_CRITICAL(&batch_lock);
+    stats.cbor_messages++;
+    stats.cbor_samples += count;
+    stats.cbor_bytes += len;
+    taskEXIT_CRITICAL(&batch_lock);
+    return true;
+}
+#endif
+
+uint32_t uplink_batch_flush(const uplink_publish_t *publish)
+{
+    if (ring_count == 0) {
+        return 0;
+    }
+
+    if (window_ms > 0) {
+        esp_timer_stop(tail_timer);
+        set_power_save(WIFI_PS_NONE);
+    }
+
+    bool batched = false;
+#if ENABLE_CBOR_UPLINK
+    if (publish->batch && (ring_count >= CBOR_MIN_SAMPLES || !publish->sample)) {
+        batched = publish_cbor(publish->batch);
+    }
+#endif
+    if (!batched && !publish->sample) {
+        // No parameter path to fall back on: keep the samples for the retry
+        if (window_ms > 0) {
+            esp_timer_start_once(tail_timer, (uint64_t)UPLINK_BURST_TAIL_MS * 1000);
+        }
+        uplink_batch_postpone();
+        return 0;
+    }
+
+    uint32_t sent = 0, delay_max = 0, delay_sum = 0;
+    while (ring_count > 0) {
+        sensor_data_t sample;
+        taskENTER_CRITICAL(&batch_lock);
+        sample = ring[ring_head];
+        ring_head = (ring_head + 1) % UPLINK_BATCH_SIZE;
+        ring_count--;
+        taskEXIT_CRITICAL(&batch_lock);
+
+        if (publish->sample && (!batched || ring_count == 0)) {
+            publish->sample(&sample);
+        } else {
+            app_metrics_record_aqi(sample.aqi);     // Counted by cloud_publish_sample otherwise
+        }
+
+        uint32_t delay = now_ms() - sample.timestamp;
+        delay_sum += delay;
+        if (delay > delay_max) {
+            delay_max = delay;
+        }
+        sent++;
+    }
+
+    if (window_ms > 0) {
+        esp_timer_start_once(tail_timer, (uint64_t)UPLINK_BURST_TAIL_MS * 1000);
+    }
+
+    taskENTER_CRITICAL(&batch_lock);
+    stats.bursts++;
+    if (alert_pending) {
+        stats.alert_bursts++;
+    }
+    stats.samples += sent;
+    stats.delay_total_ms += delay_sum;
+    if (delay_max > stats.delay_max_ms) {
+        stats.delay_max_ms = delay_max;
+    }
+    flush_now = false;
+    alert_pending = false;
+    taskEXIT_CRITICAL(&batch_lock);
+
+    app_metrics_record_uplink(sent, delay_sum, delay_max);
+    return sent;
+}
+
+void uplink_batch_postpone(void)
+{
+    taskENTER_CRITICAL(&batch_lock);
+    deadline_ms = now_ms() + UPLINK_RETRY_MS;
+    flush_now = false;
+    taskEXIT_CRITICAL(&batch_lock);
+}
+
+void uplink_batch_get_stats(uplink_batch_stats_t *out)
+{
+    taskENTER_CRITICAL(&batch_lock);
+    *out = stats;
+    out->window_ms = window_ms;
+    out->pending = ring_count;
+    taskEXIT_CRITICAL(&batch_lock);
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int uplink_cmd(int argc, char **argv)
+{
+    if (argc >= 2) {
+        long s = strtol(argv[1], NULL, 10);
+        if (s < 0 || s > UPLINK_WINDOW_LIMIT_MS / 1000) {
+            printf("window must be 0-%d s\n", UPLINK_WINDOW_LIMIT_MS / 1000);
+            return 1;
+        }
+        uplink_batch_set_window_ms((uint32_t)s * 1000);
+    }
+
+    uplink_batch_stats_t s;
+    uplink_batch_get_stats(&s);
+    printf("window %lu s, %u pending\n", s.window_ms / 1000, s.pending);
+    printf("bursts %lu (%lu alert), samples %lu, dropped %lu\n",
+           s.bursts, s.alert_bursts, s.samples, s.dropped);
+    printf("delay avg %llu ms, max %lu ms\n",
+           s.samples ? s.delay_total_ms / s.samples : 0, s.delay_max_ms);
+    printf("cbor %lu batches, %lu samples, %lu bytes (%.1f per sample)\n",
+           s.cbor_messages, s.cbor_samples, s.cbor_bytes,
+           s.cbor_samples ? (double)s.cbor_bytes / s.cbor_samples : 0.0);
+    return 0;
+}
+
+esp_err_t uplink_batch_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "uplink",
+        .help = "Batched uplink stats; with SEC, set the window (0 publishes every sample)",
+        .hint = "[SEC]",
+        .func = uplink_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
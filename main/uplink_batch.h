@@ -0,0 +1,105 @@
+/**
+ * @file uplink_batch.h
+ * @brief Batched uplink windows with Wi-Fi modem sleep in between
+ *
+ * The cloud task hands every sample to the batch instead of publishing it
+ * straight away. The batch goes out in one burst when its window closes
+ * (UPLINK_WINDOW_MS after the oldest pending sample), when it fills up, or
+ * at once when a sample starts an alert. Between bursts the station sits in
+ * max modem sleep, waking only every APP_WIFI_LISTEN_INTERVAL beacons; for
+ * a burst the radio stays fully on, plus UPLINK_BURST_TAIL_MS for the
+ * acknowledgements and any cloud writes queued for the device.
+ *
+ * With ENABLE_CBOR_UPLINK a burst of two or more samples goes up as one
+ * CBOR message (telemetry_cbor.h) instead of one set of RainMaker
+ * parameter reports per sample; only the newest sample is still reported
+ * as parameters, to keep the app's current values. If the CBOR publish
+ * fails, every sample falls back to the parameter path. A publisher
+ * without a per-sample path (ENABLE_TS_AGGREGATE, where the parameters
+ * carry aggregated points instead) sends every burst as CBOR, a single
+ * sample too, and keeps the samples for a retry if that fails.
+ *
+ * A window of 0 publishes every sample as it arrives and leaves the power
+ * save mode at the ESP-IDF default, as before.
+ */
+
+#ifndef UPLINK_BATCH_H
+#define UPLINK_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "sensor_task.h"
+
+typedef struct {
+    uint32_t window_ms;
+    uint32_t bursts;                // Flushes that published something
+    uint32_t alert_bursts;          // Of those, opened early by an alert
+    uint32_t samples;               // Samples published
+    uint32_t dropped;               // Oldest samples pushed out while offline
+    uint32_t delay_max_ms;          // Sample taken to published
+    uint64_t delay_total_ms;
+    uint32_t cbor_messages;         // Bursts sent as one CBOR batch
+    uint32_t cbor_samples;
+    uint32_t cbor_bytes;
+    uint16_t pending;
+} uplink_batch_stats_t;
+
+typedef struct {
+    void (*sample)(const sensor_data_t *sample);            // cloud_publish_sample; NULL: CBOR only
+    esp_err_t (*batch)(const uint8_t *cbor, size_t len);    // NULL: per sample only
+} uplink_publish_t;
+
+/**
+ * @brief Enter max modem sleep if batching is on; call from the cloud task
+ */
+void uplink_batch_init(void);
+
+/**
+ * @brief Change the window at runtime (0: publish every sample)
+ */
+void uplink_batch_set_window_ms(uint32_t window_ms);
+
+/**
+ * @brief Queue one sample; the oldest is pushed out when the batch is full
+ *
+ * @param evicted Receives the sample pushed out, if any
+ * @return true if a sample was pushed out
+ */
+bool uplink_batch_add(const sensor_data_t *sample, sensor_data_t *evicted);
+
+/**
+ * @brief Whether the pending samples should go out now
+ */
+bool uplink_batch_due(void);
+
+/**
+ * @brief How long the cloud task may block waiting for the next sample
+ *
+ * @return Ticks until the window closes, portMAX_DELAY with nothing pending
+ */
+TickType_t uplink_batch_wait_ticks(void);
+
+/**
+ * @brief Publish every pending sample, oldest first, with the radio awake
+ *
+ * @param publish Per-sample and (optional) CBOR batch publishers
+ * @return Samples published
+ */
+uint32_t uplink_batch_flush(const uplink_publish_t *publish);
+
+/**
+ * @brief Try again in UPLINK_RETRY_MS; call when a due batch found the cloud down
+ */
+void uplink_batch_postpone(void);
+
+void uplink_batch_get_stats(uplink_batch_stats_t *out);
+
+/**
+ * @brief Register the "uplink" console command (stats, set the window)
+ */
+esp_err_t uplink_batch_register_console(void);
+
+#endif // UPLINK_BATCH_H
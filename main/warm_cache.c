@@ -0,0 +1,174 @@
+/**
+ * @file warm_cache.c
+ * @brief Warm-start cache implementation
+ *
+ * Every update rewrites the CRC over the whole block (about 40 bytes), so
+ * a reset in the middle of an update is caught as a mismatch at boot. The
+ * RTC clock keeps counting through digital resets, which gives the age of
+ * the cached sample.
+ */
+
+#include "warm_cache.h"
+#include "project_config.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+#include <esp_rtc_time.h>
+#include <esp_console.h>
+
+static const char *TAG = "WARM_CACHE";
+
+#define WARM_CACHE_MAGIC    0x57415232  // "WAR2"; change with the layout
+
+typedef struct {
+    uint32_t magic;
+    uint32_t has_sample;
+    uint32_t alert;             // alert_type_t
+    uint64_t latest_rtc_us;     // RTC clock when the sample was cached
+    sensor_data_t sample;       // Latest sample
+    uint32_t crc;               // Over everything above
+} warm_cache_t;
+
+RTC_NOINIT_ATTR static warm_cache_t cache;
+
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool have_restored = false;
+static sensor_data_t restored_sample;
+static alert_type_t restored_alert = ALERT_NONE;
+
+// ============================================
+// HELPERS
+// ============================================
+
+static uint32_t cache_crc(void)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&cache, offsetof(warm_cache_t, crc));
+}
+
+static bool cache_valid(void)
+{
+    return cache.magic == WARM_CACHE_MAGIC &&
+           cache.has_sample <= 1 &&
+           cache.crc == cache_crc();
+}
+
+static void cache_reset(void)
+{
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = WARM_CACHE_MAGIC;
+    cache.alert = ALERT_NONE;
+    cache.crc = cache_crc();
+}
+
+// ============================================
+// PUBLIC API
+// ============================================
+
+void warm_cache_init(void)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    // RTC memory content is undefined after power loss
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT || !cache_valid()) {
+        if (reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT) {
+            ESP_LOGW(TAG, "Cache failed its check, starting empty");
+        }
+        cache_reset();
+        return;
+    }
+
+    if (!cache.has_sample) {
+        return;
+    }
+
+    uint64_t age_ms = (esp_rtc_get_time_us() - cache.latest_rtc_us) / 1000;
+    if (age_ms > WARM_CACHE_MAX_AGE_MS) {
+        ESP_LOGI(TAG, "Cached sample is %llu s old, not restoring", age_ms / 1000);
+        return;
+    }
+
+    restored_sample = cache.sample;
+    restored_alert = (alert_type_t)cache.alert;
+    have_restored = true;
+
+    // Also the latest reading for /metrics and the consumers until the first cycle
+    sensor_seed_latest(&restored_sample);
+    ESP_LOGI(TAG, "Restored sample (%llu ms old), alert %d", age_ms, restored_alert);
+}
+
+void warm_cache_push(const sensor_data_t *sample)
+{
+    uint64_t now_us = esp_rtc_get_time_us();
+
+    taskENTER_CRITICAL(&cache_lock);
+    cache.sample = *sample;
+    cache.has_sample = 1;
+    cache.latest_rtc_us = now_us;
+    cache.crc = cache_crc();
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+void warm_cache_set_alert(alert_type_t alert)
+{
+    taskENTER_CRITICAL(&cache_lock);
+    if (cache.alert != (uint32_t)alert) {
+        cache.alert = alert;
+        cache.crc = cache_crc();
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+bool warm_cache_restored_sample(sensor_data_t *out)
+{
+    if (have_restored) {
+        *out = restored_sample;
+    }
+    return have_restored;
+}
+
+alert_type_t warm_cache_restored_alert(void)
+{
+    return restored_alert;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+static int warm_cmd(int argc, char **argv)
+{
+    warm_cache_t copy;
+
+    taskENTER_CRITICAL(&cache_lock);
+    copy = cache;
+    taskEXIT_CRITICAL(&cache_lock);
+
+    printf("reset reason %d, alert %lu\n", esp_reset_reason(), copy.alert);
+    if (copy.has_sample) {
+        const sensor_data_t *s = &copy.sample;
+        printf("  t=%lu ms  %.1f C  %.1f %%  AQI %d  %u lux\n",
+               s->timestamp, s->temperature, s->humidity, s->aqi, s->light_lux);
+    }
+    return 0;
+}
+
+esp_err_t warm_cache_register_console(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "warm",
+        .help = "Sample and alert state kept across resets",
+        .hint = NULL,
+        .func = warm_cmd,
+    };
+    esp_err_t err = esp_console_cmd_register(&cmd);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Console command not registered: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file warm_cache.h
+ * @brief Last sample and alert state kept across resets (ENABLE_WARM_START)
+ *
+ * The cache lives in RTC_NOINIT memory, which a software reset, panic,
+ * watchdog or OTA restart leaves alone. A CRC guards it; after a power-on
+ * or brownout, or on a CRC mismatch, it starts empty. At boot the display,
+ * alert engine and sensor_get_latest() restore from it, so the screen and
+ * /metrics show the last reading straight away instead of waiting for the
+ * first sensor cycle.
+ */
+
+#ifndef WARM_CACHE_H
+#define WARM_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_task.h"
+#include "alert_task.h"
+
+/**
+ * @brief Validate the cache left by the previous run
+ *
+ * Call first thing in app_main. A fresh sample also becomes the latest
+ * sample (sensor_seed_latest()); one older than WARM_CACHE_MAX_AGE_MS is
+ * not restored.
+ */
+void warm_cache_init(void);
+
+/**
+ * @brief Keep a sample in place of the previous one
+ */
+void warm_cache_push(const sensor_data_t *sample);
+
+/**
+ * @brief Record the alert state after a sample
+ */
+void warm_cache_set_alert(alert_type_t alert);
+
+/**
+ * @brief Sample restored from the previous run, if fresh enough
+ *
+ * @return false after a cold start, or when the cache is stale or corrupt
+ */
+bool warm_cache_restored_sample(sensor_data_t *out);
+
+/**
+ * @brief Alert state restored from the previous run (ALERT_NONE if none)
+ */
+alert_type_t warm_cache_restored_alert(void);
+
+/**
+ * @brief Register the "warm" console command (cached sample and alert)
+ */
+esp_err_t warm_cache_register_console(void);
+
+#endif // WARM_CACHE_H
@@ -0,0 +1,45 @@
+/**
+ * @file bench_main.c
+ * @brief Host entry point for the hot-path microbenchmarks
+ *
+ * Runs the benchmarks registered by perf_benches_register() on the host
+ * clock and prints the same JSON line as the "perf" console command, so
+ * host and target results can be fed to tools/perf_compare.py alike.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "sim.h"
+#include "perf.h"
+#include "perf_benches.h"
+
+static const char *s_filter;
+static int s_run;
+
+static void bench_entry(void)
+{
+    if (perf_benches_register() == ESP_OK) {
+        s_run = perf_run(s_filter);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            s_filter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--filter SUBSTRING]\n", argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    // Keep stdout pure JSON
+    sim_log_set_level(ESP_LOG_ERROR);
+    sim_kernel_run(bench_entry, UINT64_MAX);
+
+    fflush(stdout);
+    _Exit(s_run > 0 ? 0 : 1);
+}
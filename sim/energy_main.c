@@ -0,0 +1,263 @@
+/**
+ * @file energy_main.c
+ * @brief Battery estimate for the deep-sleep duty cycle (ENABLE_DEEP_SLEEP_MODE)
+ *
+ * Walks one simulated day per configuration on the virtual clock. Every wake
+ * takes a real sample through the firmware (sensor_sample_once() against the
+ * DHT11/LDR models), so the awake time includes the DHT11 transfer and any
+ * retries, and the upload decision is the firmware's own
+ * sleep_logger_upload_due() on the firmware's alert thresholds. Charge is
+ * then summed from the current profile below, which holds typical ESP32-C3
+ * datasheet figures; edit it for a measured board.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "sim.h"
+#include "project_config.h"
+#include "app_driver.h"
+#include "sensor_task.h"
+#include "alert_task.h"
+#include "sleep_logger.h"
+
+#define ENERGY_DAY_S        86400.0
+#define ENERGY_MAX_CONFIGS  8
+
+// Current profile (mA and ms)
+typedef struct {
+    double sleep_ma;            // Chip in deep sleep with the RTC timer
+    double sensors_ma;          // DHT11 standby + LDR divider, always powered
+    double boot_ms;             // Deep-sleep wake to app_main
+    double boot_ma;
+    double active_ma;           // CPU running, radio off
+    double init_ms;             // Full init before Wi-Fi (NVS, RainMaker, Insights)
+    double connect_ms;          // Wi-Fi association, DHCP, MQTT/TLS
+    double radio_ma;            // Average with the radio up
+    double publish_ms;          // Per buffered sample
+    double always_on_ma;        // Normal firmware: Wi-Fi modem sleep, OLED on
+} energy_profile_t;
+
+static const energy_profile_t s_profile = {
+    .sleep_ma = 0.005,
+    .sensors_ma = 0.21,         // 60 uA DHT11 standby + ~150 uA LDR divider
+    .boot_ms = 120.0,
+    .boot_ma = 22.0,
+    .active_ma = 22.0,
+    .init_ms = 600.0,
+    .connect_ms = 3500.0,
+    .radio_ma = 85.0,
+    .publish_ms = 25.0,
+    .always_on_ma = 32.0,
+};
+
+typedef struct {
+    uint32_t interval_s;
+    uint32_t upload_every;      // 0: always-on firmware
+} energy_config_t;
+
+typedef struct {
+    uint32_t wakes;
+    uint32_t uploads;
+    uint32_t alert_uploads;
+    double awake_s;
+    double sleep_mah;
+    double sample_mah;
+    double upload_mah;
+} energy_result_t;
+
+static energy_config_t s_configs[ENERGY_MAX_CONFIGS] = {
+    { 10, 0 },
+    { 10, 30 },
+    { 60, 10 },
+    { 60, 30 },
+    { 300, 12 },
+};
+static int s_config_count = 5;
+static energy_result_t s_results[ENERGY_MAX_CONFIGS];
+static double s_heatwave_h = -1.0;
+static double s_battery_mah = 2000.0;
+
+// ============================================
+// STIMULUS
+// ============================================
+
+// Same day/night cycle as env_logger_sim; the heatwave repeats daily
+static void day_env(uint64_t now_us, sim_env_t *env, void *ctx)
+{
+    (void)ctx;
+    double t = fmod((double)now_us / 1e6, ENERGY_DAY_S);
+    double phase = 2.0 * M_PI * t / ENERGY_DAY_S;
+
+    env->temperature = (float)(24.0 + 5.0 * sin(phase));
+    env->humidity = (float)(55.0 - 12.0 * sin(phase));
+    env->light_raw = (int)(2000.0 + 1500.0 * sin(phase));
+    env->dht_fault = false;
+
+    if (s_heatwave_h >= 0.0 && t >= s_heatwave_h * 3600.0 && t < (s_heatwave_h + 1.0) * 3600.0) {
+        env->temperature = 38.0f;
+    }
+}
+
+// ============================================
+// MODEL
+// ============================================
+
+static double mah(double ma, double ms)
+{
+    return ma * ms / 3.6e6;
+}
+
+static void run_day(const energy_config_t *cfg, energy_result_t *res)
+{
+    const energy_profile_t *p = &s_profile;
+    uint64_t day_start = sim_now_us();
+    uint32_t wakes = (uint32_t)(ENERGY_DAY_S / cfg->interval_s);
+    uint32_t since_upload = 0, buffered = 0;
+    bool was_alert = false;
+    double awake_ms = 0.0;
+
+    memset(res, 0, sizeof(*res));
+    res->wakes = wakes;
+
+    for (uint32_t i = 0; i < wakes; i++) {
+        // Sleep until this wake is due (at the start of its interval slot)
+        uint64_t due = day_start + (uint64_t)i * cfg->interval_s * 1000000ULL;
+        if (due > sim_now_us()) {
+            vTaskDelay(pdMS_TO_TICKS((due - sim_now_us()) / 1000));
+        }
+
+        uint64_t t0 = sim_now_us();
+        sensor_data_t sample;
+        sensor_sample_once(&sample);
+        double sample_ms = (double)(sim_now_us() - t0) / 1000.0;
+
+        bool in_alert = alert_check_thresholds(&sample) != ALERT_NONE;
+        bool alert_started = in_alert && !was_alert;
+        was_alert = in_alert;
+
+        if (cfg->upload_every == 0) {
+            continue;       // Always-on: charged as a flat current below
+        }
+
+        res->sample_mah += mah(p->boot_ma, p->boot_ms) + mah(p->active_ma, sample_ms);
+        awake_ms += p->boot_ms + sample_ms;
+        since_upload++;
+        if (buffered < DEEP_SLEEP_RING_SIZE) {
+            buffered++;
+        }
+
+        if (sleep_logger_upload_due(since_upload, buffered, alert_started, cfg->upload_every)) {
+            double upload_ms = p->connect_ms + buffered * p->publish_ms + DEEP_SLEEP_FLUSH_MS;
+            res->upload_mah += mah(p->active_ma, p->init_ms) + mah(p->radio_ma, upload_ms);
+            awake_ms += p->init_ms + upload_ms;
+            res->uploads++;
+            res->alert_uploads += alert_started;
+            since_upload = 0;
+            buffered = 0;
+        }
+    }
+
+    if (cfg->upload_every == 0) {
+        res->awake_s = ENERGY_DAY_S;
+        res->sample_mah = p->always_on_ma * 24.0;
+        res->uploads = wakes;
+        return;
+    }
+    res->awake_s = awake_ms / 1000.0;
+    res->sleep_mah = (p->sleep_ma + p->sensors_ma) * 24.0;
+}
+
+static void energy_entry(void)
+{
+    // The parts of app_main a sample wake runs
+    nvs_flash_init();
+    app_driver_init();
+    sensor_init();
+
+    for (int i = 0; i < s_config_count; i++) {
+        run_day(&s_configs[i], &s_results[i]);
+    }
+}
+
+// ============================================
+// ENTRY
+// ============================================
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --config SEC:N     sample every SEC s, upload every N wakes (0 = always-on);\n"
+            "                     replaces the built-in list, up to %d times\n"
+            "  --heatwave-at H    38 C for one hour from hour H of each day\n"
+            "  --battery MAH      battery capacity for the days column (default 2000)\n",
+            prog, ENERGY_MAX_CONFIGS);
+}
+
+int main(int argc, char **argv)
+{
+    bool custom = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--config") == 0 && v) {
+            if (!custom) {
+                s_config_count = 0;
+                custom = true;
+            }
+            char *end;
+            uint32_t interval = (uint32_t)strtoul(v, &end, 0);
+            if (interval < SAMPLE_INTERVAL_MIN_MS / 1000 || *end != ':' ||
+                s_config_count == ENERGY_MAX_CONFIGS) {
+                usage(argv[0]);
+                return 1;
+            }
+            s_configs[s_config_count].interval_s = interval;
+            s_configs[s_config_count].upload_every = (uint32_t)strtoul(end + 1, NULL, 0);
+            s_config_count++; i++;
+        } else if (strcmp(a, "--heatwave-at") == 0 && v) {
+            s_heatwave_h = atof(v); i++;
+        } else if (strcmp(a, "--battery") == 0 && v) {
+            s_battery_mah = atof(v); i++;
+        } else {
+            usage(argv[0]);
+            return strcmp(a, "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    sim_log_set_level(ESP_LOG_ERROR);
+    sim_hw_set_env(day_env, NULL);
+    sim_kernel_run(energy_entry, UINT64_MAX);
+
+    printf("%-26s %6s %8s %9s %9s %9s %9s %9s %8s\n", "configuration", "wakes",
+           "uploads", "awake s", "sleep", "samples", "uploads", "mAh/day", "days");
+    for (int i = 0; i < s_config_count; i++) {
+        const energy_config_t *c = &s_configs[i];
+        const energy_result_t *r = &s_results[i];
+        char name[32];
+        if (c->upload_every == 0) {
+            snprintf(name, sizeof(name), "always-on, %lu s", (unsigned long)c->interval_s);
+        } else {
+            snprintf(name, sizeof(name), "deep sleep, %lu s, N=%lu",
+                     (unsigned long)c->interval_s, (unsigned long)c->upload_every);
+        }
+        double total = r->sleep_mah + r->sample_mah + r->upload_mah;
+        printf("%-26s %6lu %8lu %9.0f %9.2f %9.2f %9.2f %9.2f %8.1f\n", name,
+               (unsigned long)r->wakes, (unsigned long)r->uploads, r->awake_s,
+               r->sleep_mah, r->sample_mah, r->upload_mah, total, s_battery_mah / total);
+        if (r->alert_uploads > 0) {
+            printf("%-26s %lu of the uploads started by an alert\n", "",
+                   (unsigned long)r->alert_uploads);
+        }
+    }
+
+    fflush(stdout);
+    _Exit(0);
+}
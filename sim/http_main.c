@@ -0,0 +1,469 @@
+/**
+ * @file http_main.c
+ * @brief Loopback test and export benchmark for the HTTP dashboard handlers
+ *
+ * Fills the local API history ring with synthetic samples, starts the
+ * dashboard (main/http_dash.c) on the esp_http_server stand-in and serves it
+ * on a 127.0.0.1 socket from the simulated main task. A plain host thread
+ * plays the browser: it fetches the page, checks the chunked CSV and JSON
+ * exports row by row, follows the event stream while new samples arrive,
+ * resumes it with Last-Event-ID (and with a stale one from before a reboot),
+ * checks the Prometheus scrape, and times repeated history exports and
+ * scrapes.
+ *
+ *   ./build_sim/env_logger_http [--samples N] [--rounds N]
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "esp_log.h"
+#include "sim.h"
+#include "project_config.h"
+#include "sensor_task.h"
+#include "local_api.h"
+#include "http_dash.h"
+#include "app_metrics.h"
+
+#define LIVE_EVENTS         64      // Samples pushed while the stream is open
+#define MAX_BODY            (1 << 20)
+
+static uint32_t s_samples = LOCAL_API_HISTORY_SAMPLES;
+static int s_rounds = 50;
+static uint16_t s_port;
+static uint32_t s_recorded;
+
+static atomic_int s_push_request;   // Client asks the server task for samples
+static atomic_bool s_client_done;
+static int s_failures;
+
+#define CHECK(cond, ...) do {                           \
+        if (!(cond)) {                                  \
+            printf("FAIL: " __VA_ARGS__);               \
+            printf("\n");                               \
+            s_failures++;                               \
+        }                                               \
+    } while (0)
+
+// ============================================
+// DEVICE SIDE
+// ============================================
+
+static void record_samples(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++, s_recorded++) {
+        sensor_data_t s = {
+            .temperature = 22.0f + (float)(s_recorded % 97) / 10.0f - (s_recorded % 7 == 0 ? 30.0f : 0.0f),
+            .humidity = 40.0f + (float)(s_recorded % 300) / 10.0f,
+            .aqi = (int)(s_recorded % 500),
+            .light_lux = (uint16_t)(s_recorded * 37),
+            .timestamp = s_recorded * 10000,
+        };
+        local_api_record(&s);
+        app_metrics_record_sample_interval(SENSOR_READ_INTERVAL_MS);
+        app_metrics_record_publish(1000 + (s_recorded % 400) * 1000);
+        http_dash_notify();
+    }
+}
+
+// ============================================
+// CLIENT SIDE (plain host thread, no firmware calls)
+// ============================================
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static int connect_server(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        .sin_port = htons(s_port),
+    };
+    struct timeval tv = { .tv_sec = 5 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+typedef struct {
+    int status;
+    char content_type[80];
+    bool chunked;
+    int chunks;
+    char *body;
+    size_t body_len;
+} response_t;
+
+/**
+ * GET path with Connection: close, read to EOF and undo the chunked
+ * encoding, checking its framing on the way.
+ */
+static bool http_get(const char *path, response_t *r)
+{
+    static char raw[MAX_BODY + 65536];
+    memset(r, 0, sizeof(*r));
+
+    int fd = connect_server();
+    if (fd < 0) {
+        return false;
+    }
+    char req[256];
+    int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: logger\r\nConnection: close\r\n\r\n", path);
+    send(fd, req, (size_t)n, 0);
+
+    size_t len = 0;
+    ssize_t got;
+    while (len < sizeof(raw) - 1 && (got = recv(fd, raw + len, sizeof(raw) - 1 - len, 0)) > 0) {
+        len += (size_t)got;
+    }
+    close(fd);
+    raw[len] = '\0';
+
+    char *body = strstr(raw, "\r\n\r\n");
+    if (!body || sscanf(raw, "HTTP/1.1 %d", &r->status) != 1) {
+        return false;
+    }
+    *body = '\0';
+    body += 4;
+    r->chunked = strstr(raw, "Transfer-Encoding: chunked") != NULL;
+    char *type = strstr(raw, "Content-Type: ");
+    if (type) {
+        sscanf(type, "Content-Type: %79[^\r]", r->content_type);
+    }
+    r->body = malloc(MAX_BODY);
+
+    if (!r->chunked) {
+        r->body_len = len - (size_t)(body - raw);
+        memcpy(r->body, body, r->body_len);
+        r->body[r->body_len] = '\0';
+        return true;
+    }
+    char *p = body, *end = raw + len;
+    for (;;) {
+        char *eol = strstr(p, "\r\n");
+        if (!eol) return false;
+        size_t size = strtoul(p, NULL, 16);
+        p = eol + 2;
+        if (size == 0) break;
+        if (p + size + 2 > end || p[size] != '\r' || p[size + 1] != '\n') return false;
+        memcpy(r->body + r->body_len, p, size);
+        r->body_len += size;
+        r->chunks++;
+        p += size + 2;
+    }
+    r->body[r->body_len] = '\0';
+    return true;
+}
+
+static int count_lines(const char *s)
+{
+    int n = 0;
+    for (; *s; s++) n += (*s == '\n');
+    return n;
+}
+
+static int count_char(const char *s, char c)
+{
+    int n = 0;
+    for (; *s; s++) n += (*s == c);
+    return n;
+}
+
+/**
+ * Read events until want arrive; returns how many came in order and
+ * sets *last_id to the id of the last one.
+ */
+static int read_events(int fd, int want, long *last_id)
+{
+    char buf[8192];
+    size_t len = 0;
+    int seen = 0;
+    while (seen < want) {
+        ssize_t got = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (got <= 0) break;
+        len += (size_t)got;
+        buf[len] = '\0';
+        char *p = buf, *end;
+        while ((end = strstr(p, "\n\n")) != NULL) {
+            long id;
+            *end = '\0';
+            char *idl = strstr(p, "id: ");
+            if (idl && sscanf(idl, "id: %ld", &id) == 1) {
+                if (*last_id >= 0 && id != *last_id + 1) {
+                    return -1;
+                }
+                *last_id = id;
+                seen++;
+            }
+            p = end + 2;
+        }
+        len -= (size_t)(p - buf);
+        memmove(buf, p, len);
+    }
+    return seen;
+}
+
+static int open_events(const char *last_event_id)
+{
+    int fd = connect_server();
+    char req[256];
+    int n = snprintf(req, sizeof(req), "GET /events HTTP/1.1\r\nHost: logger\r\n%s%s%s\r\n",
+                     last_event_id ? "Last-Event-ID: " : "", last_event_id ? last_event_id : "",
+                     last_event_id ? "\r\n" : "");
+    send(fd, req, (size_t)n, 0);
+    return fd;
+}
+
+static void wait_pushed(void)
+{
+    while (atomic_load(&s_push_request) != 0) {
+        usleep(100);
+    }
+}
+
+static void bench_export(const char *path, uint32_t rows_expected)
+{
+    response_t r;
+    double best = 1e9;
+    size_t bytes = 0;
+    int chunks = 0;
+    for (int i = 0; i < s_rounds; i++) {
+        double t0 = now_s();
+        bool ok = http_get(path, &r);
+        double dt = now_s() - t0;
+        if (!ok) {
+            CHECK(false, "%s: bad response", path);
+            return;
+        }
+        if (dt < best) best = dt;
+        bytes = r.body_len;
+        chunks = r.chunks;
+        free(r.body);
+    }
+    printf("%-14s: %lu rows, %zu bytes (%.1f per row), %d chunks, best of %d %.2f ms "
+           "(%.0f rows/s, %.1f MB/s)\n", path, (unsigned long)rows_expected, bytes,
+           rows_expected ? (double)bytes / rows_expected : 0.0, chunks, s_rounds, best * 1e3,
+           rows_expected / best, bytes / best / 1e6);
+}
+
+/**
+ * Check the exposition format line by line: comments are HELP/TYPE, every
+ * sample is "name[{labels}] value", and the histogram's +Inf bucket equals
+ * its count. Returns the number of samples.
+ */
+static int check_metrics(const char *body, uint32_t samples_expected)
+{
+    int series = 0;
+    unsigned long inf = 0, count = 0, samples = 0;
+    const char *p = body;
+    while (*p) {
+        const char *eol = strchr(p, '\n');
+        if (!eol) {
+            CHECK(false, "/metrics: last line not terminated");
+            break;
+        }
+        char line[256];
+        snprintf(line, sizeof(line), "%.*s", (int)(eol - p), p);
+        p = eol + 1;
+        if (line[0] == '#') {
+            CHECK(strncmp(line, "# HELP ", 7) == 0 || strncmp(line, "# TYPE ", 7) == 0,
+                  "/metrics: bad comment '%s'", line);
+            continue;
+        }
+        char name[128];
+        double value;
+        CHECK(sscanf(line, "%127[a-zA-Z0-9_:]%*[^ ] %lf", name, &value) == 2 ||
+              sscanf(line, "%127[a-zA-Z0-9_:] %lf", name, &value) == 2,
+              "/metrics: bad sample '%s'", line);
+        CHECK(strncmp(line, "envlogger_", 10) == 0, "/metrics: unprefixed '%s'", line);
+        sscanf(line, "envlogger_publish_latency_seconds_bucket{le=\"+Inf\"} %lu", &inf);
+        sscanf(line, "envlogger_publish_latency_seconds_count %lu", &count);
+        sscanf(line, "envlogger_samples_total %lu", &samples);
+        series++;
+    }
+    CHECK(count == samples_expected && inf == count, "/metrics: histogram +Inf %lu, count %lu",
+          inf, count);
+    CHECK(samples == samples_expected, "/metrics: samples_total %lu, expected %lu", samples,
+          (unsigned long)samples_expected);
+    return series;
+}
+
+static void bench_metrics(int series)
+{
+    response_t r;
+    double best = 1e9;
+    size_t bytes = 0;
+    for (int i = 0; i < s_rounds; i++) {
+        double t0 = now_s();
+        bool ok = http_get("/metrics", &r);
+        double dt = now_s() - t0;
+        if (!ok) {
+            CHECK(false, "/metrics: bad response");
+            return;
+        }
+        if (dt < best) best = dt;
+        bytes = r.body_len;
+        free(r.body);
+    }
+    printf("%-14s: %d series, %zu bytes, best of %d %.2f ms\n", "/metrics", series, bytes,
+           s_rounds, best * 1e3);
+}
+
+static void *client_thread(void *arg)
+{
+    response_t r;
+    uint32_t held = s_samples < LOCAL_API_HISTORY_SAMPLES ? s_samples : LOCAL_API_HISTORY_SAMPLES;
+    uint32_t oldest = s_samples - held;
+
+    CHECK(http_get("/", &r) && r.status == 200 && strstr(r.body, "EventSource"),
+          "/: page not served");
+    free(r.body);
+    CHECK(http_get("/nope", &r) && r.status == 404, "/nope: expected 404");
+    free(r.body);
+
+    // CSV: header + one line per held sample, oldest first, chunked
+    CHECK(http_get("/history.csv", &r) && r.status == 200 && r.chunked, "/history.csv: not chunked");
+    CHECK(count_lines(r.body) == (int)held + 1, "/history.csv: %d lines for %lu samples",
+          count_lines(r.body), (unsigned long)held);
+    char first[32];
+    snprintf(first, sizeof(first), "\n%lu,", (unsigned long)oldest);
+    CHECK(strstr(r.body, first) != NULL, "/history.csv: does not start at seq %lu",
+          (unsigned long)oldest);
+    CHECK(strstr(r.body, ",-") != NULL, "/history.csv: no negative temperature row");
+    free(r.body);
+
+    // JSON: an array of one object per sample
+    CHECK(http_get("/history.json", &r) && r.status == 200 && r.body[0] == '[' &&
+          strcmp(r.body + r.body_len - 2, "]\n") == 0, "/history.json: not an array");
+    CHECK(count_char(r.body, '{') == (int)held, "/history.json: %d objects for %lu samples",
+          count_char(r.body, '{'), (unsigned long)held);
+    free(r.body);
+
+    CHECK(http_get("/history.json?last=10", &r) && count_char(r.body, '{') == 10,
+          "/history.json?last=10: wrong count");
+    free(r.body);
+    char path[64];
+    snprintf(path, sizeof(path), "/history.csv?since=%lu", (unsigned long)(s_samples - 5));
+    CHECK(http_get(path, &r) && count_lines(r.body) == 6, "%s: wrong count", path);
+    free(r.body);
+
+    // Prometheus scrape: one plain-text response, before any live samples
+    CHECK(http_get("/metrics", &r) && r.status == 200 && !r.chunked &&
+          strcmp(r.content_type, "text/plain; version=0.0.4; charset=utf-8") == 0,
+          "/metrics: status %d, type '%s'", r.status, r.content_type);
+    int series = check_metrics(r.body, s_samples);
+    free(r.body);
+
+    // Event stream: the newest sample at once, then every new one in order
+    int fd = open_events(NULL);
+    long last_id = -1;
+    CHECK(read_events(fd, 1, &last_id) == 1 && last_id == (long)s_samples - 1,
+          "/events: first event is not the newest sample");
+    atomic_store(&s_push_request, LIVE_EVENTS);
+    int live = read_events(fd, LIVE_EVENTS, &last_id);
+    CHECK(live == LIVE_EVENTS, "/events: %d of %d live events in order", live, LIVE_EVENTS);
+    close(fd);
+    wait_pushed();      // The server clears the request after its last event went out
+
+    // Reconnect after missing some: resumes right after Last-Event-ID
+    atomic_store(&s_push_request, 10);
+    wait_pushed();
+    char id[16];
+    snprintf(id, sizeof(id), "%ld", last_id);
+    fd = open_events(id);
+    int resumed = read_events(fd, 10, &last_id);
+    CHECK(resumed == 10, "/events: %d of 10 missed events after Last-Event-ID", resumed);
+    close(fd);
+
+    // Reconnect with an id from before a reboot: starts at the newest sample
+    snprintf(id, sizeof(id), "%ld", last_id + 1000);
+    fd = open_events(id);
+    long reboot_id = -1;
+    CHECK(read_events(fd, 1, &reboot_id) == 1 && reboot_id == last_id,
+          "/events: Last-Event-ID past the head did not start at the newest sample");
+    close(fd);
+    printf("%-14s: %d live events in order, %d resumed after Last-Event-ID, "
+           "stale id restarts at %ld\n", "/events", live, resumed, reboot_id);
+
+    bench_export("/history.csv", held);
+    bench_export("/history.json", held);
+    bench_metrics(series);
+
+    atomic_store(&s_client_done, true);
+    return NULL;
+}
+
+// ============================================
+// ENTRY
+// ============================================
+
+static void http_entry(void)
+{
+    record_samples(s_samples);
+    if (http_dash_start() != ESP_OK || sim_httpd_listen(&s_port) != 0) {
+        printf("FAIL: server did not start\n");
+        s_failures++;
+        return;
+    }
+
+    pthread_t client;
+    pthread_create(&client, NULL, client_thread, NULL);
+    while (!atomic_load(&s_client_done)) {
+        sim_httpd_poll(1);
+        int push = atomic_load(&s_push_request);
+        if (push > 0) {
+            record_samples((uint32_t)push);
+            atomic_store(&s_push_request, 0);
+        }
+    }
+    pthread_join(client, NULL);
+
+    http_dash_stats_t st;
+    http_dash_get_stats(&st);
+    printf("server        : %lu exports, %lu rows, %lu chunks, %lu streams, %lu events\n",
+           (unsigned long)st.exports, (unsigned long)st.rows, (unsigned long)st.chunks,
+           (unsigned long)st.sse_opened, (unsigned long)st.events);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            s_samples = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            s_rounds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--samples N] [--rounds N]\n", argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (s_samples < 16) {
+        s_samples = 16;
+    }
+
+    sim_log_set_level(ESP_LOG_WARN);
+    sim_kernel_run(http_entry, UINT64_MAX);
+
+    printf("%s\n", s_failures ? "FAILED" : "ok");
+    fflush(stdout);
+    _Exit(s_failures ? 1 : 0);
+}
@@ -0,0 +1,18 @@
+/**
+ * @file app_insights.h
+ * @brief Host simulation stand-in for the RainMaker Insights helper
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t app_insights_enable(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/**
+ * @file esp_attr.h
+ * @brief Host simulation stand-in for the section attributes
+ *
+ * The host has no RTC memory; the variables are ordinary statics.
+ */
+
+#pragma once
+
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
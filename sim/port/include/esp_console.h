@@ -0,0 +1,31 @@
+/**
+ * @file esp_console.h
+ * @brief Host simulation stand-in for the console command registry
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*esp_console_cmd_func_t)(int argc, char **argv);
+
+typedef struct {
+    const char *command;
+    const char *help;
+    const char *hint;
+    esp_console_cmd_func_t func;
+    void *argtable;
+} esp_console_cmd_t;
+
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd);
+
+/** Run a registered command by name (simulation only). */
+int sim_console_run(const char *command_line);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file esp_cpu.h
+ * @brief Host simulation stand-in for the CPU cycle counter
+ *
+ * Cycles are derived from virtual time at the ESP32-C3's 160 MHz so code that
+ * measures spans with the cycle counter reports target-equivalent numbers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+/**
+ * @file esp_diagnostics.h
+ * @brief Host simulation stand-in for the ESP diagnostics data types
+ */
+
+#pragma once
+
+typedef enum {
+    ESP_DIAG_DATA_TYPE_BOOL,
+    ESP_DIAG_DATA_TYPE_INT,
+    ESP_DIAG_DATA_TYPE_UINT,
+    ESP_DIAG_DATA_TYPE_FLOAT,
+    ESP_DIAG_DATA_TYPE_STR,
+    ESP_DIAG_DATA_TYPE_IPv4,
+    ESP_DIAG_DATA_TYPE_MAC,
+} esp_diag_data_type_t;
@@ -0,0 +1,24 @@
+/**
+ * @file esp_diagnostics_metrics.h
+ * @brief Host simulation stand-in for ESP Insights metrics (kept in memory)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_diagnostics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_diag_metrics_register(const char *tag, const char *key, const char *label,
+                                    const char *path, esp_diag_data_type_t type);
+esp_err_t esp_diag_metrics_add_uint(const char *key, uint32_t value);
+esp_err_t esp_diag_metrics_add_int(const char *key, int32_t value);
+esp_err_t esp_diag_metrics_add_float(const char *key, float value);
+
+#ifdef __cplusplus
+}
+#endif
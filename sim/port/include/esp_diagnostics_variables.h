@@ -0,0 +1,24 @@
+/**
+ * @file esp_diagnostics_variables.h
+ * @brief Host simulation stand-in for ESP Insights variables (kept in memory)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_diagnostics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_diag_variable_register(const char *tag, const char *key, const char *label,
+                                     const char *path, esp_diag_data_type_t type);
+esp_err_t esp_diag_variable_add_uint(const char *key, uint32_t value);
+esp_err_t esp_diag_variable_add_int(const char *key, int32_t value);
+esp_err_t esp_diag_variable_add_str(const char *key, const char *value);
+
+#ifdef __cplusplus
+}
+#endif
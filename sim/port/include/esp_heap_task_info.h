@@ -0,0 +1,9 @@
+/**
+ * @file esp_heap_task_info.h
+ * @brief Host simulation stand-in; per-task heap tracking is not modelled
+ *
+ * CONFIG_HEAP_TASK_TRACKING stays undefined on the host, so callers compile
+ * their tracking paths out.
+ */
+
+#pragma once
@@ -0,0 +1,35 @@
+/**
+ * @file esp_https_server.h
+ * @brief Host simulation stand-in for esp_https_server (configuration only)
+ */
+
+#pragma once
+
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HTTPD_SSL_TRANSPORT_SECURE,
+    HTTPD_SSL_TRANSPORT_INSECURE,
+} httpd_ssl_transport_mode_t;
+
+typedef struct {
+    httpd_config_t httpd;
+    httpd_ssl_transport_mode_t transport_mode;
+    uint16_t port_secure;
+    uint16_t port_insecure;
+} httpd_ssl_config_t;
+
+#define HTTPD_SSL_CONFIG_DEFAULT() {            \
+        .httpd = HTTPD_DEFAULT_CONFIG(),        \
+        .transport_mode = HTTPD_SSL_TRANSPORT_SECURE, \
+        .port_secure = 443,                     \
+        .port_insecure = 80,                    \
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file esp_local_ctrl.h
+ * @brief Host simulation stand-in for esp_local_ctrl
+ *
+ * Keeps the registered properties, handlers and custom endpoints; sim_main
+ * reaches them through sim_local_ctrl_get()/sim_local_ctrl_set()/
+ * sim_local_ctrl_request() in place of a LAN client. Transport and security
+ * settings are accepted and ignored.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#include "esp_https_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROP_FLAG_READONLY          (1 << 0)
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t len;
+} protocomm_security1_params_t;
+
+typedef enum {
+    PROTOCOM_SEC0 = 0,
+    PROTOCOM_SEC1,
+    PROTOCOM_SEC2,
+    PROTOCOM_SEC_CUSTOM,
+} esp_local_ctrl_proto_sec_t;
+
+// protocomm.h
+typedef esp_err_t (*protocomm_req_handler_t)(uint32_t session_id, const uint8_t *inbuf,
+                                             ssize_t inlen, uint8_t **outbuf, ssize_t *outlen,
+                                             void *priv_data);
+
+typedef struct esp_local_ctrl_prop {
+    char *name;
+    uint32_t type;
+    size_t size;
+    uint32_t flags;
+    void *ctx;
+    void (*ctx_free_fn)(void *ctx);
+} esp_local_ctrl_prop_t;
+
+typedef struct esp_local_ctrl_prop_val {
+    void *data;
+    size_t size;
+    void (*free_fn)(void *data);
+} esp_local_ctrl_prop_val_t;
+
+typedef struct esp_local_ctrl_handlers {
+    esp_err_t (*get_prop_values)(size_t props_count, const esp_local_ctrl_prop_t props[],
+                                 esp_local_ctrl_prop_val_t prop_values[], void *usr_ctx);
+    esp_err_t (*set_prop_values)(size_t props_count, const esp_local_ctrl_prop_t props[],
+                                 const esp_local_ctrl_prop_val_t prop_values[], void *usr_ctx);
+    void *usr_ctx;
+    void (*usr_ctx_free_fn)(void *usr_ctx);
+} esp_local_ctrl_handlers_t;
+
+typedef struct esp_local_ctrl_transport esp_local_ctrl_transport_t;
+const esp_local_ctrl_transport_t *esp_local_ctrl_get_transport_httpd(void);
+#define ESP_LOCAL_CTRL_TRANSPORT_HTTPD (esp_local_ctrl_get_transport_httpd())
+
+typedef union {
+    void *ble;
+    httpd_ssl_config_t *httpd;
+} esp_local_ctrl_transport_config_t;
+
+typedef struct esp_local_ctrl_proto_sec_cfg {
+    esp_local_ctrl_proto_sec_t version;
+    void *custom_handle;
+    const void *sec_params;
+} esp_local_ctrl_proto_sec_cfg_t;
+
+typedef struct esp_local_ctrl_config {
+    const esp_local_ctrl_transport_t *transport;
+    esp_local_ctrl_transport_config_t transport_config;
+    esp_local_ctrl_proto_sec_cfg_t proto_sec;
+    esp_local_ctrl_handlers_t handlers;
+    size_t max_properties;
+} esp_local_ctrl_config_t;
+
+esp_err_t esp_local_ctrl_start(const esp_local_ctrl_config_t *config);
+esp_err_t esp_local_ctrl_stop(void);
+esp_err_t esp_local_ctrl_add_property(const esp_local_ctrl_prop_t *prop);
+esp_err_t esp_local_ctrl_set_handler(const char *ep_name, protocomm_req_handler_t handler,
+                                     void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+/**
+ * @file esp_random.h
+ * @brief Host simulation stand-in for the hardware RNG (seeded, repeatable)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+void esp_fill_random(void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
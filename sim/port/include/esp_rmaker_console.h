@@ -0,0 +1,10 @@
+/**
+ * @file esp_rmaker_console.h
+ * @brief Host simulation stand-in for the RainMaker console
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+esp_err_t esp_rmaker_console_init(void);
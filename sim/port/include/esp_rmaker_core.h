@@ -0,0 +1,137 @@
+/**
+ * @file esp_rmaker_core.h
+ * @brief Host simulation stand-in for the RainMaker core API
+ *
+ * Nodes, devices and params live in memory. Every report is recorded so the
+ * simulator can count and digest what would have gone to the cloud.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_rmaker_node esp_rmaker_node_t;
+typedef struct sim_rmaker_device esp_rmaker_device_t;
+typedef struct sim_rmaker_param esp_rmaker_param_t;
+
+typedef enum {
+    RMAKER_VAL_TYPE_INVALID = 0,
+    RMAKER_VAL_TYPE_BOOLEAN,
+    RMAKER_VAL_TYPE_INTEGER,
+    RMAKER_VAL_TYPE_FLOAT,
+    RMAKER_VAL_TYPE_STRING,
+    RMAKER_VAL_TYPE_OBJECT,
+    RMAKER_VAL_TYPE_ARRAY,
+} esp_rmaker_val_type_t;
+
+typedef union {
+    bool b;
+    int i;
+    float f;
+    char *s;
+} esp_rmaker_val_t;
+
+typedef struct {
+    esp_rmaker_val_type_t type;
+    esp_rmaker_val_t val;
+} esp_rmaker_param_val_t;
+
+typedef enum {
+    PROP_FLAG_WRITE = (1 << 0),
+    PROP_FLAG_READ = (1 << 1),
+    PROP_FLAG_TIME_SERIES = (1 << 2),
+    PROP_FLAG_PERSIST = (1 << 3),
+    PROP_FLAG_SIMPLE_TIME_SERIES = (1 << 4),
+} esp_param_property_flags_t;
+
+typedef enum {
+    ESP_RMAKER_REQ_SRC_INIT = 0,
+    ESP_RMAKER_REQ_SRC_CLOUD,
+    ESP_RMAKER_REQ_SRC_SCHEDULE,
+    ESP_RMAKER_REQ_SRC_SCENE_ACTIVATE,
+    ESP_RMAKER_REQ_SRC_SCENE_DEACTIVATE,
+    ESP_RMAKER_REQ_SRC_LOCAL,
+    ESP_RMAKER_REQ_SRC_MAX,
+} esp_rmaker_req_src_t;
+
+typedef struct {
+    esp_rmaker_req_src_t src;
+} esp_rmaker_write_ctx_t;
+
+typedef struct {
+    esp_rmaker_req_src_t src;
+} esp_rmaker_read_ctx_t;
+
+typedef esp_err_t (*esp_rmaker_device_write_cb_t)(const esp_rmaker_device_t *device,
+        const esp_rmaker_param_t *param, const esp_rmaker_param_val_t val,
+        void *priv_data, esp_rmaker_write_ctx_t *ctx);
+typedef esp_err_t (*esp_rmaker_device_read_cb_t)(const esp_rmaker_device_t *device,
+        const esp_rmaker_param_t *param, void *priv_data, esp_rmaker_read_ctx_t *ctx);
+
+typedef struct {
+    bool enable_time_sync;
+} esp_rmaker_config_t;
+
+esp_rmaker_node_t *esp_rmaker_node_init(const esp_rmaker_config_t *config,
+                                        const char *name, const char *type);
+esp_err_t esp_rmaker_start(void);
+char *esp_rmaker_get_node_id(void);
+esp_err_t esp_rmaker_node_add_device(const esp_rmaker_node_t *node,
+                                     const esp_rmaker_device_t *device);
+
+esp_rmaker_device_t *esp_rmaker_device_create(const char *dev_name, const char *type,
+                                              void *priv_data);
+esp_err_t esp_rmaker_device_add_cb(const esp_rmaker_device_t *device,
+                                   esp_rmaker_device_write_cb_t write_cb,
+                                   esp_rmaker_device_read_cb_t read_cb);
+esp_err_t esp_rmaker_device_add_param(const esp_rmaker_device_t *device,
+                                      const esp_rmaker_param_t *param);
+esp_err_t esp_rmaker_device_assign_primary_param(const esp_rmaker_device_t *device,
+                                                 const esp_rmaker_param_t *param);
+const char *esp_rmaker_device_get_name(const esp_rmaker_device_t *device);
+esp_rmaker_param_t *esp_rmaker_device_get_param_by_type(const esp_rmaker_device_t *device,
+                                                        const char *param_type);
+esp_rmaker_param_t *esp_rmaker_device_get_param_by_name(const esp_rmaker_device_t *device,
+                                                        const char *param_name);
+
+esp_rmaker_param_t *esp_rmaker_param_create(const char *param_name, const char *type,
+                                            esp_rmaker_param_val_t val, uint8_t properties);
+esp_err_t esp_rmaker_param_add_ui_type(const esp_rmaker_param_t *param, const char *ui_type);
+esp_err_t esp_rmaker_param_add_bounds(const esp_rmaker_param_t *param,
+                                      esp_rmaker_param_val_t min,
+                                      esp_rmaker_param_val_t max,
+                                      esp_rmaker_param_val_t step);
+esp_err_t esp_rmaker_param_update(const esp_rmaker_param_t *param, esp_rmaker_param_val_t val);
+esp_err_t esp_rmaker_param_update_and_report(const esp_rmaker_param_t *param,
+                                             esp_rmaker_param_val_t val);
+esp_err_t esp_rmaker_param_update_and_notify(const esp_rmaker_param_t *param,
+                                             esp_rmaker_param_val_t val);
+esp_err_t esp_rmaker_raise_alert(const char *alert_str);
+char *esp_rmaker_param_get_name(const esp_rmaker_param_t *param);
+esp_rmaker_param_val_t *esp_rmaker_param_get_val(esp_rmaker_param_t *param);
+
+const char *esp_rmaker_device_cb_src_to_str(esp_rmaker_req_src_t src);
+
+esp_rmaker_param_val_t esp_rmaker_bool(bool bval);
+esp_rmaker_param_val_t esp_rmaker_int(int ival);
+esp_rmaker_param_val_t esp_rmaker_float(float fval);
+esp_rmaker_param_val_t esp_rmaker_str(const char *sval);
+
+esp_err_t esp_rmaker_timezone_service_enable(void);
+esp_err_t esp_rmaker_system_service_enable(void *config);
+
+/**
+ * @brief Simulation only: deliver a write from the "phone app" to a param
+ */
+esp_err_t sim_rmaker_write(const char *device_name, const char *param_name,
+                           esp_rmaker_param_val_t val);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+/**
+ * @file esp_rmaker_mqtt.h
+ * @brief Host simulation stand-in for the RainMaker MQTT API
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_rmaker_mqtt_publish(const char *topic, void *data, size_t data_len, uint8_t qos,
+                                  int *msg_id);
+
+#ifdef __cplusplus
+}
+#endif
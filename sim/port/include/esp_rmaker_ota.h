@@ -0,0 +1,18 @@
+/**
+ * @file esp_rmaker_ota.h
+ * @brief Host simulation stand-in for the RainMaker ota service
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_rmaker_ota_enable_default(void);
+
+#ifdef __cplusplus
+}
+#endif
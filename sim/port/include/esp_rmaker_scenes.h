@@ -0,0 +1,18 @@
+/**
+ * @file esp_rmaker_scenes.h
+ * @brief Host simulation stand-in for the RainMaker scenes service
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_rmaker_scenes_enable(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+/**
+ * @file esp_rmaker_standard_devices.h
+ * @brief Host simulation stand-in for RainMaker standard devices
+ */
+
+#pragma once
+
+#include "esp_rmaker_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_rmaker_device_t *esp_rmaker_temp_sensor_device_create(const char *dev_name,
+                                                          void *priv_data, float temperature);
+esp_rmaker_device_t *esp_rmaker_switch_device_create(const char *dev_name,
+                                                     void *priv_data, bool power);
+
+#ifdef __cplusplus
+}
+#endif
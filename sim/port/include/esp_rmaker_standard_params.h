@@ -0,0 +1,14 @@
+/**
+ * @file esp_rmaker_standard_params.h
+ * @brief Host simulation stand-in for RainMaker standard params
+ */
+
+#pragma once
+
+#include "esp_rmaker_core.h"
+#include "esp_rmaker_standard_types.h"
+
+#define ESP_RMAKER_DEF_NAME_PARAM       "Name"
+#define ESP_RMAKER_DEF_POWER_NAME       "Power"
+#define ESP_RMAKER_DEF_TEMPERATURE_NAME "Temperature"
+#define ESP_RMAKER_DEF_HUMIDITY_NAME    "Humidity"
@@ -0,0 +1,20 @@
+/**
+ * @file esp_rmaker_standard_types.h
+ * @brief Host simulation stand-in for RainMaker standard type strings
+ */
+
+#pragma once
+
+#define ESP_RMAKER_UI_TOGGLE            "esp.ui.toggle"
+#define ESP_RMAKER_UI_SLIDER            "esp.ui.slider"
+#define ESP_RMAKER_UI_DROPDOWN          "esp.ui.dropdown"
+#define ESP_RMAKER_UI_TEXT              "esp.ui.text"
+
+#define ESP_RMAKER_PARAM_NAME           "esp.param.name"
+#define ESP_RMAKER_PARAM_POWER          "esp.param.power"
+#define ESP_RMAKER_PARAM_TEMPERATURE    "esp.param.temperature"
+#define ESP_RMAKER_PARAM_HUMIDITY       "esp.param.humidity"
+
+#define ESP_RMAKER_DEVICE_SWITCH        "esp.device.switch"
+#define ESP_RMAKER_DEVICE_TEMP_SENSOR   "esp.device.temperature-sensor"
+#define ESP_RMAKER_DEVICE_OTHER         "esp.device.other"
@@ -0,0 +1,30 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief Host simulation stand-in for ROM delay helpers
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Busy-wait: advances virtual time without letting other tasks run
+ */
+void ets_delay_us(uint32_t us);
+#define esp_rom_delay_us(us) ets_delay_us(us)
+
+/**
+ * @brief Matches the simulated 160 MHz cycle counter in esp_cpu.h
+ */
+static inline uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+    return 160;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+/**
+ * @file esp_rtc_time.h
+ * @brief Host simulation stand-in for the RTC clock (virtual time)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t esp_rtc_get_time_us(void);
+
+#ifdef __cplusplus
+}
+#endif
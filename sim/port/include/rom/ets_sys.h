@@ -0,0 +1,22 @@
+/**
+ * @file ets_sys.h
+ * @brief Host simulation stand-in for ROM delay helpers
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Busy-wait: advances virtual time without letting other tasks run
+ */
+void ets_delay_us(uint32_t us);
+#define esp_rom_delay_us(us) ets_delay_us(us)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file sdkconfig.h
+ * @brief Kconfig values for the host simulation build
+ *
+ * Mirrors the options from sdkconfig.defaults that change firmware code
+ * paths; everything else stays undefined (disabled).
+ */
+
+#pragma once
+
+#define CONFIG_FREERTOS_HZ              1000
+#define CONFIG_SENSOR_READ_INTERVAL_SEC 10
+#define CONFIG_UPLINK_WINDOW_SEC        60
+#define CONFIG_DLOG_ENABLE              1
+#define CONFIG_DLOG_RING_WORDS          2048
+#define CONFIG_EVTRACE_ENABLE           1
+#define CONFIG_EVTRACE_RING_EVENTS      1024
+#define CONFIG_PERF_ROUNDS              11
+#define CONFIG_PERF_MIN_ROUND_US        2000
+#define CONFIG_PUSH_BUTTON_DEBOUNCE_MS      20
+#define CONFIG_PUSH_BUTTON_LONG_PRESS_MS    3000
+#define CONFIG_PUSH_BUTTON_DOUBLE_PRESS_MS  350
+#define CONFIG_PUSH_BUTTON_MAX_SUBSCRIBERS  4
+#define CONFIG_PUSH_BUTTON_TASK_STACK_SIZE  2048
+#define CONFIG_PUSH_BUTTON_TASK_PRIORITY    7
+#define CONFIG_APP_WIFI_BACKOFF_MIN_MS      500
+#define CONFIG_APP_WIFI_BACKOFF_MAX_MS      60000
+#define CONFIG_APP_WIFI_LISTEN_INTERVAL     3
+#ifndef CONFIG_APP_WIFI_FAST_REJOIN_TRIES
+#define CONFIG_APP_WIFI_FAST_REJOIN_TRIES   2   // -D0 to compare against scanning
+#endif
@@ -0,0 +1,326 @@
+/**
+ * @file sim.h
+ * @brief Host simulation kernel and device-model control interface
+ *
+ * Everything the simulated firmware sees goes through the ESP-IDF and
+ * FreeRTOS stand-ins in this directory. This header is only for the
+ * simulator itself (sim_main.c and the device models) to drive virtual time
+ * and inspect what the firmware did.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================
+// KERNEL / VIRTUAL TIME
+// ============================================
+
+/**
+ * @brief Run the firmware entry point as the "main" task until virtual time
+ *        reaches end_us or every task is blocked forever
+ *
+ * @param entry Firmware entry point (normally app_main)
+ * @param end_us Virtual time at which the run stops
+ */
+void sim_kernel_run(void (*entry)(void), uint64_t end_us);
+
+/**
+ * @brief Current virtual time in microseconds since simulated boot
+ */
+uint64_t sim_now_us(void);
+
+/**
+ * @brief Burn CPU time on the running task without yielding
+ *
+ * Used for busy-waits (ets_delay_us) and for charging modelled CPU cost.
+ */
+void sim_busy_us(uint32_t us);
+
+/**
+ * @brief Block the running task for a modelled peripheral transfer
+ */
+void sim_sleep_us(uint64_t us);
+
+/**
+ * @brief Virtual time spent with every task blocked
+ */
+uint64_t sim_idle_us(void);
+
+/**
+ * @brief Number of context switches performed so far
+ */
+uint64_t sim_context_switches(void);
+
+/**
+ * @brief Per-queue statistics, in creation order
+ */
+typedef struct {
+    uint32_t length;
+    uint32_t item_size;
+    uint32_t sends;
+    uint32_t send_fails;
+    uint32_t receives;
+    uint32_t peeks;
+    uint32_t high_water;
+} sim_queue_stats_t;
+
+/**
+ * @brief Copy statistics of the index-th plain data queue (semaphores and
+ *        mutexes are skipped)
+ *
+ * @return true if such a queue exists
+ */
+bool sim_queue_stats(int index, sim_queue_stats_t *out);
+
+/**
+ * @brief Number of tasks created so far (excluding the simulator's "main")
+ *        and the stack bytes they requested
+ */
+void sim_task_stack_stats(uint32_t *tasks, uint32_t *bytes);
+
+// ============================================
+// LOGGING
+// ============================================
+
+/**
+ * @brief Set the global console log level (esp_log_level_t value)
+ */
+void sim_log_set_level(int level);
+
+/**
+ * @brief Number of log lines emitted and bytes they would have cost on UART
+ */
+void sim_log_stats(uint32_t *lines, uint64_t *bytes);
+
+// ============================================
+// DEVICE MODELS
+// ============================================
+
+/**
+ * @brief Environment seen by the sensors at a given virtual time
+ */
+typedef struct {
+    float temperature;      // °C as reported by DHT11 (0.1 resolution)
+    float humidity;         // % RH
+    int light_raw;          // LDR ADC code 0-4095
+    bool dht_fault;         // true makes the DHT11 stop responding
+} sim_env_t;
+
+typedef void (*sim_env_fn_t)(uint64_t now_us, sim_env_t *env, void *ctx);
+
+/**
+ * @brief Install the function that produces sensor stimulus over time
+ */
+void sim_hw_set_env(sim_env_fn_t fn, void *ctx);
+
+/**
+ * @brief Observed hardware activity, for reports and digests
+ */
+typedef struct {
+    uint32_t dht_reads;             // start pulses seen on the DHT11 line
+    uint32_t adc_reads;
+    uint32_t i2c_transactions;
+    uint64_t i2c_bytes;
+    uint64_t i2c_busy_us;
+    uint32_t frames;                // full GRAM uploads to the SSD1306
+    uint32_t frame_digest;          // running FNV-1a over every frame
+    uint32_t red_led_on;            // rising edges on the red alert LED
+    uint32_t buzzer_on;             // rising edges on the buzzer
+    uint64_t first_red_led_us;      // UINT64_MAX until the first alert
+    uint64_t dht_gap_min_us;        // shortest/longest time between DHT11
+    uint64_t dht_gap_max_us;        //   start pulses (0 until two reads)
+    uint64_t frame_gap_min_us;      // same for GRAM uploads
+    uint64_t frame_gap_max_us;
+} sim_hw_stats_t;
+
+void sim_hw_get_stats(sim_hw_stats_t *out);
+
+/**
+ * @brief Copy the SSD1306 GRAM last uploaded (128x64, page-major)
+ */
+void sim_hw_get_frame(uint8_t out[1024]);
+
+/**
+ * @brief Drive an input pin (e.g. the button) and fire its GPIO ISR on change
+ */
+void sim_hw_drive_input(int gpio_num, int level);
+
+/**
+ * @brief Seed for esp_random()
+ */
+void sim_hw_seed(uint32_t seed);
+
+/**
+ * @brief Reset reason esp_reset_reason() reports (default ESP_RST_POWERON)
+ */
+void sim_hw_set_reset_reason(int reason);
+
+// CPU time charged by the init stand-ins, rough ESP32-C3 figures for the
+// boot timeline (NVS page scan, esp_wifi_init, claim data and node config,
+// RainMaker task start, esp_wifi_start with PHY calibration)
+#define SIM_NVS_INIT_US             30000
+#define SIM_WIFI_INIT_US            60000
+#define SIM_RMAKER_NODE_INIT_US     90000
+#define SIM_RMAKER_START_US         20000
+#define SIM_WIFI_START_US           40000
+
+// ============================================
+// WI-FI STAND-IN
+// ============================================
+
+/**
+ * @brief Time the simulated AP comes up (default 0, UINT64_MAX for never)
+ *
+ * A join without a cached AP takes about 2.5 s (scan, association, DHCP),
+ * one on the cached BSSID/channel about 0.6 s; the MQTT connection follows
+ * 0.5 s after the IP.
+ */
+void sim_wifi_set_ap(uint64_t up_at_us);
+
+/**
+ * @brief Take the AP away for dur_us from start_us (up to 8 outages)
+ */
+void sim_wifi_add_outage(uint64_t start_us, uint64_t dur_us);
+
+/**
+ * @brief Wake the radio for a transmission (called by the RainMaker stand-in)
+ *
+ * In a power-save mode the radio stays on SIM_TX_AWAKE_US after the last
+ * transmission, for the MQTT acknowledgement; back-to-back publishes share
+ * one wake.
+ */
+void sim_wifi_note_tx(void);
+
+typedef struct {
+    double avg_ma;              // Chip average since boot
+    double radio_on_pct;        // Time with the RF receiver on
+    uint32_t wakes;             // Transmit wakes from power save
+} sim_wifi_power_t;
+
+/**
+ * @brief Average current under the radio model in sim_wifi.c
+ */
+void sim_wifi_power(sim_wifi_power_t *out);
+
+// ============================================
+// LOCAL CONTROL STAND-IN
+// ============================================
+
+/**
+ * @brief Read a property registered with esp_local_ctrl, as a LAN client would
+ *
+ * @param data Set to a malloc'd copy of the value; the caller frees it
+ * @return ESP_ERR_NOT_FOUND for an unknown name or before esp_local_ctrl_start()
+ */
+int sim_local_ctrl_get(const char *name, void **data, size_t *size);
+
+/**
+ * @brief Write a property; read-only ones are refused as on the device
+ */
+int sim_local_ctrl_set(const char *name, const void *data, size_t size);
+
+/**
+ * @brief Send a request to a custom endpoint (esp_local_ctrl_set_handler)
+ *
+ * @param out Set to the handler's malloc'd response; the caller frees it
+ * @return ESP_ERR_NOT_FOUND for an unknown endpoint, else the handler's result
+ */
+int sim_local_ctrl_request(const char *endpoint, const void *in, size_t in_len,
+                           void **out, size_t *out_len);
+
+// ============================================
+// HTTP SERVER STAND-IN
+// ============================================
+
+/**
+ * @brief Listen on 127.0.0.1 for the server started with httpd_start()
+ *
+ * @param port Set to the ephemeral port chosen
+ * @return 0 on success, -1 if no server is started or the socket failed
+ */
+int sim_httpd_listen(uint16_t *port);
+
+/**
+ * @brief Accept connections and serve complete requests on the calling task
+ *
+ * Blocks up to timeout_ms in poll(); virtual time does not move.
+ *
+ * @return Requests served, -1 without a listener
+ */
+int sim_httpd_poll(uint32_t timeout_ms);
+
+// ============================================
+// RAINMAKER STAND-IN
+// ============================================
+
+typedef void (*sim_publish_fn_t)(uint64_t now_us, const char *device,
+                                 const char *param, const char *value, void *ctx);
+
+/**
+ * @brief Observe every esp_rmaker_param_update_and_report()
+ */
+void sim_rmaker_set_publish_hook(sim_publish_fn_t fn, void *ctx);
+
+/**
+ * @brief Total publishes recorded and running digest over them
+ */
+void sim_rmaker_stats(uint32_t *publishes, uint32_t *digest);
+
+/**
+ * @brief Modelled MQTT publish latency charged to the calling task
+ */
+void sim_rmaker_set_publish_latency_us(uint32_t us);
+
+/**
+ * @brief Raw esp_rmaker_mqtt_publish() messages and bytes
+ *
+ * No digest: CBOR batches carry the host's wall-clock time.
+ */
+void sim_rmaker_mqtt_stats(uint32_t *messages, uint32_t *bytes);
+
+/**
+ * @brief Append every tlm/ MQTT payload to a file (a CBOR sequence for tlm/cbor)
+ */
+int sim_rmaker_mqtt_dump(const char *path);
+
+// ============================================
+// INSIGHTS STAND-IN
+// ============================================
+
+/**
+ * @brief Inspect a registered Insights metric or variable
+ *
+ * @return false once index runs past the registered keys
+ */
+bool sim_diag_stats(int index, const char **key, bool *variable, uint32_t *updates,
+                    double *last, double *sum);
+
+// ============================================
+// HELPERS
+// ============================================
+
+static inline uint32_t sim_fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+#define SIM_FNV1A_INIT 2166136261u
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_H
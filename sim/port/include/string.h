@@ -0,0 +1,13 @@
+/**
+ * @file string.h
+ * @brief Adds the BSD strlcpy() newlib provides on target to older glibc
+ */
+
+#pragma once
+
+#include_next <string.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+#define SIM_NEED_STRLCPY 1
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file manager.h
+ * @brief Host simulation stand-in for the provisioning manager
+ *
+ * The simulated device is always provisioned.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ESP_EVENT_DECLARE_BASE(WIFI_PROV_EVENT);
+
+typedef enum {
+    WIFI_PROV_INIT,
+    WIFI_PROV_START,
+    WIFI_PROV_CRED_RECV,
+    WIFI_PROV_CRED_FAIL,
+    WIFI_PROV_CRED_SUCCESS,
+    WIFI_PROV_END,
+    WIFI_PROV_DEINIT,
+} wifi_prov_cb_event_t;
+
+typedef enum {
+    WIFI_PROV_SECURITY_0 = 0,
+    WIFI_PROV_SECURITY_1,
+    WIFI_PROV_SECURITY_2,
+} wifi_prov_security_t;
+
+typedef struct {
+    int id;
+} wifi_prov_scheme_t;
+
+typedef struct {
+    int unused;
+} wifi_prov_event_handler_t;
+
+typedef struct {
+    wifi_prov_scheme_t scheme;
+    wifi_prov_event_handler_t scheme_event_handler;
+    wifi_prov_event_handler_t app_event_handler;
+} wifi_prov_mgr_config_t;
+
+esp_err_t wifi_prov_mgr_init(wifi_prov_mgr_config_t config);
+void wifi_prov_mgr_deinit(void);
+esp_err_t wifi_prov_mgr_is_provisioned(bool *provisioned);
+esp_err_t wifi_prov_mgr_start_provisioning(wifi_prov_security_t security,
+                                           const void *wifi_prov_sec_params,
+                                           const char *service_name,
+                                           const char *service_key);
+
+#ifdef __cplusplus
+}
+#endif
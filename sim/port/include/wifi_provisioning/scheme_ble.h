@@ -0,0 +1,12 @@
+/**
+ * @file scheme_ble.h
+ * @brief Host simulation stand-in for the BLE provisioning scheme
+ */
+
+#pragma once
+
+#include "wifi_provisioning/manager.h"
+
+extern const wifi_prov_scheme_t wifi_prov_scheme_ble;
+
+#define WIFI_PROV_SCHEME_BLE_EVENT_HANDLER_FREE_BTDM    { 0 }
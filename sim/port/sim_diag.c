@@ -0,0 +1,134 @@
+/**
+ * @file sim_diag.c
+ * @brief Insights metrics/variables and console stand-ins
+ *
+ * Metrics and variables keep their last value and an update count so the
+ * simulation report can show what would have reached the dashboard.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "esp_diagnostics_metrics.h"
+#include "esp_diagnostics_variables.h"
+#include "esp_console.h"
+#include "esp_rmaker_console.h"
+#include "sim.h"
+
+#define SIM_DIAG_MAX_KEYS   64
+#define SIM_CONSOLE_MAX     16
+
+typedef struct {
+    const char *key;
+    bool variable;
+    uint32_t updates;
+    double last;
+    double sum;
+} sim_diag_entry_t;
+
+static sim_diag_entry_t s_entries[SIM_DIAG_MAX_KEYS];
+static int s_entry_count;
+static esp_console_cmd_t s_cmds[SIM_CONSOLE_MAX];
+static int s_cmd_count;
+
+static esp_err_t diag_register(const char *key, bool variable)
+{
+    if (s_entry_count >= SIM_DIAG_MAX_KEYS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_entries[s_entry_count++] = (sim_diag_entry_t){ .key = key, .variable = variable };
+    return ESP_OK;
+}
+
+static esp_err_t diag_add(const char *key, double value)
+{
+    for (int i = 0; i < s_entry_count; i++) {
+        if (strcmp(s_entries[i].key, key) == 0) {
+            s_entries[i].updates++;
+            s_entries[i].last = value;
+            s_entries[i].sum += value;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_diag_metrics_register(const char *tag, const char *key, const char *label,
+                                    const char *path, esp_diag_data_type_t type)
+{
+    (void)tag; (void)label; (void)path; (void)type;
+    return diag_register(key, false);
+}
+
+esp_err_t esp_diag_metrics_add_uint(const char *key, uint32_t value) { return diag_add(key, value); }
+esp_err_t esp_diag_metrics_add_int(const char *key, int32_t value) { return diag_add(key, value); }
+esp_err_t esp_diag_metrics_add_float(const char *key, float value) { return diag_add(key, value); }
+
+esp_err_t esp_diag_variable_register(const char *tag, const char *key, const char *label,
+                                     const char *path, esp_diag_data_type_t type)
+{
+    (void)tag; (void)label; (void)path; (void)type;
+    return diag_register(key, true);
+}
+
+esp_err_t esp_diag_variable_add_uint(const char *key, uint32_t value) { return diag_add(key, value); }
+esp_err_t esp_diag_variable_add_int(const char *key, int32_t value) { return diag_add(key, value); }
+
+esp_err_t esp_diag_variable_add_str(const char *key, const char *value)
+{
+    (void)value;
+    return diag_add(key, 0);
+}
+
+bool sim_diag_stats(int index, const char **key, bool *variable, uint32_t *updates,
+                    double *last, double *sum)
+{
+    if (index < 0 || index >= s_entry_count) {
+        return false;
+    }
+    *key = s_entries[index].key;
+    *variable = s_entries[index].variable;
+    *updates = s_entries[index].updates;
+    *last = s_entries[index].last;
+    *sum = s_entries[index].sum;
+    return true;
+}
+
+// ============================================
+// CONSOLE
+// ============================================
+
+esp_err_t esp_rmaker_console_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd)
+{
+    if (s_cmd_count >= SIM_CONSOLE_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_cmds[s_cmd_count++] = *cmd;
+    return ESP_OK;
+}
+
+int sim_console_run(const char *command_line)
+{
+    char buf[128];
+    char *argv[8];
+    int argc = 0;
+
+    snprintf(buf, sizeof(buf), "%s", command_line);
+    for (char *tok = strtok(buf, " "); tok && argc < 8; tok = strtok(NULL, " ")) {
+        argv[argc++] = tok;
+    }
+    if (argc == 0) {
+        return -1;
+    }
+    for (int i = 0; i < s_cmd_count; i++) {
+        if (strcmp(s_cmds[i].command, argv[0]) == 0) {
+            return s_cmds[i].func(argc, argv);
+        }
+    }
+    printf("unknown command: %s\n", argv[0]);
+    return -1;
+}
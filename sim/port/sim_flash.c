@@ -0,0 +1,94 @@
+/**
+ * @file sim_flash.c
+ * @brief RAM-backed data partitions for the host simulation build
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+
+#define SIM_FLASH_SECTOR    4096
+
+typedef struct {
+    esp_partition_t part;
+    uint8_t *data;
+} sim_partition_t;
+
+// Same offsets and sizes as partitions.csv
+static sim_partition_t s_partitions[] = {
+    { .part = { .address = 0x3A7000, .size = 0x30000, .erase_size = SIM_FLASH_SECTOR,
+                .label = "backlog" } },
+};
+
+#define SIM_PARTITION_COUNT (sizeof(s_partitions) / sizeof(s_partitions[0]))
+
+static sim_partition_t *lookup(const esp_partition_t *partition)
+{
+    for (size_t i = 0; i < SIM_PARTITION_COUNT; i++) {
+        if (&s_partitions[i].part == partition) {
+            return &s_partitions[i];
+        }
+    }
+    return NULL;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    (void)subtype;
+    if (type != ESP_PARTITION_TYPE_DATA) {
+        return NULL;
+    }
+    for (size_t i = 0; i < SIM_PARTITION_COUNT; i++) {
+        sim_partition_t *p = &s_partitions[i];
+        if (label == NULL || strcmp(label, p->part.label) == 0) {
+            if (!p->data) {
+                p->data = malloc(p->part.size);
+                if (!p->data) {
+                    return NULL;
+                }
+                memset(p->data, 0xff, p->part.size);
+            }
+            return &p->part;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset,
+                             void *dst, size_t size)
+{
+    sim_partition_t *p = lookup(partition);
+    if (!p || src_offset + size > p->part.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, p->data + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset,
+                              const void *src, size_t size)
+{
+    sim_partition_t *p = lookup(partition);
+    if (!p || dst_offset + size > p->part.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t *s = src;
+    for (size_t i = 0; i < size; i++) {
+        p->data[dst_offset + i] &= s[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset,
+                                    size_t size)
+{
+    sim_partition_t *p = lookup(partition);
+    if (!p || offset % SIM_FLASH_SECTOR || size % SIM_FLASH_SECTOR ||
+        offset + size > p->part.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(p->data + offset, 0xff, size);
+    return ESP_OK;
+}
@@ -0,0 +1,499 @@
+/**
+ * @file sim_httpd.c
+ * @brief esp_http_server stand-in over real loopback sockets
+ *
+ * One server instance. httpd_start() records the configuration and
+ * handlers; sim_httpd_listen() binds 127.0.0.1 on an ephemeral port, and
+ * sim_httpd_poll() accepts connections and runs the handler of each complete
+ * request on the calling task, as the server task would on the device.
+ * Connections stay open until the client closes them, so handlers may keep
+ * a socket for httpd_socket_send() (Server-Sent Events). Work queued with
+ * httpd_queue_work() runs at once on the caller.
+ *
+ * Requests are GET/HEAD without a body; that is all the firmware serves.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_HTTPD";
+
+#define SIM_HTTPD_MAX_HANDLERS  16
+#define SIM_HTTPD_MAX_CONNS     16
+#define SIM_HTTPD_MAX_HDRS      8
+#define SIM_HTTPD_REQ_MAX       2048
+
+typedef struct {
+    int fd;
+    size_t len;
+    char buf[SIM_HTTPD_REQ_MAX];
+} sim_conn_t;
+
+typedef struct {
+    sim_conn_t *conn;
+    const char *headers;            // Request header block, after the request line
+    const char *query;              // After '?', or NULL
+    const char *status;
+    const char *type;
+    const char *hdr_field[SIM_HTTPD_MAX_HDRS];
+    const char *hdr_value[SIM_HTTPD_MAX_HDRS];
+    int hdr_count;
+    bool head_sent;
+    bool chunked;
+    bool failed;
+    bool close_after;               // "Connection: close", or an error response
+} sim_req_aux_t;
+
+static struct {
+    bool started;
+    httpd_config_t config;
+    httpd_uri_t handlers[SIM_HTTPD_MAX_HANDLERS];
+    int handler_count;
+    int listen_fd;
+    sim_conn_t conns[SIM_HTTPD_MAX_CONNS];
+} s_httpd = { .listen_fd = -1 };
+
+// ============================================
+// SERVER
+// ============================================
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    if (s_httpd.started) {
+        ESP_LOGE(TAG, "Only one server instance is simulated");
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_httpd.started = true;
+    s_httpd.config = *config;
+    s_httpd.handler_count = 0;
+    for (int i = 0; i < SIM_HTTPD_MAX_CONNS; i++) {
+        s_httpd.conns[i].fd = -1;
+    }
+    *handle = &s_httpd;
+    return ESP_OK;
+}
+
+static void close_conn(sim_conn_t *c)
+{
+    if (c->fd < 0) return;
+    if (s_httpd.config.close_fn) {
+        s_httpd.config.close_fn(&s_httpd, c->fd);   // Closes the socket itself
+    } else {
+        close(c->fd);
+    }
+    c->fd = -1;
+    c->len = 0;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    for (int i = 0; i < SIM_HTTPD_MAX_CONNS; i++) {
+        close_conn(&s_httpd.conns[i]);
+    }
+    if (s_httpd.listen_fd >= 0) {
+        close(s_httpd.listen_fd);
+        s_httpd.listen_fd = -1;
+    }
+    s_httpd.started = false;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    if (s_httpd.handler_count >= SIM_HTTPD_MAX_HANDLERS ||
+        s_httpd.handler_count >= s_httpd.config.max_uri_handlers) {
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    s_httpd.handlers[s_httpd.handler_count++] = *uri_handler;
+    return ESP_OK;
+}
+
+int sim_httpd_listen(uint16_t *port)
+{
+    if (!s_httpd.started) {
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        .sin_port = 0,
+    };
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, s_httpd.config.backlog_conn) < 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &len) < 0) {
+        close(fd);
+        return -1;
+    }
+    s_httpd.listen_fd = fd;
+    *port = ntohs(addr.sin_port);
+    return 0;
+}
+
+// ============================================
+// RESPONSES
+// ============================================
+
+static int send_all(int fd, const char *buf, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = send(fd, buf + done, len - done, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return HTTPD_SOCK_ERR_FAIL;
+        }
+        done += (size_t)n;
+    }
+    return (int)len;
+}
+
+static sim_req_aux_t *aux_of(httpd_req_t *r)
+{
+    return (sim_req_aux_t *)r->aux;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    aux_of(r)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    aux_of(r)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    sim_req_aux_t *a = aux_of(r);
+    if (a->hdr_count >= SIM_HTTPD_MAX_HDRS) {
+        return ESP_ERR_NO_MEM;
+    }
+    a->hdr_field[a->hdr_count] = field;
+    a->hdr_value[a->hdr_count] = value;
+    a->hdr_count++;
+    return ESP_OK;
+}
+
+static esp_err_t send_head(httpd_req_t *r, ssize_t content_len)
+{
+    sim_req_aux_t *a = aux_of(r);
+    char head[1024];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n",
+                     a->status, a->type);
+    for (int i = 0; i < a->hdr_count; i++) {
+        n += snprintf(head + n, sizeof(head) - n, "%s: %s\r\n", a->hdr_field[i], a->hdr_value[i]);
+    }
+    if (content_len >= 0) {
+        n += snprintf(head + n, sizeof(head) - n, "Content-Length: %zd\r\n\r\n", content_len);
+    } else {
+        n += snprintf(head + n, sizeof(head) - n, "Transfer-Encoding: chunked\r\n\r\n");
+    }
+    a->head_sent = true;
+    if (send_all(a->conn->fd, head, (size_t)n) < 0) {
+        a->failed = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    sim_req_aux_t *a = aux_of(r);
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    }
+    if (send_head(r, buf_len) != ESP_OK) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    if (r->method != HTTP_HEAD && buf_len > 0 && send_all(a->conn->fd, buf, (size_t)buf_len) < 0) {
+        a->failed = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    sim_req_aux_t *a = aux_of(r);
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    }
+    if (!a->head_sent) {
+        a->chunked = true;
+        if (send_head(r, -1) != ESP_OK) {
+            return ESP_ERR_HTTPD_RESP_SEND;
+        }
+    }
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", buf_len);
+    if (send_all(a->conn->fd, size, (size_t)n) < 0 ||
+        (buf_len > 0 && send_all(a->conn->fd, buf, (size_t)buf_len) < 0) ||
+        send_all(a->conn->fd, "\r\n", 2) < 0) {
+        a->failed = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    static const char *const status[] = {
+        [HTTPD_400_BAD_REQUEST] = HTTPD_400,
+        [HTTPD_404_NOT_FOUND] = HTTPD_404,
+        [HTTPD_405_METHOD_NOT_ALLOWED] = "405 Method Not Allowed",
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = HTTPD_500,
+    };
+    httpd_resp_set_status(req, status[error]);
+    httpd_resp_set_type(req, "text/plain");
+    aux_of(req)->close_after = true;
+    return httpd_resp_send(req, msg ? msg : status[error], HTTPD_RESP_USE_STRLEN);
+}
+
+int httpd_send(httpd_req_t *r, const char *buf, size_t buf_len)
+{
+    sim_req_aux_t *a = aux_of(r);
+    a->head_sent = true;        // The handler writes its own response
+    return send_all(a->conn->fd, buf, buf_len);
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return aux_of(r)->conn->fd;
+}
+
+int httpd_socket_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    return send_all(sockfd, buf, buf_len);
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *arg)
+{
+    if (!s_httpd.started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    work(arg);
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    for (int i = 0; i < SIM_HTTPD_MAX_CONNS; i++) {
+        if (s_httpd.conns[i].fd == sockfd) {
+            close_conn(&s_httpd.conns[i]);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// ============================================
+// REQUESTS
+// ============================================
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *q = aux_of(r)->query;
+    return q ? strlen(q) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    const char *q = aux_of(r)->query;
+    if (!q) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(buf, buf_len, "%s", q);
+    return strlen(q) < buf_len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    size_t klen = strlen(key);
+    const char *p = qry;
+    while (p && *p) {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > klen && strncmp(p, key, klen) == 0 && p[klen] == '=') {
+            size_t vlen = len - klen - 1;
+            snprintf(val, val_size, "%.*s", (int)vlen, p + klen + 1);
+            return vlen < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static const char *find_hdr(httpd_req_t *r, const char *field, size_t *len)
+{
+    size_t flen = strlen(field);
+    for (const char *p = aux_of(r)->headers; p && *p; ) {
+        const char *eol = strstr(p, "\r\n");
+        if (!eol || eol == p) break;
+        if (strncasecmp(p, field, flen) == 0 && p[flen] == ':') {
+            const char *v = p + flen + 1;
+            while (*v == ' ') v++;
+            *len = (size_t)(eol - v);
+            return v;
+        }
+        p = eol + 2;
+    }
+    return NULL;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    size_t len = 0;
+    return find_hdr(r, field, &len) ? len : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    size_t len;
+    const char *v = find_hdr(r, field, &len);
+    if (!v) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    snprintf(val, val_size, "%.*s", (int)len, v);
+    return len < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+static void serve_request(sim_conn_t *c, size_t head_len)
+{
+    char *line = c->buf;
+    char *eol = strstr(line, "\r\n");
+    *eol = '\0';
+
+    char method[8], target[512];
+    if (sscanf(line, "%7s %511s", method, target) != 2) {
+        close_conn(c);
+        return;
+    }
+
+    httpd_req_t req = { .handle = &s_httpd };
+    sim_req_aux_t aux = { .conn = c, .headers = eol + 2, .status = HTTPD_200,
+                          .type = HTTPD_TYPE_TEXT };
+    req.aux = &aux;
+    req.method = strcmp(method, "HEAD") == 0 ? HTTP_HEAD :
+                 strcmp(method, "GET") == 0 ? HTTP_GET : HTTP_POST;
+    char *q = strchr(target, '?');
+    if (q) {
+        *q = '\0';
+        aux.query = q + 1;
+    }
+    strncpy((char *)req.uri, target, sizeof(req.uri) - 1);
+    char conn_hdr[16];
+    aux.close_after = httpd_req_get_hdr_value_str(&req, "Connection", conn_hdr,
+                                                  sizeof(conn_hdr)) == ESP_OK &&
+                      strcasecmp(conn_hdr, "close") == 0;
+
+    const httpd_uri_t *h = NULL;
+    for (int i = 0; i < s_httpd.handler_count; i++) {
+        if (strcmp(s_httpd.handlers[i].uri, target) == 0 &&
+            s_httpd.handlers[i].method == req.method) {
+            h = &s_httpd.handlers[i];
+            break;
+        }
+    }
+
+    esp_err_t err;
+    if (h) {
+        req.user_ctx = h->user_ctx;
+        err = h->handler(&req);
+    } else {
+        err = httpd_resp_send_err(&req, HTTPD_404_NOT_FOUND, NULL);
+    }
+
+    // Drop the request from the buffer; pipelined bytes stay
+    size_t rest = c->len - head_len;
+    memmove(c->buf, c->buf + head_len, rest);
+    c->len = rest;
+
+    if (err != ESP_OK || aux.failed || aux.close_after) {
+        close_conn(c);
+    }
+}
+
+int sim_httpd_poll(uint32_t timeout_ms)
+{
+    struct pollfd fds[SIM_HTTPD_MAX_CONNS + 1];
+    int idx[SIM_HTTPD_MAX_CONNS + 1];
+    int n = 0;
+
+    if (s_httpd.listen_fd < 0) {
+        return -1;
+    }
+    fds[n] = (struct pollfd){ .fd = s_httpd.listen_fd, .events = POLLIN };
+    idx[n++] = -1;
+    for (int i = 0; i < SIM_HTTPD_MAX_CONNS; i++) {
+        if (s_httpd.conns[i].fd >= 0) {
+            fds[n] = (struct pollfd){ .fd = s_httpd.conns[i].fd, .events = POLLIN };
+            idx[n++] = i;
+        }
+    }
+
+    if (poll(fds, n, (int)timeout_ms) <= 0) {
+        return 0;
+    }
+
+    int served = 0;
+    for (int k = 0; k < n; k++) {
+        if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        if (idx[k] < 0) {
+            int fd = accept(s_httpd.listen_fd, NULL, NULL);
+            if (fd < 0) continue;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            int slot = -1;
+            for (int i = 0; i < SIM_HTTPD_MAX_CONNS && i < s_httpd.config.max_open_sockets; i++) {
+                if (s_httpd.conns[i].fd < 0) { slot = i; break; }
+            }
+            if (slot < 0) {
+                close(fd);
+                continue;
+            }
+            s_httpd.conns[slot].fd = fd;
+            s_httpd.conns[slot].len = 0;
+            continue;
+        }
+
+        sim_conn_t *c = &s_httpd.conns[idx[k]];
+        if (c->fd < 0) continue;        // Closed by an earlier handler this round
+        ssize_t got = recv(c->fd, c->buf + c->len, sizeof(c->buf) - 1 - c->len, 0);
+        if (got <= 0) {
+            close_conn(c);
+            continue;
+        }
+        c->len += (size_t)got;
+        c->buf[c->len] = '\0';
+
+        char *end;
+        while (c->fd >= 0 && (end = strstr(c->buf, "\r\n\r\n")) != NULL) {
+            serve_request(c, (size_t)(end + 4 - c->buf));
+            c->buf[c->len] = '\0';
+            served++;
+        }
+        if (c->fd >= 0 && c->len >= sizeof(c->buf) - 1) {
+            close_conn(c);              // Header block too large
+        }
+    }
+    return served;
+}
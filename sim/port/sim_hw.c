@@ -0,0 +1,486 @@
+/**
+ * @file sim_hw.c
+ * @brief Peripheral models for the host simulation build
+ *
+ * - DHT11: replays the real single-wire waveform, bit by bit, so the driver's
+ *   edge timing and checksum logic run unmodified
+ * - LDR: ADC codes come from the installed environment function
+ * - SSD1306: I2C writes are decoded into a GRAM copy; every full upload counts
+ *   as a rendered frame and is folded into a digest
+ * - LEDs/buzzer: rising edges are counted for alert reporting
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "driver/adc.h"
+#include "driver/i2c.h"
+#include "esp_adc_cal.h"
+#include "esp_random.h"
+#include "esp_cpu.h"
+#include "esp_system.h"
+#include "rom/ets_sys.h"
+#include "sim.h"
+
+// Pin roles follow main/project_config.h
+#define SIM_DHT_GPIO        4
+#define SIM_RED_LED_GPIO    3
+#define SIM_BUZZER_GPIO     10
+
+#define SIM_CPU_MHZ         160
+#define SIM_I2C_BYTE_US     90      // 9 bit clocks at 100 kHz
+#define SIM_I2C_OVERHEAD_US 20      // start + stop + driver latency
+
+// DHT11 waveform (microseconds), per datasheet
+#define DHT_RESP_DELAY_US   20
+#define DHT_RESP_LOW_US     80
+#define DHT_RESP_HIGH_US    80
+#define DHT_BIT_LOW_US      50
+#define DHT_BIT0_HIGH_US    27
+#define DHT_BIT1_HIGH_US    70
+
+static sim_env_fn_t s_env_fn = NULL;
+static void *s_env_ctx = NULL;
+static sim_hw_stats_t s_stats = { .first_red_led_us = UINT64_MAX };
+static uint64_t s_last_dht_us = UINT64_MAX;
+static uint64_t s_last_frame_us = UINT64_MAX;
+
+// Track the spread of intervals between periodic events (timing jitter)
+static void note_interval(uint64_t *last_us, uint64_t *min_us, uint64_t *max_us)
+{
+    uint64_t now = sim_now_us();
+    if (*last_us != UINT64_MAX) {
+        uint64_t gap = now - *last_us;
+        if (*min_us == 0 || gap < *min_us) *min_us = gap;
+        if (gap > *max_us) *max_us = gap;
+    }
+    *last_us = now;
+}
+static uint32_t s_levels[GPIO_NUM_MAX];
+static gpio_mode_t s_modes[GPIO_NUM_MAX];
+static gpio_isr_t s_isr[GPIO_NUM_MAX];
+static void *s_isr_arg[GPIO_NUM_MAX];
+static uint32_t s_rng = 0x12345678u;
+
+// DHT11 transaction state
+static bool s_dht_active = false;
+static uint64_t s_dht_t0 = 0;
+static uint32_t s_dht_edges[2 + 2 * 40 + 1];
+static int s_dht_edge_count = 0;
+static bool s_dht_fault = false;
+
+// SSD1306 model
+static uint8_t s_gram[1024];
+static uint32_t s_gram_ptr = 0;
+
+static void env_now(sim_env_t *env)
+{
+    env->temperature = 25.0f;
+    env->humidity = 50.0f;
+    env->light_raw = 2000;
+    env->dht_fault = false;
+    if (s_env_fn) {
+        s_env_fn(sim_now_us(), env, s_env_ctx);
+    }
+}
+
+void sim_hw_set_env(sim_env_fn_t fn, void *ctx)
+{
+    s_env_fn = fn;
+    s_env_ctx = ctx;
+}
+
+void sim_hw_get_stats(sim_hw_stats_t *out)
+{
+    *out = s_stats;
+}
+
+void sim_hw_get_frame(uint8_t out[1024])
+{
+    memcpy(out, s_gram, sizeof(s_gram));
+}
+
+void sim_hw_seed(uint32_t seed)
+{
+    s_rng = seed ? seed : 0x12345678u;
+}
+
+// ============================================
+// DHT11 MODEL
+// ============================================
+
+static void dht_begin_response(void)
+{
+    sim_env_t env;
+    env_now(&env);
+
+    s_stats.dht_reads++;
+    note_interval(&s_last_dht_us, &s_stats.dht_gap_min_us, &s_stats.dht_gap_max_us);
+    s_dht_fault = env.dht_fault;
+    s_dht_active = true;
+    s_dht_t0 = sim_now_us();
+    if (s_dht_fault) return;
+
+    float t = env.temperature < 0.0f ? 0.0f : env.temperature;
+    float h = env.humidity < 0.0f ? 0.0f : env.humidity;
+    uint8_t data[5];
+    data[0] = (uint8_t)h;
+    data[1] = (uint8_t)((h - (float)data[0]) * 10.0f + 0.5f) % 10;
+    data[2] = (uint8_t)t;
+    data[3] = (uint8_t)((t - (float)data[2]) * 10.0f + 0.5f) % 10;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+
+    // Edge list: each entry is the duration of one alternating level,
+    // starting with the sensor's low response pulse
+    int n = 0;
+    s_dht_edges[n++] = DHT_RESP_LOW_US;
+    s_dht_edges[n++] = DHT_RESP_HIGH_US;
+    for (int i = 0; i < 40; i++) {
+        bool one = (data[i / 8] >> (7 - (i % 8))) & 1;
+        s_dht_edges[n++] = DHT_BIT_LOW_US;
+        s_dht_edges[n++] = one ? DHT_BIT1_HIGH_US : DHT_BIT0_HIGH_US;
+    }
+    s_dht_edges[n++] = DHT_BIT_LOW_US;
+    s_dht_edge_count = n;
+}
+
+static int dht_level_now(void)
+{
+    if (!s_dht_active || s_dht_fault) return 1;
+
+    uint64_t t = sim_now_us() - s_dht_t0;
+    if (t < DHT_RESP_DELAY_US) return 1;
+    t -= DHT_RESP_DELAY_US;
+
+    for (int i = 0; i < s_dht_edge_count; i++) {
+        if (t < s_dht_edges[i]) return (i % 2 == 0) ? 0 : 1;
+        t -= s_dht_edges[i];
+    }
+    s_dht_active = false;
+    return 1;
+}
+
+// ============================================
+// GPIO
+// ============================================
+
+esp_err_t gpio_config(const gpio_config_t *cfg)
+{
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (cfg->pin_bit_mask & (1ULL << pin)) {
+            s_modes[pin] = cfg->mode;
+            if (cfg->pull_up_en) s_levels[pin] = 1;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    level = level ? 1 : 0;
+    if (!s_levels[gpio_num] && level) {
+        if (gpio_num == SIM_RED_LED_GPIO) {
+            s_stats.red_led_on++;
+            if (s_stats.first_red_led_us == UINT64_MAX) {
+                s_stats.first_red_led_us = sim_now_us();
+            }
+        } else if (gpio_num == SIM_BUZZER_GPIO) {
+            s_stats.buzzer_on++;
+        }
+    }
+    s_levels[gpio_num] = level;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return 0;
+    if (gpio_num == SIM_DHT_GPIO && s_modes[gpio_num] == GPIO_MODE_INPUT) {
+        return dht_level_now();
+    }
+    return (int)s_levels[gpio_num];
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    if (gpio_num == SIM_DHT_GPIO && mode == GPIO_MODE_INPUT &&
+        s_modes[gpio_num] != GPIO_MODE_INPUT) {
+        dht_begin_response();
+    }
+    s_modes[gpio_num] = mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    (void)gpio_num;
+    (void)intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    (void)gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    (void)gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    s_isr[gpio_num] = isr_handler;
+    s_isr_arg[gpio_num] = args;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    s_isr[gpio_num] = NULL;
+    return ESP_OK;
+}
+
+void sim_hw_drive_input(int gpio_num, int level)
+{
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) return;
+    uint32_t old = s_levels[gpio_num];
+    s_levels[gpio_num] = level ? 1 : 0;
+    if (old != s_levels[gpio_num] && s_isr[gpio_num]) {
+        s_isr[gpio_num](s_isr_arg[gpio_num]);
+    }
+}
+
+// ============================================
+// ADC
+// ============================================
+
+esp_err_t adc1_config_width(adc_bits_width_t width_bit)
+{
+    (void)width_bit;
+    return ESP_OK;
+}
+
+esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten)
+{
+    (void)channel;
+    (void)atten;
+    return ESP_OK;
+}
+
+int adc1_get_raw(adc1_channel_t channel)
+{
+    (void)channel;
+    sim_env_t env;
+    env_now(&env);
+    s_stats.adc_reads++;
+    sim_busy_us(40);    // one SAR conversion plus driver overhead
+
+    int raw = env.light_raw + (int)(esp_random() % 9) - 4;
+    if (raw < 0) raw = 0;
+    if (raw > 4095) raw = 4095;
+    return raw;
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t adc_num, adc_atten_t atten,
+                                             adc_bits_width_t bit_width, uint32_t default_vref,
+                                             esp_adc_cal_characteristics_t *chars)
+{
+    chars->adc_num = adc_num;
+    chars->atten = atten;
+    chars->bit_width = bit_width;
+    chars->vref = default_vref;
+    chars->coeff_a = 2500;
+    chars->coeff_b = 0;
+    return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t adc_reading,
+                                    const esp_adc_cal_characteristics_t *chars)
+{
+    return (adc_reading * chars->coeff_a) / 4095 + chars->coeff_b;
+}
+
+// ============================================
+// I2C + SSD1306 MODEL
+// ============================================
+
+struct sim_i2c_cmd {
+    uint8_t bytes[1100];
+    size_t len;
+};
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf)
+{
+    (void)port;
+    (void)conf;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags)
+{
+    (void)port;
+    (void)mode;
+    (void)slv_rx_buf_len;
+    (void)slv_tx_buf_len;
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1, sizeof(struct sim_i2c_cmd));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd)
+{
+    (void)cmd;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en)
+{
+    (void)ack_en;
+    if (cmd->len >= sizeof(cmd->bytes)) return ESP_ERR_NO_MEM;
+    cmd->bytes[cmd->len++] = data;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t len, bool ack_en)
+{
+    (void)ack_en;
+    if (cmd->len + len > sizeof(cmd->bytes)) return ESP_ERR_NO_MEM;
+    memcpy(cmd->bytes + cmd->len, data, len);
+    cmd->len += len;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd)
+{
+    (void)cmd;
+    return ESP_OK;
+}
+
+static void ssd1306_model(const uint8_t *bytes, size_t len)
+{
+    if (len < 2) return;
+    uint8_t control = bytes[1];
+
+    if (control == 0x00) {
+        // Column/page address commands rewind the GRAM pointer
+        if (len == 3 && (bytes[2] == 0x21 || bytes[2] == 0x22)) {
+            s_gram_ptr = 0;
+        }
+        return;
+    }
+
+    if (control == 0x40) {
+        for (size_t i = 2; i < len; i++) {
+            s_gram[s_gram_ptr] = bytes[i];
+            s_gram_ptr = (s_gram_ptr + 1) % sizeof(s_gram);
+        }
+        if (len - 2 == sizeof(s_gram)) {
+            s_stats.frames++;
+            note_interval(&s_last_frame_us, &s_stats.frame_gap_min_us,
+                          &s_stats.frame_gap_max_us);
+            s_stats.frame_digest = sim_fnv1a(s_stats.frame_digest ? s_stats.frame_digest
+                                             : SIM_FNV1A_INIT, s_gram, sizeof(s_gram));
+        }
+    }
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks)
+{
+    (void)port;
+    (void)ticks;
+    uint64_t busy = SIM_I2C_OVERHEAD_US + (uint64_t)cmd->len * SIM_I2C_BYTE_US;
+
+    s_stats.i2c_transactions++;
+    s_stats.i2c_bytes += cmd->len;
+    s_stats.i2c_busy_us += busy;
+    ssd1306_model(cmd->bytes, cmd->len);
+
+    // The driver blocks on the transfer-complete interrupt
+    sim_sleep_us(busy);
+    return ESP_OK;
+}
+
+// ============================================
+// MISC SOC SERVICES
+// ============================================
+
+void ets_delay_us(uint32_t us)
+{
+    sim_busy_us(us);
+}
+
+uint32_t esp_random(void)
+{
+    // xorshift32: repeatable for a given --seed
+    uint32_t x = s_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_rng = x;
+    return x;
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *p = (uint8_t *)buf;
+    for (size_t i = 0; i < len; i++) {
+        p[i] = (uint8_t)esp_random();
+    }
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    return (esp_cpu_cycle_count_t)(sim_now_us() * SIM_CPU_MHZ);
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return 180 * 1024;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 160 * 1024;
+}
+
+static esp_reset_reason_t s_reset_reason = ESP_RST_POWERON;
+
+void sim_hw_set_reset_reason(int reason)
+{
+    s_reset_reason = (esp_reset_reason_t)reason;
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return s_reset_reason;
+}
+
+void esp_restart(void)
+{
+    fprintf(stderr, "sim: esp_restart() called, exiting\n");
+    exit(2);
+}
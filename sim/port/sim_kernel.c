@@ -0,0 +1,851 @@
+/**
+ * @file sim_kernel.c
+ * @brief Virtual-time FreeRTOS stand-in for the host simulation build
+ *
+ * Each task gets a host thread, but a single lock is handed from task to task
+ * so exactly one of them runs at a time, like the single ESP32-C3 core.
+ * Switches only happen at blocking calls (or when a call readies a higher
+ * priority task), which keeps runs deterministic. When every task is blocked
+ * the clock jumps to the earliest wake-up or timer deadline instead of
+ * sleeping, so simulated time runs as fast as the host can execute the code.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+#define SIM_TASK_NAME_LEN   16
+#define SIM_NO_WAKE         UINT64_MAX
+
+struct sim_task {
+    pthread_t thread;
+    pthread_cond_t cv;
+    char name[SIM_TASK_NAME_LEN];
+    UBaseType_t priority;
+    UBaseType_t number;         // TCB number, as uxTaskGetSystemState lists it
+    UBaseType_t trace_number;   // vTaskSetTaskNumber; 0 until set, as on target
+    uint32_t stack_depth;
+    TaskFunction_t fn;
+    void *arg;
+    eTaskState state;
+    uint64_t wake_us;
+    const void *wait_obj;
+    bool timed_out;
+    uint64_t ready_seq;
+    uint64_t runtime_us;
+    uint32_t notify;
+    struct sim_task *next;
+};
+
+typedef enum {
+    SIM_QUEUE_DATA,
+    SIM_QUEUE_MUTEX,
+    SIM_QUEUE_SEMAPHORE,
+} sim_queue_kind_t;
+
+struct sim_queue {
+    sim_queue_kind_t kind;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    uint8_t *storage;
+    sim_queue_stats_t stats;
+    struct sim_queue *next;
+};
+
+struct sim_event_group {
+    EventBits_t bits;
+};
+
+struct sim_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool active;
+    uint64_t deadline_us;
+    uint64_t period_us;
+    struct sim_timer *next;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_done_cv = PTHREAD_COND_INITIALIZER;
+static struct sim_task *s_tasks = NULL;
+static struct sim_task *s_current = NULL;
+static struct sim_queue *s_queues = NULL;
+static struct sim_timer *s_timers = NULL;
+static uint64_t s_now_us = 0;
+static uint64_t s_end_us = 0;
+static uint64_t s_idle_us = 0;
+static uint64_t s_seq = 0;
+static uint64_t s_switches = 0;
+static UBaseType_t s_next_number = 1;
+static bool s_done = false;
+static bool s_in_isr = false;
+
+// ============================================
+// SCHEDULER CORE
+// ============================================
+
+static void make_ready(struct sim_task *t)
+{
+    t->state = eReady;
+    t->wait_obj = NULL;
+    t->wake_us = SIM_NO_WAKE;
+    t->ready_seq = ++s_seq;
+}
+
+static struct sim_task *pick_next(void)
+{
+    struct sim_task *best = NULL;
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state != eReady) continue;
+        if (!best || t->priority > best->priority ||
+            (t->priority == best->priority && t->ready_seq < best->ready_seq)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static uint64_t next_event_us(void)
+{
+    uint64_t next = SIM_NO_WAKE;
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state == eBlocked && t->wake_us < next) next = t->wake_us;
+    }
+    for (struct sim_timer *tm = s_timers; tm; tm = tm->next) {
+        if (tm->active && tm->deadline_us < next) next = tm->deadline_us;
+    }
+    return next;
+}
+
+static void fire_due_timers(void)
+{
+    bool fired = true;
+    s_in_isr = true;
+    while (fired) {
+        fired = false;
+        for (struct sim_timer *tm = s_timers; tm; tm = tm->next) {
+            if (!tm->active || tm->deadline_us > s_now_us) continue;
+            if (tm->period_us) {
+                tm->deadline_us += tm->period_us;
+            } else {
+                tm->active = false;
+            }
+            tm->callback(tm->arg);
+            fired = true;
+        }
+    }
+    s_in_isr = false;
+}
+
+static void expire_timeouts(void)
+{
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state == eBlocked && t->wake_us <= s_now_us) {
+            make_ready(t);
+            t->timed_out = true;
+        }
+    }
+}
+
+static void finish_run(void)
+{
+    s_done = true;
+    pthread_cond_signal(&s_done_cv);
+}
+
+/**
+ * Hand the CPU to the best ready task. The caller has already moved itself
+ * out of eRunning. Returns once the caller is scheduled again (never for a
+ * deleted task, which returns immediately so its thread can exit).
+ */
+static void reschedule(struct sim_task *self)
+{
+    struct sim_task *next = pick_next();
+
+    while (next == NULL) {
+        uint64_t when = next_event_us();
+        if (when == SIM_NO_WAKE || when > s_end_us) {
+            if (s_end_us > s_now_us && when != SIM_NO_WAKE) {
+                s_idle_us += s_end_us - s_now_us;
+                s_now_us = s_end_us;
+            }
+            finish_run();
+            if (self->state == eDeleted) return;
+            for (;;) pthread_cond_wait(&self->cv, &s_lock);
+        }
+        if (when > s_now_us) {
+            s_idle_us += when - s_now_us;
+            s_now_us = when;
+        }
+        fire_due_timers();
+        expire_timeouts();
+        next = pick_next();
+    }
+
+    next->state = eRunning;
+    if (next != s_current) s_switches++;
+    s_current = next;
+    if (next == self) return;
+
+    pthread_cond_signal(&next->cv);
+    if (self->state == eDeleted) return;
+    while (s_current != self) {
+        pthread_cond_wait(&self->cv, &s_lock);
+    }
+}
+
+static void yield_to_higher(void)
+{
+    if (s_in_isr || s_current == NULL) return;
+    struct sim_task *best = pick_next();
+    if (best && best->priority > s_current->priority) {
+        struct sim_task *self = s_current;
+        make_ready(self);
+        reschedule(self);
+    }
+}
+
+/**
+ * Block the running task on obj until woken or deadline_us passes.
+ * Returns false on timeout.
+ */
+static bool block_until(const void *obj, uint64_t deadline_us)
+{
+    struct sim_task *self = s_current;
+    if (s_in_isr || self == NULL) {
+        fprintf(stderr, "sim: blocking call outside task context\n");
+        abort();
+    }
+    self->state = eBlocked;
+    self->wait_obj = obj;
+    self->wake_us = deadline_us;
+    self->timed_out = false;
+    reschedule(self);
+    return !self->timed_out;
+}
+
+static void wake_waiters(const void *obj)
+{
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state == eBlocked && t->wait_obj == obj) make_ready(t);
+    }
+}
+
+static uint64_t deadline_for(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) return SIM_NO_WAKE;
+    return (s_now_us / 1000 + ticks) * 1000;
+}
+
+static void *task_entry(void *param)
+{
+    struct sim_task *t = (struct sim_task *)param;
+
+    pthread_mutex_lock(&s_lock);
+    while (s_current != t) {
+        pthread_cond_wait(&t->cv, &s_lock);
+    }
+    t->fn(t->arg);
+
+    // Returning from a task function is a bug on target; treat it as delete
+    fprintf(stderr, "sim: task '%s' returned without vTaskDelete\n", t->name);
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+// ============================================
+// SIMULATOR CONTROL
+// ============================================
+
+static void main_task_fn(void *arg)
+{
+    void (*entry)(void) = *(void (**)(void))arg;
+    entry();
+    vTaskDelete(NULL);
+}
+
+void sim_kernel_run(void (*entry)(void), uint64_t end_us)
+{
+    static void (*s_entry)(void);
+    TaskHandle_t main_task;
+
+    pthread_mutex_lock(&s_lock);
+    s_end_us = end_us;
+    s_entry = entry;
+    xTaskCreatePinnedToCore(main_task_fn, "main", 4096, &s_entry, 1, &main_task, 0);
+    main_task->state = eRunning;
+    s_current = main_task;
+    pthread_cond_signal(&main_task->cv);
+    while (!s_done) {
+        pthread_cond_wait(&s_done_cv, &s_lock);
+    }
+    // The lock is intentionally kept: every task stays parked from here on
+}
+
+uint64_t sim_now_us(void)
+{
+    return s_now_us;
+}
+
+void sim_busy_us(uint32_t us)
+{
+    s_now_us += us;
+    if (s_current) s_current->runtime_us += us;
+}
+
+void sim_sleep_us(uint64_t us)
+{
+    static const char sleep_obj = 0;
+    if (s_in_isr || s_current == NULL) {
+        s_now_us += us;
+        return;
+    }
+    block_until(&sleep_obj, s_now_us + us);
+}
+
+uint64_t sim_idle_us(void)
+{
+    return s_idle_us;
+}
+
+uint64_t sim_context_switches(void)
+{
+    return s_switches;
+}
+
+bool sim_queue_stats(int index, sim_queue_stats_t *out)
+{
+    // s_queues is newest-first; walk to creation order
+    int total = 0;
+    for (struct sim_queue *q = s_queues; q; q = q->next) {
+        if (q->kind == SIM_QUEUE_DATA) total++;
+    }
+    if (index < 0 || index >= total) return false;
+    int want = total - 1 - index;
+    for (struct sim_queue *q = s_queues; q; q = q->next) {
+        if (q->kind != SIM_QUEUE_DATA) continue;
+        if (want-- == 0) {
+            *out = q->stats;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sim_task_stack_stats(uint32_t *tasks, uint32_t *bytes)
+{
+    *tasks = 0;
+    *bytes = 0;
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (strcmp(t->name, "main") == 0) continue;
+        (*tasks)++;
+        *bytes += t->stack_depth;
+    }
+}
+
+// ============================================
+// TASKS
+// ============================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name,
+                                   uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core_id)
+{
+    (void)core_id;
+    struct sim_task *t = calloc(1, sizeof(*t));
+    if (!t) return pdFAIL;
+
+    pthread_cond_init(&t->cv, NULL);
+    snprintf(t->name, sizeof(t->name), "%s", name ? name : "");
+    t->fn = fn;
+    t->arg = arg;
+    t->priority = priority;
+    t->stack_depth = stack_depth;
+    t->number = s_next_number++;
+    make_ready(t);
+
+    // Append so uxTaskGetSystemState lists tasks in creation order
+    struct sim_task **tail = &s_tasks;
+    while (*tail) tail = &(*tail)->next;
+    *tail = t;
+
+    if (handle) *handle = t;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, 256 * 1024);
+    if (pthread_create(&t->thread, &attr, task_entry, t) != 0) {
+        fprintf(stderr, "sim: failed to create thread for '%s'\n", t->name);
+        abort();
+    }
+    pthread_attr_destroy(&attr);
+
+    yield_to_higher();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    struct sim_task *t = task ? task : s_current;
+    t->state = eDeleted;
+    if (t != s_current) return;
+
+    reschedule(t);
+    pthread_mutex_unlock(&s_lock);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0) {
+        taskYIELD();
+        return;
+    }
+    static const char delay_obj = 0;
+    block_until(&delay_obj, deadline_for(ticks));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *prev_wake, TickType_t increment)
+{
+    static const char delay_obj = 0;
+    TickType_t target = *prev_wake + increment;
+    *prev_wake = target;
+    if ((uint64_t)target * 1000 <= s_now_us) {
+        return pdFALSE;
+    }
+    block_until(&delay_obj, (uint64_t)target * 1000);
+    return pdTRUE;
+}
+
+void taskYIELD(void)
+{
+    struct sim_task *self = s_current;
+    make_ready(self);
+    reschedule(self);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(s_now_us / 1000);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current;
+}
+
+char *pcTaskGetName(TaskHandle_t task)
+{
+    struct sim_task *t = task ? task : s_current;
+    return t ? t->name : NULL;
+}
+
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task)
+{
+    return task ? task->trace_number : 0;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t task, UBaseType_t number)
+{
+    if (task) task->trace_number = number;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    struct sim_task *t = task ? task : s_current;
+    return t ? t->priority : 0;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    UBaseType_t n = 1;  // IDLE
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state != eDeleted) n++;
+    }
+    return n;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    // Host stacks say nothing about target usage; report the full allocation
+    struct sim_task *t = task ? task : s_current;
+    return t ? t->stack_depth : 0;
+}
+
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t *status, BaseType_t get_free_stack,
+                  eTaskState state)
+{
+    struct sim_task *t = task ? task : s_current;
+
+    status->xHandle = t;
+    status->pcTaskName = t->name;
+    status->xTaskNumber = t->number;
+    status->eCurrentState = state == eInvalid ? t->state : state;
+    status->uxCurrentPriority = t->priority;
+    status->uxBasePriority = t->priority;
+    status->ulRunTimeCounter = (uint32_t)t->runtime_us;
+    status->pxStackBase = NULL;
+    status->usStackHighWaterMark = get_free_stack ? t->stack_depth : 0;
+    status->xCoreID = 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t count,
+                                 uint32_t *total_runtime)
+{
+    static const char idle_name[] = "IDLE";
+    UBaseType_t n = 0;
+
+    if (count < uxTaskGetNumberOfTasks()) return 0;
+
+    for (struct sim_task *t = s_tasks; t; t = t->next) {
+        if (t->state == eDeleted) continue;
+        vTaskGetInfo(t, &status[n], pdTRUE, eInvalid);
+        n++;
+    }
+
+    memset(&status[n], 0, sizeof(status[n]));
+    status[n].pcTaskName = idle_name;
+    status[n].xTaskNumber = 0;
+    status[n].eCurrentState = eReady;
+    status[n].ulRunTimeCounter = (uint32_t)s_idle_us;
+    status[n].usStackHighWaterMark = 1024;
+    n++;
+
+    if (total_runtime) *total_runtime = (uint32_t)s_now_us;
+    return n;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct sim_task *self = s_current;
+    uint64_t deadline = deadline_for(ticks);
+
+    while (self->notify == 0) {
+        if (ticks == 0 || !block_until(self, deadline)) return 0;
+    }
+    uint32_t value = self->notify;
+    self->notify = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    task->notify++;
+    wake_waiters(task);
+    yield_to_higher();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_prio_woken)
+{
+    task->notify++;
+    wake_waiters(task);
+    if (higher_prio_woken) *higher_prio_woken = pdTRUE;
+}
+
+// ============================================
+// QUEUES AND SEMAPHORES
+// ============================================
+
+static struct sim_queue *queue_new(sim_queue_kind_t kind, UBaseType_t length,
+                                   UBaseType_t item_size)
+{
+    struct sim_queue *q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->kind = kind;
+    q->length = length;
+    q->item_size = item_size;
+    if (item_size) {
+        q->storage = calloc(length, item_size);
+        if (!q->storage) {
+            free(q);
+            return NULL;
+        }
+    }
+    q->stats.length = length;
+    q->stats.item_size = item_size;
+    q->next = s_queues;
+    s_queues = q;
+    return q;
+}
+
+static void queue_push(struct sim_queue *q, const void *item, bool front)
+{
+    if (q->item_size) {
+        UBaseType_t slot;
+        if (front) {
+            q->head = (q->head + q->length - 1) % q->length;
+            slot = q->head;
+        } else {
+            slot = (q->head + q->count) % q->length;
+        }
+        memcpy(q->storage + slot * q->item_size, item, q->item_size);
+    }
+    q->count++;
+    q->stats.sends++;
+    if (q->count > q->stats.high_water) q->stats.high_water = q->count;
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks,
+                             bool front)
+{
+    uint64_t deadline = deadline_for(ticks);
+
+    while (q->count >= q->length) {
+        if (ticks == 0 || s_in_isr || !block_until(q, deadline)) {
+            q->stats.send_fails++;
+            return errQUEUE_FULL;
+        }
+    }
+    queue_push(q, item, front);
+    wake_waiters(q);
+    yield_to_higher();
+    return pdPASS;
+}
+
+static BaseType_t queue_take(QueueHandle_t q, void *item, TickType_t ticks, bool peek)
+{
+    uint64_t deadline = deadline_for(ticks);
+
+    while (q->count == 0) {
+        if (ticks == 0 || !block_until(q, deadline)) return pdFALSE;
+    }
+    if (q->item_size && item) {
+        memcpy(item, q->storage + q->head * q->item_size, q->item_size);
+    }
+    if (peek) {
+        q->stats.peeks++;
+        return pdTRUE;
+    }
+    q->head = q->item_size ? (q->head + 1) % q->length : 0;
+    q->count--;
+    q->stats.receives++;
+    wake_waiters(q);
+    yield_to_higher();
+    return pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    return queue_new(SIM_QUEUE_DATA, length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    // Queues are few and long-lived; keep them listed for the final report
+    (void)queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    return queue_send(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    return queue_send(queue, item, ticks, true);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    queue->count = 0;
+    queue->head = 0;
+    return queue_send(queue, item, 0, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken)
+{
+    bool was_isr = s_in_isr;
+    s_in_isr = true;
+    BaseType_t ret = queue_send(queue, item, 0, false);
+    s_in_isr = was_isr;
+    if (woken) *woken = pdFALSE;
+    return ret;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_take(queue, item, ticks, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_take(queue, item, ticks, true);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    queue->count = 0;
+    queue->head = 0;
+    wake_waiters(queue);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    return queue->length - queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct sim_queue *q = queue_new(SIM_QUEUE_MUTEX, 1, 0);
+    if (q) q->count = 1;
+    return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return queue_new(SIM_QUEUE_SEMAPHORE, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    struct sim_queue *q = queue_new(SIM_QUEUE_SEMAPHORE, max, 0);
+    if (q) q->count = initial;
+    return q;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    return queue_take(sem, NULL, ticks, false);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return queue_send(sem, NULL, 0, false);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    return xQueueSendFromISR(sem, NULL, woken);
+}
+
+// ============================================
+// EVENT GROUPS
+// ============================================
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(struct sim_event_group));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    group->bits |= bits;
+    wake_waiters(group);
+    yield_to_higher();
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_for_all,
+                                TickType_t ticks)
+{
+    uint64_t deadline = deadline_for(ticks);
+
+    for (;;) {
+        EventBits_t now = group->bits;
+        bool met = wait_for_all ? (now & bits) == bits : (now & bits) != 0;
+        if (met) {
+            if (clear_on_exit) group->bits &= ~bits;
+            return now;
+        }
+        if (ticks == 0 || !block_until(group, deadline)) return group->bits;
+    }
+}
+
+// ============================================
+// ESP_TIMER
+// ============================================
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+    struct sim_timer *tm = calloc(1, sizeof(*tm));
+    if (!tm) return ESP_ERR_NO_MEM;
+    tm->callback = args->callback;
+    tm->arg = args->arg;
+    tm->next = s_timers;
+    s_timers = tm;
+    *out = tm;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline_us = s_now_us + timeout_us;
+    timer->period_us = 0;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline_us = s_now_us + period_us;
+    timer->period_us = period_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    struct sim_timer **pp = &s_timers;
+    while (*pp && *pp != timer) pp = &(*pp)->next;
+    if (!*pp) return ESP_ERR_INVALID_ARG;
+    *pp = timer->next;
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer->active;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)s_now_us;
+}
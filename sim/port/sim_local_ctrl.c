@@ -0,0 +1,161 @@
+/**
+ * @file sim_local_ctrl.c
+ * @brief esp_local_ctrl stand-in: property table, endpoints and handler dispatch
+ *
+ * There is no server. sim_main plays the LAN client after the run through
+ * sim_local_ctrl_get()/sim_local_ctrl_set()/sim_local_ctrl_request(), which
+ * go through the same handlers a request from the network would reach.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_local_ctrl.h"
+#include "esp_log.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_LOCAL_CTRL";
+
+#define SIM_MAX_PROPS           16
+#define SIM_MAX_ENDPOINTS       4
+
+static struct esp_local_ctrl_transport {
+    int unused;
+} s_httpd;
+
+static esp_local_ctrl_handlers_t s_handlers;
+static esp_local_ctrl_prop_t s_props[SIM_MAX_PROPS];
+static size_t s_prop_count;
+static size_t s_max_props;
+static bool s_running;
+
+static struct {
+    const char *name;
+    protocomm_req_handler_t handler;
+    void *ctx;
+} s_endpoints[SIM_MAX_ENDPOINTS];
+static size_t s_endpoint_count;
+
+const esp_local_ctrl_transport_t *esp_local_ctrl_get_transport_httpd(void)
+{
+    return &s_httpd;
+}
+
+esp_err_t esp_local_ctrl_start(const esp_local_ctrl_config_t *config)
+{
+    if (!config || s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_handlers = config->handlers;
+    s_max_props = config->max_properties < SIM_MAX_PROPS ? config->max_properties : SIM_MAX_PROPS;
+    s_prop_count = 0;
+    s_running = true;
+    ESP_LOGD(TAG, "Started, port %u", (unsigned)config->transport_config.httpd->port_insecure);
+    return ESP_OK;
+}
+
+esp_err_t esp_local_ctrl_stop(void)
+{
+    s_running = false;
+    s_prop_count = 0;
+    s_endpoint_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_local_ctrl_add_property(const esp_local_ctrl_prop_t *prop)
+{
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_prop_count >= s_max_props) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_props[s_prop_count++] = *prop;
+    return ESP_OK;
+}
+
+esp_err_t esp_local_ctrl_set_handler(const char *ep_name, protocomm_req_handler_t handler,
+                                     void *user_ctx)
+{
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!ep_name || !handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_endpoint_count >= SIM_MAX_ENDPOINTS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_endpoints[s_endpoint_count].name = ep_name;
+    s_endpoints[s_endpoint_count].handler = handler;
+    s_endpoints[s_endpoint_count].ctx = user_ctx;
+    s_endpoint_count++;
+    return ESP_OK;
+}
+
+static const esp_local_ctrl_prop_t *find_prop(const char *name)
+{
+    for (size_t i = 0; s_running && i < s_prop_count; i++) {
+        if (strcmp(s_props[i].name, name) == 0) {
+            return &s_props[i];
+        }
+    }
+    return NULL;
+}
+
+int sim_local_ctrl_get(const char *name, void **data, size_t *size)
+{
+    const esp_local_ctrl_prop_t *prop = find_prop(name);
+    if (!prop) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_local_ctrl_prop_val_t val = { 0 };
+    esp_err_t err = s_handlers.get_prop_values(1, prop, &val, s_handlers.usr_ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    *data = malloc(val.size ? val.size : 1);
+    memcpy(*data, val.data, val.size);
+    *size = val.size;
+    if (val.free_fn) {
+        val.free_fn(val.data);
+    }
+    return ESP_OK;
+}
+
+int sim_local_ctrl_set(const char *name, const void *data, size_t size)
+{
+    const esp_local_ctrl_prop_t *prop = find_prop(name);
+    if (!prop) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (prop->flags & PROP_FLAG_READONLY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_local_ctrl_prop_val_t val = { .data = (void *)data, .size = size };
+    return s_handlers.set_prop_values(1, prop, &val, s_handlers.usr_ctx);
+}
+
+int sim_local_ctrl_request(const char *endpoint, const void *in, size_t in_len,
+                           void **out, size_t *out_len)
+{
+    for (size_t i = 0; s_running && i < s_endpoint_count; i++) {
+        if (strcmp(s_endpoints[i].name, endpoint) != 0) {
+            continue;
+        }
+        uint8_t *buf = NULL;
+        ssize_t len = 0;
+        esp_err_t err = s_endpoints[i].handler(0, in, (ssize_t)in_len, &buf, &len,
+                                               s_endpoints[i].ctx);
+        if (err != ESP_OK) {
+            free(buf);
+            return err;
+        }
+        *out = buf;
+        *out_len = (size_t)len;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file sim_log.c
+ * @brief Logging and error-name stand-ins for the host simulation build
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "sim.h"
+
+#define SIM_LOG_MAX_TAGS 32
+
+static esp_log_level_t s_level = ESP_LOG_INFO;
+static struct {
+    char tag[24];
+    esp_log_level_t level;
+} s_tags[SIM_LOG_MAX_TAGS];
+static int s_tag_count = 0;
+static uint32_t s_lines = 0;
+static uint64_t s_bytes = 0;
+
+void sim_log_set_level(int level)
+{
+    s_level = (esp_log_level_t)level;
+}
+
+void sim_log_stats(uint32_t *lines, uint64_t *bytes)
+{
+    if (lines) *lines = s_lines;
+    if (bytes) *bytes = s_bytes;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0) {
+        s_level = level;
+        return;
+    }
+    for (int i = 0; i < s_tag_count; i++) {
+        if (strcmp(s_tags[i].tag, tag) == 0) {
+            s_tags[i].level = level;
+            return;
+        }
+    }
+    if (s_tag_count < SIM_LOG_MAX_TAGS) {
+        snprintf(s_tags[s_tag_count].tag, sizeof(s_tags[0].tag), "%s", tag);
+        s_tags[s_tag_count].level = level;
+        s_tag_count++;
+    }
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(sim_now_us() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    // Compile-time maximum on target is verbose, runtime default is info
+    esp_log_level_t limit = s_level;
+    for (int i = 0; i < s_tag_count; i++) {
+        if (strcmp(s_tags[i].tag, tag) == 0) {
+            limit = s_tags[i].level;
+            break;
+        }
+    }
+
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    // Count what the UART would have carried at the target's default level
+    if (level <= ESP_LOG_INFO) {
+        s_lines++;
+        s_bytes += len > 0 ? (uint64_t)len : 0;
+    }
+    if (level > limit) return;
+    fputs(line, stdout);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        default: return "UNKNOWN ERROR";
+    }
+}
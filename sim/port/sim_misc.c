@@ -0,0 +1,115 @@
+/**
+ * @file sim_misc.c
+ * @brief OTA, app descriptor and Insights stand-ins
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_ota_ops.h"
+#include "esp_app_desc.h"
+#include "app_insights.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_rtc_time.h"
+#include "esp_rom_crc.h"
+#include "sim.h"
+
+static const char *TAG = "SIM";
+
+static const esp_partition_t s_ota_0 = {
+    .address = 0x20000,
+    .size = 0x1C0000,
+    .label = "ota_0",
+};
+
+static const esp_app_desc_t s_app_desc = {
+    .version = PROJECT_VER,
+    .project_name = "smart_environmental_logger",
+    .time = __TIME__,
+    .date = __DATE__,
+    .idf_ver = "host-sim",
+};
+
+const esp_partition_t *esp_ota_get_running_partition(void)
+{
+    return &s_ota_0;
+}
+
+const esp_partition_t *esp_ota_get_boot_partition(void)
+{
+    return &s_ota_0;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition,
+                                      esp_ota_img_states_t *ota_state)
+{
+    (void)partition;
+    *ota_state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void)
+{
+    return ESP_OK;
+}
+
+const esp_app_desc_t *esp_app_get_description(void)
+{
+    return &s_app_desc;
+}
+
+esp_err_t app_insights_enable(void)
+{
+    ESP_LOGI(TAG, "Insights stand-in enabled");
+    return ESP_OK;
+}
+
+// Every simulated boot is a power-on; deep sleep ends the run
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void)
+{
+    return ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+    ESP_LOGI(TAG, "Timer wake-up in %llu us", (unsigned long long)time_in_us);
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start(void)
+{
+    ESP_LOGW(TAG, "Deep sleep is not simulated, stopping");
+    fflush(stdout);
+    _Exit(0);
+}
+
+uint64_t esp_rtc_get_time_us(void)
+{
+    return sim_now_us();
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+#if SIM_NEED_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
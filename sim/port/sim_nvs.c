@@ -0,0 +1,173 @@
+/**
+ * @file sim_nvs.c
+ * @brief In-memory NVS stand-in for the host simulation build
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "sim.h"
+
+#define SIM_NVS_MAX_NAMESPACES  16
+#define SIM_NVS_MAX_ENTRIES     256
+
+typedef struct {
+    uint32_t ns;
+    char key[16];
+    void *data;
+    size_t len;
+} sim_nvs_entry_t;
+
+static char s_namespaces[SIM_NVS_MAX_NAMESPACES][16];
+static int s_ns_count = 0;
+static sim_nvs_entry_t s_entries[SIM_NVS_MAX_ENTRIES];
+static int s_entry_count = 0;
+static bool s_initialized = false;
+
+esp_err_t nvs_flash_init(void)
+{
+    sim_busy_us(SIM_NVS_INIT_US);
+    s_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    for (int i = 0; i < s_entry_count; i++) free(s_entries[i].data);
+    s_entry_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out_handle)
+{
+    (void)mode;
+    if (!s_initialized) return ESP_ERR_NVS_NOT_INITIALIZED;
+    for (int i = 0; i < s_ns_count; i++) {
+        if (strcmp(s_namespaces[i], name) == 0) {
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    if (s_ns_count >= SIM_NVS_MAX_NAMESPACES) return ESP_ERR_NO_MEM;
+    snprintf(s_namespaces[s_ns_count], sizeof(s_namespaces[0]), "%s", name);
+    *out_handle = (nvs_handle_t)(++s_ns_count);
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+static sim_nvs_entry_t *find(nvs_handle_t handle, const char *key)
+{
+    for (int i = 0; i < s_entry_count; i++) {
+        if (s_entries[i].ns == handle && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t set_raw(nvs_handle_t handle, const char *key, const void *data, size_t len)
+{
+    if (handle == 0) return ESP_ERR_NVS_INVALID_HANDLE;
+    sim_nvs_entry_t *e = find(handle, key);
+    if (!e) {
+        if (s_entry_count >= SIM_NVS_MAX_ENTRIES) return ESP_ERR_NVS_NO_FREE_PAGES;
+        e = &s_entries[s_entry_count++];
+        e->ns = handle;
+        snprintf(e->key, sizeof(e->key), "%s", key);
+        e->data = NULL;
+    }
+    void *copy = malloc(len ? len : 1);
+    if (!copy) return ESP_ERR_NO_MEM;
+    memcpy(copy, data, len);
+    free(e->data);
+    e->data = copy;
+    e->len = len;
+    return ESP_OK;
+}
+
+static esp_err_t get_raw(nvs_handle_t handle, const char *key, void *out, size_t len)
+{
+    sim_nvs_entry_t *e = find(handle, key);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    if (e->len != len) return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out, e->data, len);
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    sim_nvs_entry_t *e = find(handle, key);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    free(e->data);
+    *e = s_entries[--s_entry_count];
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    for (int i = 0; i < s_entry_count;) {
+        if (s_entries[i].ns == handle) {
+            free(s_entries[i].data);
+            s_entries[i] = s_entries[--s_entry_count];
+        } else {
+            i++;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t h, const char *k, uint8_t v)   { return set_raw(h, k, &v, sizeof(v)); }
+esp_err_t nvs_set_u16(nvs_handle_t h, const char *k, uint16_t v) { return set_raw(h, k, &v, sizeof(v)); }
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *k, uint32_t v) { return set_raw(h, k, &v, sizeof(v)); }
+esp_err_t nvs_set_i32(nvs_handle_t h, const char *k, int32_t v)  { return set_raw(h, k, &v, sizeof(v)); }
+esp_err_t nvs_get_u8(nvs_handle_t h, const char *k, uint8_t *v)   { return get_raw(h, k, v, sizeof(*v)); }
+esp_err_t nvs_get_u16(nvs_handle_t h, const char *k, uint16_t *v) { return get_raw(h, k, v, sizeof(*v)); }
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *k, uint32_t *v) { return get_raw(h, k, v, sizeof(*v)); }
+esp_err_t nvs_get_i32(nvs_handle_t h, const char *k, int32_t *v)  { return get_raw(h, k, v, sizeof(*v)); }
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    return set_raw(handle, key, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return set_raw(handle, key, value, length);
+}
+
+static esp_err_t get_var(nvs_handle_t handle, const char *key, void *out, size_t *length)
+{
+    sim_nvs_entry_t *e = find(handle, key);
+    if (!e) return ESP_ERR_NVS_NOT_FOUND;
+    if (out == NULL) {
+        *length = e->len;
+        return ESP_OK;
+    }
+    if (*length < e->len) return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out, e->data, e->len);
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    return get_var(handle, key, out_value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return get_var(handle, key, out_value, length);
+}
@@ -0,0 +1,443 @@
+/**
+ * @file sim_rmaker.c
+ * @brief In-memory RainMaker stand-in that records every publish
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_rmaker_core.h"
+#include "esp_rmaker_standard_params.h"
+#include "esp_rmaker_standard_devices.h"
+#include "esp_rmaker_schedule.h"
+#include "esp_rmaker_scenes.h"
+#include "esp_rmaker_ota.h"
+#include "esp_rmaker_mqtt.h"
+#include "freertos/FreeRTOS.h"
+#include "sim.h"
+
+#define SIM_RMAKER_MAX_PARAMS 16
+
+struct sim_rmaker_param {
+    char name[40];
+    char type[40];
+    uint8_t flags;
+    bool changed;               // Updated, goes out with the next report
+    esp_rmaker_param_val_t val;
+    const struct sim_rmaker_device *device;
+};
+
+struct sim_rmaker_device {
+    char name[32];
+    char type[40];
+    void *priv;
+    esp_rmaker_device_write_cb_t write_cb;
+    struct sim_rmaker_param *params[SIM_RMAKER_MAX_PARAMS];
+    int param_count;
+    struct sim_rmaker_device *next;
+};
+
+struct sim_rmaker_node {
+    char name[32];
+};
+
+static struct sim_rmaker_node s_node;
+static struct sim_rmaker_device *s_devices = NULL;
+static sim_publish_fn_t s_hook = NULL;
+static void *s_hook_ctx = NULL;
+static uint32_t s_publishes = 0;
+static uint32_t s_digest = SIM_FNV1A_INIT;
+static uint32_t s_latency_us = 0;
+static uint32_t s_mqtt_messages = 0;
+static uint32_t s_mqtt_bytes = 0;
+static FILE *s_mqtt_dump = NULL;
+
+void sim_rmaker_set_publish_hook(sim_publish_fn_t fn, void *ctx)
+{
+    s_hook = fn;
+    s_hook_ctx = ctx;
+}
+
+void sim_rmaker_stats(uint32_t *publishes, uint32_t *digest)
+{
+    if (publishes) *publishes = s_publishes;
+    if (digest) *digest = s_digest;
+}
+
+void sim_rmaker_set_publish_latency_us(uint32_t us)
+{
+    s_latency_us = us;
+}
+
+static void val_to_str(esp_rmaker_param_val_t val, char *buf, size_t len)
+{
+    switch (val.type) {
+        case RMAKER_VAL_TYPE_BOOLEAN: snprintf(buf, len, "%s", val.val.b ? "true" : "false"); break;
+        case RMAKER_VAL_TYPE_INTEGER: snprintf(buf, len, "%d", val.val.i); break;
+        case RMAKER_VAL_TYPE_FLOAT:   snprintf(buf, len, "%.2f", val.val.f); break;
+        case RMAKER_VAL_TYPE_STRING:
+        case RMAKER_VAL_TYPE_OBJECT:
+        case RMAKER_VAL_TYPE_ARRAY:   snprintf(buf, len, "%s", val.val.s ? val.val.s : ""); break;
+        default:                      snprintf(buf, len, "?"); break;
+    }
+}
+
+static void store_val(struct sim_rmaker_param *p, esp_rmaker_param_val_t val)
+{
+    if (p->val.type == RMAKER_VAL_TYPE_STRING || p->val.type == RMAKER_VAL_TYPE_OBJECT ||
+        p->val.type == RMAKER_VAL_TYPE_ARRAY) {
+        free(p->val.val.s);
+    }
+    p->val = val;
+    if ((val.type == RMAKER_VAL_TYPE_STRING || val.type == RMAKER_VAL_TYPE_OBJECT ||
+         val.type == RMAKER_VAL_TYPE_ARRAY) && val.val.s) {
+        p->val.val.s = strdup(val.val.s);
+    }
+}
+
+// ============================================
+// NODE / DEVICE / PARAM
+// ============================================
+
+esp_rmaker_node_t *esp_rmaker_node_init(const esp_rmaker_config_t *config,
+                                        const char *name, const char *type)
+{
+    (void)config;
+    (void)type;
+    sim_busy_us(SIM_RMAKER_NODE_INIT_US);
+    snprintf(s_node.name, sizeof(s_node.name), "%s", name);
+    return &s_node;
+}
+
+esp_err_t esp_rmaker_start(void)
+{
+    sim_busy_us(SIM_RMAKER_START_US);
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_node_add_device(const esp_rmaker_node_t *node,
+                                     const esp_rmaker_device_t *device)
+{
+    (void)node;
+    struct sim_rmaker_device *dev = (struct sim_rmaker_device *)device;
+    if (!dev) return ESP_ERR_INVALID_ARG;
+    struct sim_rmaker_device **tail = &s_devices;
+    while (*tail) tail = &(*tail)->next;
+    *tail = dev;
+    return ESP_OK;
+}
+
+esp_rmaker_device_t *esp_rmaker_device_create(const char *dev_name, const char *type,
+                                              void *priv_data)
+{
+    struct sim_rmaker_device *dev = calloc(1, sizeof(*dev));
+    if (!dev) return NULL;
+    snprintf(dev->name, sizeof(dev->name), "%s", dev_name);
+    snprintf(dev->type, sizeof(dev->type), "%s", type ? type : "");
+    dev->priv = priv_data;
+    return dev;
+}
+
+esp_err_t esp_rmaker_device_add_cb(const esp_rmaker_device_t *device,
+                                   esp_rmaker_device_write_cb_t write_cb,
+                                   esp_rmaker_device_read_cb_t read_cb)
+{
+    (void)read_cb;
+    if (!device) return ESP_ERR_INVALID_ARG;
+    ((struct sim_rmaker_device *)device)->write_cb = write_cb;
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_device_add_param(const esp_rmaker_device_t *device,
+                                      const esp_rmaker_param_t *param)
+{
+    struct sim_rmaker_device *dev = (struct sim_rmaker_device *)device;
+    struct sim_rmaker_param *p = (struct sim_rmaker_param *)param;
+    if (!dev || !p || dev->param_count >= SIM_RMAKER_MAX_PARAMS) return ESP_ERR_INVALID_ARG;
+    p->device = dev;
+    dev->params[dev->param_count++] = p;
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_device_assign_primary_param(const esp_rmaker_device_t *device,
+                                                 const esp_rmaker_param_t *param)
+{
+    return (device && param) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+const char *esp_rmaker_device_get_name(const esp_rmaker_device_t *device)
+{
+    return device ? device->name : NULL;
+}
+
+esp_rmaker_param_t *esp_rmaker_device_get_param_by_type(const esp_rmaker_device_t *device,
+                                                        const char *param_type)
+{
+    if (!device || !param_type) return NULL;
+    for (int i = 0; i < device->param_count; i++) {
+        if (strcmp(device->params[i]->type, param_type) == 0) return device->params[i];
+    }
+    return NULL;
+}
+
+esp_rmaker_param_t *esp_rmaker_device_get_param_by_name(const esp_rmaker_device_t *device,
+                                                        const char *param_name)
+{
+    if (!device || !param_name) return NULL;
+    for (int i = 0; i < device->param_count; i++) {
+        if (strcmp(device->params[i]->name, param_name) == 0) return device->params[i];
+    }
+    return NULL;
+}
+
+esp_rmaker_param_t *esp_rmaker_param_create(const char *param_name, const char *type,
+                                            esp_rmaker_param_val_t val, uint8_t properties)
+{
+    struct sim_rmaker_param *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+    snprintf(p->name, sizeof(p->name), "%s", param_name);
+    snprintf(p->type, sizeof(p->type), "%s", type ? type : "");
+    p->flags = properties;
+    store_val(p, val);
+    return p;
+}
+
+esp_err_t esp_rmaker_param_add_ui_type(const esp_rmaker_param_t *param, const char *ui_type)
+{
+    (void)ui_type;
+    return param ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_rmaker_param_add_bounds(const esp_rmaker_param_t *param,
+                                      esp_rmaker_param_val_t min,
+                                      esp_rmaker_param_val_t max,
+                                      esp_rmaker_param_val_t step)
+{
+    (void)min;
+    (void)max;
+    (void)step;
+    return param ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_rmaker_param_update(const esp_rmaker_param_t *param, esp_rmaker_param_val_t val)
+{
+    if (!param) return ESP_ERR_INVALID_ARG;
+    struct sim_rmaker_param *p = (struct sim_rmaker_param *)param;
+    store_val(p, val);
+    p->changed = true;
+    return ESP_OK;
+}
+
+static void record_param(struct sim_rmaker_param *p)
+{
+    char text[160];
+    val_to_str(p->val, text, sizeof(text));
+    const char *dev_name = p->device ? p->device->name : "";
+
+    s_digest = sim_fnv1a(s_digest, dev_name, strlen(dev_name));
+    s_digest = sim_fnv1a(s_digest, p->name, strlen(p->name));
+    s_digest = sim_fnv1a(s_digest, text, strlen(text));
+    if (s_hook) {
+        s_hook(sim_now_us(), dev_name, p->name, text, s_hook_ctx);
+    }
+    p->changed = false;
+}
+
+esp_err_t esp_rmaker_param_update_and_report(const esp_rmaker_param_t *param,
+                                             esp_rmaker_param_val_t val)
+{
+    if (!param) return ESP_ERR_INVALID_ARG;
+    struct sim_rmaker_param *p = (struct sim_rmaker_param *)param;
+    store_val(p, val);
+
+    // One report carries every value updated since the last one
+    s_publishes++;
+    for (struct sim_rmaker_device *dev = s_devices; dev; dev = dev->next) {
+        for (int i = 0; i < dev->param_count; i++) {
+            if (dev->params[i]->changed && dev->params[i] != p) {
+                record_param(dev->params[i]);
+            }
+        }
+    }
+    record_param(p);
+    sim_wifi_note_tx();
+    if (s_latency_us) {
+        sim_sleep_us(s_latency_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_param_update_and_notify(const esp_rmaker_param_t *param,
+                                             esp_rmaker_param_val_t val)
+{
+    return esp_rmaker_param_update_and_report(param, val);
+}
+
+char *esp_rmaker_get_node_id(void)
+{
+    static char node_id[] = "simnode";
+    return node_id;
+}
+
+void sim_rmaker_mqtt_stats(uint32_t *messages, uint32_t *bytes)
+{
+    if (messages) *messages = s_mqtt_messages;
+    if (bytes) *bytes = s_mqtt_bytes;
+}
+
+int sim_rmaker_mqtt_dump(const char *path)
+{
+    s_mqtt_dump = fopen(path, "wb");
+    return s_mqtt_dump ? 0 : -1;
+}
+
+esp_err_t esp_rmaker_mqtt_publish(const char *topic, void *data, size_t data_len, uint8_t qos,
+                                  int *msg_id)
+{
+    (void)qos;
+    if (!topic || !data) return ESP_ERR_INVALID_ARG;
+
+    s_mqtt_messages++;
+    s_mqtt_bytes += (uint32_t)data_len;
+    if (s_mqtt_dump && strstr(topic, "/tlm/")) {      // Only the CBOR telemetry
+        fwrite(data, 1, data_len, s_mqtt_dump);
+        fflush(s_mqtt_dump);
+    }
+    if (msg_id) {
+        *msg_id = (int)s_mqtt_messages;
+    }
+    sim_wifi_note_tx();
+    if (s_latency_us) {
+        sim_sleep_us(s_latency_us);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_raise_alert(const char *alert_str)
+{
+    (void)alert_str;
+    s_publishes++;
+    return ESP_OK;
+}
+
+char *esp_rmaker_param_get_name(const esp_rmaker_param_t *param)
+{
+    return param ? ((struct sim_rmaker_param *)param)->name : NULL;
+}
+
+esp_rmaker_param_val_t *esp_rmaker_param_get_val(esp_rmaker_param_t *param)
+{
+    return param ? &param->val : NULL;
+}
+
+const char *esp_rmaker_device_cb_src_to_str(esp_rmaker_req_src_t src)
+{
+    switch (src) {
+        case ESP_RMAKER_REQ_SRC_INIT: return "Init";
+        case ESP_RMAKER_REQ_SRC_CLOUD: return "Cloud";
+        case ESP_RMAKER_REQ_SRC_SCHEDULE: return "Schedule";
+        case ESP_RMAKER_REQ_SRC_LOCAL: return "Local";
+        default: return "Other";
+    }
+}
+
+esp_err_t sim_rmaker_write(const char *device_name, const char *param_name,
+                           esp_rmaker_param_val_t val)
+{
+    for (struct sim_rmaker_device *dev = s_devices; dev; dev = dev->next) {
+        if (strcmp(dev->name, device_name) != 0) continue;
+        esp_rmaker_param_t *p = esp_rmaker_device_get_param_by_name(dev, param_name);
+        if (!p || !dev->write_cb) return ESP_ERR_NOT_FOUND;
+        esp_rmaker_write_ctx_t ctx = { .src = ESP_RMAKER_REQ_SRC_CLOUD };
+        return dev->write_cb(dev, p, val, dev->priv, &ctx);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// ============================================
+// VALUE CONSTRUCTORS
+// ============================================
+
+esp_rmaker_param_val_t esp_rmaker_bool(bool bval)
+{
+    esp_rmaker_param_val_t v = { .type = RMAKER_VAL_TYPE_BOOLEAN, .val.b = bval };
+    return v;
+}
+
+esp_rmaker_param_val_t esp_rmaker_int(int ival)
+{
+    esp_rmaker_param_val_t v = { .type = RMAKER_VAL_TYPE_INTEGER, .val.i = ival };
+    return v;
+}
+
+esp_rmaker_param_val_t esp_rmaker_float(float fval)
+{
+    esp_rmaker_param_val_t v = { .type = RMAKER_VAL_TYPE_FLOAT, .val.f = fval };
+    return v;
+}
+
+esp_rmaker_param_val_t esp_rmaker_str(const char *sval)
+{
+    esp_rmaker_param_val_t v = { .type = RMAKER_VAL_TYPE_STRING, .val.s = (char *)sval };
+    return v;
+}
+
+// ============================================
+// STANDARD DEVICES AND SERVICES
+// ============================================
+
+esp_rmaker_device_t *esp_rmaker_temp_sensor_device_create(const char *dev_name,
+                                                          void *priv_data, float temperature)
+{
+    esp_rmaker_device_t *dev = esp_rmaker_device_create(dev_name,
+                                                        ESP_RMAKER_DEVICE_TEMP_SENSOR, priv_data);
+    if (!dev) return NULL;
+    esp_rmaker_device_add_param(dev, esp_rmaker_param_create(ESP_RMAKER_DEF_NAME_PARAM,
+        ESP_RMAKER_PARAM_NAME, esp_rmaker_str(dev_name), PROP_FLAG_READ | PROP_FLAG_WRITE));
+    esp_rmaker_param_t *temp = esp_rmaker_param_create(ESP_RMAKER_DEF_TEMPERATURE_NAME,
+        ESP_RMAKER_PARAM_TEMPERATURE, esp_rmaker_float(temperature), PROP_FLAG_READ);
+    esp_rmaker_device_add_param(dev, temp);
+    esp_rmaker_device_assign_primary_param(dev, temp);
+    return dev;
+}
+
+esp_rmaker_device_t *esp_rmaker_switch_device_create(const char *dev_name,
+                                                     void *priv_data, bool power)
+{
+    esp_rmaker_device_t *dev = esp_rmaker_device_create(dev_name,
+                                                        ESP_RMAKER_DEVICE_SWITCH, priv_data);
+    if (!dev) return NULL;
+    esp_rmaker_device_add_param(dev, esp_rmaker_param_create(ESP_RMAKER_DEF_NAME_PARAM,
+        ESP_RMAKER_PARAM_NAME, esp_rmaker_str(dev_name), PROP_FLAG_READ | PROP_FLAG_WRITE));
+    esp_rmaker_param_t *pwr = esp_rmaker_param_create(ESP_RMAKER_DEF_POWER_NAME,
+        ESP_RMAKER_PARAM_POWER, esp_rmaker_bool(power), PROP_FLAG_READ | PROP_FLAG_WRITE);
+    esp_rmaker_device_add_param(dev, pwr);
+    esp_rmaker_device_assign_primary_param(dev, pwr);
+    return dev;
+}
+
+esp_err_t esp_rmaker_timezone_service_enable(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_system_service_enable(void *config)
+{
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_schedule_enable(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_scenes_enable(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_ota_enable_default(void)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,480 @@
+/**
+ * @file sim_wifi.c
+ * @brief Event loop, Wi-Fi driver, provisioning and MQTT connection stand-ins
+ *
+ * One AP, already provisioned, comes up at sim_wifi_set_ap() time and drops
+ * out during the outages added with sim_wifi_add_outage(). A connect attempt
+ * is a scan (all channels, or one probe when the config names the AP's
+ * BSSID and channel), association and DHCP, each a timer phase. Whether the
+ * AP is there is checked at the end of every phase. The RainMaker MQTT
+ * connection follows an IP by SIM_MQTT_CONNECT_US.
+ *
+ * The radio model meters how long the RF receiver is on: during connection
+ * attempts, all the time with power save off, and otherwise only for the
+ * beacons the power-save mode wakes for and after each transmission.
+ */
+
+#include <string.h>
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_rmaker_common_events.h"
+#include "wifi_provisioning/manager.h"
+#include "wifi_provisioning/scheme_ble.h"
+#include "sim.h"
+
+static const char *TAG = "SIM_WIFI";
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+ESP_EVENT_DEFINE_BASE(WIFI_PROV_EVENT);
+ESP_EVENT_DEFINE_BASE(RMAKER_COMMON_EVENT);
+
+const wifi_prov_scheme_t wifi_prov_scheme_ble = { 0 };
+
+#define SIM_MAX_HANDLERS        16
+#define SIM_MAX_OUTAGES         8
+
+#define SIM_FULL_SCAN_US        2000000     // Active scan over 13 channels
+#define SIM_PROBE_US            100000      // Probe on one known channel
+#define SIM_ASSOC_US            200000      // Auth, association, 4-way handshake
+#define SIM_DHCP_US             300000
+#define SIM_MQTT_CONNECT_US     500000      // TLS and MQTT CONNECT to RainMaker
+
+// Radio current model, rough ESP32-C3 figures (CPU running, no light sleep)
+#define SIM_BASE_MA             20.0        // CPU on, RF off (modem sleep)
+#define SIM_RADIO_MA            85.0        // RF receiver on, TX averaged in
+#define SIM_BEACON_US           102400      // Beacon interval; DTIM period 1
+#define SIM_BEACON_WAKE_US      3000        // Wake, receive the beacon, sleep
+#define SIM_TX_AWAKE_US         250000      // Transmit, then wait for the PUBACK
+
+static const uint8_t s_ap_bssid[6] = { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 };
+static const uint8_t s_ap_channel = 6;
+static const char s_ap_ssid[] = "sim-ap";
+static const uint8_t s_sta_mac[6] = { 0x58, 0xcf, 0x79, 0x0a, 0x1b, 0x2c };
+
+// ============================================
+// EVENT LOOP
+// ============================================
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void *arg;
+} sim_handler_t;
+
+static sim_handler_t s_handlers[SIM_MAX_HANDLERS];
+static int s_handler_count = 0;
+static bool s_loop_created = false;
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    if (s_loop_created) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_loop_created = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void *event_handler_arg)
+{
+    if (!s_loop_created) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_handler_count == SIM_MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_handlers[s_handler_count++] = (sim_handler_t){
+        event_base, event_id, event_handler, event_handler_arg
+    };
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
+                         const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait)
+{
+    (void)event_data_size;
+    (void)ticks_to_wait;
+    for (int i = 0; i < s_handler_count; i++) {
+        const sim_handler_t *h = &s_handlers[i];
+        if (h->base == event_base && (h->id == ESP_EVENT_ANY_ID || h->id == event_id)) {
+            h->fn(h->arg, event_base, event_id, (void *)event_data);
+        }
+    }
+    return ESP_OK;
+}
+
+// ============================================
+// ACCESS POINT MODEL
+// ============================================
+
+typedef enum {
+    LINK_IDLE,
+    LINK_SCAN,
+    LINK_ASSOC,
+    LINK_DHCP,
+    LINK_UP,
+} sim_link_t;
+
+typedef struct {
+    uint64_t start_us;
+    uint64_t dur_us;
+} sim_outage_t;
+
+static uint64_t s_ap_up_at_us = 0;
+static sim_outage_t s_outages[SIM_MAX_OUTAGES];
+static int s_outage_count = 0;
+
+static wifi_config_t s_sta_config;
+static bool s_sta_started = false;
+static sim_link_t s_link = LINK_IDLE;
+static bool s_probe_only = false;
+static esp_timer_handle_t s_phase_timer = NULL;
+static esp_timer_handle_t s_mqtt_timer = NULL;
+static esp_timer_handle_t s_outage_timer = NULL;
+
+static wifi_ps_type_t s_ps = WIFI_PS_MIN_MODEM;
+static uint64_t s_meter_us = 0;         // Metered up to here
+static uint64_t s_awake_until_us = 0;   // End of the current transmit wake
+static double s_charge_ma_us = 0.0;
+static uint64_t s_radio_on_us = 0;
+static uint32_t s_tx_wakes = 0;
+
+// ============================================
+// RADIO METER
+// ============================================
+
+static void meter_on(uint64_t us)
+{
+    s_radio_on_us += us;
+    s_charge_ma_us += SIM_RADIO_MA * (double)us;
+}
+
+// Charge everything since the last call to the current state
+static void meter(void)
+{
+    uint64_t now = sim_now_us();
+    uint64_t span = now - s_meter_us;
+    s_charge_ma_us += SIM_BASE_MA * (double)span;
+
+    if (!s_sta_started || s_link == LINK_IDLE) {
+        // Radio off between attempts
+    } else if (s_link != LINK_UP || s_ps == WIFI_PS_NONE) {
+        meter_on(span);
+    } else {
+        uint64_t awake = 0;
+        if (s_awake_until_us > s_meter_us) {
+            awake = (s_awake_until_us < now ? s_awake_until_us : now) - s_meter_us;
+        }
+        uint32_t beacons = s_ps == WIFI_PS_MAX_MODEM && s_sta_config.sta.listen_interval > 0 ?
+                           s_sta_config.sta.listen_interval : 1;
+        uint64_t dozing = span - awake;
+        meter_on(awake + dozing * SIM_BEACON_WAKE_US / ((uint64_t)SIM_BEACON_US * beacons));
+    }
+    s_meter_us = now;
+}
+
+static void set_link(sim_link_t link)
+{
+    meter();
+    s_link = link;
+}
+
+static bool ap_present(void)
+{
+    uint64_t now = sim_now_us();
+    if (now < s_ap_up_at_us) {
+        return false;
+    }
+    for (int i = 0; i < s_outage_count; i++) {
+        if (now >= s_outages[i].start_us && now < s_outages[i].start_us + s_outages[i].dur_us) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void post_disconnected(uint8_t reason)
+{
+    wifi_event_sta_disconnected_t event = { .reason = reason, .rssi = -60 };
+    memcpy(event.ssid, s_sta_config.sta.ssid, sizeof(event.ssid));
+    event.ssid_len = (uint8_t)strnlen((const char *)event.ssid, sizeof(event.ssid));
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event), 0);
+}
+
+static void phase_timer_cb(void *arg)
+{
+    (void)arg;
+    if (!ap_present()) {
+        uint8_t reason = s_link == LINK_SCAN ? WIFI_REASON_NO_AP_FOUND
+                                             : WIFI_REASON_BEACON_TIMEOUT;
+        set_link(LINK_IDLE);
+        post_disconnected(reason);
+        return;
+    }
+
+    switch (s_link) {
+    case LINK_SCAN:
+        if (s_probe_only && (s_sta_config.sta.channel != s_ap_channel ||
+                             memcmp(s_sta_config.sta.bssid, s_ap_bssid, 6) != 0)) {
+            set_link(LINK_IDLE);
+            post_disconnected(WIFI_REASON_NO_AP_FOUND);
+            return;
+        }
+        set_link(LINK_ASSOC);
+        esp_timer_start_once(s_phase_timer, SIM_ASSOC_US);
+        break;
+    case LINK_ASSOC:
+        set_link(LINK_DHCP);
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, NULL, 0, 0);
+        esp_timer_start_once(s_phase_timer, SIM_DHCP_US);
+        break;
+    case LINK_DHCP:
+        set_link(LINK_UP);
+        esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, NULL, 0, 0);
+        esp_timer_start_once(s_mqtt_timer, SIM_MQTT_CONNECT_US);
+        break;
+    default:
+        break;
+    }
+}
+
+static void mqtt_timer_cb(void *arg)
+{
+    (void)arg;
+    if (s_link == LINK_UP) {
+        esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_CONNECTED, NULL, 0, 0);
+    }
+}
+
+// Fires at the start of each outage; an attempt in progress fails on its own
+static void outage_timer_cb(void *arg)
+{
+    (void)arg;
+    if (s_link == LINK_UP) {
+        set_link(LINK_IDLE);
+        ESP_LOGW(TAG, "AP gone");
+        esp_timer_stop(s_mqtt_timer);
+        post_disconnected(WIFI_REASON_BEACON_TIMEOUT);
+        esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_DISCONNECTED, NULL, 0, 0);
+    }
+
+    // Arm for the next outage still ahead
+    uint64_t now = sim_now_us();
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < s_outage_count; i++) {
+        if (s_outages[i].start_us > now && s_outages[i].start_us < next) {
+            next = s_outages[i].start_us;
+        }
+    }
+    if (next != UINT64_MAX) {
+        esp_timer_start_once(s_outage_timer, next - now);
+    }
+}
+
+// ============================================
+// WI-FI DRIVER
+// ============================================
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    return NULL;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    (void)config;
+    sim_busy_us(SIM_WIFI_INIT_US);
+
+    const esp_timer_create_args_t phase_args = { .callback = phase_timer_cb, .name = "sim_wifi" };
+    const esp_timer_create_args_t mqtt_args = { .callback = mqtt_timer_cb, .name = "sim_mqtt" };
+    const esp_timer_create_args_t outage_args = { .callback = outage_timer_cb, .name = "sim_outage" };
+    esp_timer_create(&phase_args, &s_phase_timer);
+    esp_timer_create(&mqtt_args, &s_mqtt_timer);
+    esp_timer_create(&outage_args, &s_outage_timer);
+
+    // The device has been provisioned before
+    memcpy(s_sta_config.sta.ssid, s_ap_ssid, sizeof(s_ap_ssid));
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    (void)mode;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    sim_busy_us(SIM_WIFI_START_US);
+    meter();
+    s_sta_started = true;
+
+    uint64_t now = sim_now_us();
+    uint64_t first = UINT64_MAX;
+    for (int i = 0; i < s_outage_count; i++) {
+        if (s_outages[i].start_us >= now && s_outages[i].start_us < first) {
+            first = s_outages[i].start_us;
+        }
+    }
+    if (first != UINT64_MAX) {
+        esp_timer_start_once(s_outage_timer, first - now);
+    }
+
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    if (!s_sta_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_link != LINK_IDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_probe_only = s_sta_config.sta.bssid_set && s_sta_config.sta.channel != 0;
+    set_link(LINK_SCAN);
+    esp_timer_start_once(s_phase_timer, s_probe_only ? SIM_PROBE_US : SIM_FULL_SCAN_US);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    if (s_link == LINK_IDLE) {
+        return ESP_OK;
+    }
+    esp_timer_stop(s_phase_timer);
+    esp_timer_stop(s_mqtt_timer);
+    set_link(LINK_IDLE);
+    post_disconnected(8);  // ASSOC_LEAVE
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    (void)interface;
+    *conf = s_sta_config;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    (void)interface;
+    meter();
+    s_sta_config = *conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (s_link != LINK_UP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(ap_info, 0, sizeof(*ap_info));
+    memcpy(ap_info->bssid, s_ap_bssid, 6);
+    memcpy(ap_info->ssid, s_ap_ssid, sizeof(s_ap_ssid));
+    ap_info->primary = s_ap_channel;
+    ap_info->rssi = -60;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    meter();
+    s_ps = type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t *type)
+{
+    *type = s_ps;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6])
+{
+    (void)ifx;
+    memcpy(mac, s_sta_mac, 6);
+    return ESP_OK;
+}
+
+// ============================================
+// PROVISIONING MANAGER
+// ============================================
+
+esp_err_t wifi_prov_mgr_init(wifi_prov_mgr_config_t config)
+{
+    (void)config;
+    return ESP_OK;
+}
+
+void wifi_prov_mgr_deinit(void)
+{
+}
+
+esp_err_t wifi_prov_mgr_is_provisioned(bool *provisioned)
+{
+    *provisioned = true;
+    return ESP_OK;
+}
+
+esp_err_t wifi_prov_mgr_start_provisioning(wifi_prov_security_t security,
+                                           const void *wifi_prov_sec_params,
+                                           const char *service_name,
+                                           const char *service_key)
+{
+    (void)security;
+    (void)wifi_prov_sec_params;
+    (void)service_name;
+    (void)service_key;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// ============================================
+// SIMULATION CONTROL
+// ============================================
+
+void sim_wifi_set_ap(uint64_t up_at_us)
+{
+    s_ap_up_at_us = up_at_us;
+}
+
+void sim_wifi_add_outage(uint64_t start_us, uint64_t dur_us)
+{
+    if (s_outage_count < SIM_MAX_OUTAGES) {
+        s_outages[s_outage_count++] = (sim_outage_t){ start_us, dur_us };
+    }
+}
+
+void sim_wifi_note_tx(void)
+{
+    meter();
+    if (s_link != LINK_UP || s_ps == WIFI_PS_NONE) {
+        return;
+    }
+    uint64_t now = sim_now_us();
+    if (s_awake_until_us <= now) {
+        s_tx_wakes++;
+    }
+    s_awake_until_us = now + SIM_TX_AWAKE_US;
+}
+
+void sim_wifi_power(sim_wifi_power_t *out)
+{
+    meter();
+    uint64_t now = sim_now_us();
+    out->avg_ma = now ? s_charge_ma_us / (double)now : 0.0;
+    out->radio_on_pct = now ? 100.0 * (double)s_radio_on_us / (double)now : 0.0;
+    out->wakes = s_tx_wakes;
+}
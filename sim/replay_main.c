@@ -0,0 +1,403 @@
+/**
+ * @file replay_main.c
+ * @brief Deterministic trace replay of the per-sample pipeline
+ *
+ * Feeds a recorded sample stream (t_ms, temperature, humidity, light) through
+ * the firmware's own calculate_aqi(), alert logic, display renderer and cloud
+ * publisher on the virtual clock, one stage after the other, and prints a
+ * digest of everything they produced plus per-stage host timing.
+ *
+ * Input lines are "t_ms,temperature,humidity,light". Anything before
+ * "CAPTURE: " is ignored, so the output of `dlog dump` run through
+ * tools/dlog_decode.py on a build with ENABLE_SAMPLE_CAPTURE can be fed in
+ * directly. Lines starting with '#' are comments.
+ *
+ * With --expect FILE the digests are compared against a reference and the
+ * process exits non-zero on any mismatch or blown per-stage budget.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_rmaker_core.h"
+#include "esp_rmaker_standard_types.h"
+#include "esp_rmaker_standard_params.h"
+#include "esp_rmaker_standard_devices.h"
+#include "sim.h"
+#include "app_driver.h"
+#include "sensor_task.h"
+#include "display_task.h"
+#include "alert_task.h"
+#include "cloud_task.h"
+
+// Globals normally owned by app_main.c
+extern SemaphoreHandle_t rainmaker_mutex;
+extern EventGroupHandle_t system_events;
+extern esp_rmaker_device_t *temp_sensor_device;
+extern esp_rmaker_device_t *humidity_sensor_device;
+extern esp_rmaker_device_t *aqi_sensor_device;
+extern esp_rmaker_device_t *alert_device;
+
+#define WIFI_CONNECTED_BIT  BIT0
+#define CLOUD_CONNECTED_BIT BIT1
+
+typedef struct {
+    uint32_t t_ms;
+    float temperature;
+    float humidity;
+    int light;
+} replay_sample_t;
+
+typedef enum {
+    STAGE_AQI = 0,
+    STAGE_ALERT,
+    STAGE_DISPLAY,
+    STAGE_PUBLISH,
+    STAGE_COUNT
+} replay_stage_t;
+
+static const char *const s_stage_names[STAGE_COUNT] = {
+    "aqi", "alert", "display", "publish",
+};
+
+typedef struct {
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t virt_us;       // virtual time the stage spent blocked or busy
+} stage_stats_t;
+
+static struct {
+    const char *input_path;
+    const char *expect_path;
+    uint32_t seed;
+    int log_level;
+
+    replay_sample_t *samples;
+    size_t count;
+
+    stage_stats_t stages[STAGE_COUNT];
+    uint32_t alert_changes;
+    uint32_t alert_digest;
+    uint32_t aqi_digest;
+} s_replay = {
+    .seed = 1,
+    .log_level = ESP_LOG_ERROR,
+    .alert_digest = SIM_FNV1A_INIT,
+    .aqi_digest = SIM_FNV1A_INIT,
+};
+
+// ============================================
+// INPUT
+// ============================================
+
+static bool load_samples(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    size_t cap = 1024;
+    s_replay.samples = malloc(cap * sizeof(replay_sample_t));
+    char line[256];
+    uint32_t lineno = 0;
+
+    while (s_replay.samples && fgets(line, sizeof(line), f)) {
+        lineno++;
+        const char *p = strstr(line, "CAPTURE: ");
+        p = p ? p + strlen("CAPTURE: ") : line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        replay_sample_t s;
+        unsigned long t_ms;
+        if (sscanf(p, "%lu,%f,%f,%d", &t_ms, &s.temperature, &s.humidity, &s.light) != 4) {
+            fprintf(stderr, "%s:%lu: expected t_ms,temperature,humidity,light\n",
+                    path, (unsigned long)lineno);
+            continue;
+        }
+        s.t_ms = (uint32_t)t_ms;
+
+        if (s_replay.count == cap) {
+            cap *= 2;
+            replay_sample_t *grown = realloc(s_replay.samples, cap * sizeof(replay_sample_t));
+            if (!grown) {
+                free(s_replay.samples);
+                s_replay.samples = NULL;
+                break;
+            }
+            s_replay.samples = grown;
+        }
+        s_replay.samples[s_replay.count++] = s;
+    }
+    fclose(f);
+
+    if (!s_replay.samples) {
+        fprintf(stderr, "out of memory loading %s\n", path);
+        return false;
+    }
+    return s_replay.count > 0;
+}
+
+// ============================================
+// PIPELINE
+// ============================================
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    // Thread CPU time, so virtual-time blocking in a stage is not counted
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define TIMED_STAGE(stage, stmt) do {                                   \
+        uint64_t _v0 = sim_now_us();                                    \
+        uint64_t _t0 = host_ns();                                       \
+        stmt;                                                           \
+        uint64_t _dt = host_ns() - _t0;                                 \
+        stage_stats_t *_s = &s_replay.stages[stage];                    \
+        _s->total_ns += _dt;                                            \
+        if (_dt > _s->max_ns) _s->max_ns = _dt;                         \
+        _s->virt_us += sim_now_us() - _v0;                              \
+    } while (0)
+
+/**
+ * Minimal RainMaker node: only the devices and params the pipeline reports to
+ */
+static void create_devices(void)
+{
+    esp_rmaker_config_t cfg = { 0 };
+    esp_rmaker_node_t *node = esp_rmaker_node_init(&cfg, "Replay", "Sensor");
+
+    temp_sensor_device = esp_rmaker_temp_sensor_device_create("Temperature", NULL, 25.0);
+    esp_rmaker_node_add_device(node, temp_sensor_device);
+
+    humidity_sensor_device = esp_rmaker_device_create("Humidity",
+        ESP_RMAKER_DEVICE_TEMP_SENSOR, NULL);
+    esp_rmaker_device_add_param(humidity_sensor_device, esp_rmaker_param_create(
+        ESP_RMAKER_DEF_HUMIDITY_NAME, ESP_RMAKER_PARAM_HUMIDITY,
+        esp_rmaker_float(50.0), PROP_FLAG_READ));
+    esp_rmaker_node_add_device(node, humidity_sensor_device);
+
+    aqi_sensor_device = esp_rmaker_device_create("Air Quality",
+        ESP_RMAKER_DEVICE_TEMP_SENSOR, NULL);
+    esp_rmaker_device_add_param(aqi_sensor_device, esp_rmaker_param_create(
+        "AQI", NULL, esp_rmaker_int(50), PROP_FLAG_READ));
+    esp_rmaker_device_add_param(aqi_sensor_device, esp_rmaker_param_create(
+        "Air Quality Status", NULL, esp_rmaker_str("Good"), PROP_FLAG_READ));
+    esp_rmaker_node_add_device(node, aqi_sensor_device);
+
+    alert_device = esp_rmaker_switch_device_create("Alert System", NULL, false);
+    esp_rmaker_device_add_param(alert_device, esp_rmaker_param_create(
+        "Alert Status", NULL, esp_rmaker_str("Normal"), PROP_FLAG_READ));
+    esp_rmaker_node_add_device(node, alert_device);
+}
+
+static void replay_entry(void)
+{
+    app_driver_init();
+    display_init();
+
+    rainmaker_mutex = xSemaphoreCreateMutex();
+    system_events = xEventGroupCreate();
+    xEventGroupSetBits(system_events, WIFI_CONNECTED_BIT | CLOUD_CONNECTED_BIT);
+    create_devices();
+
+    uint32_t t0_ms = s_replay.samples[0].t_ms;
+    alert_type_t last_alert = ALERT_NONE;
+
+    for (size_t i = 0; i < s_replay.count; i++) {
+        const replay_sample_t *in = &s_replay.samples[i];
+
+        // Samples land at their recorded offsets; stages may overrun them
+        uint64_t due_us = (uint64_t)(in->t_ms - t0_ms) * 1000ull;
+        if (due_us > sim_now_us()) {
+            vTaskDelay(pdMS_TO_TICKS((due_us - sim_now_us()) / 1000));
+        }
+
+        sensor_data_t data = {
+            .temperature = in->temperature,
+            .humidity = in->humidity,
+            .timestamp = in->t_ms,
+        };
+
+        TIMED_STAGE(STAGE_AQI,
+                    data.aqi = calculate_aqi(data.temperature, data.humidity, in->light));
+        s_replay.aqi_digest = sim_fnv1a(s_replay.aqi_digest, &data.aqi, sizeof(data.aqi));
+
+        alert_type_t alert;
+        TIMED_STAGE(STAGE_ALERT, alert = alert_process_sample(&data));
+        if (alert != last_alert) {
+            uint32_t rec[2] = { (uint32_t)i, (uint32_t)alert };
+            s_replay.alert_digest = sim_fnv1a(s_replay.alert_digest, rec, sizeof(rec));
+            s_replay.alert_changes++;
+            last_alert = alert;
+        }
+
+        TIMED_STAGE(STAGE_DISPLAY, display_sensor_data(&data));
+        TIMED_STAGE(STAGE_PUBLISH, cloud_publish_sample(&data));
+    }
+}
+
+// ============================================
+// DIGESTS AND EXPECTATIONS
+// ============================================
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t hash;
+} digest_t;
+
+static int collect_digests(digest_t out[4])
+{
+    sim_hw_stats_t hw;
+    uint32_t publishes = 0, publish_digest = 0;
+
+    sim_hw_get_stats(&hw);
+    sim_rmaker_stats(&publishes, &publish_digest);
+
+    out[0] = (digest_t){ "aqi", (uint32_t)s_replay.count, s_replay.aqi_digest };
+    out[1] = (digest_t){ "alerts", s_replay.alert_changes, s_replay.alert_digest };
+    out[2] = (digest_t){ "publishes", publishes, publish_digest };
+    out[3] = (digest_t){ "frames", hw.frames, hw.frame_digest };
+    return 4;
+}
+
+/**
+ * Expectation file: "digest <name> <count> <hash>" and
+ * "budget <stage> <max mean ns>" lines; '#' starts a comment.
+ */
+static int check_expectations(const char *path, const digest_t *digests, int n)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+
+    int failures = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char kind[16], name[32];
+        unsigned long a, b;
+
+        if (line[0] == '#' || sscanf(line, "%15s %31s", kind, name) != 2) {
+            continue;
+        }
+
+        if (strcmp(kind, "digest") == 0 && sscanf(line, "%*s %*s %lu %lx", &a, &b) == 2) {
+            int i;
+            for (i = 0; i < n && strcmp(digests[i].name, name) != 0; i++) {}
+            if (i == n) {
+                printf("FAIL unknown digest %s\n", name);
+                failures++;
+            } else if (digests[i].count != a || digests[i].hash != b) {
+                printf("FAIL digest %s: got %lu %08lx, expected %lu %08lx\n", name,
+                       (unsigned long)digests[i].count, (unsigned long)digests[i].hash, a, b);
+                failures++;
+            }
+        } else if (strcmp(kind, "budget") == 0 && sscanf(line, "%*s %*s %lu", &a) == 1) {
+            int s;
+            for (s = 0; s < STAGE_COUNT && strcmp(s_stage_names[s], name) != 0; s++) {}
+            if (s == STAGE_COUNT) {
+                printf("FAIL unknown stage %s\n", name);
+                failures++;
+                continue;
+            }
+            uint64_t mean = s_replay.stages[s].total_ns / s_replay.count;
+            if (mean > a) {
+                printf("FAIL budget %s: mean %llu ns > %lu ns\n", name,
+                       (unsigned long long)mean, a);
+                failures++;
+            }
+        }
+    }
+    fclose(f);
+
+    printf("%s: %s\n", path, failures ? "MISMATCH" : "ok");
+    return failures ? 1 : 0;
+}
+
+// ============================================
+// ENTRY
+// ============================================
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options] SAMPLES.csv\n"
+            "  --seed N        esp_random() seed (default 1)\n"
+            "  --expect FILE   compare digests/budgets, exit 1 on mismatch\n"
+            "  --verbose       firmware warning/info logging\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--seed") == 0 && v) {
+            s_replay.seed = (uint32_t)strtoul(v, NULL, 0); i++;
+        } else if (strcmp(a, "--expect") == 0 && v) {
+            s_replay.expect_path = v; i++;
+        } else if (strcmp(a, "--verbose") == 0) {
+            s_replay.log_level = ESP_LOG_INFO;
+        } else if (a[0] != '-' && !s_replay.input_path) {
+            s_replay.input_path = a;
+        } else {
+            usage(argv[0]);
+            return strcmp(a, "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!s_replay.input_path) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!load_samples(s_replay.input_path)) {
+        fprintf(stderr, "%s: no samples\n", s_replay.input_path);
+        return 1;
+    }
+
+    sim_log_set_level(s_replay.log_level);
+    sim_hw_seed(s_replay.seed);
+
+    const replay_sample_t *last = &s_replay.samples[s_replay.count - 1];
+    uint64_t span_us = (uint64_t)(last->t_ms - s_replay.samples[0].t_ms) * 1000ull;
+    // Generous tail so the last sample's beeps and publish complete
+    sim_kernel_run(replay_entry, span_us + 60ull * 1000000ull);
+
+    digest_t digests[4];
+    int n = collect_digests(digests);
+
+    printf("=== Replay: %s (%lu samples, %.1f s) ===\n", s_replay.input_path,
+           (unsigned long)s_replay.count, (double)span_us / 1e6);
+    for (int i = 0; i < n; i++) {
+        printf("digest %-9s %lu %08lx\n", digests[i].name,
+               (unsigned long)digests[i].count, (unsigned long)digests[i].hash);
+    }
+    printf("%-8s %12s %12s %14s\n", "stage", "mean ns", "max ns", "virtual us");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        const stage_stats_t *st = &s_replay.stages[s];
+        printf("%-8s %12llu %12llu %14llu\n", s_stage_names[s],
+               (unsigned long long)(st->total_ns / s_replay.count),
+               (unsigned long long)st->max_ns, (unsigned long long)st->virt_us);
+    }
+
+    int rc = 0;
+    if (s_replay.expect_path) {
+        rc = check_expectations(s_replay.expect_path, digests, n);
+    }
+    fflush(stdout);
+    _Exit(rc);
+}
@@ -0,0 +1,551 @@
+/**
+ * @file sim_main.c
+ * @brief Host simulation entry point
+ *
+ * Boots the real app_main() on the virtual-time kernel with simulated
+ * sensors, display and RainMaker, runs it for the requested virtual
+ * duration and prints a throughput / latency report.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sim.h"
+#include "esp_rmaker_core.h"
+#include "cloud_task.h"
+#include "project_config.h"
+#include "dlog.h"
+#include "evtrace.h"
+#include "push_button.h"
+#include "adaptive_sampling.h"
+#include "warm_cache.h"
+#include "app_wifi.h"
+#include "uplink_batch.h"
+#include "outbox.h"
+#include "cloud_rate.h"
+#include "backlog.h"
+#include "ts_aggregate.h"
+#include "local_api.h"
+#include "esp_system.h"
+
+extern void app_main(void);
+
+#define SIM_MAX_PRESSES     8
+#define SIM_MAX_DROPS       8
+#define SIM_BOUNCE_US       300     // Contact bounce: two extra edges this far apart
+
+typedef struct {
+    double duration_s;
+    uint32_t seed;
+    int log_level;
+    double ap_at_s;
+    double drop_at_s[SIM_MAX_DROPS];
+    double drop_dur_s[SIM_MAX_DROPS];
+    int drop_count;
+    double heatwave_at_s;
+    const char *dump_path;
+    double press_at_s[SIM_MAX_PRESSES];
+    uint32_t press_hold_ms[SIM_MAX_PRESSES];
+    int press_count;
+    double interval_at_s;
+    int interval_s;
+    bool warm_start;
+    int uplink_window_s;
+    const char *lan_dump_path;
+    const char *tlm_dump_path;
+} sim_options_t;
+
+static sim_options_t s_opts = {
+    .duration_s = 3600.0,
+    .seed = 1,
+    .log_level = ESP_LOG_INFO,
+    .heatwave_at_s = -1.0,
+    .interval_at_s = -1.0,
+    .uplink_window_s = -1,
+};
+
+// ============================================
+// STIMULUS
+// ============================================
+
+/**
+ * Default environment: a compressed day/night cycle with an optional step
+ * into a heatwave so alert latency can be measured.
+ */
+static void synthetic_env(uint64_t now_us, sim_env_t *env, void *ctx)
+{
+    const sim_options_t *opts = (const sim_options_t *)ctx;
+    double t = (double)now_us / 1e6;
+    double phase = 2.0 * M_PI * t / 86400.0;
+
+    env->temperature = (float)(24.0 + 5.0 * sin(phase));
+    env->humidity = (float)(55.0 - 12.0 * sin(phase));
+    env->light_raw = (int)(2000.0 + 1500.0 * sin(phase));
+    env->dht_fault = false;
+
+    if (opts->heatwave_at_s >= 0.0 && t >= opts->heatwave_at_s) {
+        env->temperature = 38.0f;
+    }
+}
+
+// A cloud write of the Sampling device's "Sample Interval"
+static void interval_write_cb(void *arg)
+{
+    (void)arg;
+    esp_err_t err = sim_rmaker_write("Sampling", "Sample Interval",
+                                     esp_rmaker_int(s_opts.interval_s));
+    printf("[sim] Sample Interval -> %d s: %s\n", s_opts.interval_s, esp_err_to_name(err));
+}
+
+#if ENABLE_WARM_START
+// What a previous run would have left in RTC memory: one sample, in alert
+static void seed_warm_cache(void)
+{
+    const sensor_data_t previous = {
+        .temperature = 38.0f,
+        .humidity = 40.0f,
+        .aqi = 60,
+        .light_lux = 500,
+    };
+
+    warm_cache_init();
+    warm_cache_push(&previous);
+    warm_cache_set_alert(ALERT_TEMP_HIGH);
+    sim_hw_set_reset_reason(ESP_RST_SW);
+}
+#endif
+
+// Button edges, bounces included, in time order
+typedef struct {
+    uint64_t at_us;
+    int level;
+} sim_edge_t;
+
+static sim_edge_t s_edges[SIM_MAX_PRESSES * 6];
+static int s_edge_count = 0;
+static int s_edge_next = 0;
+static esp_timer_handle_t s_button_timer;
+
+static void add_bouncy_edge(uint64_t at_us, int level)
+{
+    s_edges[s_edge_count++] = (sim_edge_t){ at_us, level };
+    s_edges[s_edge_count++] = (sim_edge_t){ at_us + SIM_BOUNCE_US, !level };
+    s_edges[s_edge_count++] = (sim_edge_t){ at_us + 2 * SIM_BOUNCE_US, level };
+}
+
+static int compare_edges(const void *a, const void *b)
+{
+    uint64_t ta = ((const sim_edge_t *)a)->at_us, tb = ((const sim_edge_t *)b)->at_us;
+    return ta < tb ? -1 : ta > tb;
+}
+
+static void button_edge_cb(void *arg)
+{
+    (void)arg;
+    sim_hw_drive_input(BUTTON_GPIO, s_edges[s_edge_next++].level);
+    if (s_edge_next < s_edge_count) {
+        esp_timer_start_once(s_button_timer, s_edges[s_edge_next].at_us - sim_now_us());
+    }
+}
+
+static void schedule_button_presses(void)
+{
+    for (int i = 0; i < s_opts.press_count; i++) {
+        uint64_t down = (uint64_t)(s_opts.press_at_s[i] * 1e6);
+        add_bouncy_edge(down, 0);       // Active low
+        add_bouncy_edge(down + s_opts.press_hold_ms[i] * 1000ULL, 1);
+    }
+    if (s_edge_count == 0) return;
+
+    qsort(s_edges, s_edge_count, sizeof(s_edges[0]), compare_edges);
+    const esp_timer_create_args_t args = {
+        .callback = button_edge_cb,
+        .name = "sim_button",
+    };
+    esp_timer_create(&args, &s_button_timer);
+    esp_timer_start_once(s_button_timer, s_edges[0].at_us);
+}
+
+// ============================================
+// REPORT
+// ============================================
+
+/**
+ * Pull the whole history over the local API, page by page, as a LAN client
+ * would; the concatenated responses go to path for tools/lapi_decode.py.
+ */
+static void pull_local_api(const char *path)
+{
+    FILE *out = NULL;
+    if (path && !(out = fopen(path, "wb"))) {
+        perror(path);
+    }
+
+    uint32_t cursor = 0, pages = 0, records = 0, gaps = 0;
+    uint64_t bytes = 0;
+    for (;;) {
+        void *data;
+        size_t size;
+        if (sim_local_ctrl_request(LOCAL_API_HISTORY_ENDPOINT, &cursor, sizeof(cursor),
+                                   &data, &size) != 0) {
+            printf("local api         : not running\n");
+            break;
+        }
+        const local_api_header_t *h = data;
+        if (out) {
+            fwrite(data, 1, size, out);
+        }
+        if (h->count == 0) {
+            free(data);
+            printf("local api         : %lu records in %lu pages, %llu bytes "
+                   "(%.1f per record), %lu gaps\n",
+                   (unsigned long)records, (unsigned long)pages, (unsigned long long)bytes,
+                   records ? (double)bytes / records : 0.0, (unsigned long)gaps);
+            break;
+        }
+        if (h->first_seq != cursor) {
+            gaps++;
+        }
+        cursor = h->first_seq + h->count;      // Kept by the client, not the device
+        records += h->count;
+        bytes += size;
+        pages++;
+        free(data);
+    }
+
+    for (int i = 0; out && i < 2; i++) {
+        void *data;
+        size_t size;
+        if (sim_local_ctrl_get(i == 0 ? "latest" : "stats", &data, &size) == 0) {
+            fwrite(data, 1, size, out);
+            free(data);
+        }
+    }
+    if (out) {
+        fclose(out);
+    }
+}
+
+static void print_report(double wall_s)
+{
+    sim_hw_stats_t hw;
+    uint32_t publishes = 0, publish_digest = 0;
+    uint32_t log_lines = 0;
+    uint64_t log_bytes = 0;
+    double virt_s = (double)sim_now_us() / 1e6;
+
+    sim_hw_get_stats(&hw);
+    sim_rmaker_stats(&publishes, &publish_digest);
+    sim_log_stats(&log_lines, &log_bytes);
+
+    printf("\n=== Simulation report ===\n");
+    printf("virtual time      : %.1f s\n", virt_s);
+    printf("wall time         : %.3f s (%.0fx real time)\n", wall_s,
+           wall_s > 0 ? virt_s / wall_s : 0.0);
+    printf("cpu idle          : %.2f %%\n",
+           virt_s > 0 ? 100.0 * (double)sim_idle_us() / (double)sim_now_us() : 0.0);
+    printf("context switches  : %llu\n", (unsigned long long)sim_context_switches());
+    uint32_t tasks, stack_bytes;
+    sim_task_stack_stats(&tasks, &stack_bytes);
+    printf("task stacks       : %lu tasks, %lu bytes\n",
+           (unsigned long)tasks, (unsigned long)stack_bytes);
+    printf("dht11 reads       : %lu (%.0f per wall second)\n", (unsigned long)hw.dht_reads,
+           wall_s > 0 ? (double)hw.dht_reads / wall_s : 0.0);
+    printf("dht11 interval    : %.3f .. %.3f s\n",
+           (double)hw.dht_gap_min_us / 1e6, (double)hw.dht_gap_max_us / 1e6);
+    printf("adc reads         : %lu\n", (unsigned long)hw.adc_reads);
+    printf("i2c transactions  : %lu (%llu bytes, %.1f s bus time)\n",
+           (unsigned long)hw.i2c_transactions, (unsigned long long)hw.i2c_bytes,
+           (double)hw.i2c_busy_us / 1e6);
+    printf("frames rendered   : %lu (digest %08lx)\n",
+           (unsigned long)hw.frames, (unsigned long)hw.frame_digest);
+    printf("frame interval    : %.3f .. %.3f s\n",
+           (double)hw.frame_gap_min_us / 1e6, (double)hw.frame_gap_max_us / 1e6);
+    printf("cloud publishes   : %lu (digest %08lx)\n",
+           (unsigned long)publishes, (unsigned long)publish_digest);
+    app_wifi_stats_t wifi;
+    app_wifi_get_stats(&wifi);
+    printf("wi-fi             : %lu attempts, %lu connects (%lu on cached AP), "
+           "%lu drops, last join %lu ms, outage max %lu ms\n",
+           (unsigned long)wifi.attempts, (unsigned long)wifi.connects,
+           (unsigned long)wifi.fast_joins, (unsigned long)wifi.disconnects,
+           (unsigned long)wifi.last_join_ms, (unsigned long)wifi.max_outage_ms);
+    sim_wifi_power_t power;
+    sim_wifi_power(&power);
+    printf("radio             : %.2f mA average, receiver on %.2f %%, %lu transmit wakes\n",
+           power.avg_ma, power.radio_on_pct, (unsigned long)power.wakes);
+    uplink_batch_stats_t up;
+    uplink_batch_get_stats(&up);
+    printf("uplink            : window %lu s, %lu bursts (%lu alert), %lu samples, "
+           "delay avg %.1f s, max %.1f s\n",
+           (unsigned long)(up.window_ms / 1000), (unsigned long)up.bursts,
+           (unsigned long)up.alert_bursts, (unsigned long)up.samples,
+           up.samples ? (double)up.delay_total_ms / up.samples / 1e3 : 0.0,
+           (double)up.delay_max_ms / 1e3);
+    uint32_t mqtt_messages, mqtt_bytes;
+    sim_rmaker_mqtt_stats(&mqtt_messages, &mqtt_bytes);
+    printf("cbor uplink       : %lu batches, %lu samples, %lu bytes (%.1f per sample), "
+           "%lu MQTT messages, %lu bytes\n",
+           (unsigned long)up.cbor_messages, (unsigned long)up.cbor_samples,
+           (unsigned long)up.cbor_bytes,
+           up.cbor_samples ? (double)up.cbor_bytes / up.cbor_samples : 0.0,
+           (unsigned long)mqtt_messages, (unsigned long)mqtt_bytes);
+    cloud_rate_stats_t rate;
+    cloud_rate_get_stats(&rate);
+    printf("cloud rate        : %lu messages, %lu throttled (wait avg %.1f s, max %.1f s), "
+           "%lu denied, %.1f of %lu tokens left\n",
+           (unsigned long)rate.granted, (unsigned long)rate.throttled,
+           rate.throttled ? (double)rate.wait_total_ms / rate.throttled / 1e3 : 0.0,
+           (double)rate.wait_max_ms / 1e3, (unsigned long)rate.denied,
+           rate.tokens_milli / 1e3, (unsigned long)rate.burst);
+    backlog_stats_t bl;
+    backlog_get_stats(&bl);
+    printf("backlog           : %lu stored, %lu replayed in %lu batches (%.1f bytes per sample), "
+           "%lu pending, %lu lost\n",
+           (unsigned long)bl.appended, (unsigned long)bl.replayed, (unsigned long)bl.batches,
+           bl.replayed ? (double)bl.bytes / bl.replayed : 0.0, (unsigned long)bl.pending,
+           (unsigned long)bl.lost);
+    if (bl.drains) {
+        if (bl.drain_ms) {
+            printf("backlog drain     : %lu drains, %.1f s, %.0f samples/s\n",
+                   (unsigned long)bl.drains, bl.drain_ms / 1e3, bl.replayed * 1e3 / bl.drain_ms);
+        } else {
+            printf("backlog drain     : %lu drains, each within one tick\n",
+                   (unsigned long)bl.drains);
+        }
+    }
+#if ENABLE_TS_AGGREGATE
+    ts_aggregate_stats_t ts;
+    ts_aggregate_get_stats(&ts);
+    printf("time series       : %lu s points, %lu published in %lu messages, "
+           "%lu pending, %lu skipped\n",
+           (unsigned long)(ts.interval_ms / 1000), (unsigned long)ts.published,
+           (unsigned long)ts.messages, (unsigned long)ts.pending, (unsigned long)ts.skipped);
+#endif
+    outbox_stats_t ob;
+    outbox_get_stats(&ob);
+    for (int c = 0; c < OUTBOX_CLASS_COUNT; c++) {
+        static const char *const names[] = { "alert", "state", "telemetry" };
+        const outbox_class_stats_t *cs = &ob.cls[c];
+        printf("outbox %-10s : %lu queued (%lu coalesced), %lu delivered, %lu dropped, "
+               "delay avg %.1f s, max %.1f s\n", names[c],
+               (unsigned long)cs->queued, (unsigned long)cs->coalesced,
+               (unsigned long)cs->delivered, (unsigned long)cs->dropped,
+               cs->delay_count ? (double)cs->delay_total_ms / cs->delay_count / 1e3 : 0.0,
+               (double)cs->delay_max_ms / 1e3);
+    }
+    pull_local_api(s_opts.lan_dump_path);
+    printf("alert LED edges   : %lu, buzzer edges: %lu\n",
+           (unsigned long)hw.red_led_on, (unsigned long)hw.buzzer_on);
+    if (s_opts.heatwave_at_s >= 0.0 && hw.first_red_led_us != UINT64_MAX) {
+        printf("alert latency     : %.3f s after heatwave onset\n",
+               (double)hw.first_red_led_us / 1e6 - s_opts.heatwave_at_s);
+    }
+    if (s_opts.press_count > 0) {
+        push_button_stats_t btn;
+        push_button_get_stats(&btn);
+        printf("button events     : press %lu, short %lu, long %lu, double %lu "
+               "(%lu bounces, press latency max %.1f ms)\n",
+               (unsigned long)btn.events[PUSH_BUTTON_PRESS],
+               (unsigned long)btn.events[PUSH_BUTTON_SHORT],
+               (unsigned long)btn.events[PUSH_BUTTON_LONG],
+               (unsigned long)btn.events[PUSH_BUTTON_DOUBLE],
+               (unsigned long)btn.bounces, (double)btn.press_latency_max_us / 1e3);
+    }
+#if ENABLE_ADAPTIVE_SAMPLING
+    adaptive_sampling_stats_t as;
+    adaptive_sampling_get_stats(&as);
+    printf("adaptive sampling : %lu samples vs %lu fixed-rate (%.1f %% saved), "
+           "interval %.1f .. %.1f s\n",
+           (unsigned long)as.samples, (unsigned long)as.fixed_samples,
+           as.fixed_samples ? 100.0 * (1.0 - (double)as.samples / as.fixed_samples) : 0.0,
+           as.samples ? (double)as.interval_min_seen_ms / 1e3 : 0.0,
+           (double)as.interval_max_seen_ms / 1e3);
+#endif
+    printf("log output        : %lu lines, %llu bytes\n",
+           (unsigned long)log_lines, (unsigned long long)log_bytes);
+
+    dlog_stats_t dlog;
+    dlog_get_stats(&dlog);
+    printf("deferred log      : %lu records, %lu bytes, %lu dropped\n",
+           (unsigned long)dlog.records, (unsigned long)dlog.bytes,
+           (unsigned long)dlog.dropped);
+
+    sim_queue_stats_t q;
+    for (int i = 0; sim_queue_stats(i, &q); i++) {
+        printf("queue %d           : len %lu, sent %lu, dropped %lu, received %lu, "
+               "peeked %lu, high-water %lu\n", i,
+               (unsigned long)q.length, (unsigned long)q.sends,
+               (unsigned long)q.send_fails, (unsigned long)q.receives,
+               (unsigned long)q.peeks, (unsigned long)q.high_water);
+    }
+
+    const char *key;
+    bool variable;
+    uint32_t updates;
+    double last, sum;
+    for (int i = 0; sim_diag_stats(i, &key, &variable, &updates, &last, &sum); i++) {
+        printf("insights %-8s : %-20s updates %lu, last %.0f, sum %.0f\n",
+               variable ? "var" : "metric", key, (unsigned long)updates, last, sum);
+    }
+}
+
+/**
+ * Write the dlog and trace rings exactly as the console commands print them,
+ * so the host decoders can be run on simulation output.
+ */
+static void dump_rings(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return;
+    }
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    dlog_dump();
+    evtrace_dump();
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(fd);
+}
+
+// ============================================
+// ENTRY
+// ============================================
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --duration SEC     virtual run time (default 3600)\n"
+            "  --seed N           esp_random() seed (default 1)\n"
+            "  --ap-at SEC        the AP comes up at SEC, <0 never (default 0)\n"
+            "  --wifi-drop SEC:DUR take the AP away at SEC for DUR seconds;\n"
+            "                     up to %d times\n"
+            "  --heatwave-at SEC  step temperature to 38 C at SEC\n"
+            "  --press-at SEC[:MS] press the button at SEC for MS (default 150),\n"
+            "                     with contact bounce; up to %d times\n"
+            "  --interval-at SEC:S write Sample Interval = S seconds at SEC\n"
+            "  --uplink-window SEC batch publishes per SEC-second window, 0 every\n"
+            "                     sample (default UPLINK_WINDOW_MS)\n"
+            "  --warm-start       boot after a software reset, with an alerting\n"
+            "                     sample in the warm-start cache\n"
+            "  --dump FILE        write the dlog and trace ring dumps to FILE\n"
+            "  --lan-dump FILE    write the local API history pages, latest and\n"
+            "                     stats responses to FILE\n"
+            "  --tlm-dump FILE    write the CBOR uplink batches to FILE\n"
+            "  --quiet            only warnings and errors on the console\n"
+            "  --verbose          debug logging\n", prog, SIM_MAX_DROPS, SIM_MAX_PRESSES);
+}
+
+static void parse_args(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--duration") == 0 && v) {
+            s_opts.duration_s = atof(v); i++;
+        } else if (strcmp(a, "--seed") == 0 && v) {
+            s_opts.seed = (uint32_t)strtoul(v, NULL, 0); i++;
+        } else if (strcmp(a, "--ap-at") == 0 && v) {
+            s_opts.ap_at_s = atof(v); i++;
+        } else if (strcmp(a, "--wifi-drop") == 0 && v && s_opts.drop_count < SIM_MAX_DROPS) {
+            char *end;
+            s_opts.drop_at_s[s_opts.drop_count] = strtod(v, &end);
+            s_opts.drop_dur_s[s_opts.drop_count] = (*end == ':') ? atof(end + 1) : 10.0;
+            s_opts.drop_count++; i++;
+        } else if (strcmp(a, "--heatwave-at") == 0 && v) {
+            s_opts.heatwave_at_s = atof(v); i++;
+        } else if (strcmp(a, "--press-at") == 0 && v && s_opts.press_count < SIM_MAX_PRESSES) {
+            char *end;
+            s_opts.press_at_s[s_opts.press_count] = strtod(v, &end);
+            s_opts.press_hold_ms[s_opts.press_count] =
+                (*end == ':') ? (uint32_t)strtoul(end + 1, NULL, 0) : 150;
+            s_opts.press_count++; i++;
+        } else if (strcmp(a, "--interval-at") == 0 && v) {
+            char *end;
+            s_opts.interval_at_s = strtod(v, &end);
+            s_opts.interval_s = (*end == ':') ? atoi(end + 1) : 0;
+            i++;
+        } else if (strcmp(a, "--uplink-window") == 0 && v) {
+            s_opts.uplink_window_s = atoi(v); i++;
+        } else if (strcmp(a, "--warm-start") == 0) {
+            s_opts.warm_start = true;
+        } else if (strcmp(a, "--lan-dump") == 0 && v) {
+            s_opts.lan_dump_path = v; i++;
+        } else if (strcmp(a, "--tlm-dump") == 0 && v) {
+            s_opts.tlm_dump_path = v; i++;
+        } else if (strcmp(a, "--dump") == 0 && v) {
+            s_opts.dump_path = v; i++;
+        } else if (strcmp(a, "--quiet") == 0) {
+            s_opts.log_level = ESP_LOG_WARN;
+        } else if (strcmp(a, "--verbose") == 0) {
+            s_opts.log_level = ESP_LOG_DEBUG;
+        } else {
+            usage(argv[0]);
+            exit(strcmp(a, "--help") == 0 ? 0 : 1);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    parse_args(argc, argv);
+
+    sim_log_set_level(s_opts.log_level);
+    sim_hw_seed(s_opts.seed);
+    sim_hw_set_env(synthetic_env, &s_opts);
+
+    sim_wifi_set_ap(s_opts.ap_at_s >= 0.0 ? (uint64_t)(s_opts.ap_at_s * 1e6) : UINT64_MAX);
+    for (int i = 0; i < s_opts.drop_count; i++) {
+        sim_wifi_add_outage((uint64_t)(s_opts.drop_at_s[i] * 1e6),
+                            (uint64_t)(s_opts.drop_dur_s[i] * 1e6));
+    }
+
+    if (s_opts.uplink_window_s >= 0) {
+        uplink_batch_set_window_ms((uint32_t)s_opts.uplink_window_s * 1000);
+    }
+    if (s_opts.tlm_dump_path && sim_rmaker_mqtt_dump(s_opts.tlm_dump_path) != 0) {
+        perror(s_opts.tlm_dump_path);
+    }
+
+    schedule_button_presses();
+
+#if ENABLE_WARM_START
+    if (s_opts.warm_start) {
+        seed_warm_cache();
+    }
+#endif
+
+    if (s_opts.interval_at_s >= 0.0) {
+        esp_timer_handle_t interval_timer;
+        const esp_timer_create_args_t args = {
+            .callback = interval_write_cb,
+            .name = "sim_interval",
+        };
+        esp_timer_create(&args, &interval_timer);
+        esp_timer_start_once(interval_timer, (uint64_t)(s_opts.interval_at_s * 1e6));
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    sim_kernel_run(app_main, (uint64_t)(s_opts.duration_s * 1e6));
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double wall = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    print_report(wall);
+    if (s_opts.dump_path) {
+        dump_rings(s_opts.dump_path);
+    }
+    fflush(stdout);
+    _Exit(0);
+}
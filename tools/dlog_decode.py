@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Decode a deferred binary log dump (components/dlog) into ESP_LOG text.
+
+Capture the serial output of the "dlog" console command, then:
+
+    python tools/dlog_decode.py build/smart_environmental_logger.elf capture.txt
+
+Format strings, tags and %s arguments are stored on the device as flash
+addresses; they are resolved here from the allocated sections of the ELF the
+device is running. No third-party packages are needed.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+DLOG_MAGIC = 0xD1
+HEADER_WORDS = 4
+LEVEL_CHARS = {1: "E", 2: "W", 3: "I", 4: "D", 5: "V"}
+
+# printf conversion: flags, width, precision, length modifier, conversion
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d+|\*)?(\.\d+)?(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])")
+
+
+class ElfStrings:
+    """Resolve addresses to NUL-terminated strings in an ELF32 image."""
+
+    SHF_ALLOC = 0x2
+    SHT_NOBITS = 8
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError("%s is not an ELF32 file" % path)
+        endian = "<" if data[5] == 1 else ">"
+        shoff, = struct.unpack_from(endian + "I", data, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + "HH", data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            (_name, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                endian + "IIIIII", data, shoff + i * shentsize)
+            if flags & self.SHF_ALLOC and sh_type != self.SHT_NOBITS and addr:
+                self.sections.append((addr, size, data[offset:offset + size]))
+
+    def string(self, addr):
+        for base, size, blob in self.sections:
+            if base <= addr < base + size:
+                end = blob.find(b"\0", addr - base)
+                if end < 0:
+                    end = size
+                return blob[addr - base:end].decode("utf-8", "replace")
+        return None
+
+
+def format_record(strings, fmt, args):
+    """Apply a printf format to raw 32-bit argument words."""
+    out = []
+    pos = 0
+    arg_iter = iter(args)
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        word = next(arg_iter, 0)
+        spec = "%" + flags + (width or "") + (prec or "")
+        if conv in "fFeEgG":
+            value = struct.unpack("<f", struct.pack("<I", word))[0]
+            out.append((spec + conv) % value)
+        elif conv in "di":
+            value = word - (1 << 32) if word & 0x80000000 else word
+            out.append((spec + "d") % value)
+        elif conv in "ouxX":
+            out.append((spec + conv) % word)
+        elif conv == "c":
+            out.append(chr(word & 0xFF))
+        elif conv == "s":
+            text = strings.string(word)
+            out.append((spec + "s") % (text if text is not None else "<ram 0x%08x>" % word))
+        elif conv == "p":
+            out.append("0x%08x" % word)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def read_dumps(lines):
+    """Yield the word list of every DLOG BEGIN/END block in a capture."""
+    words = None
+    for line in lines:
+        if "=== DLOG BEGIN" in line:
+            words = []
+        elif "=== DLOG END" in line:
+            if words is not None:
+                yield words
+            words = None
+        elif words is not None:
+            words.extend(int(tok, 16) for tok in line.split()
+                         if re.fullmatch(r"[0-9a-fA-F]{8}", tok))
+
+
+def decode(strings, words):
+    """Yield (timestamp_us, level, tag, message) for each intact record."""
+    i = 0
+    last_ts = None
+    wraps = 0
+    while i + HEADER_WORDS <= len(words):
+        header = words[i]
+        nargs = (header >> 16) & 0xF
+        fmt = strings.string(words[i + 1]) if header >> 24 == DLOG_MAGIC else None
+        if fmt is None or i + HEADER_WORDS + nargs > len(words):
+            i += 1  # Torn record at the ring's oldest edge, resynchronise
+            continue
+        tag = strings.string(words[i + 2]) or "?"
+        ts = words[i + 3]
+        if last_ts is not None and ts < last_ts:
+            wraps += 1
+        last_ts = ts
+        args = words[i + HEADER_WORDS:i + HEADER_WORDS + nargs]
+        level = LEVEL_CHARS.get((header >> 20) & 0xF, "?")
+        yield (wraps << 32) + ts, level, tag, format_record(strings, fmt, args)
+        i += HEADER_WORDS + nargs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="application ELF flashed on the device")
+    parser.add_argument("capture", nargs="?", help="serial capture (default: stdin)")
+    opts = parser.parse_args()
+
+    strings = ElfStrings(opts.elf)
+    src = open(opts.capture, errors="replace") if opts.capture else sys.stdin
+    for words in read_dumps(src):
+        for ts, level, tag, message in decode(strings, words):
+            print("%s (%d) %s: %s" % (level, ts // 1000, tag, message))
+
+
+if __name__ == "__main__":
+    main()
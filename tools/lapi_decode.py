@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Decode local LAN API responses (main/local_api.h) into CSV.
+
+Over esp_local_ctrl (HTTP on port 8080, security 1 with the PoP from the
+"lapi pop" console command), send the "history" endpoint a uint32 cursor,
+starting at 0 and then first_seq + count of the last response, until a page
+comes back empty, and append each raw response to one file; "latest" and
+"stats" property values may be mixed in. Then:
+
+    python tools/lapi_decode.py pages.bin > samples.csv
+    python tools/lapi_decode.py --stats pages.bin
+
+The simulator writes such a file with --lan-dump. Records are printed once
+per sequence number, oldest first. No third-party packages are needed.
+"""
+
+import argparse
+import struct
+import sys
+
+VERSION = 2
+KIND_LATEST, KIND_STATS, KIND_HISTORY = 1, 2, 3
+
+HEADER = struct.Struct("<BBHIIII")          # local_api_header_t
+RECORD = struct.Struct("<IhHHH")            # local_api_record_t
+STATS = struct.Struct("<I3h3H3H3H")         # local_api_stats_t
+
+
+def read_responses(data):
+    """Yield (header, payload) for each response in a concatenated dump."""
+    pos = 0
+    while pos + HEADER.size <= len(data):
+        version, kind, count, first_seq, next_seq, now_ms, epoch_s = \
+            HEADER.unpack_from(data, pos)
+        if version != VERSION:
+            raise ValueError("offset %d: unknown version %d" % (pos, version))
+        pos += HEADER.size
+        if kind == KIND_STATS:
+            size = STATS.size
+        elif kind in (KIND_LATEST, KIND_HISTORY):
+            size = count * RECORD.size
+        else:
+            raise ValueError("offset %d: unknown kind %d" % (pos, kind))
+        if pos + size > len(data):
+            raise ValueError("offset %d: truncated response" % pos)
+        header = dict(kind=kind, count=count, first_seq=first_seq,
+                      next_seq=next_seq, now_ms=now_ms, epoch_s=epoch_s)
+        yield header, data[pos:pos + size]
+        pos += size
+
+
+def wall_time(header, time_ms):
+    """Unix time of a sample, or None before the device had synced time."""
+    if not header["epoch_s"]:
+        return None
+    return header["epoch_s"] - (header["now_ms"] - time_ms) / 1000.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", nargs="?", help="concatenated responses (default: stdin)")
+    parser.add_argument("--stats", action="store_true",
+                        help="print the stats responses instead of the samples")
+    opts = parser.parse_args()
+
+    src = open(opts.dump, "rb") if opts.dump else sys.stdin.buffer
+    data = src.read()
+
+    samples = {}
+    for header, payload in read_responses(data):
+        if header["kind"] == KIND_STATS:
+            if opts.stats:
+                v = STATS.unpack(payload)
+                print("%d samples over %.0f s" % (header["count"], v[0] / 1000.0))
+                for i, (name, scale) in enumerate((("temp_c", 10.0), ("hum_pct", 10.0),
+                                                   ("aqi", 1.0), ("lux", 1.0))):
+                    lo, avg, hi = v[1 + 3 * i:4 + 3 * i]
+                    print("  %-8s min %g avg %g max %g" % (name, lo / scale, avg / scale,
+                                                           hi / scale))
+            continue
+        for i in range(header["count"]):
+            rec = RECORD.unpack_from(payload, i * RECORD.size)
+            samples[header["first_seq"] + i] = (header, rec)
+
+    if opts.stats:
+        return
+    print("seq,time_ms,unix_time,temp_c,hum_pct,aqi,lux")
+    for seq in sorted(samples):
+        header, (time_ms, temp_dc, hum_dc, aqi, lux) = samples[seq]
+        unix = wall_time(header, time_ms)
+        print("%d,%d,%s,%.1f,%.1f,%d,%d" % (seq, time_ms, "" if unix is None else "%.0f" % unix,
+                                           temp_dc / 10.0, hum_dc / 10.0, aqi, lux))
+
+
+if __name__ == "__main__":
+    main()
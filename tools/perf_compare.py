@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Compare two microbenchmark runs (components/perf) and flag regressions.
+
+Save the output of the "perf" console command (or of the host build's
+env_logger_bench) for each firmware version, then:
+
+    python tools/perf_compare.py perf-1.0.0.txt perf-1.1.0.txt --threshold 10
+
+The JSON line is picked out of the capture, so raw serial logs work. Medians
+are compared; the exit status is 1 if any benchmark got slower by more than
+the threshold (percent), so the script can gate CI.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Return (header, {name: result}) from the first perf JSON line in path."""
+    with open(path, errors="replace") as f:
+        for line in f:
+            start = line.find('{"perf":')
+            if start >= 0:
+                doc = json.loads(line[start:])
+                return doc, {r["name"]: r for r in doc["results"]}
+    raise ValueError("%s: no perf JSON line found" % path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("base", help="baseline capture")
+    parser.add_argument("new", help="capture to compare against the baseline")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed median slowdown in percent (default 10)")
+    opts = parser.parse_args()
+
+    base_doc, base = load(opts.base)
+    new_doc, new = load(opts.new)
+    if (base_doc["target"], base_doc["clock"]) != (new_doc["target"], new_doc["clock"]):
+        print("warning: comparing %s/%s against %s/%s" % (
+            base_doc["target"], base_doc["clock"], new_doc["target"], new_doc["clock"]),
+            file=sys.stderr)
+
+    print("%-26s %13s %13s %8s" % ("benchmark", base_doc["version"], new_doc["version"], "delta"))
+    regressions = 0
+    for name in list(base) + [n for n in new if n not in base]:
+        if name not in base or name not in new:
+            cols = ["%d ns" % runs[name]["ns_median"] if name in runs else "-"
+                    for runs in (base, new)]
+            print("%-26s %13s %13s %8s" % (name, cols[0], cols[1], "n/a"))
+            continue
+        old_ns = base[name]["ns_median"]
+        new_ns = new[name]["ns_median"]
+        delta = 100.0 * (new_ns - old_ns) / old_ns if old_ns else 0.0
+        flag = ""
+        if delta > opts.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-26s %10d ns %10d ns %+7.1f%%%s" % (name, old_ns, new_ns, delta, flag))
+
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
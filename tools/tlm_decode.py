@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Decode CBOR uplink batches (main/telemetry_cbor.h) into CSV.
+
+Subscribe to node/<node_id>/tlm/cbor and append each payload to one file
+(CBOR is self-delimiting, so the file is a plain CBOR sequence). Then:
+
+    python tools/tlm_decode.py batches.bin > samples.csv
+    python tools/tlm_decode.py --compare batches.bin
+
+--compare prints bytes per sample against the JSON parameter reports the
+same samples would have cost. Backlog replay batches (main/backlog.h) fill
+the boot column, and gap is 1 on the first sample after a restart. The simulator writes such a file with
+--tlm-dump. Only the CBOR subset the firmware emits is decoded; no
+third-party packages are needed.
+"""
+
+import argparse
+import sys
+
+VERSION = 1
+STATUS = ((50, "Good"), (100, "Moderate"), (150, "Unhealthy for Sensitive"),
+          (200, "Unhealthy"), (300, "Very Unhealthy"))
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def head(self):
+        if self.pos >= len(self.data):
+            raise ValueError("offset %d: truncated" % self.pos)
+        initial = self.data[self.pos]
+        self.pos += 1
+        major, info = initial >> 5, initial & 0x1f
+        if info < 24:
+            return major, info
+        size = {24: 1, 25: 2, 26: 4, 27: 8}.get(info)
+        if size is None or self.pos + size > len(self.data):
+            raise ValueError("offset %d: unsupported item 0x%02x" % (self.pos - 1, initial))
+        value = int.from_bytes(self.data[self.pos:self.pos + size], "big")
+        self.pos += size
+        return major, value
+
+    def item(self):
+        major, value = self.head()
+        if major == 0:
+            return value
+        if major == 1:
+            return -1 - value
+        if major == 3:
+            text = self.data[self.pos:self.pos + value].decode()
+            self.pos += value
+            return text
+        if major == 4:
+            return [self.item() for _ in range(value)]
+        if major == 5:
+            return {self.item(): self.item() for _ in range(value)}
+        raise ValueError("offset %d: unsupported major type %d" % (self.pos, major))
+
+
+def read_batches(data):
+    """Yield (batch, encoded size) for each batch in a CBOR sequence."""
+    r = Reader(data)
+    while r.pos < len(data):
+        start = r.pos
+        batch = r.item()
+        if not isinstance(batch, dict) or batch.get("v") != VERSION:
+            raise ValueError("offset %d: not a version %d batch" % (start, VERSION))
+        yield batch, r.pos - start
+
+
+def samples(batch):
+    """Yield (time_ms, unix_time or None, temp_c, hum_pct, aqi, lux)."""
+    t = batch["t"]
+    for dt, temp_dc, hum_dc, aqi, lux in batch["s"]:
+        t += dt
+        unix = batch["e"] - (batch["n"] - t) / 1000.0 if batch["e"] else None
+        yield t, unix, temp_dc / 10.0, hum_dc / 10.0, aqi, lux
+
+
+def json_size(temp_c, hum_pct, aqi):
+    """Bytes of the parameter report cloud_publish_sample() sends."""
+    status = next((s for limit, s in STATUS if aqi <= limit), "Hazardous")
+    return len('{"Temperature Sensor":{"Temperature":%.5f},"Humidity Sensor":{"Humidity":%.5f},'
+               '"AQI Sensor":{"AQI":%d,"Air Quality Status":"%s"}}'
+               % (temp_c, hum_pct, aqi, status))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dump", nargs="?", help="CBOR sequence of batches (default: stdin)")
+    parser.add_argument("--compare", action="store_true",
+                        help="print bytes per sample against the JSON parameter path")
+    opts = parser.parse_args()
+
+    src = open(opts.dump, "rb") if opts.dump else sys.stdin.buffer
+    data = src.read()
+
+    if opts.compare:
+        batches = count = cbor = json = 0
+        for batch, size in read_batches(data):
+            batches += 1
+            cbor += size
+            for _, _, temp_c, hum_pct, aqi, _ in samples(batch):
+                count += 1
+                json += json_size(temp_c, hum_pct, aqi)
+        if not count:
+            print("no samples")
+            return
+        print("%d batches, %d samples" % (batches, count))
+        print("  cbor %7d bytes, %6.1f per sample" % (cbor, cbor / count))
+        print("  json %7d bytes, %6.1f per sample (%.1fx)" % (json, json / count, json / cbor))
+        return
+
+    print("time_ms,unix_time,temp_c,hum_pct,aqi,lux,boot,gap")
+    for batch, _ in read_batches(data):
+        boot = batch.get("b", "")
+        gap = batch.get("g", 0)
+        for t, unix, temp_c, hum_pct, aqi, lux in samples(batch):
+            print("%d,%s,%.1f,%.1f,%d,%d,%s,%d" % (t, "" if unix is None else "%.0f" % unix,
+                                                   temp_c, hum_pct, aqi, lux, boot, gap))
+            gap = 0
+
+
+if __name__ == "__main__":
+    main()
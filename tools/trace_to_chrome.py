@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Convert an event trace dump (components/evtrace) to Chrome trace JSON.
+
+Capture the serial output of the "trace" console command, then:
+
+    python tools/trace_to_chrome.py capture.txt -o trace.json
+
+Open trace.json in chrome://tracing or https://ui.perfetto.dev. Each
+FreeRTOS task becomes one thread; spans are B/E pairs and instants are
+thread-scoped "i" events carrying their 16-bit argument.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+PHASES = {0: "B", 1: "E", 2: "i"}
+
+
+def read_dumps(lines):
+    """Yield (cpu_mhz, tasks, events, entries) for every TRACE BEGIN/END block."""
+    block = None
+    for line in lines:
+        if "=== TRACE BEGIN" in line:
+            m = re.search(r"cpu_mhz=(\d+)", line)
+            block = (int(m.group(1)) if m else 160, {}, {}, [])
+        elif "=== TRACE END" in line:
+            if block is not None:
+                yield block
+            block = None
+        elif block is not None:
+            parts = line.split()
+            if len(parts) >= 3 and parts[0] == "task":
+                block[1][int(parts[1])] = " ".join(parts[2:])
+            elif len(parts) >= 3 and parts[0] == "event":
+                block[2][int(parts[1])] = " ".join(parts[2:])
+            else:
+                words = [int(tok, 16) for tok in parts if re.fullmatch(r"[0-9a-fA-F]{8}", tok)]
+                block[3].extend(zip(words[0::2], words[1::2]))
+
+
+def convert(cpu_mhz, tasks, events, entries):
+    """Build the traceEvents list, unwrapping the 32-bit cycle counter."""
+    out = []
+    seen_tasks = set()
+    last = None
+    high = 0
+    base = None
+    for cycles, info in entries:
+        # Preemption can reorder neighbouring entries slightly, so only a
+        # large backwards step counts as a wrap
+        if last is not None and last - cycles > 1 << 31:
+            high += 1 << 32
+        last = cycles
+        absolute = high + cycles
+        if base is None:
+            base = absolute
+        ev_type = info >> 30
+        task = (info >> 22) & 0xFF
+        event = (info >> 16) & 0x3F
+        arg = info & 0xFFFF
+        if ev_type not in PHASES:
+            continue
+        seen_tasks.add(task)
+        record = {
+            "name": events.get(event, "event_%d" % event),
+            "ph": PHASES[ev_type],
+            "ts": (absolute - base) / float(cpu_mhz),
+            "pid": 1,
+            "tid": task,
+        }
+        if ev_type == 2:
+            record["s"] = "t"
+            record["args"] = {"arg": arg}
+        out.append(record)
+
+    # The recorder keeps 8 bits of the task number
+    listed = {number & 0xFF: name for number, name in tasks.items()}
+    unknown = sorted(seen_tasks - set(listed))
+    for task in sorted(seen_tasks):
+        out.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": task,
+                    "args": {"name": listed.get(task, "task %d" % task)}})
+    out.append({"name": "process_name", "ph": "M", "pid": 1,
+                "args": {"name": "smart-env-logger"}})
+    return out, unknown
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="serial capture (default: stdin)")
+    parser.add_argument("-o", "--output", help="output JSON (default: stdout)")
+    parser.add_argument("--strict", action="store_true",
+                        help="fail if an event names a task missing from the task table")
+    opts = parser.parse_args()
+
+    src = open(opts.capture, errors="replace") if opts.capture else sys.stdin
+    trace_events, unknown = [], []
+    for block in read_dumps(src):
+        trace_events, unknown = convert(*block)  # Keep the most recent dump
+    if not trace_events:
+        sys.exit("no TRACE BEGIN/END block found")
+    if unknown:
+        # A task deleted before the dump, or a recorder writing the wrong number
+        print("events from tasks not in the task table: %s" %
+              " ".join(str(t) for t in unknown), file=sys.stderr)
+        if opts.strict:
+            sys.exit(1)
+
+    doc = {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+    if opts.output:
+        with open(opts.output, "w") as f:
+            json.dump(doc, f)
+    else:
+        json.dump(doc, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()